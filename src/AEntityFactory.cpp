@@ -23,9 +23,14 @@
 #include "moab/CN.hpp"
 #include "moab/MeshTopoUtil.hpp"
 #include "EntitySequence.hpp"
+#include "ElementSequence.hpp"
+#include "ScdElementData.hpp"
+#include "ScdVertexData.hpp"
 #include "SequenceData.hpp"
 #include "SequenceManager.hpp"
 #include "RangeSeqIntersectIter.hpp"
+#include "ThreadPool.hpp"
+#include "moab/MemoryCounter.hpp"
 
 #include <assert.h>
 #include <algorithm>
@@ -33,6 +38,88 @@
 
 namespace moab {
 
+  // Adjacency lists are charged to the counter of the instance (which
+  // also charges the MEM_ADJACENCIES counter) where they are created,
+  // grown, and destroyed.
+static inline size_t list_bytes( const AdjacencyVector* vec )
+  { return vec ? sizeof(AdjacencyVector) + vec->capacity() * sizeof(EntityHandle) : 0; }
+
+static AdjacencyVector* new_adj_list( MemoryCounter& counter )
+{
+  AdjacencyVector* vec = new AdjacencyVector;
+  counter.add( list_bytes( vec ) );
+  return vec;
+}
+
+template <class Iter> static 
+AdjacencyVector* new_adj_list( MemoryCounter& counter, Iter begin, Iter end )
+{
+  AdjacencyVector* vec = new AdjacencyVector( begin, end );
+  counter.add( list_bytes( vec ) );
+  return vec;
+}
+
+static void delete_adj_list( MemoryCounter& counter, AdjacencyVector* vec )
+{
+  if (vec) {
+    counter.remove( list_bytes( vec ) );
+    delete vec;
+  }
+}
+
+  // Bulk operations on many lists total the changes here and publish
+  // them to the counter once, rather than updating the shared atomic
+  // counters (and the MEM_ADJACENCIES counter above them) per list.
+struct AdjListTally {
+  size_t addBytes, addLists, removeBytes, removeLists;
+
+  AdjListTally() : addBytes(0), addLists(0), removeBytes(0), removeLists(0) {}
+
+  template <class Iter>
+  AdjacencyVector* new_list( Iter begin, Iter end )
+  {
+    AdjacencyVector* vec = new AdjacencyVector( begin, end );
+    addBytes += list_bytes( vec );
+    ++addLists;
+    return vec;
+  }
+
+  void delete_list( AdjacencyVector* vec )
+  {
+    if (vec) {
+      removeBytes += list_bytes( vec );
+      ++removeLists;
+      delete vec;
+    }
+  }
+
+    // fold another tally into this one; called concurrently
+    // by workers when \c atomic is true
+  void merge( const AdjListTally& other, bool atomic )
+  {
+    if (atomic) {
+      atomic_fetch_add( addBytes, other.addBytes );
+      atomic_fetch_add( addLists, other.addLists );
+      atomic_fetch_add( removeBytes, other.removeBytes );
+      atomic_fetch_add( removeLists, other.removeLists );
+    }
+    else {
+      addBytes += other.addBytes;
+      addLists += other.addLists;
+      removeBytes += other.removeBytes;
+      removeLists += other.removeLists;
+    }
+  }
+
+  void publish( MemoryCounter& counter ) const
+  {
+    if (addLists)
+      counter.add( addBytes, addLists );
+    if (removeLists)
+      counter.remove( removeBytes, removeLists );
+  }
+};
+
 ErrorCode AEntityFactory::get_vertices( EntityHandle h,
                                           const EntityHandle*& vect_out,
                                           int& count_out,
@@ -52,10 +139,16 @@ ErrorCode AEntityFactory::get_vertices( EntityHandle h,
 }
 
 AEntityFactory::AEntityFactory(Core *mdb) 
+  : adjMemory( &MemoryCounter::category( MEM_ADJACENCIES ) )
 {
   assert(NULL != mdb);
   thisMB = mdb;
   mVertElemAdj = false;
+  memoryBudget = 0;
+  numThreads = 0;
+  accessCount = 0;
+  numRestores = 0;
+  budgetHolds = 0;
 }
 
 
@@ -65,6 +158,7 @@ AEntityFactory::~AEntityFactory()
   EntityType ent_type;
 
   // iterate through each element type
+  AdjListTally tally;
   for (ent_type = MBVERTEX; ent_type <= MBENTITYSET; ent_type++) {
     TypeSequenceManager::iterator i;
     TypeSequenceManager& seqman = thisMB->sequence_manager()->entity_map( ent_type );
@@ -75,11 +169,20 @@ AEntityFactory::~AEntityFactory()
       adj_list += (*i)->start_handle() - (*i)->data()->start_handle();
       
       for (EntityID j = 0; j < (*i)->size(); ++j) {
-        delete adj_list[j];
+        tally.delete_list( adj_list[j] );
         adj_list[j] = 0;
       }
     }
   }
+  tally.publish( adjMemory );
+  
+  for (size_t j = 0; j < compactVertAdj.size(); ++j) {
+    adjMemory.remove( compactVertAdj[j]->memory_use() );
+    delete compactVertAdj[j];
+  }
+  
+  for (AdjacencyPageMap::iterator p = adjPages.begin(); p != adjPages.end(); ++p)
+    adjMemory.remove( p->second.removed.get_memory_use() );
 }
 
 //! get the elements contained by source_entity, of
@@ -199,12 +302,28 @@ ErrorCode AEntityFactory::get_element(const EntityHandle *vertex_list,
   if(mVertElemAdj == false)
     create_vert_elem_adjacencies();
   
-  // get the adjacency list
+  // get the adjacency list, which must not be released while in use
+  BudgetHold hold( this );
   const EntityHandle* adj_vec;
   int num_adj;
   result = get_adjacencies( vertex_list[0], adj_vec, num_adj );
-  if(result != MB_SUCCESS || adj_vec == NULL)
+  if(result != MB_SUCCESS)
+    return result;
+  
+  // structured elements aren't in the adjacency list
+  std::vector<EntityHandle> scd_adj;
+  const unsigned target_dim = CN::Dimension(target_type);
+  result = get_structured_elements( vertex_list[0], target_dim, target_dim, scd_adj );
+  if (result != MB_SUCCESS)
     return result;
+  if (!scd_adj.empty()) {
+    scd_adj.insert( scd_adj.end(), adj_vec, adj_vec + num_adj );
+    std::sort( scd_adj.begin(), scd_adj.end() );
+    adj_vec = &scd_adj[0];
+    num_adj = scd_adj.size();
+  }
+  else if (adj_vec == NULL)
+    num_adj = 0; // e.g. structured vertex, may still create the element
 
   // check to see if any of these are equivalent to the vertex list
   int dum;
@@ -379,6 +498,8 @@ ErrorCode AEntityFactory::add_adjacency(EntityHandle from_ent,
   if (MB_SUCCESS != result) 
     return result;
 
+  const size_t old_bytes = list_bytes( adj_list_ptr );
+
     // get an iterator to the right spot in this sorted vector
   AdjacencyVector::iterator adj_iter;
   if (!adj_list_ptr->empty()) 
@@ -393,6 +514,7 @@ ErrorCode AEntityFactory::add_adjacency(EntityHandle from_ent,
   }
   else
     adj_list_ptr->push_back(to_ent);
+  adjMemory.resize( old_bytes, list_bytes( adj_list_ptr ) );
 
     // if both_ways is true, recursively call this function
   if (true == both_ways && to_type != MBVERTEX)
@@ -486,50 +608,699 @@ ErrorCode AEntityFactory::remove_all_adjacencies(EntityHandle base_entity,
   return MB_SUCCESS;
 }
 
-ErrorCode AEntityFactory::create_vert_elem_adjacencies()
+/**\brief Passes of the bulk construction of vertex to element adjacencies
+ *
+ * Element passes (COUNT and FILL) work on chunks of element sequences;
+ * vertex passes (SORT and EXPAND) work on chunks of vertex blocks.  
+ * Items in the same pass never write the same memory, except for 
+ * the per-vertex counters and cursors, which are updated atomically
+ * when more than one thread is in use.
+ */
+class VertElemAdjTask : public ThreadTask
+{
+public:
+  typedef AEntityFactory::CompactVertAdj Block;
+
+  enum Pass { COUNT, FILL, SORT, EXPAND };
+
+  struct ElemChunk {
+    const ElementSequence* seq;
+    EntityHandle start, end;
+  };
+
+  struct VertChunk {
+    size_t block;
+    EntityID begin, end;
+  };
+
+  VertElemAdjTask( AEntityFactory* factory, std::vector<Block*>& blocks, bool atomic )
+    : factory(factory), blocks(blocks), atomic(atomic), pass(COUNT),
+      numParallelElemChunks(0)
+    {}
+
+  ErrorCode execute( size_t item );
+
+  //! set up element chunks; polyhedra, which require other
+  //! queries to get their vertices, are placed at the end
+  void init_element_chunks( SequenceManager* seqman );
+  
+  //! set up vertex chunks
+  void init_vertex_chunks();
+
+  //! run the current element pass
+  ErrorCode run_element_pass( ThreadPool& pool, Pass p );
+  
+  AEntityFactory* factory;
+  std::vector<Block*>& blocks;
+  bool atomic;
+  Pass pass;
+  std::vector<ElemChunk> elemChunks;
+  size_t numParallelElemChunks;
+  std::vector<VertChunk> vertChunks;
+  std::vector< std::vector<EntityID> > blockLengths;
+    //! lists created and released by the EXPAND pass, summed over
+    //! chunks and published to the factory's counter by the caller
+  AdjListTally listTally;
+
+private:
+  ErrorCode execute_element_chunk( const ElemChunk& chunk );
+  void execute_vertex_chunk( const VertChunk& chunk );
+};
+
+const EntityID VERT_ELEM_ADJ_CHUNK_SIZE = 16384;
+
+void VertElemAdjTask::init_element_chunks( SequenceManager* seqman )
+{
+  std::vector<ElemChunk> poly_chunks;
+  for (EntityType t = MBEDGE; t != MBENTITYSET; t++) {
+    std::vector<ElemChunk>& list = (MBPOLYHEDRON == t) ? poly_chunks : elemChunks;
+    TypeSequenceManager& typeseq = seqman->entity_map( t );
+    for (TypeSequenceManager::iterator i = typeseq.begin(); i != typeseq.end(); ++i) {
+        // adjacencies for structured elements are computed, not stored
+      if (dynamic_cast<ScdElementData*>((*i)->data()))
+        continue;
+      
+      ElemChunk chunk;
+      chunk.seq = static_cast<ElementSequence*>(*i);
+      for (EntityHandle h = (*i)->start_handle(); h <= (*i)->end_handle(); ) {
+        chunk.start = h;
+        if ((*i)->end_handle() - h < (EntityHandle)VERT_ELEM_ADJ_CHUNK_SIZE)
+          chunk.end = (*i)->end_handle();
+        else
+          chunk.end = h + VERT_ELEM_ADJ_CHUNK_SIZE - 1;
+        list.push_back( chunk );
+        if (chunk.end == (*i)->end_handle())
+          break;
+        h = chunk.end + 1;
+      }
+    }
+  }
+  numParallelElemChunks = elemChunks.size();
+  elemChunks.insert( elemChunks.end(), poly_chunks.begin(), poly_chunks.end() );
+}
+
+void VertElemAdjTask::init_vertex_chunks()
+{
+  VertChunk chunk;
+  for (chunk.block = 0; chunk.block < blocks.size(); ++chunk.block) {
+    const EntityID count = blocks[chunk.block]->offsets.size() - 1;
+    for (chunk.begin = 0; chunk.begin < count; chunk.begin = chunk.end) {
+      chunk.end = std::min( count, chunk.begin + VERT_ELEM_ADJ_CHUNK_SIZE );
+      vertChunks.push_back( chunk );
+    }
+  }
+}
+
+ErrorCode VertElemAdjTask::run_element_pass( ThreadPool& pool, Pass p )
+{
+  pass = p;
+  ErrorCode rval = pool.run( *this, numParallelElemChunks );
+  for (size_t i = numParallelElemChunks; MB_SUCCESS == rval && i < elemChunks.size(); ++i)
+    rval = execute_element_chunk( elemChunks[i] );
+  return rval;
+}
+
+ErrorCode VertElemAdjTask::execute( size_t item )
+{
+  if (COUNT == pass || FILL == pass)
+    return execute_element_chunk( elemChunks[item] );
+  
+  execute_vertex_chunk( vertChunks[item] );
+  return MB_SUCCESS;
+}
+
+ErrorCode VertElemAdjTask::execute_element_chunk( const ElemChunk& chunk )
+{
+  const bool poly = (MBPOLYHEDRON == chunk.seq->type());
+  const EntityHandle* array = poly ? 0 : chunk.seq->get_connectivity_array();
+  int num_conn = chunk.seq->nodes_per_element();
+  if (array)
+    array += num_conn * (chunk.start - chunk.seq->start_handle());
+
+  const EntityHandle* conn;
+  std::vector<EntityHandle> storage;
+  ErrorCode rval;
+  Block* block = blocks.front();
+  for (EntityHandle h = chunk.start; h <= chunk.end; ++h) {
+    if (array) {
+      conn = array;
+      array += num_conn;
+    }
+    else {
+      if (poly)
+        rval = factory->get_vertices( h, conn, num_conn, storage );
+      else
+        rval = chunk.seq->get_connectivity( h, conn, num_conn, false, &storage );
+      if (MB_SUCCESS != rval)
+        return rval;
+    }
+
+    for (int k = 0; k < num_conn; ++k) {
+      if (conn[k] < block->startHandle || conn[k] > block->endHandle) {
+        block = AEntityFactory::find_compact_block( blocks, conn[k] );
+        if (!block)
+          return MB_ENTITY_NOT_FOUND;
+      }
+
+      const EntityID idx = conn[k] - block->startHandle;
+      if (COUNT == pass) {
+        if (atomic)
+          atomic_fetch_add( block->offsets[idx+1], (EntityID)1 );
+        else
+          ++block->offsets[idx+1];
+      }
+      else {
+        EntityID pos;
+        if (atomic)
+          pos = atomic_fetch_add( block->offsets[idx], (EntityID)1 );
+        else
+          pos = block->offsets[idx]++;
+        block->adjacencies[pos] = h;
+      }
+    }
+  }
+
+  return MB_SUCCESS;
+}
+
+void VertElemAdjTask::execute_vertex_chunk( const VertChunk& chunk )
+{
+  Block* b = blocks[chunk.block];
+  std::vector<EntityID>& offsets = b->offsets;
+  std::vector<EntityHandle>::iterator adj = b->adjacencies.begin();
+  
+  if (SORT == pass) {
+      // each offset is at the end of the vertex's list
+    std::vector<EntityID>& lengths = blockLengths[chunk.block];
+    for (EntityID j = chunk.begin; j < chunk.end; ++j) {
+      std::vector<EntityHandle>::iterator beg = adj + (j ? offsets[j-1] : 0),
+                                          end = adj + offsets[j];
+      std::sort( beg, end );
+      lengths[j] = std::unique( beg, end ) - beg;
+    }
+  }
+  else { // EXPAND
+    AdjacencyVector** adj_list = b->data->get_adjacency_data();
+    AdjListTally tally;
+    for (EntityID j = chunk.begin; j < chunk.end; ++j) {
+      if (offsets[j] == offsets[j+1])
+        continue;
+      AdjacencyVector* vec = tally.new_list( adj + offsets[j], adj + offsets[j+1] );
+      tally.delete_list( adj_list[j] );
+      adj_list[j] = vec;
+    }
+    listTally.merge( tally, atomic );
+  }
+}
+
+unsigned AEntityFactory::thread_count( unsigned num_threads ) const
+{
+  if (num_threads)
+    return num_threads;
+  if (numThreads)
+    return numThreads;
+  if (unsigned n = ThreadPool::env_num_threads())
+    return n;
+  return 1;
+}
+
+ErrorCode AEntityFactory::create_vert_elem_adjacencies( unsigned num_threads )
 {
+    // other threads may be reading adjacency data
+  if (thisMB->is_read_only_phase())
+    return MB_FAILURE;
+  if (mVertElemAdj)
+    return MB_SUCCESS;
+
+    // Build the adjacencies in packed form and then copy them
+    // into per-vertex lists, merging any existing lists.
+  ThreadPool pool( thread_count( num_threads ) );
+  std::vector<CompactVertAdj*> blocks;
+  ErrorCode result = pack_vert_adjacencies( blocks, true, pool );
+  if (MB_SUCCESS != result)
+    return result;
 
+  for (size_t i = 0; i < blocks.size(); ++i) 
+    if (!blocks[i]->adjacencies.empty() && !blocks[i]->data->get_adjacency_data())
+      blocks[i]->data->allocate_adjacency_data();
+  
+  VertElemAdjTask task( this, blocks, pool.num_threads() > 1 );
+  task.init_vertex_chunks();
+  task.pass = VertElemAdjTask::EXPAND;
+  result = pool.run( task, task.vertChunks.size() );
+  task.listTally.publish( adjMemory );
+
+  for (size_t i = 0; i < blocks.size(); ++i)
+    delete blocks[i];
+  if (MB_SUCCESS != result)
+    return result;
+  
   mVertElemAdj = true;
+  return MB_SUCCESS;
+}
 
-  EntityType ent_type;
-  Range::iterator i_range;
-  const EntityHandle *connectivity;
-  std::vector<EntityHandle> aux_connect;
-  int number_nodes;
-  ErrorCode result;
-  Range handle_range;
+ErrorCode AEntityFactory::pack_vert_adjacencies( std::vector<CompactVertAdj*>& blocks,
+                                                 bool with_elements,
+                                                 ThreadPool& pool )
+{
+    // one block per SequenceData, counting existing per-vertex lists
+  TypeSequenceManager& verts = thisMB->sequence_manager()->entity_map( MBVERTEX );
+  TypeSequenceManager::iterator i;
+  for (i = verts.begin(); i != verts.end(); ++i) {
+    SequenceData* data = (*i)->data();
+    if (blocks.empty() || blocks.back()->data != data) {
+      blocks.push_back( new CompactVertAdj );
+      blocks.back()->startHandle = data->start_handle();
+      blocks.back()->endHandle = data->end_handle();
+      blocks.back()->data = data;
+      blocks.back()->offsets.resize( data->size() + 1, 0 );
+    }
+    
+    AdjacencyVector** adj_list = data->get_adjacency_data();
+    if (!adj_list)
+      continue;
+    EntityID* counts = &blocks.back()->offsets[1];
+    for (EntityHandle h = (*i)->start_handle(); h <= (*i)->end_handle(); ++h)
+      if (adj_list[h - data->start_handle()])
+        counts[h - data->start_handle()] = adj_list[h - data->start_handle()]->size();
+  }
+  if (blocks.empty())
+    return MB_SUCCESS;
   
-  // 1. over all element types, for each element, create vertex-element adjacencies
-  for (ent_type = MBEDGE; ent_type != MBENTITYSET; ent_type++) 
-  {
-    handle_range.clear();
+  VertElemAdjTask task( this, blocks, pool.num_threads() > 1 );
+  ErrorCode result = MB_SUCCESS;
+  if (with_elements) {
+    task.init_element_chunks( thisMB->sequence_manager() );
+    result = task.run_element_pass( pool, VertElemAdjTask::COUNT );
+  }
+  
+    // convert counts to offsets, then copy existing lists, leaving
+    // each offset at the end of the vertex's entries
+  std::vector<CompactVertAdj*>::iterator b;
+  for (b = blocks.begin(); MB_SUCCESS == result && b != blocks.end(); ++b) {
+    std::vector<EntityID>& offsets = (*b)->offsets;
+    for (size_t j = 1; j < offsets.size(); ++j)
+      offsets[j] += offsets[j-1];
+    (*b)->adjacencies.resize( offsets.back() );
+    
+    AdjacencyVector** adj_list = (*b)->data->get_adjacency_data();
+    for (size_t j = 0; adj_list && j + 1 < offsets.size(); ++j) {
+      if (adj_list[j]) {
+        std::copy( adj_list[j]->begin(), adj_list[j]->end(), 
+                   (*b)->adjacencies.begin() + offsets[j] );
+        offsets[j] += adj_list[j]->size();
+      }
+    }
+  }
+  if (MB_SUCCESS == result && with_elements)
+    result = task.run_element_pass( pool, VertElemAdjTask::FILL );
+  
+    // Lists built from both existing entries and element connectivity 
+    // are unsorted and may contain duplicates (for degenerate elements.)
+  if (MB_SUCCESS == result && with_elements) {
+    task.blockLengths.resize( blocks.size() );
+    for (size_t j = 0; j < blocks.size(); ++j)
+      task.blockLengths[j].resize( blocks[j]->offsets.size() - 1 );
+    task.init_vertex_chunks();
+    task.pass = VertElemAdjTask::SORT;
+    result = pool.run( task, task.vertChunks.size() );
+  }
+  
+  if (MB_SUCCESS != result) {
+    for (b = blocks.begin(); b != blocks.end(); ++b)
+      delete *b;
+    blocks.clear();
+    return result;
+  }
+  
+    // shift offsets back to the start of each list
+  for (size_t k = 0; k < blocks.size(); ++k) {
+    std::vector<EntityID>& offsets = blocks[k]->offsets;
+    std::vector<EntityHandle>& adj = blocks[k]->adjacencies;
+    EntityID read_begin = 0, write = 0;
+    for (size_t j = 0; j + 1 < offsets.size(); ++j) {
+      EntityID read_end = offsets[j];
+      if (with_elements) {
+        EntityID len = task.blockLengths[k][j];
+        if (write != read_begin)
+          std::copy( adj.begin() + read_begin, adj.begin() + read_begin + len, 
+                     adj.begin() + write );
+        offsets[j] = write;
+        write += len;
+      }
+      else {
+        offsets[j] = read_begin;
+      }
+      read_begin = read_end;
+    }
+    if (with_elements) {
+      offsets.back() = write;
+      if (write != (EntityID)adj.size())
+        std::vector<EntityHandle>( adj.begin(), adj.begin() + write ).swap( adj );
+    }
+    else {
+      offsets.back() = read_begin;
+    }
+  }
+  
+  return MB_SUCCESS;
+}
 
-    // get this type of entity
-    result = thisMB->get_entities_by_type(0, ent_type, handle_range);
-    if (result != MB_SUCCESS)
-      return result;
+ErrorCode AEntityFactory::compact_vert_elem_adjacencies( unsigned num_threads )
+{
+    // other threads may be reading adjacency data
+  if (thisMB->is_read_only_phase())
+    return MB_FAILURE;
+  if (!compactVertAdj.empty())
+    return MB_SUCCESS;
+  ErrorCode result = restore_vert_elem_adjacencies();
+  if (MB_SUCCESS != result)
+    return result;
+  
+  ThreadPool pool( thread_count( num_threads ) );
+  std::vector<CompactVertAdj*> blocks;
+  result = pack_vert_adjacencies( blocks, !mVertElemAdj, pool );
+  if (MB_SUCCESS != result)
+    return result;
+  
+    // release the per-vertex lists
+  AdjListTally tally;
+  TypeSequenceManager& verts = thisMB->sequence_manager()->entity_map( MBVERTEX );
+  TypeSequenceManager::iterator i;
+  for (i = verts.begin(); i != verts.end(); ++i) {
+    AdjacencyVector** adj_list = (*i)->data()->get_adjacency_data();
+    if (!adj_list)
+      continue;
+    
+    adj_list += (*i)->start_handle() - (*i)->data()->start_handle();
+    for (EntityID j = 0; j < (*i)->size(); ++j) {
+      tally.delete_list( adj_list[j] );
+      adj_list[j] = 0;
+    }
+    
+    TypeSequenceManager::iterator next = i;
+    if (++next == verts.end() || (*next)->data() != (*i)->data())
+      (*i)->data()->release_adjacency_data();
+  }
+  
+  tally.publish( adjMemory );
+  for (size_t j = 0; j < blocks.size(); ++j)
+    adjMemory.add( blocks[j]->memory_use() );
+  mVertElemAdj = true;
+  compactVertAdj.swap( blocks );
+  return MB_SUCCESS;
+}
 
-    for (i_range = handle_range.begin(); i_range != handle_range.end(); ++i_range) 
-    {
-      result = get_vertices( *i_range, connectivity, number_nodes, aux_connect );
-      if (MB_SUCCESS != result)
-        return result;
+ErrorCode AEntityFactory::expand_vert_elem_adjacencies()
+{
+  if (compactVertAdj.empty())
+    return MB_SUCCESS;
+    // other threads may be reading adjacency data
+  if (thisMB->is_read_only_phase())
+    return MB_FAILURE;
+  
+  std::vector<CompactVertAdj*> blocks;
+  blocks.swap( compactVertAdj );
+  
+  ErrorCode result = MB_SUCCESS;
+  AdjListTally tally;
+  for (std::vector<CompactVertAdj*>::iterator b = blocks.begin(); b != blocks.end(); ++b) {
+    const std::vector<EntityID>& offsets = (*b)->offsets;
+    std::vector<EntityHandle>::const_iterator adj = (*b)->adjacencies.begin();
+    for (size_t j = 0; MB_SUCCESS == result && j + 1 < offsets.size(); ++j) {
+      if (offsets[j] == offsets[j+1])
+        continue;
       
-        // add the adjacency
-      for( int k=0; k<number_nodes; k++)
-        if ((result = add_adjacency(connectivity[k], *i_range)) != MB_SUCCESS)
-          return result;
+      AdjacencyVector* vec = tally.new_list( adj + offsets[j], adj + offsets[j+1] );
+      result = set_adjacency_ptr( (*b)->startHandle + j, vec );
+      if (MB_SUCCESS != result)
+        tally.delete_list( vec );
     }
+    adjMemory.remove( (*b)->memory_use() );
+    delete *b;
   }
+  tally.publish( adjMemory );
+  
+  return result;
+}
+
+ErrorCode AEntityFactory::set_memory_budget( size_t bytes )
+{
+  memoryBudget = bytes;
+  if (!memoryBudget)
+    return restore_vert_elem_adjacencies();
+  return enforce_memory_budget();
+}
+
+bool AEntityFactory::may_release_vert_adjacencies() const
+{
+  if (!memoryBudget || adjMemory.bytes() <= memoryBudget)
+    return false;
+    // Compact lists cannot be released individually, other threads may
+    // be reading the lists, or the caller may hold pointers to lists.
+  return mVertElemAdj && compactVertAdj.empty() && !budgetHolds 
+      && !thisMB->is_read_only_phase();
+}
 
+ErrorCode AEntityFactory::enforce_memory_budget( const EntityHandle* entities,
+                                                 int num_entities )
+{
+  if (!may_release_vert_adjacencies())
+    return MB_SUCCESS;
+  
+  const unsigned long in_use = accessCount;
+  std::vector<EntityHandle> storage;
+  for (int i = 0; i < num_entities; ++i)
+    keep_vert_adjacencies( entities[i], storage );
+  return release_least_recent( in_use );
+}
+
+ErrorCode AEntityFactory::enforce_memory_budget( const Range& entities )
+{
+  if (!may_release_vert_adjacencies())
+    return MB_SUCCESS;
+  
+  const unsigned long in_use = accessCount;
+  std::vector<EntityHandle> storage;
+  for (Range::const_iterator i = entities.begin(); i != entities.end(); ++i)
+    keep_vert_adjacencies( *i, storage );
+  return release_least_recent( in_use );
+}
+
+ErrorCode AEntityFactory::release_least_recent( unsigned long in_use )
+{
+    // pages not used since 'in_use', by time of last use
+  std::vector< std::pair<unsigned long,EntityHandle> > pages;
+  const SequenceData* prev = 0;
+  TypeSequenceManager& verts = thisMB->sequence_manager()->entity_map( MBVERTEX );
+  for (TypeSequenceManager::iterator i = verts.begin(); i != verts.end(); ++i) {
+    const SequenceData* data = (*i)->data();
+    if (data == prev || !data->get_adjacency_data())
+      continue;
+    prev = data;
+    EntityHandle h = data->start_handle();
+    while (h <= data->end_handle()) {
+      AdjacencyPageMap::iterator page = vert_adjacency_page( h, data );
+      if (!page->second.released && page->second.lastAccess <= in_use)
+        pages.push_back( std::make_pair( page->second.lastAccess, page->first ) );
+      h = page->second.last + 1;
+    }
+  }
+  std::sort( pages.begin(), pages.end() );
+  
+    // release down to a lower limit, such that the next few queries 
+    // may restore pages without releasing others
+  const size_t limit = memoryBudget - memoryBudget / 4;
+  for (size_t j = 0; j < pages.size() && adjMemory.bytes() > limit; ++j) {
+    ErrorCode rval = release_vert_adjacencies( adjPages.find( pages[j].second ) );
+    if (MB_SUCCESS != rval)
+      return rval;
+  }
   return MB_SUCCESS;
 }
 
+ErrorCode AEntityFactory::restore_vert_elem_adjacencies()
+{
+    // other threads may be reading adjacency data
+  if (thisMB->is_read_only_phase())
+    return MB_FAILURE;
+  
+  for (AdjacencyPageMap::iterator i = adjPages.begin(); i != adjPages.end(); ++i) {
+    if (i->second.released) {
+      ErrorCode rval = rebuild_vert_adjacencies( i );
+      if (MB_SUCCESS != rval)
+        return rval;
+    }
+  }
+  return MB_SUCCESS;
+}
+
+AEntityFactory::AdjacencyPageMap::iterator 
+AEntityFactory::vert_adjacency_page( EntityHandle vertex, const SequenceData* data )
+{
+  AdjacencyPageMap::iterator next = adjPages.upper_bound( vertex ), prev = next;
+  if (prev != adjPages.begin() && (--prev)->second.last >= vertex)
+    return prev;
+  
+    // pages are aligned to the start of the SequenceData, but
+    // pages created before the SequenceData changed may overlap
+  EntityHandle first = vertex - (vertex - data->start_handle()) % ADJ_PAGE_SIZE;
+  EntityHandle last = std::min( first + (ADJ_PAGE_SIZE - 1), data->end_handle() );
+  if (next != adjPages.begin() && prev->second.last >= first)
+    first = prev->second.last + 1;
+  if (next != adjPages.end() && next->first <= last)
+    last = next->first - 1;
+  
+  AdjacencyPage page;
+  page.last = last;
+  page.lastAccess = 0;
+  page.released = false;
+  return adjPages.insert( next, std::make_pair( first, page ) );
+}
+
+void AEntityFactory::keep_vert_adjacencies( EntityHandle entity,
+                                            std::vector<EntityHandle>& storage )
+{
+  const EntityHandle* conn = &entity;
+  int len = 1;
+  if (MBENTITYSET == TYPE_FROM_HANDLE(entity))
+    return;
+    // invalid handles are reported by the query
+  if (MBVERTEX != TYPE_FROM_HANDLE(entity) 
+   && MB_SUCCESS != get_vertices( entity, conn, len, storage ))
+    return;
+  
+  EntitySequence* seq;
+  for (int i = 0; i < len; ++i) 
+    if (MB_SUCCESS == thisMB->sequence_manager()->find( conn[i], seq ))
+      vert_adjacency_page( conn[i], seq->data() )->second.lastAccess = ++accessCount;
+}
+
+ErrorCode AEntityFactory::touch_vert_adjacencies( EntityHandle vertex, 
+                                                  const SequenceData* data )
+{
+    // all lists are restored before a read-only phase begins
+  if (thisMB->is_read_only_phase())
+    return MB_SUCCESS;
+  
+  AdjacencyPageMap::iterator page = vert_adjacency_page( vertex, data );
+  page->second.lastAccess = ++accessCount;
+  if (page->second.released)
+    return rebuild_vert_adjacencies( page );
+  return MB_SUCCESS;
+}
+
+ErrorCode AEntityFactory::release_vert_adjacencies( AdjacencyPageMap::iterator page )
+{
+  BudgetHold hold( this );
+  const EntityHandle last = page->second.last;
+  std::vector<EntityHandle> keep, removed, storage;
+  const EntityHandle* conn;
+  int len;
+  EntityHandle vertex = page->first;
+  while (vertex <= last) {
+    EntitySequence* seq;
+    if (MB_SUCCESS != thisMB->sequence_manager()->find( vertex, seq )) {
+      ++vertex;
+      continue;
+    }
+    const EntityHandle end = std::min( last, seq->end_handle() );
+    AdjacencyVector** adj_list = seq->data()->get_adjacency_data();
+    for (; vertex <= end; ++vertex) {
+      AdjacencyVector*& list = adj_list[vertex - seq->data()->start_handle()];
+      if (!list)
+        continue;
+      
+        // keep entities that were explicitly made adjacent
+      keep.clear();
+      for (AdjacencyVector::iterator k = list->begin(); k != list->end(); ++k) {
+        const EntityType type = TYPE_FROM_HANDLE(*k);
+        if (MBVERTEX != type && MBENTITYSET != type) {
+          ErrorCode rval = get_vertices( *k, conn, len, storage );
+          if (MB_SUCCESS != rval)
+            return rval;
+          if (std::find( conn, conn + len, vertex ) != conn + len) {
+            removed.push_back( *k );
+            continue;
+          }
+        }
+        keep.push_back( *k );
+      }
+      
+      delete_adj_list( adjMemory, list );
+      list = keep.empty() ? 0 : new_adj_list( adjMemory, keep.begin(), keep.end() );
+    }
+  }
+  
+  std::sort( removed.begin(), removed.end() );
+  removed.erase( std::unique( removed.begin(), removed.end() ), removed.end() );
+  Range& elems = page->second.removed;
+  std::copy( removed.rbegin(), removed.rend(), range_inserter( elems ) );
+  adjMemory.add( elems.get_memory_use() );
+  page->second.released = true;
+  return MB_SUCCESS;
+}
+
+ErrorCode AEntityFactory::rebuild_vert_adjacencies( AdjacencyPageMap::iterator page )
+{
+  BudgetHold hold( this );
+  const EntityHandle first = page->first, last = page->second.last;
+  Range& elems = page->second.removed;
+  page->second.released = false;
+  ++numRestores;
+  
+    // the lists of the vertices of an element are restored 
+    // before the element is deleted or its connectivity changed
+  std::vector< std::pair<EntityHandle,EntityHandle> > pairs;
+  std::vector<EntityHandle> storage;
+  const EntityHandle* conn;
+  int len;
+  for (Range::const_iterator i = elems.begin(); i != elems.end(); ++i) {
+    ErrorCode rval = get_vertices( *i, conn, len, storage );
+    if (MB_SUCCESS != rval)
+      return rval;
+    for (int k = 0; k < len; ++k)
+      if (conn[k] >= first && conn[k] <= last)
+        pairs.push_back( std::make_pair( conn[k], *i ) );
+  }
+  adjMemory.remove( elems.get_memory_use() );
+  elems.clear();
+  
+  std::sort( pairs.begin(), pairs.end() );
+  return add_vert_elem_pairs( pairs );
+}
+
+AEntityFactory::CompactVertAdj* 
+AEntityFactory::find_compact_block( const std::vector<CompactVertAdj*>& blocks,
+                                    EntityHandle vertex )
+{
+  size_t lo = 0, hi = blocks.size();
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (blocks[mid]->endHandle < vertex)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo == blocks.size() || blocks[lo]->startHandle > vertex)
+    return 0;
+  return blocks[lo];
+}
 
 ErrorCode AEntityFactory::get_adjacencies(EntityHandle entity,
                                             const EntityHandle *&adjacent_entities,
                                             int &num_entities) const
 {
+  if (!compactVertAdj.empty() && MBVERTEX == TYPE_FROM_HANDLE(entity)) {
+    const CompactVertAdj* block = find_compact_block( compactVertAdj, entity );
+    if (block) {
+      const EntityID idx = entity - block->startHandle;
+      num_entities = block->offsets[idx+1] - block->offsets[idx];
+      adjacent_entities = num_entities ? &block->adjacencies[block->offsets[idx]] : 0;
+      return MB_SUCCESS;
+    }
+  }
+
   AdjacencyVector const* vec_ptr = 0;
   ErrorCode result = get_adjacency_ptr( entity, vec_ptr );
   if (MB_SUCCESS != result || !vec_ptr) {
@@ -543,17 +1314,40 @@ ErrorCode AEntityFactory::get_adjacencies(EntityHandle entity,
   return MB_SUCCESS;
 }
 
+ErrorCode AEntityFactory::get_adjacencies(EntityHandle entity,
+                                            const EntityHandle *&adjacent_entities,
+                                            int &num_entities,
+                                            std::vector<EntityHandle>& storage) const
+{
+  ErrorCode result = get_adjacencies( entity, adjacent_entities, num_entities );
+  if (MB_SUCCESS != result || MBVERTEX != TYPE_FROM_HANDLE(entity))
+    return result;
+  
+  storage.clear();
+  result = get_structured_elements( entity, 1, 3, storage );
+  if (MB_SUCCESS != result || storage.empty())
+    return result;
+  
+  storage.insert( storage.end(), adjacent_entities, adjacent_entities + num_entities );
+  std::sort( storage.begin(), storage.end() );
+  storage.erase( std::unique( storage.begin(), storage.end() ), storage.end() );
+  adjacent_entities = &storage[0];
+  num_entities = storage.size();
+  return MB_SUCCESS;
+}
+
 ErrorCode AEntityFactory::get_adjacencies(EntityHandle entity,
                                             std::vector<EntityHandle>& adjacent_entities) const
 {
-  AdjacencyVector const* vec_ptr = 0;
-  ErrorCode result = get_adjacency_ptr( entity, vec_ptr );
-  if (MB_SUCCESS != result || !vec_ptr) {
+  const EntityHandle* adj = 0;
+  int num_adj = 0;
+  ErrorCode result = get_adjacencies( entity, adj, num_adj );
+  if (MB_SUCCESS != result || !adj) {
     adjacent_entities.clear();
     return result;
   }
   
-  adjacent_entities = *vec_ptr;
+  adjacent_entities.assign( adj, adj + num_adj );
   return MB_SUCCESS;
 }
 
@@ -564,10 +1358,10 @@ ErrorCode AEntityFactory::get_adjacencies( EntityHandle entity,
   adj_vec = 0;
   ErrorCode result = get_adjacency_ptr( entity, adj_vec );
   if (MB_SUCCESS == result && !adj_vec && create) {
-    adj_vec = new AdjacencyVector;
+    adj_vec = new_adj_list( adjMemory );
     result = set_adjacency_ptr( entity, adj_vec );
     if (MB_SUCCESS != result) {
-      delete adj_vec;
+      delete_adj_list( adjMemory, adj_vec );
       adj_vec = 0;
     }
   }
@@ -659,44 +1453,181 @@ ErrorCode AEntityFactory::notify_create_entity(const EntityHandle entity,
   return result;
 }
 
+ErrorCode AEntityFactory::notify_create_entities(const EntityHandle start_handle,
+                                                 const int number_elements,
+                                                 const int nodes_per_element,
+                                                 const EntityHandle *conn_array)
+{
+  if (!vert_elem_adjacencies())
+    return MB_SUCCESS;
+
+  ErrorCode result = MB_SUCCESS, tmp_result;
+  if (TYPE_FROM_HANDLE(start_handle) == MBPOLYHEDRON) {
+    for (int i = 0; i < number_elements; ++i) {
+      tmp_result = notify_create_entity( start_handle + i, 
+                                         conn_array + (size_t)i * nodes_per_element,
+                                         nodes_per_element );
+      if (MB_SUCCESS != tmp_result) result = tmp_result;
+    }
+    return result;
+  }
+
+    // append each element to the lists of its vertices.  Elements are
+    // visited in increasing order, so each list needs an insertion
+    // only if it already holds larger handles.
+  const EntityHandle* conn = conn_array;
+  for (int i = 0; i < number_elements; ++i) {
+    const EntityHandle elem = start_handle + i;
+    for (int j = 0; j < nodes_per_element; ++j, ++conn) {
+      AdjacencyVector* adj_list_ptr = NULL;
+      tmp_result = get_adjacencies( *conn, adj_list_ptr, true );
+      if (MB_SUCCESS != tmp_result) {
+        result = tmp_result;
+        continue;
+      }
+      
+      const size_t old_capacity = adj_list_ptr->capacity();
+      const size_t old_bytes = list_bytes( adj_list_ptr );
+      if (adj_list_ptr->empty() || adj_list_ptr->back() < elem)
+        adj_list_ptr->push_back( elem );
+      else if (adj_list_ptr->back() != elem) {
+        AdjacencyVector::iterator pos = std::lower_bound( adj_list_ptr->begin(),
+                                                          adj_list_ptr->end(), elem );
+        if (*pos != elem)
+          adj_list_ptr->insert( pos, elem );
+      }
+      if (adj_list_ptr->capacity() != old_capacity)
+        adjMemory.resize( old_bytes, list_bytes( adj_list_ptr ) );
+    }
+  }
+  
+  return result;
+}
+
+ErrorCode AEntityFactory::add_vert_elem_pairs( const std::vector< std::pair<EntityHandle,EntityHandle> >& pairs )
+{
+    // append the new elements to the list for each vertex, merging
+    // only if the list contains larger handles
+  ErrorCode result = MB_SUCCESS, tmp_result;
+  size_t i = 0;
+  while (i < pairs.size()) {
+    const EntityHandle vtx = pairs[i].first;
+    AdjacencyVector* adj_list_ptr = NULL;
+    tmp_result = get_adjacencies( vtx, adj_list_ptr, true );
+    if (MB_SUCCESS != tmp_result) {
+      result = tmp_result;
+      for (; i < pairs.size() && pairs[i].first == vtx; ++i);
+      continue;
+    }
+
+    const size_t old_bytes = list_bytes( adj_list_ptr );
+    const size_t old_size = adj_list_ptr->size();
+    for (; i < pairs.size() && pairs[i].first == vtx; ++i) 
+      if (adj_list_ptr->size() == old_size || adj_list_ptr->back() != pairs[i].second)
+        adj_list_ptr->push_back( pairs[i].second );
+    if (old_size && (*adj_list_ptr)[old_size-1] >= (*adj_list_ptr)[old_size]) {
+      std::inplace_merge( adj_list_ptr->begin(), adj_list_ptr->begin() + old_size, 
+                          adj_list_ptr->end() );
+      adj_list_ptr->erase( std::unique( adj_list_ptr->begin(), adj_list_ptr->end() ),
+                           adj_list_ptr->end() );
+    }
+    adjMemory.resize( old_bytes, list_bytes( adj_list_ptr ) );
+  }
+
+  return result;
+}
+
 ErrorCode AEntityFactory::get_zero_to_n_elements(EntityHandle source_entity,
                             const unsigned int target_dimension,
                             std::vector<EntityHandle> &target_entities,
                             const bool create_if_missing,
                             const int /*create_adjacency_option = -1*/)
 {
-  AdjacencyVector::iterator start_ent, end_ent;
-
-  // get the adjacency vector
-  AdjacencyVector *adj_vec = NULL;
-  ErrorCode result = get_adjacencies( source_entity, adj_vec );
-  if(result != MB_SUCCESS || adj_vec == NULL)
+  // get the adjacency list
+  const EntityHandle *adj_vec = NULL;
+  int num_adj = 0;
+  ErrorCode result = get_adjacencies( source_entity, adj_vec, num_adj );
+  if(result != MB_SUCCESS)
     return result;
   
   if (target_dimension < 3 && create_if_missing) {
-      std::vector<EntityHandle> tmp_ents;
-      
-      start_ent = std::lower_bound(adj_vec->begin(), adj_vec->end(), 
-                         FIRST_HANDLE(CN::TypeDimensionMap[target_dimension+1].first));
-
-      end_ent = std::lower_bound(start_ent, adj_vec->end(), 
-                         LAST_HANDLE(CN::TypeDimensionMap[3].second));
-      
-      std::vector<EntityHandle> elems(start_ent, end_ent);
+      std::vector<EntityHandle> tmp_ents, elems;
+      result = get_vertex_elements( source_entity, target_dimension+1, 3, 
+                                    adj_vec, num_adj, elems );
+      if (MB_SUCCESS != result)
+        return result;
  
       // make target_dimension elements from all adjacient higher-dimension elements
-      for(start_ent = elems.begin(); start_ent != elems.end(); ++start_ent)
+      for(std::vector<EntityHandle>::iterator it = elems.begin(); it != elems.end(); ++it)
       {
         tmp_ents.clear();
-        get_down_adjacency_elements(*start_ent, target_dimension, tmp_ents, create_if_missing, 0);
+        get_down_adjacency_elements(*it, target_dimension, tmp_ents, create_if_missing, 0);
       }
+      
+      // creating entities may have modified or moved the list
+      result = get_adjacencies( source_entity, adj_vec, num_adj );
+      if(result != MB_SUCCESS)
+        return result;
   }
     
-  DimensionPair dim_pair = CN::TypeDimensionMap[target_dimension];
-  start_ent = std::lower_bound(adj_vec->begin(), adj_vec->end(), FIRST_HANDLE(dim_pair.first ));
-  end_ent   = std::lower_bound(start_ent,        adj_vec->end(), LAST_HANDLE (dim_pair.second));
-  target_entities.insert( target_entities.end(), start_ent, end_ent );
-  return MB_SUCCESS;  
+  return get_vertex_elements( source_entity, target_dimension, target_dimension,
+                              adj_vec, num_adj, target_entities );
+}
+
+ErrorCode AEntityFactory::get_vertex_elements( EntityHandle vertex,
+                                               unsigned min_dim, unsigned max_dim,
+                                               const EntityHandle* adj, int num_adj,
+                                               std::vector<EntityHandle>& target_entities ) const
+{
+  const size_t orig_size = target_entities.size();
+  ErrorCode result = get_structured_elements( vertex, min_dim, max_dim, target_entities );
+  
+  const EntityHandle *start_ent, *end_ent;
+  start_ent = std::lower_bound(adj,       adj + num_adj, FIRST_HANDLE(CN::TypeDimensionMap[min_dim].first ));
+  end_ent   = std::lower_bound(start_ent, adj + num_adj, LAST_HANDLE (CN::TypeDimensionMap[max_dim].second));
+  if (target_entities.size() == orig_size) {
+    target_entities.insert( target_entities.end(), start_ent, end_ent );
+  }
+  else {
+    target_entities.insert( target_entities.end(), start_ent, end_ent );
+    std::vector<EntityHandle>::iterator begin = target_entities.begin() + orig_size;
+    std::sort( begin, target_entities.end() );
+    target_entities.erase( std::unique( begin, target_entities.end() ), target_entities.end() );
+  }
+  return result;
+}
+
+ErrorCode AEntityFactory::get_structured_elements( EntityHandle vertex,
+                                                   unsigned min_dim, unsigned max_dim,
+                                                   std::vector<EntityHandle>& target_entities ) const
+{
+    // only structured vertices can be in structured elements
+  EntitySequence* seq;
+  ErrorCode result = thisMB->sequence_manager()->find( vertex, seq );
+  if (MB_SUCCESS != result)
+    return result;
+  const ScdVertexData* vdata = dynamic_cast<const ScdVertexData*>(seq->data());
+  if (!vdata)
+    return MB_SUCCESS;
+  
+  const std::vector<ScdElementData*>& blocks = vdata->element_data();
+  for (std::vector<ScdElementData*>::const_iterator i = blocks.begin(); i != blocks.end(); ++i) {
+    const unsigned dim = CN::Dimension( TYPE_FROM_HANDLE( (*i)->start_handle() ) );
+    if (dim < min_dim || dim > max_dim)
+      continue;
+      
+      // keep only elements that are in a sequence using this data,
+      // skipping any that were deleted
+    const size_t before = target_entities.size();
+    (*i)->get_vertex_adjacencies( vdata, vertex, target_entities );
+    size_t w = before;
+    for (size_t r = before; r < target_entities.size(); ++r)
+      if (MB_SUCCESS == thisMB->sequence_manager()->find( target_entities[r], seq ) && seq->data() == *i)
+        target_entities[w++] = target_entities[r];
+    target_entities.resize( w );
+  }
+  
+  return MB_SUCCESS;
 }
 
 ErrorCode AEntityFactory::get_down_adjacency_elements(EntityHandle source_entity,
@@ -1430,10 +2361,25 @@ ErrorCode AEntityFactory::get_adjacency_ptr( EntityHandle entity,
 {
   ptr = 0;
   
+    // caller may modify the list, so vertex lists must be expanded
+  ErrorCode rval;
+  if (!compactVertAdj.empty() && MBVERTEX == TYPE_FROM_HANDLE(entity)) {
+    rval = expand_vert_elem_adjacencies();
+    if (MB_SUCCESS != rval)
+      return rval;
+  }
+  
   EntitySequence* seq;
-  ErrorCode rval = thisMB->sequence_manager()->find( entity, seq );
-  if (MB_SUCCESS != rval || !seq->data()->get_adjacency_data())
+  rval = thisMB->sequence_manager()->find( entity, seq );
+  if (MB_SUCCESS != rval)
     return rval;
+  if (memoryBudget && MBVERTEX == TYPE_FROM_HANDLE(entity)) {
+    rval = touch_vert_adjacencies( entity, seq->data() );
+    if (MB_SUCCESS != rval)
+      return rval;
+  }
+  if (!seq->data()->get_adjacency_data())
+    return MB_SUCCESS;
   
   ptr = seq->data()->get_adjacency_data()[entity - seq->data()->start_handle()];
   return MB_SUCCESS;
@@ -1446,8 +2392,16 @@ ErrorCode AEntityFactory::get_adjacency_ptr( EntityHandle entity,
   
   EntitySequence* seq;
   ErrorCode rval = thisMB->sequence_manager()->find( entity, seq );
-  if (MB_SUCCESS != rval || !seq->data()->get_adjacency_data())
+  if (MB_SUCCESS != rval)
     return rval;
+    // restoring released lists does not change the adjacencies
+  if (memoryBudget && MBVERTEX == TYPE_FROM_HANDLE(entity)) {
+    rval = const_cast<AEntityFactory*>(this)->touch_vert_adjacencies( entity, seq->data() );
+    if (MB_SUCCESS != rval)
+      return rval;
+  }
+  if (!seq->data()->get_adjacency_data())
+    return MB_SUCCESS;
   
   ptr = seq->data()->get_adjacency_data()[entity - seq->data()->start_handle()];
   return MB_SUCCESS;
@@ -1457,8 +2411,15 @@ ErrorCode AEntityFactory::get_adjacency_ptr( EntityHandle entity,
 ErrorCode AEntityFactory::set_adjacency_ptr( EntityHandle entity, 
                                                std::vector<EntityHandle>* ptr )
 {
+  ErrorCode rval;
+  if (!compactVertAdj.empty() && MBVERTEX == TYPE_FROM_HANDLE(entity)) {
+    rval = expand_vert_elem_adjacencies();
+    if (MB_SUCCESS != rval)
+      return rval;
+  }
+
   EntitySequence* seq;
-  ErrorCode rval = thisMB->sequence_manager()->find( entity, seq );
+  rval = thisMB->sequence_manager()->find( entity, seq );
   if (MB_SUCCESS != rval)
     return rval;
     
@@ -1467,7 +2428,7 @@ ErrorCode AEntityFactory::set_adjacency_ptr( EntityHandle entity,
   
   const EntityHandle index = entity - seq->data()->start_handle();
   std::vector<EntityHandle>*& ref = seq->data()->get_adjacency_data()[index];
-  delete ref;
+  delete_adj_list( adjMemory, ref );
   ref = ptr;
   return MB_SUCCESS;
 }
@@ -1492,14 +2453,20 @@ void AEntityFactory::get_memory_use( unsigned long& entity_total,
         memory_total += prev_data->size() * sizeof(AdjacencyVector*);
       }
       
-      const AdjacencyVector* vec;
-      for (EntityHandle h = (*i)->start_handle(); h <= (*i)->end_handle(); ++h) {
-        get_adjacency_ptr( h, vec );
-        if (vec) 
-          entity_total += vec->capacity() * sizeof(EntityHandle) + sizeof(AdjacencyVector);
+      const AdjacencyVector* const* vec = (*i)->data()->get_adjacency_data()
+                                  + ((*i)->start_handle() - (*i)->data()->start_handle());
+      for (EntityID j = 0; j < (*i)->size(); ++j) {
+        if (vec[j]) 
+          entity_total += vec[j]->capacity() * sizeof(EntityHandle) + sizeof(AdjacencyVector);
       }
     }
   }
+  
+  for (size_t j = 0; j < compactVertAdj.size(); ++j) {
+    entity_total += compactVertAdj[j]->adjacencies.capacity() * sizeof(EntityHandle)
+                  + compactVertAdj[j]->offsets.capacity() * sizeof(EntityID);
+    memory_total += sizeof(CompactVertAdj) + sizeof(CompactVertAdj*);
+  }
  
   memory_total += sizeof(*this) + entity_total;
 }
@@ -1517,6 +2484,17 @@ ErrorCode AEntityFactory::get_memory_use( const Range& ents_in,
     return rval;
   
   do {
+    if (!compactVertAdj.empty() && MBVERTEX == iter.get_sequence()->type()) {
+      for (EntityHandle h = iter.get_start_handle(); h <= iter.get_end_handle(); ++h) {
+        const CompactVertAdj* block = find_compact_block( compactVertAdj, h );
+        if (block) {
+          const EntityID idx = h - block->startHandle;
+          min_per_ent += sizeof(EntityID) + sizeof(EntityHandle) 
+                       * (block->offsets[idx+1] - block->offsets[idx]);
+        }
+      }
+    }
+  
     AdjacencyVector** array = iter.get_sequence()->data()->get_adjacency_data();
     if (!array)
       continue;
@@ -1548,6 +2526,122 @@ ErrorCode AEntityFactory::get_memory_use( const Range& ents_in,
    calling code is notifying this that an entity is going to be deleted
    from the database
 */
+ErrorCode AEntityFactory::move_adjacencies( EntityHandle from, EntityHandle to )
+{
+  ErrorCode rval;
+  if (!compactVertAdj.empty() && MBVERTEX == TYPE_FROM_HANDLE(from)) {
+    rval = expand_vert_elem_adjacencies();
+    if (MB_SUCCESS != rval)
+      return rval;
+  }
+  
+  EntitySequence *from_seq, *to_seq;
+  rval = thisMB->sequence_manager()->find( from, from_seq );
+  if (MB_SUCCESS != rval)
+    return rval;
+  rval = thisMB->sequence_manager()->find( to, to_seq );
+  if (MB_SUCCESS != rval)
+    return rval;
+  
+  if (memoryBudget && MBVERTEX == TYPE_FROM_HANDLE(from)) {
+    rval = touch_vert_adjacencies( from, from_seq->data() );
+    if (MB_SUCCESS != rval)
+      return rval;
+    rval = touch_vert_adjacencies( to, to_seq->data() );
+    if (MB_SUCCESS != rval)
+      return rval;
+  }
+  
+  AdjacencyVector** from_data = from_seq->data()->get_adjacency_data();
+  if (!from_data || !from_data[from - from_seq->data()->start_handle()])
+    return MB_SUCCESS;
+  if (!to_seq->data()->get_adjacency_data() && !to_seq->data()->allocate_adjacency_data())
+    return MB_MEMORY_ALLOCATION_FAILED;
+  
+  AdjacencyVector*& from_ref = from_data[from - from_seq->data()->start_handle()];
+  AdjacencyVector*& to_ref = to_seq->data()->get_adjacency_data()[to - to_seq->data()->start_handle()];
+  if (to_ref)
+    return MB_ALREADY_ALLOCATED;
+  to_ref = from_ref;
+  from_ref = 0;
+  
+    // Vertices do not occur in adjacency lists other than as the
+    // connectivity of elements, which is the caller's responsibility.
+    // Other entities occur in the lists of entities in their own list.
+  if (MBVERTEX == TYPE_FROM_HANDLE(from))
+    return MB_SUCCESS;
+  for (AdjacencyVector::iterator i = to_ref->begin(); i != to_ref->end(); ++i) {
+    if (MBENTITYSET == TYPE_FROM_HANDLE(*i))
+      continue;
+    AdjacencyVector* list = 0;
+    rval = get_adjacencies( *i, list, false );
+    if (MB_SUCCESS != rval || !list)
+      continue;
+    AdjacencyVector::iterator j = std::lower_bound( list->begin(), list->end(), from );
+    if (j == list->end() || *j != from)
+      continue;
+    list->erase( j );
+    list->insert( std::lower_bound( list->begin(), list->end(), to ), to );
+  }
+  
+  return MB_SUCCESS;
+}
+
+ErrorCode AEntityFactory::replace_adjacent_handles( const std::vector< std::pair<EntityHandle,EntityHandle> >& moves )
+{
+  if (moves.empty())
+    return MB_SUCCESS;
+  
+  ErrorCode rval;
+  if (!compactVertAdj.empty()) {
+    rval = expand_vert_elem_adjacencies();
+    if (MB_SUCCESS != rval)
+      return rval;
+  }
+  if (memoryBudget) {
+    rval = restore_vert_elem_adjacencies();
+    if (MB_SUCCESS != rval)
+      return rval;
+  }
+  
+  std::vector< std::pair<EntityHandle,EntityHandle> >::const_iterator m;
+  const EntityHandle first_moved = moves.front().first;
+  for (EntityType t = MBVERTEX; t < MBENTITYSET; ++t) {
+    TypeSequenceManager& seqs = thisMB->sequence_manager()->entity_map( t );
+    const SequenceData* prev = 0;
+    for (TypeSequenceManager::iterator i = seqs.begin(); i != seqs.end(); ++i) {
+      SequenceData* data = (*i)->data();
+      AdjacencyVector** lists = data->get_adjacency_data();
+      if (data == prev || !lists)
+        continue;
+      prev = data;
+      
+      for (EntityID j = 0; j < data->size(); ++j) {
+        AdjacencyVector* list = lists[j];
+        if (!list)
+          continue;
+        bool changed = false;
+        for (AdjacencyVector::iterator k = list->begin(); k != list->end(); ++k) {
+          if (*k < first_moved)
+            continue;
+          m = std::lower_bound( moves.begin(), moves.end(), 
+                                std::pair<EntityHandle,EntityHandle>( *k, 0 ) );
+          if (m != moves.end() && m->first == *k) {
+            *k = m->second;
+            changed = true;
+          }
+        }
+        if (changed) {
+          std::sort( list->begin(), list->end() );
+          list->erase( std::unique( list->begin(), list->end() ), list->end() );
+        }
+      }
+    }
+  }
+  
+  return MB_SUCCESS;
+}
+
 ErrorCode AEntityFactory::notify_delete_entity(EntityHandle entity)
 {
   if (TYPE_FROM_HANDLE(entity) == MBVERTEX) {
@@ -1562,5 +2656,187 @@ ErrorCode AEntityFactory::notify_delete_entity(EntityHandle entity)
   // remove any references to this entity from other entities
   return remove_all_adjacencies(entity, true);
 }
+
+  // remove from a sorted list all entities in a range, except those
+  // in another range
+static void remove_entities_in( AdjacencyVector& list, const Range& entities,
+                                const Range& except )
+{
+  AdjacencyVector::iterator w = list.begin();
+  for (AdjacencyVector::iterator r = list.begin(); r != list.end(); ++r)
+    if (entities.find( *r ) == entities.end() || except.find( *r ) != except.end())
+      *w++ = *r;
+  list.erase( w, list.end() );
+}
+
+ErrorCode AEntityFactory::notify_delete_entities(const Range& entities, Range& failed)
+{
+  ErrorCode result = MB_SUCCESS, rval;
+  if (!compactVertAdj.empty()) {
+    rval = expand_vert_elem_adjacencies();
+    if (MB_SUCCESS != rval) {
+      failed.merge( entities );
+      return rval;
+    }
+  }
+  
+  const Range::const_iterator verts_end = entities.upper_bound( MBVERTEX );
+  const Range::const_iterator elems_end = entities.lower_bound( MBENTITYSET );
+  
+    // vertex adjacencies are needed to check whether vertices are in use
+  if (entities.begin() != verts_end && !vert_elem_adjacencies()) {
+    rval = create_vert_elem_adjacencies();
+    if (MB_SUCCESS != rval) {
+      failed.merge( entities );
+      return rval;
+    }
+  }
+  
+    // sets are cleared individually
+  for (Range::const_iterator i = elems_end; i != entities.end(); ++i) {
+    rval = notify_delete_entity( *i );
+    if (MB_SUCCESS != rval) {
+      result = rval;
+      failed.insert( *i );
+    }
+  }
+  
+    // Explicit adjacencies between elements of the same dimension
+    // are found only through the lists of the deleted elements.
+  unsigned deleted_dims = 0;
+  for (EntityType t = MBEDGE; t != MBENTITYSET; t++) {
+    std::pair<Range::const_iterator,Range::const_iterator> r = entities.equal_range( t );
+    if (r.first != r.second)
+      deleted_dims |= 1u << CN::Dimension( t );
+  }
+  
+    // Remove deleted elements from the lists of their vertices, and 
+    // gather other entities that may have explicit adjacencies to 
+    // deleted elements: those in the lists of deleted elements and 
+    // elements of other dimensions in the vertex lists.  Vertices 
+    // in the vertex lists are left for later, as those still in use
+    // are not deleted.  Invalid handles are passed back in 'failed'.
+  Range dead_elems;
+  dead_elems.merge( verts_end, entities.end() );
+  std::vector<EntityHandle> refs, storage;
+  std::vector< std::pair<EntityHandle,EntityHandle> > set_members;
+  const EntityHandle* conn;
+  int len;
+  AdjacencyVector* list;
+  for (Range::const_iterator i = verts_end; i != elems_end; ++i) {
+    rval = get_vertices( *i, conn, len, storage );
+    if (MB_SUCCESS == rval)
+      rval = get_adjacency_ptr( *i, list );
+    if (MB_SUCCESS != rval) {
+      result = rval;
+      failed.insert( *i );
+      continue;
+    }
+    for (size_t j = 0; list && j < list->size(); ++j) {
+      if (MBENTITYSET == TYPE_FROM_HANDLE((*list)[j]))
+        set_members.push_back( std::make_pair( (*list)[j], *i ) );
+      else
+        refs.push_back( (*list)[j] );
+    }
+    
+    if (!vert_elem_adjacencies())
+      continue;
+    for (int k = 0; k < len; ++k) {
+      rval = get_adjacency_ptr( conn[k], list );
+      if (MB_SUCCESS != rval) {
+        result = rval;
+        continue;
+      }
+        // skip lists already updated for another deleted element
+      if (!list || !std::binary_search( list->begin(), list->end(), *i ))
+        continue;
+      remove_entities_in( *list, dead_elems, failed );
+      for (AdjacencyVector::iterator j = list->begin(); j != list->end(); ++j) {
+        const EntityType type = TYPE_FROM_HANDLE(*j);
+        if (MBENTITYSET != type && (deleted_dims & ~(1u << CN::Dimension( type ))))
+          refs.push_back( *j );
+      }
+    }
+  }
+  
+    // Vertices cannot be deleted while used by other elements.  Those
+    // that can be deleted may be in sets that track their contents,
+    // and have explicit adjacencies to other vertices.
+  for (Range::const_iterator i = entities.begin(); i != verts_end; ++i) {
+    storage.clear();
+    rval = get_structured_elements( *i, 1, 3, storage );
+    if (MB_SUCCESS == rval)
+      rval = get_adjacency_ptr( *i, list );
+    if (MB_SUCCESS != rval) {
+      result = rval;
+      failed.insert( *i );
+      continue;
+    }
+    
+    bool in_use = !storage.empty();
+    for (size_t j = 0; !in_use && list && j < list->size(); ++j) 
+      if (MBVERTEX != TYPE_FROM_HANDLE((*list)[j]) && MBENTITYSET != TYPE_FROM_HANDLE((*list)[j]))
+        in_use = true;
+    if (in_use) {
+      failed.insert( *i );
+      result = MB_FAILURE;
+      continue;
+    }
+    for (size_t j = 0; list && j < list->size(); ++j) {
+      if (MBENTITYSET == TYPE_FROM_HANDLE((*list)[j]))
+        set_members.push_back( std::make_pair( (*list)[j], *i ) );
+      else
+        refs.push_back( (*list)[j] );
+    }
+  }
+  
+    // remove deleted entities from the lists of remaining ones
+  std::sort( refs.begin(), refs.end() );
+  refs.erase( std::unique( refs.begin(), refs.end() ), refs.end() );
+  for (size_t j = 0; j < refs.size(); ++j) {
+    if (entities.find( refs[j] ) != entities.end() && failed.find( refs[j] ) == failed.end())
+      continue;
+    rval = get_adjacency_ptr( refs[j], list );
+    if (MB_SUCCESS != rval)
+      result = rval;
+    else if (list)
+      remove_entities_in( *list, entities, failed );
+  }
+  
+    // remove deleted entities from each set that tracks them
+  std::sort( set_members.begin(), set_members.end() );
+  std::vector<EntityHandle> members;
+  for (size_t j = 0; j < set_members.size(); ) {
+    const EntityHandle set = set_members[j].first;
+    members.clear();
+    for (; j < set_members.size() && set_members[j].first == set; ++j)
+      members.push_back( set_members[j].second );
+    if (entities.find( set ) != entities.end() && failed.find( set ) == failed.end())
+      continue;
+    rval = thisMB->remove_entities( set, &members[0], members.size() );
+    if (MB_SUCCESS != rval)
+      result = rval;
+  }
+  
+    // release the lists of the deleted entities
+  Range deleted = subtract( entities, failed );
+  RangeSeqIntersectIter iter( thisMB->sequence_manager() );
+  rval = iter.init( deleted.begin(), deleted.lower_bound( MBENTITYSET ) );
+  while (MB_SUCCESS == rval) {
+    AdjacencyVector** array = iter.get_sequence()->data()->get_adjacency_data();
+    if (array) {
+      array += iter.get_start_handle() - iter.get_sequence()->data()->start_handle();
+      for (EntityID j = 0; j <= (EntityID)(iter.get_end_handle() - iter.get_start_handle()); ++j) {
+        delete_adj_list( adjMemory, array[j] );
+        array[j] = 0;
+      }
+    }
+    rval = iter.step();
+  }
+  if (MB_FAILURE != rval)
+    return rval;
+  
+  return result;
+}
   
 } // namespace moab
@@ -21,12 +21,17 @@
 #endif
 
 #include "moab/Forward.hpp"
+#include "moab/MemoryCounter.hpp"
+#include "moab/Range.hpp"
 #include <vector>
+#include <map>
 
 namespace moab {
 
 typedef std::vector<EntityHandle> AdjacencyVector;
 class Core;
+class SequenceData;
+class ThreadPool;
 
 //! class AEntityFactory
 class AEntityFactory 
@@ -123,6 +128,15 @@ public:
   ErrorCode get_adjacencies(EntityHandle entity,
                                const EntityHandle *&adjacent_entities,
                                int &num_entities) const;
+
+    //! As above, but also including any structured elements adjacent
+    //! to a vertex, which are computed rather than stored.  If there are
+    //! any, the merged, sorted list is placed in \c storage and
+    //! \c adjacent_entities points into it.
+  ErrorCode get_adjacencies(EntityHandle entity,
+                               const EntityHandle *&adjacent_entities,
+                               int &num_entities,
+                               std::vector<EntityHandle>& storage) const;
                                
   ErrorCode get_adjacencies( EntityHandle entity,
                                std::vector<EntityHandle>*& adj_vec_ptr_out,
@@ -133,20 +147,93 @@ public:
                                std::vector<EntityHandle>& adjacent_entities) const;
   
 
-  //! creates vertex to element adjacency information
-  ErrorCode create_vert_elem_adjacencies();
+  //! creates vertex to element adjacency information, using up to 
+  //! num_threads threads (zero for thread_count())
+  ErrorCode create_vert_elem_adjacencies( unsigned num_threads = 0 );
 
   //! returns whether vertex to element adjacencies are being stored
   bool vert_elem_adjacencies() const { return mVertElemAdj; }
 
+  //! pack vertex to element adjacencies into one offset array and one
+  //! handle array per block of vertices, creating them if necessary;
+  //! the per-vertex lists are restored by the first modification
+  ErrorCode compact_vert_elem_adjacencies( unsigned num_threads = 0 );
+
+  //! set the number of threads used to build vertex to element
+  //! adjacencies when not passed explicitly, or zero for the default
+  void set_num_threads( unsigned num_threads ) { numThreads = num_threads; }
+
+  //! value from set_num_threads
+  unsigned num_threads() const { return numThreads; }
+
+  //! threads to use for a request of \c num_threads: the request if
+  //! nonzero, else num_threads() if nonzero, else MOAB_NUM_THREADS
+  //! if set, else one.  Adjacencies are usually built lazily inside
+  //! some other query, so all processors are used only on request.
+  unsigned thread_count( unsigned num_threads = 0 ) const;
+
+  //! convert compacted vertex adjacencies back into per-vertex lists
+  ErrorCode expand_vert_elem_adjacencies();
+
+  //! returns whether vertex adjacencies are currently in compact form
+  bool vert_elem_adjacencies_compact() const { return !compactVertAdj.empty(); }
+
+  //! limit the memory used by adjacency lists to approximately 'bytes',
+  //! where zero (the default) means no limit; see enforce_memory_budget
+  ErrorCode set_memory_budget( size_t bytes );
+
+  //! returns the memory limit for adjacency lists, or zero if none
+  size_t memory_budget() const { return memoryBudget; }
+
+  //! returns the memory currently used by adjacency lists of this instance
+  size_t memory_use() const { return adjMemory.bytes(); }
+
+  //! if adjacency lists use more memory than the budget, reduce the
+  //! vertex to element lists of the least recently used pages of
+  //! vertices to their explicit adjacencies, until the lists use at
+  //! most three quarters of the budget.  The removed entries are 
+  //! restored from element connectivity when a list of the page is 
+  //! next accessed.  Pages with vertices of 'entities' (or of their
+  //! connectivity) are not released, as the caller is about to use 
+  //! them.  Does nothing while the adjacencies are compact, in a 
+  //! read-only phase, or while pointers to lists may be held.
+  ErrorCode enforce_memory_budget( const EntityHandle* entities = 0, 
+                                   int num_entities = 0 );
+
+  //! as above, keeping the pages used by a range of entities
+  ErrorCode enforce_memory_budget( const Range& entities );
+
+  //! restore all vertex to element lists reduced by enforce_memory_budget
+  ErrorCode restore_vert_elem_adjacencies();
+
+  //! returns the number of times the released lists of a page of
+  //! vertices were restored, a measure of the cost of the budget
+  unsigned long vert_adjacency_restores() const { return numRestores; }
+
   //! calling code notifying this that an entity is getting deleted
   ErrorCode notify_delete_entity(EntityHandle entity);
 
+  //! calling code notifying this that a range of entities is getting
+  //! deleted; each list that refers to the entities is updated in one
+  //! pass, and each set that tracks them is updated once.  Invalid
+  //! handles and vertices still adjacent to elements that are not 
+  //! deleted are passed back in 'failed' and left unchanged, while the
+  //! other entities are processed.
+  ErrorCode notify_delete_entities(const Range& entities, Range& failed);
+
   //! calling code notifying this that to update connectivity of 'entity' 
   ErrorCode notify_create_entity(const EntityHandle entity, 
                                     const EntityHandle *node_array,
                                     const int number_nodes);
 
+  //! calling code notifying this of a block of new elements with
+  //! consecutive handles; elements are appended to vertex lists in
+  //! order, without sorting or temporary storage
+  ErrorCode notify_create_entities(const EntityHandle start_handle,
+                                   const int number_elements,
+                                   const int nodes_per_element,
+                                   const EntityHandle *conn_array);
+
   //! calling code notifying that an entity changed its connectivity
   ErrorCode notify_change_connectivity(EntityHandle entity, 
                                           const EntityHandle* old_array,
@@ -163,6 +250,16 @@ public:
   ErrorCode merge_adjust_adjacencies(EntityHandle entity_to_keep,
                                        EntityHandle entity_to_remove);
   
+  //! move the explicit adjacency list of one entity to another entity
+  //! that has none, updating references in the lists of the adjacent
+  //! entities.  Used when an entity is moved to a new handle.
+  ErrorCode move_adjacencies( EntityHandle from, EntityHandle to );
+  
+  //! replace handles of moved entities in every explicit adjacency
+  //! list, including one-way adjacencies that move_adjacencies cannot
+  //! find.  \c moves holds (old,new) pairs sorted by old handle.
+  ErrorCode replace_adjacent_handles( const std::vector< std::pair<EntityHandle,EntityHandle> >& moves );
+
   void get_memory_use( unsigned long& total_entity_storage,
                        unsigned long& total_storage );
   ErrorCode get_memory_use( const Range& entities,
@@ -180,6 +277,88 @@ private:
                             int& count_out,
                             std::vector<EntityHandle>& storage );
 
+  //! Adjacencies of the vertices in [startHandle,endHandle]: those of
+  //! vertex startHandle+i are adjacencies[offsets[i]] up to but not
+  //! including adjacencies[offsets[i+1]].
+  //! The block covers the handle range of the vertex SequenceData
+  //! 'data', which is only used while building the block.
+  struct CompactVertAdj {
+    EntityHandle startHandle, endHandle;
+    SequenceData* data;
+    std::vector<EntityID> offsets;
+    std::vector<EntityHandle> adjacencies;
+    size_t memory_use() const
+      { return sizeof(CompactVertAdj) + offsets.capacity() * sizeof(EntityID)
+             + adjacencies.capacity() * sizeof(EntityHandle); }
+  };
+  
+  friend class VertElemAdjTask;
+  
+  static CompactVertAdj* find_compact_block( const std::vector<CompactVertAdj*>& blocks,
+                                             EntityHandle vertex );
+  
+  //! Pack the current vertex adjacency lists into one block per vertex
+  //! SequenceData, also adding adjacencies from element connectivity 
+  //! if with_elements is true.
+  ErrorCode pack_vert_adjacencies( std::vector<CompactVertAdj*>& blocks,
+                                   bool with_elements,
+                                   ThreadPool& pool );
+
+  //! Add each (vertex,element) pair to the list of the vertex; the
+  //! pairs must be sorted
+  ErrorCode add_vert_elem_pairs( const std::vector< std::pair<EntityHandle,EntityHandle> >& pairs );
+
+  //! Vertex lists are released and restored in pages of at most
+  //! this many consecutive handles of one SequenceData
+  enum { ADJ_PAGE_SIZE = 1024 };
+
+  //! Use of the vertex lists of a page of vertices
+  struct AdjacencyPage {
+    EntityHandle last;        //!< last vertex of the page
+    unsigned long lastAccess; //!< accessCount at last use
+    bool released;            //!< lists contain only explicit adjacencies
+    Range removed;            //!< elements removed from the lists
+  };
+  typedef std::map<EntityHandle,AdjacencyPage> AdjacencyPageMap;
+
+  //! Get the page containing a vertex of a SequenceData, creating it
+  //! if the vertex is in no page
+  AdjacencyPageMap::iterator vert_adjacency_page( EntityHandle vertex, 
+                                                  const SequenceData* data );
+
+  //! Mark the pages of the vertices of an entity as used
+  void keep_vert_adjacencies( EntityHandle entity,
+                                   std::vector<EntityHandle>& storage );
+
+  //! Whether enforce_memory_budget needs to and may release lists
+  bool may_release_vert_adjacencies() const;
+
+  //! Release the least recently used pages not used since the
+  //! access count 'in_use', until within three quarters of the budget
+  ErrorCode release_least_recent( unsigned long in_use );
+
+  //! Record use of the list of a vertex, restoring the lists of its
+  //! page first if they were released by enforce_memory_budget
+  ErrorCode touch_vert_adjacencies( EntityHandle vertex, const SequenceData* data );
+
+  //! Remove entries that can be computed from element connectivity
+  //! from the vertex lists of a page
+  ErrorCode release_vert_adjacencies( AdjacencyPageMap::iterator page );
+
+  //! Restore the entries removed by release_vert_adjacencies
+  ErrorCode rebuild_vert_adjacencies( AdjacencyPageMap::iterator page );
+
+  //! Prevents enforce_memory_budget from releasing lists while in scope,
+  //! for functions that keep pointers to lists across other queries
+  class BudgetHold {
+  public:
+    BudgetHold( const AEntityFactory* f ) : factory(f) { ++factory->budgetHolds; }
+    ~BudgetHold() { --factory->budgetHolds; }
+  private:
+    const AEntityFactory* factory;
+  };
+  friend class BudgetHold;
+
   //! private constructor to prevent the construction of a default one
   AEntityFactory();
 
@@ -189,6 +368,32 @@ private:
   //! whether vertex to element adjacencies are begin done
   bool mVertElemAdj;
   
+  //! compacted vertex adjacencies, sorted by start handle; empty
+  //! if vertex adjacencies are stored as per-vertex lists
+  std::vector<CompactVertAdj*> compactVertAdj;
+
+  //! memory of adjacency lists of this instance; also charged to
+  //! MEM_ADJACENCIES.  Bulk operations publish their totals once.
+  MemoryCounter adjMemory;
+
+  //! limit for adjMemory, or zero for none
+  size_t memoryBudget;
+
+  //! value from set_num_threads
+  unsigned numThreads;
+
+  //! count of vertex list accesses, for least recently used order
+  unsigned long accessCount;
+
+  //! pages of vertex lists, by first vertex
+  AdjacencyPageMap adjPages;
+
+  //! number of calls to rebuild_vert_adjacencies
+  unsigned long numRestores;
+
+  //! number of BudgetHold objects in scope
+  mutable int budgetHolds;
+  
   //! compare vertex_list to the vertices in this_entity, 
   //!  and return true if they contain the same vertices
   bool entities_equivalent(const EntityHandle this_entity, 
@@ -196,6 +401,21 @@ private:
                            const int vertex_list_size,
                            const EntityType target_type);
 
+  //! Append to target_entities, in sorted order, the entities of dimensions
+  //! min_dim through max_dim adjacent to vertex: those in the vertex's 
+  //! adjacency list (adj, num_adj) and any structured elements.
+  ErrorCode get_vertex_elements( EntityHandle vertex,
+                                 unsigned min_dim, unsigned max_dim,
+                                 const EntityHandle* adj, int num_adj,
+                                 std::vector<EntityHandle>& target_entities ) const;
+
+  //! Append to target_entities the structured elements of dimensions
+  //! min_dim through max_dim adjacent to vertex.  These adjacencies
+  //! are computed from the structured parameterization, never stored.
+  ErrorCode get_structured_elements( EntityHandle vertex,
+                                     unsigned min_dim, unsigned max_dim,
+                                     std::vector<EntityHandle>& target_entities ) const;
+
   ErrorCode get_zero_to_n_elements(EntityHandle source_entity,
                             const unsigned int target_dimension,
                             std::vector<EntityHandle> &target_entities,
@@ -5,32 +5,142 @@
 
 namespace moab {
 
-void BitPage::search( unsigned char value, int offset, int count, 
-                      int per_ent, Range& results, EntityHandle start ) const
+template <class Op> 
+void BitPage::scan( unsigned char value, int offset, int count, 
+                    int per_ent, Op& op ) const
 {
+  if (value >> per_ent)
+    return; // can never match
+  
+  const int per_byte = 8 / per_ent;
+  const int per_word = per_byte * sizeof(Word);
   const int end = offset + count;
-  Range::iterator hint = results.begin();
-  while (offset != end) {
+  
+    // values up to first Word boundary
+  for (; offset < end && offset % per_word; ++offset)
+    if (get_bits( offset, per_ent ) == value)
+      op.values( offset, 1 );
+  
+    // whole Words
+  const Word pattern = word_pattern( byte_pattern( value, per_ent ) );
+  const Word lsbs = word_pattern( byte_pattern( 1, per_ent ) );
+  for (; end - offset >= per_word; offset += per_word) {
+    Word bits;
+    memcpy( &bits, byteArray + offset / per_byte, sizeof(Word) );
+    Word match = zero_values( bits ^ pattern, lsbs, per_ent );
+    if (match == lsbs)
+      op.values( offset, per_word );
+    else if (match)
+      op.word( offset, match );
+  }
+  
+    // remaining values
+  for (; offset < end; ++offset)
     if (get_bits( offset, per_ent ) == value)
-      hint = results.insert( hint, start );
-    ++offset;
-    ++start;
+      op.values( offset, 1 );
+}
+
+namespace {
+
+/**\brief Insert handles of matching values into a Range as intervals */
+class SearchOp 
+{
+public:
+  SearchOp( Range& results, EntityHandle start, int per_ent ) 
+    : mResults( results ), mHint( results.begin() ), 
+      mStart( start ), mPerEnt( per_ent ), mFirst( 0 ), mCount( 0 ) {}
+  
+  ~SearchOp() { flush(); }
+  
+  void values( int offset, int count )
+  {
+    EntityHandle h = mStart + offset;
+    if (mCount && h == mFirst + mCount) 
+      mCount += count;
+    else {
+      flush();
+      mFirst = h;
+      mCount = count;
+    }
+  }
+  
+  template <typename Word> void word( int offset, Word match )
+  {
+      // examine bytes in memory order, which is the order of the values
+    unsigned char bytes[sizeof(Word)];
+    memcpy( bytes, &match, sizeof(Word) );
+    const int per_byte = 8 / mPerEnt;
+    for (unsigned i = 0; i < sizeof(Word); ++i, offset += per_byte) {
+      if (!bytes[i])
+        continue;
+      for (int j = 0; j < per_byte; ++j)
+        if ((bytes[i] >> (j*mPerEnt)) & 1)
+          values( offset + j, 1 );
+    }
   }
+  
+  void flush()
+  {
+    if (mCount) {
+      mHint = mResults.insert( mHint, mFirst, mFirst + mCount - 1 );
+      mCount = 0;
+    }
+  }
+
+private:
+  Range& mResults;
+  Range::iterator mHint;
+  EntityHandle mStart;  //!< handle corresponding to offset zero
+  int mPerEnt;
+  EntityHandle mFirst, mCount; //!< pending interval
+};
+
+/**\brief Count matching values */
+class CountOp
+{
+public:
+  CountOp() : mCount(0) {}
+  
+  void values( int, int count ) 
+    { mCount += count; }
+  
+  template <typename Word> void word( int, Word match ) 
+    { 
+#ifdef __GNUC__
+      mCount += __builtin_popcountl( match );
+#else
+      for (; match; match &= match - 1)
+        ++mCount;
+#endif
+    }
+  
+  size_t mCount;
+};
+
+} // namespace
+
+void BitPage::search( unsigned char value, int offset, int count, 
+                      int per_ent, Range& results, EntityHandle start ) const
+{
+  SearchOp op( results, start - offset, per_ent );
+  scan( value, offset, count, per_ent, op );
+}
+
+size_t BitPage::count( unsigned char value, int offset, int count, 
+                       int per_ent ) const
+{
+  CountOp op;
+  scan( value, offset, count, per_ent, op );
+  return op.mCount;
 }
 
 BitPage::BitPage( int per_ent, unsigned char init_val )
 {
-  unsigned char mask = (unsigned char)(1<<per_ent)-1; // 2^per_ent - 1
-  init_val &= (unsigned char)mask;
   switch (per_ent) {
     default: assert(false); abort(); break; // must be power of two
-      // Note: no breaks. fall through such that all bits in init_val are set
-    case 1: init_val |= (unsigned char)(init_val << 1);
-    case 2: init_val |= (unsigned char)(init_val << 2);
-    case 4: init_val |= (unsigned char)(init_val << 4);
-    case 8: ;
+    case 1: case 2: case 4: case 8: ;
   }
-  memset( byteArray, init_val, BitTag::PageSize );
+  memset( byteArray, byte_pattern( init_val, per_ent ), BitTag::PageSize );
 }
 
   
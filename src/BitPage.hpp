@@ -2,6 +2,7 @@
 #define BIT_PAGE_HPP
 
 #include <assert.h>
+#include <string.h>
 #include "BitTag.hpp"
 
 namespace moab {
@@ -117,13 +118,76 @@ public:
    */
   void search( unsigned char value, int offset, int count, 
                int bits_per_ent, Range& results, EntityHandle start ) const;
+  
+  /**\brief Count stored values equal to specified value.
+   *
+   *\param value   The value to look for
+   *\param offset  The offset at which to begin searching
+   *\param count   The number of values to search
+   *\param bits_per_ent Number of bits composing each tag value.
+   *\return The number of values in [offset,offset+count) equal to 'value'
+   */
+  size_t count( unsigned char value, int offset, int count, 
+                int bits_per_ent ) const;
 
 private:
 
+    /**\brief Unit in which values are compared by search and count */
+  typedef unsigned long Word;
+
+    /**\brief Replicate the lower bits_per_ent bits of value into every
+     *        tag value position in a byte */
+  static inline unsigned char byte_pattern( unsigned char value, int bits_per_ent );
+  
+    /**\brief Replicate a byte into every byte of a Word */
+  static inline Word word_pattern( unsigned char byte )
+    { return (~(Word)0 / 0xFF) * byte; }
+  
+    /**\brief Find zero tag values in a Word
+     *
+     * For each tag value position in 'bits' that contains a value of
+     * zero, set the lowest bit of that position in the result.  All
+     * other bits of the result are zero.  'lsbs' must have only the
+     * lowest bit of each value position set.  Values never span bytes,
+     * so the result is independent of the byte order of the platform.
+     */
+  static inline Word zero_values( Word bits, Word lsbs, int bits_per_ent );
+  
+    /**\brief Find stored values equal to specified value
+     *
+     * Call op.values(offset,n) for each run of n matching values
+     * found a byte or Word at a time, and op.word(offset,m) for each 
+     * Word that contains both matching and non-matching values, 
+     * where 'm' is the result of zero_values for that Word.
+     */
+  template <class Op> 
+  void scan( unsigned char value, int offset, int count, 
+             int bits_per_ent, Op& op ) const;
+
   /**\brief The actual array of bytes */
   char byteArray[BitTag::PageSize];
 };
 
+inline unsigned char BitPage::byte_pattern( unsigned char value, int per_ent )
+{
+  value &= (unsigned char)((1<<per_ent)-1);
+    // double the pattern until all bits in the byte are set
+  for (int shift = per_ent; shift < 8; shift *= 2)
+    value |= (unsigned char)(value << shift);
+  return value;
+}
+
+inline BitPage::Word BitPage::zero_values( Word bits, Word lsbs, int per_ent )
+{
+    // OR all bits of each value into its lowest bit.  Right shifts
+    // move bits toward the lowest bit of the same value, and only the
+    // lowest bits are kept, so bits from adjacent values never mix.
+  for (int shift = per_ent / 2; shift; shift /= 2)
+    bits |= bits >> shift;
+  return ~bits & lsbs;
+}
+
+
 inline unsigned char BitPage::get_bits( int offset, int per_ent ) const
 {
     // Assume per_ent is a power of two, which should be guaranteed
@@ -148,21 +212,65 @@ inline void BitPage::set_bits( int offset, int per_ent, unsigned char bits )
 
 inline void BitPage::get_bits( int offset, int count, int per_ent, unsigned char* data ) const
 {
+  if (8 == per_ent) {
+    memcpy( data, byteArray + offset, count );
+    return;
+  }
+  
+  const int per_byte = 8 / per_ent;
+  const unsigned char mask = (unsigned char)((1<<per_ent)-1);
   unsigned char* end = data+count;
+    // values up to first byte boundary
+  while (data != end && offset % per_byte)
+    *(data++) = get_bits( offset++, per_ent );
+    // whole bytes
+  const unsigned char* byte = reinterpret_cast<const unsigned char*>(byteArray) + offset/per_byte;
+  for (; end - data >= per_byte; ++byte, offset += per_byte) 
+    for (int i = 0; i < 8; i += per_ent)
+      *(data++) = (unsigned char)(*byte >> i) & mask;
+    // remaining values
   while (data != end)
     *(data++) = get_bits( offset++, per_ent );
 }
 
 inline void BitPage::set_bits( int offset, int count, int per_ent, const unsigned char* data )
 {
+  if (8 == per_ent) {
+    memcpy( byteArray + offset, data, count );
+    return;
+  }
+  
+  const int per_byte = 8 / per_ent;
+  const unsigned char mask = (unsigned char)((1<<per_ent)-1);
   const unsigned char* end = data+count;
+    // values up to first byte boundary
+  while (data != end && offset % per_byte)
+    set_bits( offset++, per_ent, *(data++) );
+    // whole bytes
+  char* byte = byteArray + offset/per_byte;
+  for (; end - data >= per_byte; ++byte, offset += per_byte) {
+    unsigned char bits = 0;
+    for (int i = 0; i < 8; i += per_ent)
+      bits |= (unsigned char)((*(data++) & mask) << i);
+    *byte = (char)bits;
+  }
+    // remaining values
   while (data != end)
     set_bits( offset++, per_ent, *(data++) );
 }
 
 inline void BitPage::set_bits( int offset, int count, int per_ent, unsigned char value )
 {
+  const int per_byte = 8 / per_ent;
   int end = offset + count;
+    // values up to first byte boundary
+  while (offset < end && offset % per_byte)
+    set_bits( offset++, per_ent, value );
+    // whole bytes
+  const int num_bytes = (end - offset) / per_byte;
+  memset( byteArray + offset/per_byte, byte_pattern( value, per_ent ), num_bytes );
+  offset += num_bytes * per_byte;
+    // remaining values
   while (offset < end)
     set_bits( offset++, per_ent, value );
 }
@@ -50,11 +50,21 @@ ErrorCode BitTag::reserve( unsigned bits )
   return MB_SUCCESS;
 }
 
+BitPage* BitTag::new_page( unsigned char init_val )
+{
+  memory_counter()->add( sizeof(BitPage) );
+  return new BitPage( storedBitsPerEntity, init_val );
+}
+
 ErrorCode BitTag::release_all_data(SequenceManager*, Error*, bool)
 {
   for (EntityType t = (EntityType)0; t != MBMAXTYPE; ++t) {
-    for (size_t i = 0; i < pageList[t].size(); ++i)
-      delete pageList[t][i];
+    for (size_t i = 0; i < pageList[t].size(); ++i) {
+      if (pageList[t][i]) {
+        memory_counter()->remove( sizeof(BitPage) );
+        delete pageList[t][i];
+      }
+    }
     pageList[t].clear();
   }
   return MB_SUCCESS;
@@ -100,7 +110,7 @@ ErrorCode BitTag::set_data( SequenceManager* seqman,
     if (pageList[type].size() <= page)
       pageList[type].resize(page+1, 0);
     if (!pageList[type][page])
-      pageList[type][page] = new BitPage( storedBitsPerEntity, default_val());
+      pageList[type][page] = new_page( default_val() );
     pageList[type][page]->set_bits( offset, storedBitsPerEntity, data[i] );
   }
   return MB_SUCCESS;
@@ -129,7 +139,7 @@ ErrorCode BitTag::clear_data( SequenceManager* seqman,
     if (pageList[type].size() <= page)
       pageList[type].resize(page+1, 0);
     if (!pageList[type][page])
-      pageList[type][page] = new BitPage( storedBitsPerEntity, default_val());
+      pageList[type][page] = new_page( default_val() );
     pageList[type][page]->set_bits( offset, storedBitsPerEntity, value );
   }
   return MB_SUCCESS;
@@ -214,7 +224,7 @@ ErrorCode BitTag::set_data( SequenceManager* seqman,
       if (page >= pageList[type].size())
         pageList[type].resize( page+1, 0 );
       if (!pageList[type][page])
-        pageList[type][page] = new BitPage( storedBitsPerEntity, def );
+        pageList[type][page] = new_page( def );
 
       size_t pcount = std::min( (EntityID)(per_page - offset), count );
       pageList[type][page]->set_bits( offset, pcount, storedBitsPerEntity, data );
@@ -255,7 +265,7 @@ ErrorCode BitTag::clear_data( SequenceManager* seqman,
       if (page >= pageList[type].size())
         pageList[type].resize( page+1, 0 );
       if (!pageList[type][page])
-        pageList[type][page] = new BitPage( storedBitsPerEntity, default_val() );
+        pageList[type][page] = new_page( default_val() );
 
       size_t pcount = std::min( (EntityID)(per_page - offset), count );
       pageList[type][page]->set_bits( offset, pcount, storedBitsPerEntity, value );
@@ -526,6 +536,49 @@ ErrorCode BitTag::get_entities_with_bits( const Range &range,
   return MB_SUCCESS;
 }
 
+ErrorCode BitTag::count_entities_with_bits( const Range &range,
+                                            EntityType in_type, 
+                                            size_t& result,
+                                            unsigned char bits ) const
+{
+  result = 0;
+  EntityType type;
+  EntityID count;
+  size_t page;
+  int offset, per_page = ents_per_page();
+  Range::const_iterator i, end;
+  if (MBMAXTYPE == in_type) {
+    i = range.begin();
+    end = range.end();
+  }
+  else {
+    std::pair<Range::iterator,Range::iterator> r = range.equal_range(in_type);
+    i = r.first;
+    end = r.second;
+  }
+  EntityHandle h;
+  while (i != end) {
+    h = *i;
+    unpack( h, type, page, offset );
+    
+      // blocks never span types because the id of zero is never used
+    i = i.end_of_block();
+    count = *i - h + 1;
+    ++i;
+    while (count > 0) {
+      EntityID pcount = std::min( count, (EntityID)(per_page - offset) );
+      if (page < pageList[type].size() && pageList[type][page]) 
+        result += pageList[type][page]->count( bits, offset, pcount, 
+                                               storedBitsPerEntity );
+    
+      count -= pcount;
+      offset = 0;
+      ++page;
+    }
+  }
+  return MB_SUCCESS;
+}
+
 ErrorCode BitTag::get_memory_use( const SequenceManager*,
                                   unsigned long& total,
                                   unsigned long& per_entity ) const
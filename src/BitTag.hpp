@@ -375,6 +375,17 @@ class BitTag : public TagInfo
                                       EntityType type, 
                                       Range& entities,
                                       unsigned char bits ) const;
+
+    /**\brief Count entities for which an explicit tag of the specified value is stored 
+     *
+     * Count the entities that get_entities_with_bits would return
+     * without constructing the list.
+     *\param count Output: number of entities in 'range' with value 'bits'
+     */
+  ErrorCode count_entities_with_bits( const Range &range,
+                                      EntityType type, 
+                                      size_t& count,
+                                      unsigned char bits ) const;
                               
   enum { Ln2PageSize = 12,              //!< Constant: log2(PageSize)
          PageSize = (1u << Ln2PageSize) //!< Constant: Bytes per BitPage (power of 2)
@@ -385,6 +396,9 @@ class BitTag : public TagInfo
   BitTag( const BitTag& );
   BitTag& operator=( const BitTag& );
   ErrorCode reserve( unsigned bits );
+
+    //! Allocate a page, charging it to the memory counter of the tag
+  BitPage* new_page( unsigned char init_val );
   
   inline unsigned char default_val() const {
     if (get_default_value())
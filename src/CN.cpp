@@ -129,7 +129,7 @@ void CN::SubEntityConn(const void *parent_conn, const EntityType parent_type,
                          const int sub_index,
                          void *sub_entity_conn, int &num_sub_vertices) 
 {
-  static int sub_indices[MAX_SUB_ENTITY_VERTICES];
+  int sub_indices[MAX_SUB_ENTITY_VERTICES];
   
   SubEntityVertexIndices(parent_type, sub_dimension, sub_index, sub_indices);
   
@@ -0,0 +1,127 @@
+#include "moab/ChunkIterator.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace moab {
+
+ChunkIterator::ChunkIterator( Interface* mb,
+                              const Range& entities,
+                              bool coordinates,
+                              bool connectivity,
+                              const Tag* tags,
+                              int num_tags )
+  : mbImpl( mb ), allEnts( &entities ), 
+    wantCoords( coordinates ), wantConnect( connectivity ),
+    tagList( tags, tags + num_tags ), tagBytes( num_tags, 0 ),
+    currIter( entities.end() ), chunkCount( 0 ),
+    connPtr( 0 ), nodesPerElem( 0 ),
+    tagPtrs( num_tags, (void*)0 )
+{
+  coordPtrs[0] = coordPtrs[1] = coordPtrs[2] = 0;
+  floatPtrs[0] = floatPtrs[1] = floatPtrs[2] = 0;
+}
+
+ErrorCode ChunkIterator::reset()
+{
+  currIter = allEnts->end();
+  for (size_t i = 0; i < tagList.size(); ++i) {
+    TagType storage;
+    ErrorCode rval = mbImpl->tag_get_type( tagList[i], storage );
+    if (MB_SUCCESS != rval)
+      return rval;
+    rval = mbImpl->tag_get_bytes( tagList[i], tagBytes[i] );
+    if (MB_VARIABLE_DATA_LENGTH == rval || MB_TAG_DENSE != storage)
+      return MB_TYPE_OUT_OF_RANGE;
+    else if (MB_SUCCESS != rval)
+      return rval;
+  }
+  
+  currIter = allEnts->begin();
+  return get_chunk();
+}
+
+ErrorCode ChunkIterator::next()
+{
+  currIter += chunkCount;
+  return get_chunk();
+}
+
+ErrorCode ChunkIterator::get_chunk()
+{
+  const Range::const_iterator end = allEnts->end();
+  chunkCount = 0;
+  if (currIter == end)
+    return MB_SUCCESS;
+  
+    // Each *_iterate call returns the number of entities for which
+    // its storage is contiguous.  The chunk is the smallest of these.
+  ErrorCode rval;
+  int count = std::numeric_limits<int>::max(), n;
+  if (wantCoords) {
+      // coordinates are stored as either double or float
+    floatPtrs[0] = floatPtrs[1] = floatPtrs[2] = 0;
+    rval = mbImpl->coords_iterate( currIter, end, coordPtrs[0], 
+                                   coordPtrs[1], coordPtrs[2], n );
+    if (MB_TYPE_OUT_OF_RANGE == rval) {
+      coordPtrs[0] = coordPtrs[1] = coordPtrs[2] = 0;
+      rval = mbImpl->coords_iterate( currIter, end, floatPtrs[0], 
+                                     floatPtrs[1], floatPtrs[2], n );
+    }
+    if (MB_SUCCESS != rval)
+      return rval;
+    count = std::min( count, n );
+  }
+  
+  if (wantConnect) {
+    rval = mbImpl->connect_iterate( currIter, end, connPtr, nodesPerElem, n );
+    if (MB_SUCCESS != rval)
+      return rval;
+    count = std::min( count, n );
+  }
+  
+  for (size_t i = 0; i < tagList.size(); ++i) {
+    rval = mbImpl->tag_iterate( tagList[i], currIter, end, n, tagPtrs[i] );
+    if (MB_SUCCESS != rval)
+      return rval;
+    count = std::min( count, n );
+  }
+  
+    // nothing requested: chunk is remainder of contiguous block of handles
+  if (!wantCoords && !wantConnect && tagList.empty()) {
+    Range::const_iterator last = currIter.end_of_block();
+    count = *last - *currIter + 1;
+  }
+  
+  chunkCount = count;
+  return MB_SUCCESS;
+}
+
+static inline bool is_aligned( const void* ptr, size_t offset, size_t alignment )
+{
+  return 0 == ((reinterpret_cast<size_t>(ptr) + offset) & (alignment - 1));
+}
+
+int ChunkIterator::peel_count( size_t alignment ) const
+{
+    // Offsets modulo a power of two repeat after 'alignment' entities,
+    // so if no position in that many entities works, none will.
+  const int limit = (size_t)chunkCount < alignment ? chunkCount : (int)alignment;
+  for (int i = 0; i < limit; ++i) {
+    bool aligned = true;
+    for (int d = 0; d < 3 && aligned; ++d) {
+      if (coordPtrs[d])
+        aligned = is_aligned( coordPtrs[d], i * sizeof(double), alignment );
+      else if (floatPtrs[d])
+        aligned = is_aligned( floatPtrs[d], i * sizeof(float), alignment );
+    }
+    if (aligned && connPtr)
+      aligned = is_aligned( connPtr, i * nodesPerElem * sizeof(EntityHandle), alignment );
+    for (size_t t = 0; t < tagList.size() && aligned; ++t)
+      aligned = is_aligned( tagPtrs[t], (size_t)i * tagBytes[t], alignment );
+    if (aligned)
+      return i;
+  }
+  return chunkCount;
+}
+
+} // namespace moab
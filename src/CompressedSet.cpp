@@ -0,0 +1,383 @@
+#include "CompressedSet.hpp"
+
+namespace moab {
+
+  // index of lowest set bit in a non-zero word
+static inline unsigned lowest_bit( unsigned long bits )
+{
+#ifdef __GNUC__
+  return __builtin_ctzl( bits );
+#else
+  unsigned result = 0;
+  for (; !(bits & 1ul); bits >>= 1)
+    ++result;
+  return result;
+#endif
+}
+
+  // number of set bits in word
+static inline unsigned count_bits( unsigned long bits )
+{
+#ifdef __GNUC__
+  return __builtin_popcountl( bits );
+#else
+  unsigned result = 0;
+  for (; bits; bits &= bits - 1)
+    ++result;
+  return result;
+#endif
+}
+
+  // mask for bits of word w that are in [lo,hi]
+static inline unsigned long word_mask( unsigned w, unsigned lo, unsigned hi )
+{
+  const unsigned bits = 8 * sizeof(unsigned long);
+  const unsigned first = w * bits;
+  unsigned long mask = ~0ul;
+  if (lo > first)
+    mask <<= (lo - first);
+  if (hi < first + bits - 1)
+    mask &= ~(~0ul << (hi - first + 1));
+  return mask;
+}
+
+  // append handle for each bit set in word
+static inline void append_bits( unsigned long bits, EntityHandle h,
+                                std::vector<EntityHandle>* list )
+{
+  while (bits) {
+    list->push_back( h + lowest_bit( bits ) );
+    bits &= bits - 1;
+  }
+}
+
+unsigned CompressedSet::find_bit( const std::vector<Word>& bits,
+                                  unsigned lo, unsigned hi, bool value )
+{
+  const Word flip = value ? 0 : ~(Word)0;
+  unsigned w = lo / WORD_BITS;
+  const unsigned w_last = hi / WORD_BITS;
+  Word word = (bits[w] ^ flip) & (~(Word)0 << (lo % WORD_BITS));
+  while (!word) {
+    if (++w > w_last)
+      return hi + 1;
+    word = bits[w] ^ flip;
+  }
+  unsigned result = w * WORD_BITS + lowest_bit( word );
+  return result > hi ? hi + 1 : result;
+}
+
+void CompressedSet::to_bitmap( Chunk& c )
+{
+  if (c.full()) {
+    c.bitmap.assign( BITMAP_WORDS, ~(Word)0 );
+  }
+  else {
+    c.bitmap.assign( BITMAP_WORDS, 0 );
+    for (size_t i = 0; i < c.array.size(); ++i)
+      c.bitmap[c.array[i] / WORD_BITS] |= (Word)1 << (c.array[i] % WORD_BITS);
+  }
+  std::vector<unsigned short>().swap( c.array );
+}
+
+void CompressedSet::to_array( Chunk& c )
+{
+  c.array.clear();
+  c.array.reserve( c.count );
+  for (unsigned w = 0; w < BITMAP_WORDS; ++w)
+    for (Word bits = c.bitmap[w]; bits; bits &= bits - 1)
+      c.array.push_back( (unsigned short)(w * WORD_BITS + lowest_bit( bits )) );
+  std::vector<Word>().swap( c.bitmap );
+}
+
+size_t CompressedSet::insert( Chunk& c, EntityHandle b, unsigned lo, unsigned hi,
+                              std::vector<EntityHandle>* inserted )
+{
+  if (c.full())
+    return 0;
+
+  if (c.bitmap.empty()) {
+    std::vector<unsigned short>::iterator lb, ub;
+    lb = std::lower_bound( c.array.begin(), c.array.end(), lo );
+    ub = std::upper_bound( lb, c.array.end(), hi );
+    const size_t added = (hi - lo + 1) - (ub - lb);
+    if (!added)
+      return 0;
+    if (c.count + added <= ARRAY_MAX) {
+      if (inserted) {
+        std::vector<unsigned short>::iterator j = lb;
+        for (unsigned o = lo; o <= hi; ++o) {
+          if (j != ub && *j == o)
+            ++j;
+          else
+            inserted->push_back( b + o );
+        }
+      }
+        // replace [lb,ub) with [lo,hi]
+      const size_t pos = lb - c.array.begin();
+      c.array.insert( ub, added, 0 );
+      for (size_t i = 0; i <= hi - lo; ++i)
+        c.array[pos+i] = (unsigned short)(lo + i);
+      c.count += added;
+      return added;
+    }
+    to_bitmap( c );
+  }
+
+  size_t added = 0;
+  for (unsigned w = lo / WORD_BITS; w <= hi / WORD_BITS; ++w) {
+    const Word mask = word_mask( w, lo, hi );
+    Word new_bits = mask & ~c.bitmap[w];
+    if (new_bits) {
+      if (inserted)
+        append_bits( new_bits, b + w * WORD_BITS, inserted );
+      added += count_bits( new_bits );
+      c.bitmap[w] |= new_bits;
+    }
+  }
+  c.count += added;
+  if (c.full())
+    std::vector<Word>().swap( c.bitmap );
+  return added;
+}
+
+size_t CompressedSet::erase( Chunk& c, EntityHandle b, unsigned lo, unsigned hi,
+                             std::vector<EntityHandle>* removed )
+{
+  if (c.full()) {
+    if (lo == 0 && hi == CHUNK_SIZE - 1) {
+      if (removed)
+        for (unsigned o = lo; o <= hi; ++o)
+          removed->push_back( b + o );
+      c.count = 0;
+      return CHUNK_SIZE;
+    }
+    to_bitmap( c );
+  }
+
+  size_t count = 0;
+  if (c.bitmap.empty()) {
+    std::vector<unsigned short>::iterator lb, ub;
+    lb = std::lower_bound( c.array.begin(), c.array.end(), lo );
+    ub = std::upper_bound( lb, c.array.end(), hi );
+    if (removed)
+      for (std::vector<unsigned short>::iterator j = lb; j != ub; ++j)
+        removed->push_back( b + *j );
+    count = ub - lb;
+    c.array.erase( lb, ub );
+    c.count -= count;
+    return count;
+  }
+
+  for (unsigned w = lo / WORD_BITS; w <= hi / WORD_BITS; ++w) {
+    const Word mask = word_mask( w, lo, hi );
+    Word old_bits = mask & c.bitmap[w];
+    if (old_bits) {
+      if (removed)
+        append_bits( old_bits, b + w * WORD_BITS, removed );
+      count += count_bits( old_bits );
+      c.bitmap[w] &= ~old_bits;
+    }
+  }
+  c.count -= count;
+  if (c.count <= ARRAY_MIN)
+    to_array( c );
+  return count;
+}
+
+size_t CompressedSet::count( const Chunk& c, unsigned lo, unsigned hi )
+{
+  if (c.full())
+    return hi - lo + 1;
+
+  if (c.bitmap.empty()) {
+    std::vector<unsigned short>::const_iterator lb, ub;
+    lb = std::lower_bound( c.array.begin(), c.array.end(), lo );
+    ub = std::upper_bound( lb, c.array.end(), hi );
+    return ub - lb;
+  }
+
+  size_t result = 0;
+  for (unsigned w = lo / WORD_BITS; w <= hi / WORD_BITS; ++w) {
+    const Word mask = word_mask( w, lo, hi );
+    result += count_bits( mask & c.bitmap[w] );
+  }
+  return result;
+}
+
+bool CompressedSet::contains( EntityHandle h ) const
+{
+  ChunkMap::const_iterator i = chunkMap.find( key(h) );
+  if (i == chunkMap.end())
+    return false;
+  const Chunk& c = i->second;
+  const unsigned o = offset(h);
+  if (c.full())
+    return true;
+  else if (!c.bitmap.empty())
+    return 0 != (c.bitmap[o / WORD_BITS] & ((Word)1 << (o % WORD_BITS)));
+  else
+    return std::binary_search( c.array.begin(), c.array.end(), o );
+}
+
+size_t CompressedSet::insert( EntityHandle first, EntityHandle last,
+                              std::vector<EntityHandle>* inserted )
+{
+  if (first > last)
+    return 0;
+  size_t added = 0;
+  const EntityHandle kf = key(first), kl = key(last);
+  ChunkMap::iterator i = chunkMap.lower_bound( kf );
+  for (EntityHandle k = kf; ; ++k) {
+    if (i == chunkMap.end() || i->first != k)
+      i = chunkMap.insert( i, ChunkMap::value_type( k, Chunk() ) );
+    unsigned lo = (k == kf) ? offset(first) : 0;
+    unsigned hi = (k == kl) ? offset(last) : CHUNK_SIZE - 1;
+    added += insert( i->second, base(k), lo, hi, inserted );
+    ++i;
+    if (k == kl)
+      break;
+  }
+  numEntities += added;
+  return added;
+}
+
+size_t CompressedSet::erase( EntityHandle first, EntityHandle last,
+                             std::vector<EntityHandle>* removed )
+{
+  if (first > last)
+    return 0;
+  size_t count = 0;
+  const EntityHandle kf = key(first), kl = key(last);
+  ChunkMap::iterator i = chunkMap.lower_bound( kf );
+  while (i != chunkMap.end() && i->first <= kl) {
+    unsigned lo = (i->first == kf) ? offset(first) : 0;
+    unsigned hi = (i->first == kl) ? offset(last) : CHUNK_SIZE - 1;
+    count += erase( i->second, base(i->first), lo, hi, removed );
+    if (i->second.count)
+      ++i;
+    else
+      chunkMap.erase( i++ );
+  }
+  numEntities -= count;
+  return count;
+}
+
+void CompressedSet::clear()
+{
+  chunkMap.clear();
+  numEntities = 0;
+}
+
+size_t CompressedSet::count( EntityHandle first, EntityHandle last ) const
+{
+  if (first > last)
+    return 0;
+  size_t result = 0;
+  const EntityHandle kf = key(first), kl = key(last);
+  ChunkMap::const_iterator i = chunkMap.lower_bound( kf );
+  for (; i != chunkMap.end() && i->first <= kl; ++i) {
+    unsigned lo = (i->first == kf) ? offset(first) : 0;
+    unsigned hi = (i->first == kl) ? offset(last) : CHUNK_SIZE - 1;
+    result += count( i->second, lo, hi );
+  }
+  return result;
+}
+
+namespace {
+  struct RangeInserter {
+    Range& list;
+    Range::iterator hint;
+    RangeInserter( Range& r ) : list(r), hint(r.begin()) {}
+    void operator()( EntityHandle s, EntityHandle e )
+      { hint = list.insert( hint, s, e ); }
+  };
+
+  struct VectorInserter {
+    std::vector<EntityHandle>& list;
+    VectorInserter( std::vector<EntityHandle>& v ) : list(v) {}
+    void operator()( EntityHandle s, EntityHandle e )
+      { for (; s <= e; ++s) list.push_back( s ); }
+  };
+
+  struct PairInserter {
+    std::vector<EntityHandle>& list;
+    PairInserter( std::vector<EntityHandle>& v ) : list(v) {}
+    void operator()( EntityHandle s, EntityHandle e )
+    {
+      if (!list.empty() && list.back() + 1 == s)
+        list.back() = e;
+      else {
+        list.push_back( s );
+        list.push_back( e );
+      }
+    }
+  };
+}
+
+void CompressedSet::get_entities( EntityHandle first, EntityHandle last,
+                                  Range& list ) const
+{
+  RangeInserter op( list );
+  visit_runs( first, last, op );
+}
+
+void CompressedSet::get_entities( EntityHandle first, EntityHandle last,
+                                  std::vector<EntityHandle>& list ) const
+{
+  list.reserve( list.size() + count( first, last ) );
+  VectorInserter op( list );
+  visit_runs( first, last, op );
+}
+
+void CompressedSet::get_pairs( std::vector<EntityHandle>& pairs ) const
+{
+  pairs.clear();
+  PairInserter op( pairs );
+  visit_runs( 0, ~(EntityHandle)0, op );
+}
+
+unsigned long CompressedSet::memory_use() const
+{
+  unsigned long result = sizeof(*this);
+  for (ChunkMap::const_iterator i = chunkMap.begin(); i != chunkMap.end(); ++i)
+    result += node_size()
+            + i->second.array.capacity() * sizeof(unsigned short)
+            + i->second.bitmap.capacity() * sizeof(Word);
+  return result;
+}
+
+unsigned long CompressedSet::chunk_memory( unsigned long count )
+{
+  if (count == CHUNK_SIZE)
+    return node_size();
+  else if (count > ARRAY_MAX)
+    return node_size() + BITMAP_WORDS * sizeof(Word);
+  else
+    return node_size() + count * sizeof(unsigned short);
+}
+
+unsigned long CompressedSet::estimate_memory_use( const EntityHandle* pairs, 
+                                                 size_t length )
+{
+  unsigned long result = sizeof(CompressedSet);
+  EntityHandle chunk = 0;
+  unsigned long count = 0;
+  for (size_t i = 0; i < length; i += 2) {
+    for (EntityHandle k = key( pairs[i] ); k <= key( pairs[i+1] ); ++k) {
+      if (count && k != chunk) {
+        result += chunk_memory( count );
+        count = 0;
+      }
+      chunk = k;
+      const EntityHandle lo = std::max( pairs[i], base( k ) );
+      const EntityHandle hi = std::min( pairs[i+1], base( k ) + (CHUNK_SIZE - 1) );
+      count += hi - lo + 1;
+    }
+  }
+  if (count)
+    result += chunk_memory( count );
+  return result;
+}
+
+} // namespace moab
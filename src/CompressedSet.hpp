@@ -0,0 +1,191 @@
+#ifndef MB_COMPRESSED_SET_HPP
+#define MB_COMPRESSED_SET_HPP
+
+#ifndef IS_BUILDING_MB
+#error "CompressedSet.hpp isn't supposed to be included into an application"
+#endif
+
+#include "moab/Range.hpp"
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace moab {
+
+/**\brief Compressed storage for contents of large unordered entity sets
+ *
+ * The handle space is divided into fixed-size chunks keyed by the high
+ * bits of the handle.  Each non-empty chunk holds the low bits of the
+ * contained handles in one of three forms, chosen by the number of
+ * handles in the chunk:
+ *  - a sorted array of 16-bit offsets (sparse chunks)
+ *  - a bitmap with one bit for each handle in the chunk (dense chunks)
+ *  - nothing at all if every handle in the chunk is contained
+ *
+ * Within a chunk this needs at most two bytes per contained handle,
+ * compared to sixteen bytes per handle for a list of ranges of isolated
+ * handles.  Each non-empty chunk also costs a std::map node and its two
+ * std::vectors, so handles scattered over many chunks with few handles
+ * each may need more memory than a list of ranges (see estimate_memory_use).
+ */
+class CompressedSet
+{
+public:
+
+  CompressedSet() : numEntities(0) {}
+
+    //! Number of contained handles
+  size_t size() const { return numEntities; }
+  bool empty() const { return 0 == numEntities; }
+
+  bool contains( EntityHandle h ) const;
+
+    /**\brief Add handles [first,last]
+     *\param inserted  If not null, handles not already in the set are
+     *                 appended to this list.
+     *\return Number of handles added
+     */
+  size_t insert( EntityHandle first, EntityHandle last,
+                 std::vector<EntityHandle>* inserted = 0 );
+
+    /**\brief Remove handles [first,last]
+     *\param removed   If not null, handles that were in the set are
+     *                 appended to this list.
+     *\return Number of handles removed
+     */
+  size_t erase( EntityHandle first, EntityHandle last,
+                std::vector<EntityHandle>* removed = 0 );
+
+  void clear();
+
+    //! Count contained handles in [first,last]
+  size_t count( EntityHandle first, EntityHandle last ) const;
+
+    //! Append contained handles in [first,last] to list
+  void get_entities( EntityHandle first, EntityHandle last, Range& list ) const;
+    //! Append contained handles in [first,last] to list
+  void get_entities( EntityHandle first, EntityHandle last,
+                     std::vector<EntityHandle>& list ) const;
+
+    /**\brief Get contents as list of [begin,end] pairs
+     *
+     * Replace the contents of \c pairs with the handles in the set in
+     * the same representation as for MeshSet's range-based contents.
+     */
+  void get_pairs( std::vector<EntityHandle>& pairs ) const;
+
+  unsigned long memory_use() const;
+
+    /**\brief Approximate memory_use() of a set of the handles in a list of ranges
+     *\param pairs  Sorted list of [first,last] pairs of handles
+     *\param length Length of the list (twice the number of pairs)
+     */
+  static unsigned long estimate_memory_use( const EntityHandle* pairs, size_t length );
+
+    /**\brief Call op(begin,end) for each block of consecutive handles
+     *
+     * Visit all blocks of consecutive handles in [first,last] in
+     * increasing order.  Blocks are not merged across chunk boundaries.
+     */
+  template <class Op>
+  void visit_runs( EntityHandle first, EntityHandle last, Op& op ) const;
+
+private:
+
+  typedef unsigned long Word;
+  enum {
+    CHUNK_BITS = 16,
+    CHUNK_SIZE = 1 << CHUNK_BITS,
+    WORD_BITS = 8 * sizeof(Word),
+    BITMAP_WORDS = CHUNK_SIZE / WORD_BITS,
+      //! chunks with more handles than this use a bitmap
+    ARRAY_MAX = CHUNK_SIZE / 16,
+      //! bitmap chunks with this many or fewer handles revert to an array
+    ARRAY_MIN = ARRAY_MAX / 2
+  };
+
+  struct Chunk {
+    unsigned count;                     //!< number of handles in chunk
+    std::vector<unsigned short> array;  //!< sorted offsets if not bitmap or full
+    std::vector<Word> bitmap;           //!< one bit per handle if not empty
+    Chunk() : count(0) {}
+    bool full() const { return count == CHUNK_SIZE; }
+  };
+
+  typedef std::map<EntityHandle,Chunk> ChunkMap;
+
+  static EntityHandle key( EntityHandle h ) { return h >> CHUNK_BITS; }
+  static unsigned offset( EntityHandle h ) { return (unsigned)(h & (CHUNK_SIZE-1)); }
+  static EntityHandle base( EntityHandle k ) { return k << CHUNK_BITS; }
+
+    //! approximate size of a std::map node holding a Chunk
+  static unsigned long node_size() 
+    { return sizeof(ChunkMap::value_type) + 4*sizeof(void*); }
+    //! approximate memory of a chunk built with \c count handles
+  static unsigned long chunk_memory( unsigned long count );
+
+  static void to_bitmap( Chunk& c );
+  static void to_array( Chunk& c );
+  static size_t insert( Chunk& c, EntityHandle base, unsigned lo, unsigned hi,
+                        std::vector<EntityHandle>* inserted );
+  static size_t erase( Chunk& c, EntityHandle base, unsigned lo, unsigned hi,
+                       std::vector<EntityHandle>* removed );
+  static size_t count( const Chunk& c, unsigned lo, unsigned hi );
+
+    //! First set (or clear if \c value is false) bit in [lo,hi], or hi+1
+  static unsigned find_bit( const std::vector<Word>& bits,
+                            unsigned lo, unsigned hi, bool value );
+
+  template <class Op> static
+  void visit_runs( const Chunk& c, EntityHandle base,
+                   unsigned lo, unsigned hi, Op& op );
+
+  ChunkMap chunkMap;
+  size_t numEntities;
+};
+
+template <class Op> inline
+void CompressedSet::visit_runs( const Chunk& c, EntityHandle b,
+                                unsigned lo, unsigned hi, Op& op )
+{
+  if (c.full()) {
+    op( b + lo, b + hi );
+  }
+  else if (!c.bitmap.empty()) {
+    for (unsigned s = find_bit( c.bitmap, lo, hi, true ); s <= hi; ) {
+      unsigned e = find_bit( c.bitmap, s, hi, false );
+      op( b + s, b + e - 1 );
+      if (e > hi)
+        break;
+      s = find_bit( c.bitmap, e, hi, true );
+    }
+  }
+  else {
+    std::vector<unsigned short>::const_iterator i, end = c.array.end();
+    i = std::lower_bound( c.array.begin(), end, lo );
+    while (i != end && *i <= hi) {
+      unsigned s = *i, e = s;
+      for (++i; i != end && *i == e + 1 && *i <= hi; ++i)
+        ++e;
+      op( b + s, b + e );
+    }
+  }
+}
+
+template <class Op> inline
+void CompressedSet::visit_runs( EntityHandle first, EntityHandle last, Op& op ) const
+{
+  if (first > last)
+    return;
+  const EntityHandle kf = key(first), kl = key(last);
+  ChunkMap::const_iterator i = chunkMap.lower_bound( kf );
+  for (; i != chunkMap.end() && i->first <= kl; ++i) {
+    unsigned lo = (i->first == kf) ? offset(first) : 0;
+    unsigned hi = (i->first == kl) ? offset(last) : CHUNK_SIZE - 1;
+    visit_runs( i->second, base(i->first), lo, hi, op );
+  }
+}
+
+} // namespace moab
+
+#endif
@@ -38,6 +38,7 @@
 #include "moab/CN.hpp"
 #include "moab/HigherOrderFactory.hpp"
 #include "SequenceManager.hpp"
+#include "ScdVertexData.hpp"
 #include "moab/Error.hpp"
 #include "moab/ReaderWriterSet.hpp"
 #include "moab/ReaderIface.hpp"
@@ -51,6 +52,7 @@
 #include "SparseTag.hpp"
 #include "VarLenDenseTag.hpp"
 #include "VarLenSparseTag.hpp"
+#include "TagValueIndex.hpp"
 
 #include <sys/stat.h>
 #include <errno.h>
@@ -778,6 +780,8 @@ ErrorCode Core::delete_mesh()
     ErrorCode tmp = (*i)->release_all_data( sequenceManager, mError, false );
     if (MB_SUCCESS != tmp)
       result = tmp;
+    if ((*i)->value_index())
+      (*i)->value_index()->clear();
   }
 
   sequenceManager->clear();
@@ -848,6 +852,39 @@ ErrorCode Core::get_vertex_coordinates(std::vector<double> &coords) const
   return result;
 }
 
+  // Get vertex sequence and offset of first handle for coords_iterate
+static ErrorCode coords_iterate_seq( SequenceManager* seq_man,
+                                     Error* error,
+                                     EntityHandle handle,
+                                     VertexSequence*& vseq,
+                                     unsigned& offset )
+{
+  EntitySequence *seq;
+  ErrorCode rval = seq_man->find(handle, seq);
+  if (MB_SUCCESS != rval) {
+    error->set_last_error("Couldn't find sequence for start handle.");
+    return rval;
+  }
+  vseq = dynamic_cast<VertexSequence*>(seq);
+  if (!vseq) {
+    error->set_last_error("Couldn't find sequence for start handle.");
+    return MB_ENTITY_NOT_FOUND;
+  }
+  offset = handle - vseq->start_handle();
+  return MB_SUCCESS;
+}
+
+  // Number of vertices from iter that are both in the range block
+  // and in the sequence containing *iter
+static int coords_iterate_count( const VertexSequence* vseq,
+                                 Range::const_iterator iter,
+                                 Range::const_iterator end )
+{
+  EntityHandle real_end = std::min(vseq->end_handle(), *(iter.end_of_block()));
+  if (*end) real_end = std::min(real_end, *end);
+  return real_end - *iter + 1;
+}
+
 ErrorCode Core::coords_iterate(Range::const_iterator iter,
                                Range::const_iterator end,
                                double*& xcoords_ptr,
@@ -855,31 +892,79 @@ ErrorCode Core::coords_iterate(Range::const_iterator iter,
                                double*& zcoords_ptr,
                                int& count)
 {
-  EntitySequence *seq;
-  ErrorCode rval = sequence_manager()->find(*iter, seq);
+  xcoords_ptr = ycoords_ptr = zcoords_ptr = NULL;
+  VertexSequence *vseq;
+  unsigned offset;
+  ErrorCode rval = coords_iterate_seq( sequence_manager(), mError, *iter, vseq, offset );
+  if (MB_SUCCESS != rval)
+    return rval;
+
+  rval = vseq->get_coordinate_arrays( xcoords_ptr, ycoords_ptr, zcoords_ptr );
   if (MB_SUCCESS != rval) {
-    mError->set_last_error("Couldn't find sequence for start handle.");
-    xcoords_ptr = ycoords_ptr = zcoords_ptr = NULL;
+    mError->set_last_error("Vertex coordinates are stored in single precision.");
     return rval;
   }
-  VertexSequence *vseq = dynamic_cast<VertexSequence*>(seq);
-  if (!vseq) {
-    mError->set_last_error("Couldn't find sequence for start handle.");
-    return MB_ENTITY_NOT_FOUND;
-  }
-
-  unsigned int offset = *iter - vseq->data()->start_handle();
-  xcoords_ptr = reinterpret_cast<double*>(vseq->data()->get_sequence_data(0)) + offset;
-  ycoords_ptr = reinterpret_cast<double*>(vseq->data()->get_sequence_data(1)) + offset;
-  zcoords_ptr = reinterpret_cast<double*>(vseq->data()->get_sequence_data(2)) + offset;
+  xcoords_ptr += offset;
+  ycoords_ptr += offset;
+  zcoords_ptr += offset;
+  count = coords_iterate_count( vseq, iter, end );
+  return MB_SUCCESS;
+}
 
-  EntityHandle real_end = *(iter.end_of_block());
-  if (*end) real_end = std::min(real_end, *end);
-  count = real_end - *iter + 1;
+ErrorCode Core::coords_iterate(Range::const_iterator iter,
+                               Range::const_iterator end,
+                               float*& xcoords_ptr,
+                               float*& ycoords_ptr,
+                               float*& zcoords_ptr,
+                               int& count)
+{
+  xcoords_ptr = ycoords_ptr = zcoords_ptr = NULL;
+  VertexSequence *vseq;
+  unsigned offset;
+  ErrorCode rval = coords_iterate_seq( sequence_manager(), mError, *iter, vseq, offset );
+  if (MB_SUCCESS != rval)
+    return rval;
 
+  rval = vseq->get_coordinate_arrays( xcoords_ptr, ycoords_ptr, zcoords_ptr );
+  if (MB_SUCCESS != rval) {
+    mError->set_last_error("Vertex coordinates are stored in double precision.");
+    return rval;
+  }
+  xcoords_ptr += offset;
+  ycoords_ptr += offset;
+  zcoords_ptr += offset;
+  count = coords_iterate_count( vseq, iter, end );
   return MB_SUCCESS;
 }
 
+  // Copy coordinates of count vertices beginning at offset
+  // from the arrays of a VertexSequence, interleaved
+template <typename T> static
+void copy_interleaved_coords( const VertexSequence* vseq, EntityID offset, 
+                              EntityID count, double* coords )
+{
+  T const *x, *y, *z;
+  vseq->get_coordinate_arrays( x, y, z );
+  x += offset;
+  y += offset;
+  z += offset;
+  for (EntityID j = 0; j < count; ++j) {
+    coords[3*j] = x[j];
+    coords[3*j+1] = y[j];
+    coords[3*j+2] = z[j];
+  }
+}
+
+  // Copy count values to dest and advance it, unless dest is null
+template <typename T> static
+void copy_blocked_coords( const T* src, EntityID count, double*& dest )
+{
+  if (dest) {
+    std::copy( src, src + count, dest );
+    dest += count;
+  }
+}
+
 ErrorCode  Core::get_coords(const Range& entities, double *coords) const
 {
   const TypeSequenceManager& vert_data = sequence_manager()->entity_map( MBVERTEX );
@@ -907,18 +992,10 @@ ErrorCode  Core::get_coords(const Range& entities, double *coords) const
       first = vseq->end_handle()+1;
     }
 
-    double const *x, *y, *z;
-    ErrorCode rval = vseq->get_coordinate_arrays( x, y, z );
-    if (MB_SUCCESS != rval)
-      return rval;
-    x += offset;
-    y += offset;
-    z += offset;
-    for (EntityID j = 0; j < count; ++j) {
-      coords[3*j] = x[j];
-      coords[3*j+1] = y[j];
-      coords[3*j+2] = z[j];
-    }
+    if (vseq->single_precision())
+      copy_interleaved_coords<float>( vseq, offset, count, coords );
+    else
+      copy_interleaved_coords<double>( vseq, offset, count, coords );
     coords=&coords[ 3*count ];
   }
 
@@ -964,6 +1041,15 @@ ErrorCode Core::get_coords( const Range& entities,
       first = vseq->end_handle()+1;
     }
 
+    if (vseq->single_precision()) {
+      float const *x, *y, *z;
+      vseq->get_coordinate_arrays( x, y, z );
+      copy_blocked_coords( x + offset, count, x_coords );
+      copy_blocked_coords( y + offset, count, y_coords );
+      copy_blocked_coords( z + offset, count, z_coords );
+      continue;
+    }
+
     double const *x, *y, *z;
     ErrorCode rval = vseq->get_coordinate_arrays( x, y, z );
     if (MB_SUCCESS != rval)
@@ -1005,6 +1091,9 @@ ErrorCode  Core::get_coords(const EntityHandle* entities,
   const EntityHandle* const end = entities + num_entities;
   const EntityHandle* iter = entities;
   ErrorCode status = MB_SUCCESS;
+    // not static: may be called concurrently in a read-only phase
+  std::vector<EntityHandle> dum_conn;
+  std::vector<double> dum_pos;
 
   while (iter != end) {
     if (TYPE_FROM_HANDLE(*iter) == MBVERTEX) {
@@ -1021,12 +1110,11 @@ ErrorCode  Core::get_coords(const EntityHandle* entities,
       vseq->get_coordinates( *iter, coords );
     }
     else {
-      static std::vector<EntityHandle> dum_conn(CN::MAX_NODES_PER_ELEMENT);
-      static std::vector<double> dum_pos(3*CN::MAX_NODES_PER_ELEMENT);
-      static const EntityHandle *conn;
-      static int num_conn;
+      const EntityHandle *conn;
+      int num_conn;
       status = get_connectivity(*iter, conn, num_conn, false, &dum_conn);
       if (MB_SUCCESS != status) return status;
+      dum_pos.resize(3*num_conn);
       status = get_coords(conn, num_conn, &dum_pos[0]);
       if (MB_SUCCESS != status) return status;
       coords[0] = coords[1] = coords[2] = 0.0;
@@ -1447,6 +1535,10 @@ ErrorCode Core::get_adjacencies( const EntityHandle *from_entities,
                                      std::vector<EntityHandle> &adj_entities,
                                      const int operation_type )
 {
+  ErrorCode rval = aEntityFactory->enforce_memory_budget( from_entities, num_entities );
+  if (MB_SUCCESS != rval)
+    return rval;
+
   if (operation_type == Interface::INTERSECT)
     return get_adjacencies_intersection( this, from_entities, from_entities+num_entities,
                                          to_dimension, create_if_missing, adj_entities );
@@ -1486,6 +1578,10 @@ ErrorCode Core::get_adjacencies( const EntityHandle *from_entities,
                                      Range &adj_entities,
                                      const int operation_type )
 {
+  ErrorCode rval = aEntityFactory->enforce_memory_budget( from_entities, num_entities );
+  if (MB_SUCCESS != rval)
+    return rval;
+
   if (operation_type == Interface::INTERSECT)
     return get_adjacencies_intersection( this, from_entities, from_entities + num_entities,
                                          to_dimension, create_if_missing, adj_entities );
@@ -1582,7 +1678,7 @@ ErrorCode Core::connect_iterate(Range::const_iterator iter,
 
   connect += eseq->nodes_per_element() * (*iter - eseq->start_handle());
 
-  EntityHandle real_end = *(iter.end_of_block());
+  EntityHandle real_end = std::min(eseq->end_handle(), *(iter.end_of_block()));
   if (*end) real_end = std::min(real_end, *end);
   count = real_end - *iter + 1;
 
@@ -1623,6 +1719,10 @@ ErrorCode Core::get_adjacencies(const Range &from_entities,
                                       Range &adj_entities,
                                       const int operation_type)
 {
+  ErrorCode rval = aEntityFactory->enforce_memory_budget( from_entities );
+  if (MB_SUCCESS != rval)
+    return rval;
+
   if (operation_type == Interface::INTERSECT)
     return get_adjacencies_intersection( this, from_entities.begin(), from_entities.end(),
                                          to_dimension, create_if_missing, adj_entities );
@@ -1706,6 +1806,27 @@ ErrorCode Core::adjacencies_iterate(Range::const_iterator iter,
   if (MB_SUCCESS != rval)
     return rval;
 
+    // adjacencies of structured vertices to their structured elements
+    // are computed, not stored, so the lists would be incomplete
+  if (MBVERTEX == type) {
+    const ScdVertexData* vdata = dynamic_cast<const ScdVertexData*>(seq->data());
+    if (vdata && !vdata->element_data().empty())
+      return MB_NOT_IMPLEMENTED;
+  }
+
+    // compacted vertex adjacencies aren't stored as vectors
+  if (MBVERTEX == type && aEntityFactory->vert_elem_adjacencies_compact()) {
+    rval = aEntityFactory->expand_vert_elem_adjacencies();
+    if (MB_SUCCESS != rval)
+      return rval;
+  }
+    // nor are those released to stay within the memory budget
+  if (MBVERTEX == type && aEntityFactory->memory_budget()) {
+    rval = aEntityFactory->restore_vert_elem_adjacencies();
+    if (MB_SUCCESS != rval)
+      return rval;
+  }
+
   adjs_ptr = const_cast<const std::vector<EntityHandle>**>(seq->data()->get_adjacency_data());
   if (!adjs_ptr)
     return rval;
@@ -1714,6 +1835,8 @@ ErrorCode Core::adjacencies_iterate(Range::const_iterator iter,
 
   EntityHandle real_end = *(iter.end_of_block());
   if (*end) real_end = std::min(real_end, *end);
+    // adjacency data is per SequenceData
+  real_end = std::min(real_end, seq->data()->end_handle());
   count = real_end - *iter + 1;
 
   return MB_SUCCESS;
@@ -1853,6 +1976,12 @@ ErrorCode Core::get_entities_by_type_and_tag(const EntityHandle meshset,
       // get the entities with this tag/value combo
     if (NULL == values || NULL == values[it])
       result = tags[it]->get_tagged_entities( sequenceManager, tmp_range, type, &range );
+    else if (tags[it]->value_index() && tags[it]->value_index()->valid() 
+          && !tags[it]->equals_default_value( values[it] )) {
+      Range indexed;
+      tags[it]->value_index()->find( values[it], indexed, type );
+      tmp_range = intersect( indexed, range );
+    }
     else {
       result = tags[it]->find_entities_with_value( sequenceManager, mError, tmp_range, values[it], 0, type, &range );
         // if there is a default value, then we should return all entities
@@ -1990,6 +2119,26 @@ ErrorCode Core::get_number_entities_by_type_and_tag(const EntityHandle meshset,
                                                           int condition,
                                                           const bool recursive) const
 {
+    // count values of a single bit tag without building the entity list
+  if (1 == num_tags && values && values[0] && valid_tag_handle( tag_handles[0] ) &&
+      MB_TAG_BIT == tag_handles[0]->get_storage_type()) {
+    Range range;
+    ErrorCode result = get_entities_by_type( meshset, type, range, recursive );
+    if (MB_SUCCESS != result)
+      return result;
+    const BitTag* tag = static_cast<const BitTag*>(tag_handles[0]);
+    const unsigned char bits = *reinterpret_cast<const unsigned char*>(values[0]);
+    size_t count, tagged = 0;
+    tag->count_entities_with_bits( range, type, count, bits );
+      // untagged entities have the default value
+    if (tag->equals_default_value( values[0] )) {
+      tag->num_tagged_entities( sequenceManager, tagged, type, &range );
+      count += range.size() - tagged;
+    }
+    num_entities = count;
+    return MB_SUCCESS;
+  }
+
   Range dum_ents;
   ErrorCode result = get_entities_by_type_and_tag(meshset, type, tag_handles, values, num_tags,
                                                      dum_ents, condition, recursive);
@@ -2055,7 +2204,13 @@ ErrorCode  Core::tag_set_data( Tag tag_handle,
 {
   assert(valid_tag_handle( tag_handle ));
   CHECK_MESH_NULL
-  return tag_handle->set_data( sequenceManager, mError, entity_handles, num_entities, tag_data );
+  TagValueIndex* index = tag_handle->value_index();
+  if (index)
+    index->remove( sequenceManager, entity_handles, num_entities );
+  ErrorCode result = tag_handle->set_data( sequenceManager, mError, entity_handles, num_entities, tag_data );
+  if (index)
+    index->add( sequenceManager, entity_handles, num_entities );
+  return result;
 }
 
 //! set the data  for given EntityHandles and Tag
@@ -2064,7 +2219,13 @@ ErrorCode  Core::tag_set_data( Tag tag_handle,
                                const void *tag_data)
 {
   assert(valid_tag_handle( tag_handle ));
-  return tag_handle->set_data( sequenceManager, mError, entity_handles, tag_data );
+  TagValueIndex* index = tag_handle->value_index();
+  if (index)
+    index->remove( sequenceManager, entity_handles );
+  ErrorCode result = tag_handle->set_data( sequenceManager, mError, entity_handles, tag_data );
+  if (index)
+    index->add( sequenceManager, entity_handles );
+  return result;
 }
 
 
@@ -2119,7 +2280,13 @@ ErrorCode  Core::tag_set_by_ptr( Tag tag_handle,
       tmp_sizes[i] = tag_sizes[i] * typesize;
     tag_sizes = &tmp_sizes[0];
   }
-  return tag_handle->set_data( sequenceManager, mError, entity_handles, num_entities, tag_data, tag_sizes );
+  TagValueIndex* index = tag_handle->value_index();
+  if (index)
+    index->remove( sequenceManager, entity_handles, num_entities );
+  ErrorCode result = tag_handle->set_data( sequenceManager, mError, entity_handles, num_entities, tag_data, tag_sizes );
+  if (index)
+    index->add( sequenceManager, entity_handles, num_entities );
+  return result;
 }
 
 //! set the data  for given EntityHandles and Tag
@@ -2138,7 +2305,90 @@ ErrorCode  Core::tag_set_by_ptr( Tag tag_handle,
       tmp_sizes[i] = tag_sizes[i] * typesize;
     tag_sizes = &tmp_sizes[0];
   }
-  return tag_handle->set_data(sequenceManager, mError, entity_handles, tag_data, tag_sizes);
+  TagValueIndex* index = tag_handle->value_index();
+  if (index)
+    index->remove( sequenceManager, entity_handles );
+  ErrorCode result = tag_handle->set_data(sequenceManager, mError, entity_handles, tag_data, tag_sizes);
+  if (index)
+    index->add( sequenceManager, entity_handles );
+  return result;
+}
+
+  // convert offsets into packed tag data to pointers and byte lengths,
+  // checking that the offsets describe consecutive values in the buffer
+static ErrorCode packed_to_pointers( TagInfo* tag, 
+                                     Error* error,
+                                     size_t num_entities,
+                                     const void* tag_data,
+                                     const int* offsets,
+                                     std::vector<const void*>& pointers,
+                                     std::vector<int>& lengths )
+{
+  if (offsets[0] < 0) {
+    error->set_last_error( "Negative offset into packed data for tag %s", tag->get_name().c_str() );
+    return MB_INDEX_OUT_OF_RANGE;
+  }
+  const int typesize = TagInfo::size_from_data_type( tag->get_data_type() );
+  const unsigned char* data = reinterpret_cast<const unsigned char*>(tag_data);
+  pointers.resize( num_entities );
+  lengths.resize( num_entities );
+  for (size_t i = 0; i < num_entities; ++i) {
+    if (offsets[i+1] < offsets[i]) {
+      error->set_last_error( "Decreasing offsets into packed data for tag %s at value %lu",
+                             tag->get_name().c_str(), (unsigned long)i );
+      return MB_INDEX_OUT_OF_RANGE;
+    }
+    pointers[i] = data + (size_t)offsets[i] * typesize;
+    lengths[i] = (offsets[i+1] - offsets[i]) * typesize;
+  }
+  return MB_SUCCESS;
+}
+
+//! set the data  for given EntityHandles and Tag
+ErrorCode  Core::tag_set_packed_data( Tag tag_handle,
+                                      const EntityHandle* entity_handles,
+                                      int num_entities,
+                                      const void* tag_data,
+                                      const int* offsets )
+{
+  assert(valid_tag_handle( tag_handle ));
+  if (!num_entities)
+    return MB_SUCCESS;
+  std::vector<const void*> pointers;
+  std::vector<int> lengths;
+  ErrorCode result = packed_to_pointers( tag_handle, mError, num_entities, tag_data, offsets, pointers, lengths );
+  if (MB_SUCCESS != result)
+    return result;
+  TagValueIndex* index = tag_handle->value_index();
+  if (index)
+    index->remove( sequenceManager, entity_handles, num_entities );
+  result = tag_handle->set_data( sequenceManager, mError, entity_handles, num_entities, &pointers[0], &lengths[0] );
+  if (index)
+    index->add( sequenceManager, entity_handles, num_entities );
+  return result;
+}
+
+//! set the data  for given EntityHandles and Tag
+ErrorCode  Core::tag_set_packed_data( Tag tag_handle,
+                                      const Range& entity_handles,
+                                      const void* tag_data,
+                                      const int* offsets )
+{
+  assert(valid_tag_handle( tag_handle ));
+  if (entity_handles.empty())
+    return MB_SUCCESS;
+  std::vector<const void*> pointers;
+  std::vector<int> lengths;
+  ErrorCode result = packed_to_pointers( tag_handle, mError, entity_handles.size(), tag_data, offsets, pointers, lengths );
+  if (MB_SUCCESS != result)
+    return result;
+  TagValueIndex* index = tag_handle->value_index();
+  if (index)
+    index->remove( sequenceManager, entity_handles );
+  result = tag_handle->set_data( sequenceManager, mError, entity_handles, &pointers[0], &lengths[0] );
+  if (index)
+    index->add( sequenceManager, entity_handles );
+  return result;
 }
 
 //! set the data  for given EntityHandles and Tag
@@ -2150,8 +2400,14 @@ ErrorCode  Core::tag_clear_data( Tag tag_handle,
 {
   assert(valid_tag_handle( tag_handle ));
   CHECK_MESH_NULL
-  return tag_handle->clear_data( sequenceManager, mError, entity_handles, num_entities, tag_data,
+  TagValueIndex* index = tag_handle->value_index();
+  if (index)
+    index->remove( sequenceManager, entity_handles, num_entities );
+  ErrorCode result = tag_handle->clear_data( sequenceManager, mError, entity_handles, num_entities, tag_data,
                                  tag_size * TagInfo::size_from_data_type( tag_handle->get_data_type() ) );
+  if (index)
+    index->add( sequenceManager, entity_handles, num_entities );
+  return result;
 }
 
 //! set the data  for given EntityHandles and Tag
@@ -2161,8 +2417,14 @@ ErrorCode  Core::tag_clear_data( Tag tag_handle,
                                  int tag_size )
 {
   assert(valid_tag_handle( tag_handle ));
-  return tag_handle->clear_data( sequenceManager, mError, entity_handles, tag_data,
+  TagValueIndex* index = tag_handle->value_index();
+  if (index)
+    index->remove( sequenceManager, entity_handles );
+  ErrorCode result = tag_handle->clear_data( sequenceManager, mError, entity_handles, tag_data,
                                  tag_size * TagInfo::size_from_data_type( tag_handle->get_data_type() ) );
+  if (index)
+    index->add( sequenceManager, entity_handles );
+  return result;
 }
 
 static bool is_zero_bytes( const void* mem, size_t size )
@@ -2355,6 +2617,9 @@ ErrorCode  Core::tag_delete_data( Tag tag_handle,
 {
   assert(valid_tag_handle( tag_handle ));
   CHECK_MESH_NULL
+  TagValueIndex* index = tag_handle->value_index();
+  if (index)
+    index->remove( sequenceManager, entity_handles, num_entities );
   return tag_handle->remove_data( sequenceManager, mError, entity_handles, num_entities );
 }
 
@@ -2363,6 +2628,9 @@ ErrorCode  Core::tag_delete_data( Tag tag_handle,
                                   const Range &entity_handles )
 {
   assert(valid_tag_handle( tag_handle ));
+  TagValueIndex* index = tag_handle->value_index();
+  if (index)
+    index->remove( sequenceManager, entity_handles );
   return tag_handle->remove_data( sequenceManager, mError, entity_handles );
 }
 
@@ -2382,6 +2650,25 @@ ErrorCode Core::tag_delete(Tag tag_handle)
   return MB_SUCCESS;
 }
 
+ErrorCode Core::tag_set_value_index( Tag tag_handle, bool enable )
+{
+  if (!valid_tag_handle( tag_handle ))
+    return MB_TAG_NOT_FOUND;
+  ErrorCode rval = tag_handle->set_value_index( enable );
+  if (MB_SUCCESS == rval && enable)
+    tag_handle->value_index()->rebuild( sequenceManager );
+  return rval;
+}
+
+ErrorCode Core::tag_get_memory_counter( Tag tag_handle, 
+                                        const MemoryCounter*& counter_out )
+{
+  if (!valid_tag_handle( tag_handle ))
+    return MB_TAG_NOT_FOUND;
+  counter_out = tag_handle->memory_counter();
+  return MB_SUCCESS;
+}
+
 ErrorCode Core::tag_iterate( Tag tag_handle,
                              Range::const_iterator iter,
                              Range::const_iterator end,
@@ -2391,6 +2678,10 @@ ErrorCode Core::tag_iterate( Tag tag_handle,
 {
   Range::const_iterator init = iter;
   assert(valid_tag_handle( tag_handle ));
+    // values may be changed through returned pointer, except
+    // during a read-only phase
+  if (tag_handle->value_index() && !is_read_only_phase())
+    tag_handle->value_index()->invalidate();
   ErrorCode result = tag_handle->tag_iterate( sequenceManager, mError, iter, end, data_ptr,
                                               allocate);
   if (MB_SUCCESS == result)
@@ -2582,6 +2873,26 @@ ErrorCode Core::create_vertex(const double coords[3], EntityHandle &handle )
   return sequence_manager()->create_vertex( coords, handle );
 }
 
+  // Create vertices with coordinates stored as T and copy 
+  // interleaved coordinates into them
+template <typename T> static
+ErrorCode create_vertices_as( ReadUtilIface* read_iface,
+                              const double* coordinates,
+                              const int nverts,
+                              EntityHandle& start_handle_out )
+{
+  std::vector<T*> arrays;
+  ErrorCode result = read_iface->get_node_coords( 3, nverts, MB_START_ID,
+                                                  start_handle_out, arrays);
+  if (MB_SUCCESS != result) return result;
+  for (int i = 0; i < nverts; i++) {
+    arrays[0][i] = coordinates[3*i];
+    arrays[1][i] = coordinates[3*i+1];
+    arrays[2][i] = coordinates[3*i+2];
+  }
+  return MB_SUCCESS;
+}
+
 ErrorCode Core::create_vertices(const double *coordinates,
                                     const int nverts,
                                     Range &entity_handles )
@@ -2591,17 +2902,13 @@ ErrorCode Core::create_vertices(const double *coordinates,
   ErrorCode result = Interface::query_interface(read_iface);
   if (MB_SUCCESS != result) return MB_FAILURE;
 
-  std::vector<double*> arrays;
   EntityHandle start_handle_out = 0;
-  result = read_iface->get_node_coords( 3, nverts, MB_START_ID,
-                                        start_handle_out, arrays);
+  if (sequenceManager->float_coordinates())
+    result = create_vertices_as<float>( read_iface, coordinates, nverts, start_handle_out );
+  else
+    result = create_vertices_as<double>( read_iface, coordinates, nverts, start_handle_out );
   Interface::release_interface(read_iface);
   if (MB_SUCCESS != result) return result;
-  for (int i = 0; i < nverts; i++) {
-    arrays[0][i] = coordinates[3*i];
-    arrays[1][i] = coordinates[3*i+1];
-    arrays[2][i] = coordinates[3*i+2];
-  }
 
   entity_handles.clear();
   entity_handles.insert(start_handle_out, start_handle_out+nverts-1);
@@ -2675,46 +2982,49 @@ ErrorCode Core::delete_entities(const Range &range)
   ErrorCode result = MB_SUCCESS, temp_result;
   Range failed_ents;
 
+    // tell AEntityFactory that these entities are going away; those
+    // that cannot be deleted are left unchanged
+  temp_result = aEntityFactory->notify_delete_entities(range, failed_ents);
+  if (MB_SUCCESS != temp_result)
+    result = temp_result;
+  Range dum_range;
+  if (!failed_ents.empty())
+    dum_range = subtract(range, failed_ents);
+  const Range& deleted = failed_ents.empty() ? range : dum_range;
+
   for (std::list<TagInfo*>::iterator i = tagList.begin(); i != tagList.end(); ++i) {
-    temp_result = (*i)->remove_data( sequenceManager, mError, range );
+    if ((*i)->value_index())
+      (*i)->value_index()->remove( sequenceManager, deleted );
+    temp_result = (*i)->remove_data( sequenceManager, mError, deleted );
       // ok if the error is tag_not_found, some ents may not have every tag on them
     if (MB_SUCCESS != temp_result && MB_TAG_NOT_FOUND != temp_result)
       result = temp_result;
   }
 
-  for (Range::const_reverse_iterator rit = range.rbegin(); rit != range.rend(); rit++) {
-
-      // tell AEntityFactory that this element is going away
-    temp_result = aEntityFactory->notify_delete_entity(*rit);
-    if (MB_SUCCESS != temp_result) {
-      result = temp_result;
-      failed_ents.insert(*rit);
-      continue;
-    }
-
-    if (TYPE_FROM_HANDLE(*rit) == MBENTITYSET) {
-      if (MeshSet* ptr = get_mesh_set( sequence_manager(), *rit )) {
-        int j, count;
-        const EntityHandle* rel;
-        ptr->clear( *rit, a_entity_factory() );
-        rel = ptr->get_parents( count );
-        for (j = 0; j < count; ++j)
-          remove_child_meshset( rel[j], *rit );
-        rel = ptr->get_children( count );
-        for (j = 0; j < count; ++j)
-          remove_parent_meshset( rel[j], *rit );
-      }
+  for (Range::const_reverse_iterator rit = deleted.rbegin(); 
+       rit != deleted.rend() && TYPE_FROM_HANDLE(*rit) == MBENTITYSET; rit++) {
+    if (MeshSet* ptr = get_mesh_set( sequence_manager(), *rit )) {
+      int j, count;
+      const EntityHandle* rel;
+      rel = ptr->get_parents( count );
+      for (j = 0; j < count; ++j)
+        remove_child_meshset( rel[j], *rit );
+      rel = ptr->get_children( count );
+      for (j = 0; j < count; ++j)
+        remove_parent_meshset( rel[j], *rit );
+      ptr->clear_all( *rit, a_entity_factory(), sequenceManager->set_list_pool() );
     }
   }
 
-  if (!failed_ents.empty()) {
-    Range dum_range = subtract(range, failed_ents);
+  if (!failed_ents.empty())
       // don't test for success, since we'll return failure in this case
-    sequence_manager()->delete_entities(mError,dum_range);
-  }
-  else
+    sequence_manager()->delete_entities(mError,deleted);
+  else {
       // now delete the entities
-    result = sequence_manager()->delete_entities(mError,range);
+    temp_result = sequence_manager()->delete_entities(mError,range);
+    if (MB_SUCCESS != temp_result)
+      result = temp_result;
+  }
 
   return result;
 }
@@ -2728,6 +3038,8 @@ ErrorCode Core::delete_entities(const EntityHandle *entities,
   Range failed_ents;
 
   for (std::list<TagInfo*>::iterator i = tagList.begin(); i != tagList.end(); ++i) {
+    if ((*i)->value_index())
+      (*i)->value_index()->remove( sequenceManager, entities, num_entities );
     temp_result = (*i)->remove_data( sequenceManager, mError, entities, num_entities);
       // ok if the error is tag_not_found, some ents may not have every tag on them
     if (MB_SUCCESS != temp_result && MB_TAG_NOT_FOUND != temp_result)
@@ -2748,13 +3060,13 @@ ErrorCode Core::delete_entities(const EntityHandle *entities,
       if (MeshSet* ptr = get_mesh_set( sequence_manager(), entities[i] )) {
         int j, count;
         const EntityHandle* rel;
-        ptr->clear( entities[i], a_entity_factory() );
         rel = ptr->get_parents( count );
         for (j = 0; j < count; ++j)
           remove_child_meshset( rel[j], entities[i] );
         rel = ptr->get_children( count );
         for (j = 0; j < count; ++j)
           remove_parent_meshset( rel[j], entities[i] );
+        ptr->clear_all( entities[i], a_entity_factory(), sequenceManager->set_list_pool() );
       }
     }
 
@@ -2931,9 +3243,9 @@ ErrorCode Core::side_number(const EntityHandle parent,
     // get the connectivity of parent and child
   const EntityHandle *parent_conn, *child_conn;
   int num_parent_vertices, num_child_vertices;
+  std::vector<EntityHandle> tmp_connect;
   ErrorCode result = get_connectivity(parent, parent_conn, num_parent_vertices, true);
   if (MB_NOT_IMPLEMENTED == result) {
-    static std::vector<EntityHandle> tmp_connect(CN::MAX_NODES_PER_ELEMENT);
     result = get_connectivity(parent, parent_conn, num_parent_vertices, true, &tmp_connect);
   }
   if (MB_SUCCESS != result) return result;
@@ -3179,7 +3491,8 @@ ErrorCode Core::set_meshset_options( const EntityHandle ms_handle,
   if (!set)
     return MB_ENTITY_NOT_FOUND;
 
-  return set->set_flags(options, ms_handle, a_entity_factory());
+  return set->set_flags(options, ms_handle, a_entity_factory(),
+                        sequenceManager->set_list_pool());
 }
 
 
@@ -3190,7 +3503,8 @@ ErrorCode Core::clear_meshset( const EntityHandle *ms_handles,
   for (int i = 0; i < num_meshsets; ++i) {
     MeshSet* set = get_mesh_set( sequence_manager(), ms_handles[i]);
     if (set)
-      set->clear(ms_handles[i], a_entity_factory());
+      set->clear(ms_handles[i], a_entity_factory(),
+                 sequenceManager->set_list_pool());
     else
       result = MB_ENTITY_NOT_FOUND;
   }
@@ -3204,7 +3518,8 @@ ErrorCode Core::clear_meshset(const Range &ms_handles)
   for (Range::iterator i = ms_handles.begin(); i != ms_handles.end(); ++i) {
     MeshSet* set = get_mesh_set( sequence_manager(), *i);
     if (set)
-      set->clear(*i, a_entity_factory());
+      set->clear(*i, a_entity_factory(),
+                 sequenceManager->set_list_pool());
     else
       result = MB_ENTITY_NOT_FOUND;
   }
@@ -3219,7 +3534,8 @@ ErrorCode Core::subtract_meshset(EntityHandle meshset1, const EntityHandle meshs
   if (!set1 || !set2)
     return MB_ENTITY_NOT_FOUND;
 
-  return set1->subtract( set2, meshset1, a_entity_factory() );
+  return set1->subtract( set2, meshset1, a_entity_factory(),
+                         sequenceManager->set_list_pool() );
 }
 
 
@@ -3230,7 +3546,8 @@ ErrorCode Core::intersect_meshset(EntityHandle meshset1, const EntityHandle mesh
   if (!set1 || !set2)
     return MB_ENTITY_NOT_FOUND;
 
-  return set1->intersect( set2, meshset1, a_entity_factory() );
+  return set1->intersect( set2, meshset1, a_entity_factory(),
+                          sequenceManager->set_list_pool() );
 }
 
 ErrorCode Core::unite_meshset(EntityHandle meshset1, const EntityHandle meshset2)
@@ -3240,7 +3557,8 @@ ErrorCode Core::unite_meshset(EntityHandle meshset1, const EntityHandle meshset2
   if (!set1 || !set2)
     return MB_ENTITY_NOT_FOUND;
 
-  return set1->unite( set2, meshset1, a_entity_factory() );
+  return set1->unite( set2, meshset1, a_entity_factory(),
+                      sequenceManager->set_list_pool() );
 }
 
 ErrorCode Core::add_entities(EntityHandle meshset,
@@ -3248,7 +3566,8 @@ ErrorCode Core::add_entities(EntityHandle meshset,
 {
   MeshSet* set = get_mesh_set( sequence_manager(), meshset );
   if (set)
-    return set->add_entities( entities, meshset, a_entity_factory() );
+    return set->add_entities( entities, meshset, a_entity_factory(),
+                              sequenceManager->set_list_pool() );
   else
     return MB_ENTITY_NOT_FOUND;
 }
@@ -3259,7 +3578,8 @@ ErrorCode Core::add_entities(EntityHandle meshset,
 {
   MeshSet* set = get_mesh_set( sequence_manager(), meshset );
   if (set)
-    return set->add_entities( entities, num_entities, meshset, a_entity_factory() );
+    return set->add_entities( entities, num_entities, meshset, a_entity_factory(),
+                              sequenceManager->set_list_pool() );
   else
     return MB_ENTITY_NOT_FOUND;
 }
@@ -3271,7 +3591,8 @@ ErrorCode Core::remove_entities(EntityHandle meshset,
 {
   MeshSet* set = get_mesh_set( sequence_manager(), meshset );
   if (set)
-    return set->remove_entities( entities, meshset, a_entity_factory() );
+    return set->remove_entities( entities, meshset, a_entity_factory(),
+                                 sequenceManager->set_list_pool() );
   else
     return MB_ENTITY_NOT_FOUND;
 }
@@ -3283,7 +3604,8 @@ ErrorCode Core::remove_entities( EntityHandle meshset,
 {
   MeshSet* set = get_mesh_set( sequence_manager(), meshset );
   if (set)
-    return set->remove_entities( entities, num_entities, meshset, a_entity_factory() );
+    return set->remove_entities( entities, num_entities, meshset, a_entity_factory(),
+                                 sequenceManager->set_list_pool() );
   else
     return MB_ENTITY_NOT_FOUND;
 }
@@ -3311,7 +3633,8 @@ ErrorCode Core::replace_entities(EntityHandle meshset,
   MeshSet* set = get_mesh_set( sequence_manager(), meshset );
   if (set)
     return set->replace_entities( meshset, old_entities, new_entities,
-                                  num_entities, a_entity_factory());
+                                  num_entities, a_entity_factory(),
+                                  sequenceManager->set_list_pool());
   else
     return MB_ENTITY_NOT_FOUND;
 }
@@ -3460,7 +3783,7 @@ ErrorCode Core::add_parent_meshset( EntityHandle meshset,
   if (!set_ptr || !parent_ptr)
     return MB_ENTITY_NOT_FOUND;
 
-  set_ptr->add_parent( parent_meshset );
+  set_ptr->add_parent( parent_meshset, sequenceManager->set_list_pool() );
   return MB_SUCCESS;
 }
 
@@ -3477,7 +3800,7 @@ ErrorCode Core::add_parent_meshsets( EntityHandle meshset,
       return MB_ENTITY_NOT_FOUND;
 
   for (int i = 0; i < count; ++i)
-    set_ptr->add_parent( parents[i] );
+    set_ptr->add_parent( parents[i], sequenceManager->set_list_pool() );
   return MB_SUCCESS;
 }
 
@@ -3489,7 +3812,7 @@ ErrorCode Core::add_child_meshset(EntityHandle meshset,
   if (!set_ptr || !child_ptr)
     return MB_ENTITY_NOT_FOUND;
 
-  set_ptr->add_child( child_meshset );
+  set_ptr->add_child( child_meshset, sequenceManager->set_list_pool() );
   return MB_SUCCESS;
 }
 
@@ -3506,7 +3829,7 @@ ErrorCode Core::add_child_meshsets( EntityHandle meshset,
       return MB_ENTITY_NOT_FOUND;
 
   for (int i = 0; i < count; ++i)
-    set_ptr->add_child( children[i] );
+    set_ptr->add_child( children[i], sequenceManager->set_list_pool() );
   return MB_SUCCESS;
 }
 
@@ -3519,8 +3842,8 @@ ErrorCode Core::add_parent_child(EntityHandle parent,
   if (!parent_ptr || !child_ptr)
     return MB_ENTITY_NOT_FOUND;
 
-  parent_ptr->add_child( child );
-  child_ptr->add_parent( parent );
+  parent_ptr->add_child( child, sequenceManager->set_list_pool() );
+  child_ptr->add_parent( parent, sequenceManager->set_list_pool() );
   return MB_SUCCESS;
 }
 
@@ -3532,8 +3855,8 @@ ErrorCode Core::remove_parent_child(EntityHandle parent,
   if (!parent_ptr || !child_ptr)
     return MB_ENTITY_NOT_FOUND;
 
-  parent_ptr->remove_child( child );
-  child_ptr->remove_parent( parent );
+  parent_ptr->remove_child( child, sequenceManager->set_list_pool() );
+  child_ptr->remove_parent( parent, sequenceManager->set_list_pool() );
   return MB_SUCCESS;
 }
 
@@ -3544,7 +3867,7 @@ ErrorCode Core::remove_parent_meshset(EntityHandle meshset,
   MeshSet* set_ptr = get_mesh_set( sequence_manager(), meshset );
   if (!set_ptr)
     return MB_ENTITY_NOT_FOUND;
-  set_ptr->remove_parent( parent_meshset );
+  set_ptr->remove_parent( parent_meshset, sequenceManager->set_list_pool() );
   return MB_SUCCESS;
 }
 
@@ -3554,7 +3877,7 @@ ErrorCode Core::remove_child_meshset(EntityHandle meshset,
   MeshSet* set_ptr = get_mesh_set( sequence_manager(), meshset );
   if (!set_ptr)
     return MB_ENTITY_NOT_FOUND;
-  set_ptr->remove_child( child_meshset );
+  set_ptr->remove_child( child_meshset, sequenceManager->set_list_pool() );
   return MB_SUCCESS;
 }
 
@@ -3789,6 +4112,46 @@ ErrorCode Core::check_adjacencies(const EntityHandle *ents, int num_ents)
   return result;
 }
 
+void Core::set_float_coordinates( bool enable )
+{
+  sequenceManager->set_float_coordinates( enable );
+}
+
+bool Core::float_coordinates() const
+{
+  return sequenceManager->float_coordinates();
+}
+
+ErrorCode Core::compact_vert_elem_adjacencies()
+{
+  return aEntityFactory->compact_vert_elem_adjacencies();
+}
+
+void Core::set_adjacency_threads( unsigned num_threads )
+{
+  aEntityFactory->set_num_threads( num_threads );
+}
+
+unsigned Core::adjacency_threads() const
+{
+  return aEntityFactory->num_threads();
+}
+
+ErrorCode Core::set_adjacency_memory_budget( size_t bytes )
+{
+  return aEntityFactory->set_memory_budget( bytes );
+}
+
+size_t Core::adjacency_memory_budget() const
+{
+  return aEntityFactory->memory_budget();
+}
+
+size_t Core::adjacency_memory_use() const
+{
+  return aEntityFactory->memory_use();
+}
+
 bool Core::is_valid(const EntityHandle this_ent) const
 {
   const EntitySequence* seq = 0;
@@ -3850,6 +4213,39 @@ ErrorCode Core::get_set_iterators(EntityHandle meshset,
   return MB_SUCCESS;
 }
 
+ErrorCode Core::begin_read_only_phase( bool create_vert_elem_adjacencies )
+{
+  if (is_read_only_phase())
+    return MB_SUCCESS;
+
+    // anything that would be lazily created by a query must
+    // be created now, while there is only one thread
+  if (create_vert_elem_adjacencies && !aEntityFactory->vert_elem_adjacencies()) {
+    ErrorCode rval = aEntityFactory->create_vert_elem_adjacencies();
+    if (MB_SUCCESS != rval)
+      return rval;
+  }
+  ErrorCode rval = aEntityFactory->restore_vert_elem_adjacencies();
+  if (MB_SUCCESS != rval)
+    return rval;
+
+  sequenceManager->set_read_only_phase( true );
+  mError->set_read_only( true );
+  return MB_SUCCESS;
+}
+
+ErrorCode Core::end_read_only_phase()
+{
+  sequenceManager->set_read_only_phase( false );
+  mError->set_read_only( false );
+  return MB_SUCCESS;
+}
+
+bool Core::is_read_only_phase() const
+{
+  return sequenceManager->read_only_phase();
+}
+
 void Core::estimated_memory_use_internal( const Range* ents,
                                   unsigned long* total_storage,
                                   unsigned long* total_amortized_storage,
@@ -4064,6 +4460,7 @@ void Core::print_database() const
            "  ---------- -------- -------- -------- -----------...\n");
   const EntityHandle* adj;
   int nadj;
+  std::vector<EntityHandle> adj_storage;
   for (i = verts.begin(); i != verts.end(); ++i) {
     const VertexSequence* seq = static_cast<const VertexSequence* >(*i);
     printf("(Sequence [%d,%d] in SequenceData [%d,%d])\n",
@@ -4080,7 +4477,7 @@ void Core::print_database() const
       else
         printf("  %10d <       ERROR %4d       >", (int)ID_FROM_HANDLE(h), (int)rval );
 
-      rval = a_entity_factory()->get_adjacencies( h, adj, nadj );
+      rval = a_entity_factory()->get_adjacencies( h, adj, nadj, adj_storage );
       if (MB_SUCCESS != rval) {
         printf(" <ERROR %d>\n", (int)rval );
         continue;
@@ -166,7 +166,8 @@ ErrorCode DenseTag::get_array( SequenceManager* seqman,
   
   void* mem = seq->data()->get_tag_data( mySequenceArray );
   if (!mem && allocate) {
-    mem = seq->data()->allocate_tag_array( mySequenceArray, get_size(), get_default_value() );
+    mem = seq->data()->allocate_tag_array( mySequenceArray, get_size(), 
+                                           memory_counter(), get_default_value() );
     if (!mem) {
       error->set_last_error("Memory allocation failed for tag data");
       return MB_MEMORY_ALLOCATION_FAILED;
@@ -0,0 +1,158 @@
+#include "moab/MemoryCounter.hpp"
+#include "moab/Types.hpp"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+namespace moab {
+
+MemoryCounter& MemoryCounter::category( MemoryCategory cat )
+{
+    // local static so that counters are initialized before 
+    // first use by static objects in other translation units
+  static MemoryCounter counters[MEM_NUM_CATEGORIES];
+  assert( cat >= 0 && cat < MEM_NUM_CATEGORIES );
+  return counters[cat];
+}
+
+const char* MemoryCounter::category_name( MemoryCategory cat )
+{
+  static const char* const names[] = { "Sequences",
+                                       "Connectivity",
+                                       "Adjacencies",
+                                       "Tags",
+                                       "Sets",
+                                       "Ranges" };
+  return cat >= 0 && cat < MEM_NUM_CATEGORIES ? names[cat] : 0;
+}
+
+void MemoryCounter::reset_all_peaks()
+{
+  for (int i = 0; i < MEM_NUM_CATEGORIES; ++i)
+    category( (MemoryCategory)i ).reset_peak();
+}
+
+void MemoryCounter::add( size_t bytes, size_t count )
+{
+#ifdef MOAB_HAVE_PTHREAD
+  __sync_fetch_and_add( &numAllocs, count );
+  const size_t total = __sync_add_and_fetch( &numBytes, bytes );
+  size_t peak = peakBytes;
+  while (total > peak) {
+    const size_t prev = __sync_val_compare_and_swap( &peakBytes, peak, total );
+    if (prev == peak)
+      break;
+    peak = prev;
+  }
+#else
+  numAllocs += count;
+  numBytes += bytes;
+  if (numBytes > peakBytes)
+    peakBytes = numBytes;
+#endif
+  if (parentCounter)
+    parentCounter->add( bytes, count );
+}
+
+void MemoryCounter::remove( size_t bytes, size_t count )
+{
+#ifdef MOAB_HAVE_PTHREAD
+  __sync_fetch_and_sub( &numAllocs, count );
+  __sync_fetch_and_sub( &numBytes, bytes );
+#else
+  numAllocs -= count;
+  numBytes -= bytes;
+#endif
+  if (parentCounter)
+    parentCounter->remove( bytes, count );
+}
+
+  // Header preceding each block from MemoryCounter::allocate,
+  // padded to keep the block aligned as malloc would.
+union CountedBlock {
+  struct {
+    size_t bytes;
+    MemoryCounter* counter;
+  } info;
+  double align[2];
+};
+
+void* MemoryCounter::allocate( size_t bytes, MemoryCounter* counter )
+{
+  CountedBlock* block = (CountedBlock*)malloc( sizeof(CountedBlock) + bytes );
+  if (!block)
+    return 0;
+  block->info.bytes = bytes;
+  block->info.counter = counter;
+  if (counter)
+    counter->add( bytes );
+  return block + 1;
+}
+
+  // Flag in CountedBlock::info.bytes marking blocks from allocate_aligned.
+  // Such blocks are preceded by the pointer returned from malloc.
+static const size_t ALIGNED_BLOCK = ~(~(size_t)0 >> 1);
+
+void* MemoryCounter::allocate_aligned( size_t bytes, MemoryCounter* counter )
+{
+  const size_t mask = MB_ARRAY_ALIGNMENT - 1;
+  const size_t padded = (bytes + mask) & ~mask;
+  const size_t header = sizeof(void*) + sizeof(CountedBlock);
+  char* base = (char*)malloc( header + mask + padded );
+  if (!base)
+    return 0;
+  char* ptr = (char*)(((size_t)(base + header) + mask) & ~mask);
+  CountedBlock* block = reinterpret_cast<CountedBlock*>(ptr) - 1;
+  reinterpret_cast<void**>(block)[-1] = base;
+  block->info.bytes = padded | ALIGNED_BLOCK;
+  block->info.counter = counter;
+  memset( ptr + bytes, 0, padded - bytes );
+  if (counter)
+    counter->add( padded );
+  return ptr;
+}
+
+void* MemoryCounter::reallocate( void* ptr, size_t bytes )
+{
+  if (!ptr)
+    return 0;
+  CountedBlock* block = reinterpret_cast<CountedBlock*>(ptr) - 1;
+  if (block->info.bytes & ALIGNED_BLOCK) {
+    const size_t old_bytes = block->info.bytes & ~ALIGNED_BLOCK;
+    void* result = allocate_aligned( bytes, block->info.counter );
+    if (!result)
+      return 0;
+    memcpy( result, ptr, old_bytes < bytes ? old_bytes : bytes );
+    deallocate( ptr );
+    return result;
+  }
+  
+  const size_t old_bytes = block->info.bytes;
+  block = (CountedBlock*)realloc( block, sizeof(CountedBlock) + bytes );
+  if (!block)
+    return 0;
+  block->info.bytes = bytes;
+  if (block->info.counter)
+    block->info.counter->resize( old_bytes, bytes );
+  return block + 1;
+}
+
+void MemoryCounter::deallocate( void* ptr )
+{
+  if (!ptr)
+    return;
+  CountedBlock* block = reinterpret_cast<CountedBlock*>(ptr) - 1;
+  if (block->info.counter)
+    block->info.counter->remove( block->info.bytes & ~ALIGNED_BLOCK );
+  if (block->info.bytes & ALIGNED_BLOCK)
+    free( reinterpret_cast<void**>(block)[-1] );
+  else
+    free( block );
+}
+
+MemoryCounter* MemoryCounter::owner( const void* ptr )
+{
+  return ptr ? (reinterpret_cast<const CountedBlock*>(ptr) - 1)->info.counter : 0;
+}
+
+} // namespace moab
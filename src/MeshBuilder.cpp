@@ -0,0 +1,160 @@
+#include "moab/MeshBuilder.hpp"
+#include "moab/Core.hpp"
+#include "moab/ReadUtilIface.hpp"
+#include "moab/Range.hpp"
+#include "AEntityFactory.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace moab {
+
+MeshBuilder::MeshBuilder( Interface* moab )
+  : mbImpl( dynamic_cast<Core*>(moab) ), readUtil( 0 ), threadPool( 0 ), poolThreads( 0 )
+{
+  if (mbImpl)
+    mbImpl->query_interface( readUtil );
+}
+
+MeshBuilder::~MeshBuilder()
+{
+  commit();
+  if (readUtil)
+    mbImpl->release_interface( readUtil );
+  delete threadPool;
+}
+
+ErrorCode MeshBuilder::add_vertices( int count,
+                                     EntityHandle& start,
+                                     double*& x, double*& y, double*& z )
+{
+  if (!readUtil)
+    return MB_FAILURE;
+  if (mbImpl->float_coordinates())
+    return MB_TYPE_OUT_OF_RANGE;
+  if (count < 1)
+    return MB_INDEX_OUT_OF_RANGE;
+
+  std::vector<double*> arrays;
+  ErrorCode rval = readUtil->get_node_coords( 3, count, 0, start, arrays );
+  if (MB_SUCCESS != rval)
+    return rval;
+  x = arrays[0];
+  y = arrays[1];
+  z = arrays[2];
+
+  Block block = { start, count, 0, 0 };
+  pendingBlocks.push_back( block );
+  return MB_SUCCESS;
+}
+
+ErrorCode MeshBuilder::add_vertices( int count,
+                                     EntityHandle& start,
+                                     float*& x, float*& y, float*& z )
+{
+  if (!readUtil)
+    return MB_FAILURE;
+  if (count < 1)
+    return MB_INDEX_OUT_OF_RANGE;
+
+  std::vector<float*> arrays;
+  ErrorCode rval = readUtil->get_node_coords( 3, count, 0, start, arrays );
+  if (MB_SUCCESS != rval)
+    return rval;
+  x = arrays[0];
+  y = arrays[1];
+  z = arrays[2];
+
+  Block block = { start, count, 0, 0 };
+  pendingBlocks.push_back( block );
+  return MB_SUCCESS;
+}
+
+ErrorCode MeshBuilder::add_elements( EntityType type,
+                                     int count,
+                                     int verts_per_elem,
+                                     EntityHandle& start,
+                                     EntityHandle*& conn )
+{
+  if (!readUtil)
+    return MB_FAILURE;
+  if (type <= MBVERTEX || type >= MBENTITYSET)
+    return MB_TYPE_OUT_OF_RANGE;
+  if (count < 1 || verts_per_elem < 1)
+    return MB_INDEX_OUT_OF_RANGE;
+
+  ErrorCode rval = readUtil->get_element_connect( count, verts_per_elem, type, 0, start, conn );
+  if (MB_SUCCESS != rval)
+    return rval;
+    // unfilled connectivity must not be taken for valid handles
+  std::fill( conn, conn + (size_t)count * verts_per_elem, 0 );
+
+  Block block = { start, count, verts_per_elem, conn };
+  pendingBlocks.push_back( block );
+  return MB_SUCCESS;
+}
+
+ErrorCode MeshBuilder::commit( Range* created )
+{
+  ErrorCode result = MB_SUCCESS;
+  Range::iterator hint;
+  if (created)
+    hint = created->begin();
+  for (size_t i = 0; i < pendingBlocks.size(); ++i) {
+    const Block& block = pendingBlocks[i];
+    if (block.verts_per_elem) {
+      const EntityHandle* end = block.conn + (size_t)block.count * block.verts_per_elem;
+      if (std::find( (const EntityHandle*)block.conn, end, (EntityHandle)0 ) != end)
+        result = MB_ENTITY_NOT_FOUND;
+      ErrorCode rval = mbImpl->a_entity_factory()->notify_create_entities( 
+                         block.start, block.count, block.verts_per_elem, block.conn );
+      if (MB_SUCCESS != rval && MB_SUCCESS == result)
+        result = rval;
+    }
+    if (created)
+      hint = created->insert( hint, block.start, block.start + block.count - 1 );
+  }
+  pendingBlocks.clear();
+  return result;
+}
+
+  // Run MeshBuilder::FillTask for fixed-size chunks of items
+class FillChunks : public ThreadTask
+{
+public:
+  static const size_t CHUNK_SIZE = 4096;
+
+  FillChunks( MeshBuilder::FillTask& task, size_t count )
+    : fillTask( task ), numItems( count ) {}
+
+  size_t num_chunks() const { return (numItems + CHUNK_SIZE - 1) / CHUNK_SIZE; }
+
+  ErrorCode execute( size_t chunk )
+  {
+    const size_t first = chunk * CHUNK_SIZE;
+    return fillTask.fill( first, std::min( CHUNK_SIZE, numItems - first ) );
+  }
+
+private:
+  MeshBuilder::FillTask& fillTask;
+  size_t numItems;
+};
+
+ErrorCode MeshBuilder::parallel_fill( FillTask& task, size_t count, unsigned num_threads )
+{
+  if (!num_threads)
+    num_threads = ThreadPool::default_num_threads();
+  if (threadPool && poolThreads != num_threads) {
+    delete threadPool;
+    threadPool = 0;
+  }
+  if (!threadPool) {
+    threadPool = new ThreadPool( num_threads );
+    poolThreads = num_threads;
+  }
+  
+  FillChunks chunks( task, count );
+  return threadPool->run( chunks, chunks.num_chunks() );
+}
+
+} // namespace moab
@@ -21,20 +21,23 @@ static inline
 MeshSet::Count insert_in_vector( const MeshSet::Count count, 
                                    MeshSet::CompactList& list,
                                    const EntityHandle h,
-                                   int &result );
+                                   int &result,
+                                   SetListPool* pool );
 
 /**\brief Remvoe from parent/child list */
 static inline
 MeshSet::Count remove_from_vector( const MeshSet::Count count, 
                                      MeshSet::CompactList& list,
                                      const EntityHandle h,
-                                     int &result );
+                                     int &result,
+                                     SetListPool* pool );
 
 
 /**\brief Resize MeshSet::CompactList.  Returns pointer to storage */
 static EntityHandle* resize_compact_list( MeshSet::Count& count,
                                             MeshSet::CompactList& clist,
-                                            size_t new_list_size );
+                                            size_t new_list_size,
+                                            SetListPool* pool );
 /**\brief Methods to insert/remove range-based data from contents list.
  *        Templatized to operate on both Range and set-based MeshSets.
  */
@@ -47,7 +50,8 @@ public:
                                                     pair_iter_t begin, 
                                                     pair_iter_t end, 
                                                     EntityHandle my_handle, 
-                                                    AEntityFactory* adj );
+                                                    AEntityFactory* adj,
+                                                    SetListPool* pool );
   
   /** Remove range-based data from range-based MeshSet */
   inline static ErrorCode ranged_remove_entities( MeshSet::Count& count, 
@@ -55,7 +59,8 @@ public:
                                                     pair_iter_t begin, 
                                                     pair_iter_t end, 
                                                     EntityHandle my_handle, 
-                                                    AEntityFactory* adj );
+                                                    AEntityFactory* adj,
+                                                    SetListPool* pool );
 
   /** Insert range-based data into list-based MeshSet */
   inline static ErrorCode vector_insert_entities( MeshSet::Count& count, 
@@ -63,7 +68,8 @@ public:
                                                     pair_iter_t begin, 
                                                     pair_iter_t end, 
                                                     EntityHandle my_handle, 
-                                                    AEntityFactory* adj );
+                                                    AEntityFactory* adj,
+                                                    SetListPool* pool );
 };
 
 /** Remove Range of handles fromr vector-based MeshSet */
@@ -71,7 +77,8 @@ static ErrorCode vector_remove_range( MeshSet::Count& count,
                                         MeshSet::CompactList& clist, 
                                         const Range& range, 
                                         EntityHandle my_handle, 
-                                        AEntityFactory* adj );
+                                        AEntityFactory* adj,
+                                        SetListPool* pool );
 
 /** Remove range-based MeshSet contents from vector-based MeshSet */
 static ErrorCode vector_remove_ranges( MeshSet::Count& count, 
@@ -79,7 +86,8 @@ static ErrorCode vector_remove_ranges( MeshSet::Count& count,
                                          const EntityHandle* pair_list,
                                          size_t num_pairs,
                                          EntityHandle my_handle, 
-                                         AEntityFactory* adj );
+                                         AEntityFactory* adj,
+                                         SetListPool* pool );
 
 /** Remove unsorted array of handles from vector-based MeshSet */
 static ErrorCode vector_remove_vector( MeshSet::Count& count, 
@@ -87,7 +95,8 @@ static ErrorCode vector_remove_vector( MeshSet::Count& count,
                                          const EntityHandle* vect,
                                          size_t vect_size,
                                          EntityHandle my_handle, 
-                                         AEntityFactory* adj );
+                                         AEntityFactory* adj,
+                                         SetListPool* pool );
 
 /** Insert unsorted array of handles into vector-based MeshSet */
 static ErrorCode vector_insert_vector( MeshSet::Count& count, 
@@ -95,12 +104,23 @@ static ErrorCode vector_insert_vector( MeshSet::Count& count,
                                          const EntityHandle* vect,
                                          size_t vect_size,
                                          EntityHandle my_handle, 
-                                         AEntityFactory* adj );
+                                         AEntityFactory* adj,
+                                         SetListPool* pool );
 
 /** Convert unsorted array of handles into array of ranged [begin,end] pairs */
 static void convert_to_ranges( const EntityHandle* vect_in, size_t vect_in_len,
                                std::vector<EntityHandle>& vect_out );
 
+/**\brief Insert ranges of handles into compressed set contents */
+template <typename pair_iter_t> static
+ErrorCode compressed_insert( CompressedSet* set, pair_iter_t begin, pair_iter_t end,
+                             EntityHandle my_handle, AEntityFactory* adj );
+
+/**\brief Remove ranges of handles from compressed set contents */
+template <typename pair_iter_t> static
+ErrorCode compressed_remove( CompressedSet* set, pair_iter_t begin, pair_iter_t end,
+                             EntityHandle my_handle, AEntityFactory* adj );
+
 
 /*****************************************************************************************
  *                             Parent/Child Operations                                   *
@@ -110,7 +130,8 @@ static inline
 MeshSet::Count insert_in_vector( const MeshSet::Count count, 
                                 MeshSet::CompactList& list,
                                 const EntityHandle h,
-                                int &result )
+                                int &result,
+                                SetListPool* pool )
 {
   switch (count) {
     case MeshSet::ZERO:
@@ -133,7 +154,7 @@ MeshSet::Count insert_in_vector( const MeshSet::Count count,
         return MeshSet::TWO;
       }
       else {
-        EntityHandle* ptr = (EntityHandle*)malloc(3*sizeof(EntityHandle));
+        EntityHandle* ptr = pool->allocate( 3 );
         ptr[0] = list.hnd[0];
         ptr[1] = list.hnd[1];
         ptr[2] = h;
@@ -148,7 +169,7 @@ MeshSet::Count insert_in_vector( const MeshSet::Count count,
       }
       else {
         int size = list.ptr[1] - list.ptr[0];
-        list.ptr[0] = (EntityHandle*)realloc( list.ptr[0], (size+1)*sizeof(EntityHandle) );
+        list.ptr[0] = pool->reallocate( list.ptr[0], size, size+1 );
         list.ptr[0][size] = h;
         list.ptr[1] = list.ptr[0] + size + 1;
         result = true;
@@ -163,7 +184,8 @@ static inline
 MeshSet::Count remove_from_vector( const MeshSet::Count count, 
                                   MeshSet::CompactList& list,
                                   const EntityHandle h,
-                                  int &result )
+                                  int &result,
+                                  SetListPool* pool )
 {
   switch (count) {
     case MeshSet::ZERO:
@@ -212,11 +234,11 @@ MeshSet::Count remove_from_vector( const MeshSet::Count count,
         p = list.ptr[0];
         list.hnd[0] = p[0];
         list.hnd[1] = p[1];
-        free( p );
+        pool->deallocate( p, 3 );
         return MeshSet::TWO;
       }
       else {
-        list.ptr[0] = (EntityHandle*)realloc( list.ptr[0], size*sizeof(EntityHandle) );
+        list.ptr[0] = pool->reallocate( list.ptr[0], size+1, size );
         list.ptr[1] = list.ptr[0] + size;
         return MeshSet::MANY;
       }
@@ -227,29 +249,29 @@ MeshSet::Count remove_from_vector( const MeshSet::Count count,
 }
 
 
-int MeshSet::add_parent( EntityHandle parent )
+int MeshSet::add_parent( EntityHandle parent, SetListPool* pool )
 { 
   int result = 0;
-  mParentCount = insert_in_vector( (Count)mParentCount, parentMeshSets, parent, result );
+  mParentCount = insert_in_vector( (Count)mParentCount, parentMeshSets, parent, result, pool );
   return result;
 }
-int MeshSet::add_child( EntityHandle child )
+int MeshSet::add_child( EntityHandle child, SetListPool* pool )
 { 
   int result = 0;
-  mChildCount = insert_in_vector( (Count)mChildCount, childMeshSets, child, result );
+  mChildCount = insert_in_vector( (Count)mChildCount, childMeshSets, child, result, pool );
   return result;
 }
 
-int MeshSet::remove_parent( EntityHandle parent )
+int MeshSet::remove_parent( EntityHandle parent, SetListPool* pool )
 { 
   int result = 0;
-  mParentCount = remove_from_vector( (Count)mParentCount, parentMeshSets, parent, result );
+  mParentCount = remove_from_vector( (Count)mParentCount, parentMeshSets, parent, result, pool );
   return result;
 }
-int MeshSet::remove_child( EntityHandle child )
+int MeshSet::remove_child( EntityHandle child, SetListPool* pool )
 { 
   int result = 0;
-  mChildCount = remove_from_vector( (Count)mChildCount, childMeshSets, child, result );
+  mChildCount = remove_from_vector( (Count)mChildCount, childMeshSets, child, result, pool );
   return result;
 }
 
@@ -258,7 +280,7 @@ int MeshSet::remove_child( EntityHandle child )
  *                          Flag Conversion Operations                                   *
  *****************************************************************************************/
 
-ErrorCode MeshSet::convert( unsigned flg, EntityHandle my_handle, AEntityFactory* adj )
+ErrorCode MeshSet::convert( unsigned flg, EntityHandle my_handle, AEntityFactory* adj, SetListPool* pool )
 {
   ErrorCode rval = MB_SUCCESS;
   if ((mFlags & MESHSET_TRACK_OWNER) && !(flg & MESHSET_TRACK_OWNER))
@@ -269,6 +291,8 @@ ErrorCode MeshSet::convert( unsigned flg, EntityHandle my_handle, AEntityFactory
     return rval;
 
   if (!(mFlags & MESHSET_ORDERED) && (flg & MESHSET_ORDERED)) {
+    if (mCompressed)
+      decompress( pool );
     size_t datalen;
     EntityHandle* data = get_contents(datalen);
     if (datalen) {
@@ -276,7 +300,7 @@ ErrorCode MeshSet::convert( unsigned flg, EntityHandle my_handle, AEntityFactory
       memcpy( &list[0], data, datalen*sizeof(EntityHandle) );
       int num_ents = num_entities();
       Count count = (Count)mContentCount;
-      data = resize_compact_list( count, contentList, num_ents );
+      data = resize_compact_list( count, contentList, num_ents, pool );
       mContentCount = count;
       assert( list.size() % 2 == 0 );
       std::vector<EntityHandle>::iterator i = list.begin();
@@ -297,9 +321,11 @@ ErrorCode MeshSet::convert( unsigned flg, EntityHandle my_handle, AEntityFactory
       std::vector<EntityHandle> ranges;
       convert_to_ranges( data, datalen, ranges );
       Count count = (Count)mContentCount;
-      data = resize_compact_list( count, contentList, ranges.size() );
+      data = resize_compact_list( count, contentList, ranges.size(), pool );
       mContentCount = count;
       memcpy( data, &ranges[0], ranges.size()*sizeof(EntityHandle) );
+      mFlags &= ~(unsigned char)MESHSET_ORDERED;
+      adapt_storage( pool, 0 );
     }
   }
   
@@ -310,9 +336,18 @@ ErrorCode MeshSet::create_adjacencies( EntityHandle my_handle, AEntityFactory* a
 {
   ErrorCode rval = MB_SUCCESS;;
   size_t count;
-  const EntityHandle *const ptr = get_contents( count );
+  const EntityHandle* ptr;
+  std::vector<EntityHandle> list;
+  if (mCompressed) {
+    get_entities( list );
+    count = list.size();
+    ptr = count ? &list[0] : 0;
+  }
+  else {
+    ptr = get_contents( count );
+  }
   const EntityHandle *const end = ptr + count;
-  if (vector_based()) {
+  if (vector_based() || mCompressed) {
     for (const EntityHandle* i = ptr; i != end; ++i) {
       rval = adj->add_adjacency( *i, my_handle, false );
       if (MB_SUCCESS != rval) {
@@ -344,9 +379,18 @@ ErrorCode MeshSet::create_adjacencies( EntityHandle my_handle, AEntityFactory* a
 ErrorCode MeshSet::remove_adjacencies( EntityHandle my_handle, AEntityFactory* adj )
 {
   size_t count;
-  const EntityHandle *const ptr = get_contents( count );
+  const EntityHandle* ptr;
+  std::vector<EntityHandle> list;
+  if (mCompressed) {
+    get_entities( list );
+    count = list.size();
+    ptr = count ? &list[0] : 0;
+  }
+  else {
+    ptr = get_contents( count );
+  }
   const EntityHandle *const end = ptr + count;
-  if (vector_based()) {
+  if (vector_based() || mCompressed) {
     for (const EntityHandle* i = ptr; i != end; ++i)
       adj->remove_adjacency( *i, my_handle );
   }
@@ -366,7 +410,8 @@ ErrorCode MeshSet::remove_adjacencies( EntityHandle my_handle, AEntityFactory* a
 
 static EntityHandle* resize_compact_list( MeshSet::Count& count,
                                             MeshSet::CompactList& clist,
-                                            size_t new_list_size )
+                                            size_t new_list_size,
+                                            SetListPool* pool )
 {
   if (count <= 2) {
     if (new_list_size <= 2) {
@@ -374,7 +419,7 @@ static EntityHandle* resize_compact_list( MeshSet::Count& count,
       return clist.hnd;
     }
     else {
-      EntityHandle* list = (EntityHandle*)malloc( new_list_size*sizeof(EntityHandle) );
+      EntityHandle* list = pool->allocate( new_list_size );
       list[0] = clist.hnd[0];
       list[1] = clist.hnd[1];
       clist.ptr[0] = list;
@@ -384,17 +429,17 @@ static EntityHandle* resize_compact_list( MeshSet::Count& count,
     }
   }
   else if (new_list_size > 2) {
-    if (new_list_size > (size_t)(clist.ptr[1] - clist.ptr[0]))
-      clist.ptr[0] = (EntityHandle*)realloc( clist.ptr[0], new_list_size*sizeof(EntityHandle) );
+    clist.ptr[0] = pool->reallocate( clist.ptr[0], clist.ptr[1] - clist.ptr[0], new_list_size );
     clist.ptr[1] = clist.ptr[0] + new_list_size;
     count = MeshSet::MANY;
     return clist.ptr[0];
   }
   else {
     EntityHandle* list = clist.ptr[0];
+    const size_t list_size = clist.ptr[1] - list;
     clist.hnd[0] = list[0];
     clist.hnd[1] = list[1];
-    free(list);
+    pool->deallocate( list, list_size );
     count = (MeshSet::Count)new_list_size;
     return clist.hnd;
   }
@@ -413,7 +458,8 @@ range_tool<pair_iter_t>::ranged_insert_entities( MeshSet::Count& count,
                                                  pair_iter_t begin, 
                                                  pair_iter_t end, 
                                                  EntityHandle my_handle, 
-                                                 AEntityFactory* adj )
+                                                 AEntityFactory* adj,
+                                                 SetListPool* pool )
 {
      //first pass:
     // 1) merge existing ranges 
@@ -576,7 +622,7 @@ range_tool<pair_iter_t>::ranged_insert_entities( MeshSet::Count& count,
     // adjust allocated array size
   const size_t occupied_size = list_write - list;
   const size_t new_list_size = occupied_size + insert_count;
-  list_ptr = resize_compact_list( count, clist, 2*new_list_size );
+  list_ptr = resize_compact_list( count, clist, 2*new_list_size, pool );
     // done?
   if (!insert_count)
     return MB_SUCCESS;
@@ -632,7 +678,8 @@ range_tool<pair_iter_t>::ranged_remove_entities( MeshSet::Count& count,
                                                  pair_iter_t begin, 
                                                  pair_iter_t end, 
                                                  EntityHandle my_handle, 
-                                                 AEntityFactory* adj )
+                                                 AEntityFactory* adj,
+                                                 SetListPool* pool )
 {
     //first pass:
     // 1) remove (from) existing ranges 
@@ -757,7 +804,7 @@ range_tool<pair_iter_t>::ranged_remove_entities( MeshSet::Count& count,
     // adjust allocated array size
   const size_t occupied_size = list_write - list;
   const size_t new_list_size = occupied_size + 2*split_count;
-  list = resize_compact_list( count, clist, new_list_size );
+  list = resize_compact_list( count, clist, new_list_size, pool );
     // done?
   if (!split_count)
     return MB_SUCCESS;
@@ -811,13 +858,14 @@ range_tool<pair_iter_t>::vector_insert_entities( MeshSet::Count& count,
                                                  pair_iter_t begin, 
                                                  pair_iter_t end, 
                                                  EntityHandle my_handle, 
-                                                 AEntityFactory* adj )
+                                                 AEntityFactory* adj,
+                                                 SetListPool* pool )
 {
   const size_t init_size = count < MeshSet::MANY ? (int)count : clist.ptr[1] - clist.ptr[0];
   size_t add_size = 0;
   for (pair_iter_t i = begin; i != end; ++i)
     add_size += i->second - i->first + 1;
-  EntityHandle* list = resize_compact_list( count, clist, init_size + add_size );
+  EntityHandle* list = resize_compact_list( count, clist, init_size + add_size, pool );
   EntityHandle* li = list + init_size;
 
   for (pair_iter_t i = begin; i != end; ++i) {
@@ -836,7 +884,8 @@ static ErrorCode vector_remove_range( MeshSet::Count& count,
                                         MeshSet::CompactList& clist, 
                                         const Range& range, 
                                         EntityHandle my_handle, 
-                                        AEntityFactory* adj )
+                                        AEntityFactory* adj,
+                                        SetListPool* pool )
 {
   EntityHandle *list;
   size_t list_size;
@@ -861,7 +910,7 @@ static ErrorCode vector_remove_range( MeshSet::Count& count,
     }
   }
 
-  resize_compact_list( count, clist, list_write - list );
+  resize_compact_list( count, clist, list_write - list, pool );
   return MB_SUCCESS;
 }
 
@@ -870,7 +919,8 @@ static ErrorCode vector_remove_ranges( MeshSet::Count& count,
                                          const EntityHandle* pair_list,
                                          size_t num_pairs,
                                          EntityHandle my_handle, 
-                                         AEntityFactory* adj )
+                                         AEntityFactory* adj,
+                                         SetListPool* pool )
 {
   EntityHandle *list;
   size_t list_size;
@@ -900,7 +950,7 @@ static ErrorCode vector_remove_ranges( MeshSet::Count& count,
     }
   }
 
-  resize_compact_list( count, clist, list_write - list );
+  resize_compact_list( count, clist, list_write - list, pool );
   return MB_SUCCESS;
 }
 
@@ -909,7 +959,8 @@ static ErrorCode vector_remove_vector( MeshSet::Count& count,
                                          const EntityHandle* vect,
                                          size_t vect_size,
                                          EntityHandle my_handle, 
-                                         AEntityFactory* adj )
+                                         AEntityFactory* adj,
+                                         SetListPool* pool )
 {
   EntityHandle *list;
   size_t list_size;
@@ -938,7 +989,7 @@ static ErrorCode vector_remove_vector( MeshSet::Count& count,
     }
   }
 
-  resize_compact_list( count, clist, list_write - list );
+  resize_compact_list( count, clist, list_write - list, pool );
   return MB_SUCCESS;
 }
 
@@ -947,10 +998,11 @@ static ErrorCode vector_insert_vector( MeshSet::Count& count,
                                          const EntityHandle* vect,
                                          size_t vect_size,
                                          EntityHandle my_handle, 
-                                         AEntityFactory* adj )
+                                         AEntityFactory* adj,
+                                         SetListPool* pool )
 {
   const size_t orig_size = count < MeshSet::MANY ? (int)count : clist.ptr[1] - clist.ptr[0];
-  EntityHandle* list = resize_compact_list( count, clist, orig_size + vect_size );
+  EntityHandle* list = resize_compact_list( count, clist, orig_size + vect_size, pool );
   if (adj) 
     for (size_t i = 0; i < vect_size; ++i)
       adj->add_adjacency( vect[i], my_handle, false );
@@ -958,78 +1010,97 @@ static ErrorCode vector_insert_vector( MeshSet::Count& count,
   return MB_SUCCESS;
 }
 
-ErrorCode MeshSet::insert_entity_ranges( const EntityHandle* range_vect, size_t len, EntityHandle my_h, AEntityFactory* adj )
+ErrorCode MeshSet::insert_entity_ranges( const EntityHandle* range_vect, size_t len, EntityHandle my_h, AEntityFactory* adj, SetListPool* pool )
 {
+  const size_t old_len = list_length();
   typedef const std::pair<EntityHandle,EntityHandle>* pair_vect_t;
   pair_vect_t pair_vect = reinterpret_cast<pair_vect_t>(range_vect);
   MeshSet::Count count = static_cast<MeshSet::Count>(mContentCount);
   ErrorCode rval;
-  if (!vector_based())
+  if (mCompressed)
+    rval = compressed_insert( contentList.cset, pair_vect, pair_vect + len/2, 
+                              my_h, tracking() ? adj : 0 );
+  else if (!vector_based())
     rval = range_tool<pair_vect_t>::ranged_insert_entities( count, contentList,  pair_vect, 
-                                             pair_vect + len/2, my_h, tracking() ? adj : 0 );
+                                             pair_vect + len/2, my_h, tracking() ? adj : 0, pool );
   else
     rval = range_tool<pair_vect_t>::vector_insert_entities( count, contentList,  pair_vect, 
-                                             pair_vect + len/2, my_h, tracking() ? adj : 0 );
+                                             pair_vect + len/2, my_h, tracking() ? adj : 0, pool );
   mContentCount = count;
+  adapt_storage( pool, old_len );
   return rval;
 }
 
-ErrorCode MeshSet::insert_entity_ranges( const Range& range, EntityHandle my_h, AEntityFactory* adj )
+ErrorCode MeshSet::insert_entity_ranges( const Range& range, EntityHandle my_h, AEntityFactory* adj, SetListPool* pool )
 {
+  const size_t old_len = list_length();
   ErrorCode rval;
   MeshSet::Count count = static_cast<MeshSet::Count>(mContentCount);
-  if (!vector_based())
+  if (mCompressed)
+    rval = compressed_insert( contentList.cset, range.const_pair_begin(), 
+                              range.const_pair_end(), my_h, tracking() ? adj : 0 );
+  else if (!vector_based())
     rval = range_tool<Range::const_pair_iterator>::ranged_insert_entities( count, 
                              contentList, range.const_pair_begin(), range.const_pair_end(), 
-                             my_h, tracking() ? adj : 0 );
+                             my_h, tracking() ? adj : 0, pool );
   else
     rval = range_tool<Range::const_pair_iterator>::vector_insert_entities( count, 
                              contentList, range.const_pair_begin(), range.const_pair_end(), 
-                             my_h, tracking() ? adj : 0 );
+                             my_h, tracking() ? adj : 0, pool );
   mContentCount = count;
+  adapt_storage( pool, old_len );
   return rval;
 }
 
-ErrorCode MeshSet::remove_entity_ranges( const EntityHandle* range_vect, size_t len, EntityHandle my_h, AEntityFactory* adj )
+ErrorCode MeshSet::remove_entity_ranges( const EntityHandle* range_vect, size_t len, EntityHandle my_h, AEntityFactory* adj, SetListPool* pool )
 {
+  const size_t old_len = list_length();
   ErrorCode rval;
   MeshSet::Count count = static_cast<MeshSet::Count>(mContentCount);
+  typedef const std::pair<EntityHandle,EntityHandle>* pair_vect_t;
+  pair_vect_t pair_vect = reinterpret_cast<pair_vect_t>(range_vect);
   if (vector_based()) 
     rval = vector_remove_ranges( count, contentList, range_vect, len/2, my_h, 
-                                 tracking() ? adj : 0 );
-  else {
-    typedef const std::pair<EntityHandle,EntityHandle>* pair_vect_t;
-    pair_vect_t pair_vect = reinterpret_cast<pair_vect_t>(range_vect);
+                                 tracking() ? adj : 0, pool );
+  else if (mCompressed)
+    rval = compressed_remove( contentList.cset, pair_vect, pair_vect + len/2, 
+                              my_h, tracking() ? adj : 0 );
+  else
     rval = range_tool<pair_vect_t>::ranged_remove_entities( count, contentList, pair_vect, 
-                                           pair_vect + len/2, my_h, tracking() ? adj : 0 );
-  }
+                                           pair_vect + len/2, my_h, tracking() ? adj : 0, pool );
   mContentCount = count;
+  adapt_storage( pool, old_len );
   return rval;
 }
 
-ErrorCode MeshSet::remove_entity_ranges( const Range& range, EntityHandle my_h, AEntityFactory* adj )
+ErrorCode MeshSet::remove_entity_ranges( const Range& range, EntityHandle my_h, AEntityFactory* adj, SetListPool* pool )
 {
+  const size_t old_len = list_length();
   ErrorCode rval;
   MeshSet::Count count = static_cast<MeshSet::Count>(mContentCount);
   if (vector_based()) 
-    rval = vector_remove_range( count, contentList, range, my_h, tracking() ? adj : 0 );
+    rval = vector_remove_range( count, contentList, range, my_h, tracking() ? adj : 0, pool );
+  else if (mCompressed)
+    rval = compressed_remove( contentList.cset, range.const_pair_begin(), 
+                              range.const_pair_end(), my_h, tracking() ? adj : 0 );
   else 
     rval = range_tool<Range::const_pair_iterator>::ranged_remove_entities( count, 
                          contentList, range.const_pair_begin(), range.const_pair_end(), 
-                         my_h, tracking() ? adj : 0 );
+                         my_h, tracking() ? adj : 0, pool );
   mContentCount = count;
+  adapt_storage( pool, old_len );
   return rval;
 }
 
 
-ErrorCode MeshSet::intersect( const MeshSet* other, EntityHandle my_handle, AEntityFactory* adj )
+ErrorCode MeshSet::intersect( const MeshSet* other, EntityHandle my_handle, AEntityFactory* adj, SetListPool* pool )
 {
   ErrorCode rval;
-  if (!vector_based() && !other->vector_based()) {
+  if (!vector_based() && !other->vector_based() && !other->compressed()) {
     size_t other_count = 0;
     const EntityHandle* other_vect = other->get_contents( other_count );
     if (!other_count)
-      return clear( my_handle, adj );
+      return clear( my_handle, adj, pool );
     assert(0 == other_count%2);
     
     std::vector<EntityHandle> compliment;
@@ -1049,7 +1120,7 @@ ErrorCode MeshSet::intersect( const MeshSet* other, EntityHandle my_handle, AEnt
       compliment.push_back( ~(EntityHandle)0 );
     }
     
-    return remove_entity_ranges( &compliment[0], compliment.size(), my_handle, adj );
+    return remove_entity_ranges( &compliment[0], compliment.size(), my_handle, adj, pool );
   }
   else {
     Range my_ents, other_ents;
@@ -1057,7 +1128,7 @@ ErrorCode MeshSet::intersect( const MeshSet* other, EntityHandle my_handle, AEnt
     if (MB_SUCCESS != rval)
       return rval;
     rval = other->get_entities(other_ents);
-    return remove_entities( moab::subtract(my_ents, other_ents), my_handle, adj );
+    return remove_entities( moab::subtract(my_ents, other_ents), my_handle, adj, pool );
   }
 }
 
@@ -1096,49 +1167,145 @@ static void convert_to_ranges( const EntityHandle* vect_in, size_t vect_in_len,
   vect_out.erase( w, vect_out.end() );
 }
 
-ErrorCode MeshSet::insert_entity_vector( const EntityHandle* vect, size_t len, EntityHandle my_h, AEntityFactory* adj )
+ErrorCode MeshSet::insert_entity_vector( const EntityHandle* vect, size_t len, EntityHandle my_h, AEntityFactory* adj, SetListPool* pool )
 {
+  const size_t old_len = list_length();
   MeshSet::Count count = static_cast<MeshSet::Count>(mContentCount);
   ErrorCode rval;
   if (vector_based())
-    rval = vector_insert_vector( count, contentList, vect, len, my_h, tracking() ? adj : 0 );
+    rval = vector_insert_vector( count, contentList, vect, len, my_h, tracking() ? adj : 0, pool );
   else {
     std::vector<EntityHandle> rangevect;
     convert_to_ranges( vect, len, rangevect );
     typedef const std::pair<EntityHandle,EntityHandle>* pair_vect_t;
     pair_vect_t pair_vect = reinterpret_cast<pair_vect_t>(&rangevect[0]);
-    rval = range_tool<pair_vect_t>::ranged_insert_entities( count, contentList, pair_vect, 
-                                 pair_vect + rangevect.size()/2, my_h, tracking() ? adj : 0 );
+    if (mCompressed)
+      rval = compressed_insert( contentList.cset, pair_vect, pair_vect + rangevect.size()/2,
+                                my_h, tracking() ? adj : 0 );
+    else
+      rval = range_tool<pair_vect_t>::ranged_insert_entities( count, contentList, pair_vect, 
+                                 pair_vect + rangevect.size()/2, my_h, tracking() ? adj : 0, pool );
   }
   mContentCount = count;
+  adapt_storage( pool, old_len );
   return rval;
 }
 
-ErrorCode MeshSet::remove_entity_vector( const EntityHandle* vect, size_t len, EntityHandle my_h, AEntityFactory* adj )
+ErrorCode MeshSet::remove_entity_vector( const EntityHandle* vect, size_t len, EntityHandle my_h, AEntityFactory* adj, SetListPool* pool )
 {
+  const size_t old_len = list_length();
   MeshSet::Count count = static_cast<MeshSet::Count>(mContentCount);
   ErrorCode rval;
   if (vector_based())
-    rval = vector_remove_vector( count, contentList, vect, len, my_h, tracking() ? adj : 0 );
+    rval = vector_remove_vector( count, contentList, vect, len, my_h, tracking() ? adj : 0, pool );
   else {
     std::vector<EntityHandle> rangevect;
     convert_to_ranges( vect, len, rangevect );
     typedef const std::pair<EntityHandle,EntityHandle>* pair_vect_t;
     pair_vect_t pair_vect = reinterpret_cast<pair_vect_t>(&rangevect[0]);
-    rval = range_tool<pair_vect_t>::ranged_remove_entities( count, contentList, pair_vect, 
-                                pair_vect + rangevect.size()/2, my_h, tracking() ? adj : 0 );
+    if (mCompressed)
+      rval = compressed_remove( contentList.cset, pair_vect, pair_vect + rangevect.size()/2,
+                                my_h, tracking() ? adj : 0 );
+    else
+      rval = range_tool<pair_vect_t>::ranged_remove_entities( count, contentList, pair_vect, 
+                                pair_vect + rangevect.size()/2, my_h, tracking() ? adj : 0, pool );
   }
   mContentCount = count;
+  adapt_storage( pool, old_len );
   return rval;
 }
 
 
 
+template <typename pair_iter_t> static
+ErrorCode compressed_insert( CompressedSet* set, pair_iter_t begin, pair_iter_t end,
+                             EntityHandle my_handle, AEntityFactory* adj )
+{
+  std::vector<EntityHandle> inserted;
+  for (; begin != end; ++begin) 
+    set->insert( (*begin).first, (*begin).second, adj ? &inserted : 0 );
+  for (size_t i = 0; i < inserted.size(); ++i)
+    adj->add_adjacency( inserted[i], my_handle, false );
+  return MB_SUCCESS;
+}
+
+template <typename pair_iter_t> static
+ErrorCode compressed_remove( CompressedSet* set, pair_iter_t begin, pair_iter_t end,
+                             EntityHandle my_handle, AEntityFactory* adj )
+{
+  std::vector<EntityHandle> removed;
+  for (; begin != end && !set->empty(); ++begin) 
+    set->erase( (*begin).first, (*begin).second, adj ? &removed : 0 );
+  for (size_t i = 0; i < removed.size(); ++i)
+    adj->remove_adjacency( removed[i], my_handle );
+  return MB_SUCCESS;
+}
+
+void MeshSet::adapt_storage( SetListPool* pool, size_t old_len )
+{
+  if (vector_based())
+    return;
+  
+  if (mCompressed) {
+    if (contentList.cset->size() < COMPRESS_MIN_RANGES/2)
+      decompress( pool );
+  }
+  else if (mContentCount == MANY) {
+      // Counting the handles and estimating the compressed size both
+      // take time linear in the length of the list, so check only when
+      // the list has grown past a power of two.
+    size_t len = contentList.ptr[1] - contentList.ptr[0];
+    if (len <= old_len || (len ^ old_len) <= old_len)
+      return;
+    
+      // Each range costs two handles while each handle in a compressed
+      // set costs at most two bytes plus the overhead of its chunk, so 
+      // compress if the average range contains fewer than four handles
+      // and the handles are not scattered over too many chunks.
+    if (len >= 2*COMPRESS_MIN_RANGES && 
+        len * sizeof(EntityHandle) > 4 * (size_t)num_entities() &&
+        len * sizeof(EntityHandle) > 
+          CompressedSet::estimate_memory_use( contentList.ptr[0], len ))
+      compress( pool );
+  }
+}
+
+void MeshSet::compress( SetListPool* pool )
+{
+  assert( !mCompressed && !vector_based() );
+  size_t len;
+  const EntityHandle* list = get_contents( len );
+  CompressedSet* set = new CompressedSet;
+  for (size_t i = 0; i < len; i += 2)
+    set->insert( list[i], list[i+1] );
+  if (mContentCount == MANY)
+    pool->deallocate( contentList.ptr[0], len );
+  contentList.cset = set;
+  mContentCount = MANY;
+  mCompressed = 1;
+}
+
+void MeshSet::decompress( SetListPool* pool )
+{
+  assert( mCompressed );
+  CompressedSet* set = contentList.cset;
+  std::vector<EntityHandle> pairs;
+  set->get_pairs( pairs );
+  mCompressed = 0;
+  MeshSet::Count count = ZERO;
+  EntityHandle* list = resize_compact_list( count, contentList, pairs.size(), pool );
+  if (!pairs.empty())
+    memcpy( list, &pairs[0], pairs.size()*sizeof(EntityHandle) );
+  mContentCount = count;
+  delete set;
+}
+
 ErrorCode MeshSet::replace_entities( EntityHandle my_handle,
                                          const EntityHandle* old_entities,
                                          const EntityHandle* new_entities,
                                          size_t num_ents,
-                                         AEntityFactory* adjfact )
+                                         AEntityFactory* adjfact,
+                                         SetListPool* pool )
 {
   if (vector_based()) {
     ErrorCode result = MB_SUCCESS;
@@ -1162,8 +1329,8 @@ ErrorCode MeshSet::replace_entities( EntityHandle my_handle,
     return result;
   }
   else {
-    ErrorCode r1 = remove_entities( old_entities, num_ents, my_handle, adjfact );
-    ErrorCode r2 = add_entities( new_entities, num_ents, my_handle, adjfact );
+    ErrorCode r1 = remove_entities( old_entities, num_ents, my_handle, adjfact, pool );
+    ErrorCode r2 = add_entities( new_entities, num_ents, my_handle, adjfact, pool );
     return (MB_SUCCESS == r2) ? r1 : r2;
   }
 }
@@ -1177,12 +1344,14 @@ unsigned long MeshSet::get_memory_use() const
 {
   unsigned long result = 0;
   if (mParentCount == MANY)
-    result += parentMeshSets.ptr[1] - parentMeshSets.ptr[0];
+    result += SetListPool::capacity( parentMeshSets.ptr[1] - parentMeshSets.ptr[0] );
   if (mChildCount == MANY)
-    result += childMeshSets.ptr[1] - childMeshSets.ptr[0];
-  if (mContentCount == MANY)
-    result += contentList.ptr[1] - contentList.ptr[0];
-  return sizeof(EntityHandle)*result;
+    result += SetListPool::capacity( childMeshSets.ptr[1] - childMeshSets.ptr[0] );
+  if (mCompressed)
+    result += contentList.cset->memory_use();
+  else if (mContentCount == MANY)
+    result += SetListPool::capacity( contentList.ptr[1] - contentList.ptr[0] );
+  return result;
 }
   
 } // namespace moab
@@ -9,6 +9,8 @@
 #include "Internals.hpp"
 #include "moab/Range.hpp"
 #include "moab/CN.hpp"
+#include "CompressedSet.hpp"
+#include "SetListPool.hpp"
 
 #include <assert.h>
 #include <vector>
@@ -20,6 +22,12 @@ namespace moab {
 class AEntityFactory;
 
 /** \brief Class to implement entity set functionality 
+  *
+  * Lists of more than two handles are allocated from the SetListPool
+  * passed to the methods that modify the set.  The same pool must be
+  * used for all modifications of a set, and the lists are released
+  * by clear_all or when the pool is released, not by the destructor.
+  *
   * \author Jason Kraftcheck <kraftche@cae.wisc.edu>
   */
 class MeshSet
@@ -33,7 +41,7 @@ public:
   //! destructor
   inline ~MeshSet();
   
-  inline ErrorCode set_flags( unsigned flags, EntityHandle my_handle, AEntityFactory* adjacencies );
+  inline ErrorCode set_flags( unsigned flags, EntityHandle my_handle, AEntityFactory* adjacencies, SetListPool* pool );
     
 
     //! get all children pointed to by this meshset
@@ -50,19 +58,19 @@ public:
 
     //! add a parent to this meshset; returns true if parent was added, 0 if it was
     //! already a parent of this meshset
-  int add_parent(EntityHandle parent);
+  int add_parent(EntityHandle parent, SetListPool* pool);
     
     //! add a child to this meshset; returns true if child was added, 0 if it was
     //! already a child of this meshset
-  int add_child(EntityHandle child);
+  int add_child(EntityHandle child, SetListPool* pool);
     
     //! remove a parent from this meshset; returns true if parent was removed, 0 if it was
     //! not a parent of this meshset
-  int remove_parent(EntityHandle parent);
+  int remove_parent(EntityHandle parent, SetListPool* pool);
     
     //! remove a child from this meshset; returns true if child was removed, 0 if it was
     //! not a child of this meshset
-  int remove_child(EntityHandle child);
+  int remove_child(EntityHandle child, SetListPool* pool);
 
   unsigned flags() const { return mFlags; }
   //! returns whether entities of meshsets know this meshset 
@@ -70,6 +78,8 @@ public:
   int set()          const { return mFlags & MESHSET_SET; }
   int ordered()      const { return mFlags & MESHSET_ORDERED; }
   int vector_based() const { return ordered(); }
+    //! contents of range-based set stored in a CompressedSet
+  bool compressed()  const { return mCompressed; }
 
     //! replace one entity with another in the set (contents and parent/child
     //! lists); returns whether it was replaced or not
@@ -77,17 +87,24 @@ public:
                                const EntityHandle *old_entities, 
                                const EntityHandle *new_entities,
                                size_t num_entities,
-                               AEntityFactory* mAdjFact);
+                               AEntityFactory* mAdjFact,
+                               SetListPool* pool);
   
     /** Clear *contents* of set (not parents or children) */
-  inline ErrorCode clear( EntityHandle myhandle, AEntityFactory* adjacencies );
+  inline ErrorCode clear( EntityHandle myhandle, AEntityFactory* adjacencies, SetListPool* pool );
   
     /** Clear all set lists (contents, parents, and children) */
-  inline ErrorCode clear_all( EntityHandle myhandle, AEntityFactory* adjacencies );
+  inline ErrorCode clear_all( EntityHandle myhandle, AEntityFactory* adjacencies, SetListPool* pool );
 
-    /** Get contents data array.  NOTE: this may not contain what you expect if not vector_based */
+    /** Get contents data array.  NOTE: this may not contain what you expect if not vector_based.
+     *  Must not be called for compressed sets. */
   inline const EntityHandle* get_contents( size_t& count_out ) const;
-    /** Get contents data array.  NOTE: this may not contain what you expect if not vector_based */
+    /** As get_contents, except that the contents of a compressed set are
+     *  written as a list of ranges to \c storage, and a pointer to that is returned. */
+  inline const EntityHandle* get_contents( size_t& count_out,
+                                           std::vector<EntityHandle>& storage ) const;
+    /** Get contents data array.  NOTE: this may not contain what you expect if not vector_based.
+     *  Must not be called for compressed sets. */
   inline EntityHandle* get_contents( size_t& count_out );
 
     /** Get entities contained in set */
@@ -126,38 +143,45 @@ public:
   //! subtract/intersect/unite meshset_2 from/with/into meshset_1; modifies meshset_1
   inline ErrorCode subtract(const MeshSet *meshset_2,
                                EntityHandle my_handle,
-                               AEntityFactory* adjacencies);
+                               AEntityFactory* adjacencies,
+                               SetListPool* pool);
 
   ErrorCode intersect(const MeshSet *meshset_2,
                                 EntityHandle my_handle,
-                                AEntityFactory* adjacencies);
+                                AEntityFactory* adjacencies,
+                                SetListPool* pool);
 
   inline ErrorCode unite(const MeshSet *meshset_2,
                             EntityHandle my_handle,
-                            AEntityFactory* adjacencies);
+                            AEntityFactory* adjacencies,
+                            SetListPool* pool);
 
   //! add these entities to this meshset
   inline ErrorCode add_entities(const EntityHandle *entity_handles,
                                    const int num_entities,
                                    EntityHandle my_handle,
-                                   AEntityFactory* adjacencies);
+                                   AEntityFactory* adjacencies,
+                                   SetListPool* pool);
     
     //! add these entities to this meshset
   inline ErrorCode add_entities(const Range &entities,
                                    EntityHandle my_handle,
-                                   AEntityFactory* adjacencies);
+                                   AEntityFactory* adjacencies,
+                                   SetListPool* pool);
     
     //! add these entities to this meshset
   inline ErrorCode remove_entities(const Range& entities,
                                       EntityHandle my_handle,
-                                      AEntityFactory* adjacencies);
+                                      AEntityFactory* adjacencies,
+                                      SetListPool* pool);
     
    
     //! remove these entities from this meshset
   inline ErrorCode remove_entities(const EntityHandle *entities,
                                       const int num_entities,
                                       EntityHandle my_handle,
-                                      AEntityFactory* adjacencies);
+                                      AEntityFactory* adjacencies,
+                                      SetListPool* pool);
 
     //! return the number of entities contained in this meshset
   inline unsigned int num_entities() const;
@@ -169,7 +193,7 @@ public:
 protected:
   
   /** Convert for changing flag values */
-  ErrorCode convert( unsigned flags, EntityHandle my_handle, AEntityFactory* adj );
+  ErrorCode convert( unsigned flags, EntityHandle my_handle, AEntityFactory* adj, SetListPool* pool );
 
   /** Add explicit adjacencies from all contained entities to this (i.e. convert to tracking) */
   ErrorCode create_adjacencies( EntityHandle myhandle, AEntityFactory* adjacencies );
@@ -178,26 +202,45 @@ protected:
   ErrorCode remove_adjacencies( EntityHandle myhandle, AEntityFactory* adjacencies );
 
   /** Insert vector of handles into MeshSet */
-  ErrorCode insert_entity_vector( const EntityHandle* vect, size_t len, EntityHandle my_h, AEntityFactory* adj );
+  ErrorCode insert_entity_vector( const EntityHandle* vect, size_t len, EntityHandle my_h, AEntityFactory* adj, SetListPool* pool );
  
   /** Insert vector of handle range pairs into MeshSet */
-  ErrorCode insert_entity_ranges( const EntityHandle* range_vect, size_t len, EntityHandle my_h, AEntityFactory* adj );
+  ErrorCode insert_entity_ranges( const EntityHandle* range_vect, size_t len, EntityHandle my_h, AEntityFactory* adj, SetListPool* pool );
 
   /** Insert Range of handles into MeshSet */
-  ErrorCode insert_entity_ranges( const Range& range, EntityHandle my_h, AEntityFactory* adj );
+  ErrorCode insert_entity_ranges( const Range& range, EntityHandle my_h, AEntityFactory* adj, SetListPool* pool );
 
   /** Remove vector of handles from MeshSet */
-  ErrorCode remove_entity_vector( const EntityHandle* vect, size_t len, EntityHandle my_h, AEntityFactory* adj );
+  ErrorCode remove_entity_vector( const EntityHandle* vect, size_t len, EntityHandle my_h, AEntityFactory* adj, SetListPool* pool );
 
   /** Remove vector of handle range pairs from MeshSet */
-  ErrorCode remove_entity_ranges( const EntityHandle* range_vect, size_t len, EntityHandle my_h, AEntityFactory* adj );
+  ErrorCode remove_entity_ranges( const EntityHandle* range_vect, size_t len, EntityHandle my_h, AEntityFactory* adj, SetListPool* pool );
 
   /** Remove Range of handles from MeshSet */
-  ErrorCode remove_entity_ranges( const Range& range, EntityHandle my_h, AEntityFactory* adj );
+  ErrorCode remove_entity_ranges( const Range& range, EntityHandle my_h, AEntityFactory* adj, SetListPool* pool );
+
+  /** Switch range-based contents to or from compressed storage as appropriate for size
+   *\param old_len  list_length() before the change to the contents */
+  void adapt_storage( SetListPool* pool, size_t old_len );
+
+  /** Length of uncompressed contents list (zero if compressed) */
+  size_t list_length() const 
+    { return mCompressed ? 0 : mContentCount == MANY ? 
+             contentList.ptr[1] - contentList.ptr[0] : mContentCount; }
+
+  /** Convert range-based contents from list of ranges to CompressedSet */
+  void compress( SetListPool* pool );
+
+  /** Convert range-based contents from CompressedSet to list of ranges */
+  void decompress( SetListPool* pool );
 
 public:  
     //! Possible values of mParentCount and mChildCount
   enum Count { ZERO=0, ONE=1, TWO=2, MANY=3 };
+    //! Range-based sets with at least this many ranges of handles are
+    //! stored in a CompressedSet if the average range is short.  Sets
+    //! with less than half this many handles revert to a list of ranges.
+  enum { COMPRESS_MIN_RANGES = 4096 };
     //! If the number of entities is less than 3, store
     //! the handles directly in the hnd member.  Otherwise
     //! use the ptr member to hold the beginning and end
@@ -205,6 +248,7 @@ public:
   union CompactList {
     EntityHandle hnd[2];  //!< Two handles
     EntityHandle* ptr[2]; //!< begin and end pointers for array
+    CompressedSet* cset;  //!< compressed contents (see mCompressed)
   };
 
 private:
@@ -224,6 +268,9 @@ private:
   //! contentList.hnd.  If MANY, then contentList.ptr contains
   //! array begin and end pointers for a dynamically allocated array..
   unsigned mContentCount : 2;
+  //! If set, contentList.cset holds the (non-empty) contents of a
+  //! range-based set and mContentCount is MANY.
+  unsigned mCompressed : 1;
   //! Storage for data lists
   CompactList parentMeshSets, childMeshSets, contentList;
 
@@ -309,30 +356,30 @@ inline MeshSet::hdl_iter::difference_type
 
   //! create an empty meshset
 MeshSet::MeshSet()
-  : mFlags(0), mParentCount(ZERO), mChildCount(ZERO), mContentCount(ZERO)
+  : mFlags(0), mParentCount(ZERO), mChildCount(ZERO), mContentCount(ZERO), mCompressed(0)
 { }
 
   //! create an empty meshset
 MeshSet::MeshSet(unsigned flg)
-        : mFlags((unsigned char)flg), mParentCount(ZERO), mChildCount(ZERO), mContentCount(ZERO)
+        : mFlags((unsigned char)flg), mParentCount(ZERO), mChildCount(ZERO), mContentCount(ZERO), mCompressed(0)
 { }
 
   //! destructor
 MeshSet::~MeshSet() 
 {
-  if (mChildCount == MANY)
-    free( childMeshSets.ptr[0] );
-  if (mParentCount == MANY)
-    free( parentMeshSets.ptr[0] );
-  if (mContentCount == MANY)
-    free( contentList.ptr[0] );
+    // Handle lists are owned by the SetListPool.  clear_all returns
+    // them to the pool before a set is deleted; SequenceManager::clear
+    // releases the whole pool after destroying all sets.
+  if (mCompressed)
+    delete contentList.cset;
   mChildCount = mParentCount = mContentCount = ZERO;
+  mCompressed = 0;
 }
   
-ErrorCode MeshSet::set_flags( unsigned flg, EntityHandle my_handle, AEntityFactory* adjacencies ) 
+ErrorCode MeshSet::set_flags( unsigned flg, EntityHandle my_handle, AEntityFactory* adjacencies, SetListPool* pool ) 
 {
   if(ZERO != mContentCount) {
-    ErrorCode result = convert(flg, my_handle, adjacencies);
+    ErrorCode result = convert(flg, my_handle, adjacencies, pool);
     if(MB_SUCCESS != result) return result;
   }
   mFlags = (unsigned char)flg;
@@ -380,30 +427,34 @@ int MeshSet::num_parents() const
     return parentMeshSets.ptr[1] - parentMeshSets.ptr[0];
 }
   
-inline ErrorCode MeshSet::clear( EntityHandle myhandle, AEntityFactory* adjacencies )
+inline ErrorCode MeshSet::clear( EntityHandle myhandle, AEntityFactory* adjacencies, SetListPool* pool )
 { 
   if (tracking())
     remove_adjacencies( myhandle, adjacencies );
-  if (mContentCount == MANY)
-    free( contentList.ptr[0] );
+  if (mCompressed)
+    delete contentList.cset;
+  else if (mContentCount == MANY)
+    pool->deallocate( contentList.ptr[0], contentList.ptr[1] - contentList.ptr[0] );
   mContentCount = ZERO;
+  mCompressed = 0;
   return MB_SUCCESS;
 }
   
-inline ErrorCode MeshSet::clear_all( EntityHandle myhandle, AEntityFactory* adjacencies )
+inline ErrorCode MeshSet::clear_all( EntityHandle myhandle, AEntityFactory* adjacencies, SetListPool* pool )
 { 
-  ErrorCode rval = clear( myhandle, adjacencies );
+  ErrorCode rval = clear( myhandle, adjacencies, pool );
   if (mChildCount == MANY)
-    free( childMeshSets.ptr[0] );
+    pool->deallocate( childMeshSets.ptr[0], childMeshSets.ptr[1] - childMeshSets.ptr[0] );
   mChildCount = ZERO;
   if (mParentCount == MANY)
-    free( parentMeshSets.ptr[0] );
+    pool->deallocate( parentMeshSets.ptr[0], parentMeshSets.ptr[1] - parentMeshSets.ptr[0] );
   mParentCount = ZERO;
   return rval;
 }
 
 inline const EntityHandle* MeshSet::get_contents( size_t& count_out ) const
 {
+  assert( !mCompressed );
   if (mContentCount == MANY) {
     count_out = contentList.ptr[1] - contentList.ptr[0];
     return contentList.ptr[0];
@@ -414,8 +465,20 @@ inline const EntityHandle* MeshSet::get_contents( size_t& count_out ) const
   }
 }
 
+inline const EntityHandle* MeshSet::get_contents( size_t& count_out,
+                                                  std::vector<EntityHandle>& storage ) const
+{
+  if (!mCompressed)
+    return get_contents( count_out );
+  
+  contentList.cset->get_pairs( storage );
+  count_out = storage.size();
+  return count_out ? &storage[0] : 0;
+}
+
 inline EntityHandle* MeshSet::get_contents( size_t& count_out )
 {
+  assert( !mCompressed );
   if (mContentCount == MANY) {
     count_out = contentList.ptr[1] - contentList.ptr[0];
     return contentList.ptr[0];
@@ -428,6 +491,10 @@ inline EntityHandle* MeshSet::get_contents( size_t& count_out )
 
 inline ErrorCode MeshSet::get_entities(std::vector<EntityHandle>& entities) const
 {
+  if (mCompressed) {
+    contentList.cset->get_entities( 0, ~(EntityHandle)0, entities );
+    return MB_SUCCESS;
+  }
   size_t count;
   const EntityHandle* ptr = get_contents( count );
   if (vector_based()) {
@@ -445,16 +512,18 @@ inline ErrorCode MeshSet::get_entities(std::vector<EntityHandle>& entities) cons
 
 inline ErrorCode MeshSet::get_entities(Range& entities) const
 {
+  if (mCompressed) {
+    contentList.cset->get_entities( 0, ~(EntityHandle)0, entities );
+    return MB_SUCCESS;
+  }
   size_t count;
   const EntityHandle* ptr = get_contents( count );
   if (vector_based()) {
-    std::copy( ptr, ptr+count, range_inserter(entities) );
+    entities.insert( ptr, ptr+count );
   }
   else {
     assert(count%2 == 0);
-    Range::iterator in = entities.begin();
-    for (size_t i = 0; i < count; i += 2) 
-      in = entities.insert( in, ptr[i], ptr[i+1] );
+    entities.insert_sorted_pairs( ptr, count/2 );
   }
   return MB_SUCCESS;
 } 
@@ -465,12 +534,17 @@ inline ErrorCode MeshSet::get_entities_by_type(EntityType type,
                                                std::vector<EntityHandle> &entity_list
                                                ) const
 {
-  size_t count;
-  const EntityHandle* ptr = get_contents( count );
   if (MBMAXTYPE == type) {
     return get_entities( entity_list);
   }
-  else if (vector_based()) {
+  else if (mCompressed) {
+    contentList.cset->get_entities( FIRST_HANDLE(type), LAST_HANDLE(type), entity_list );
+    return MB_SUCCESS;
+  }
+
+  size_t count;
+  const EntityHandle* ptr = get_contents( count );
+  if (vector_based()) {
     std::remove_copy_if( ptr, ptr+count, 
                          std::back_inserter( entity_list ),
                          not_type_test(type) );
@@ -501,12 +575,17 @@ inline ErrorCode MeshSet::get_entities_by_type(EntityType type,
 inline ErrorCode MeshSet::get_entities_by_type( EntityType type,
                                                     Range& entity_list) const
 {
-  size_t count;
-  const EntityHandle* ptr = get_contents( count );
   if (MBMAXTYPE == type) {
     return get_entities( entity_list );
   }
-  else if (vector_based()) {
+  else if (mCompressed) {
+    contentList.cset->get_entities( FIRST_HANDLE(type), LAST_HANDLE(type), entity_list );
+    return MB_SUCCESS;
+  }
+
+  size_t count;
+  const EntityHandle* ptr = get_contents( count );
+  if (vector_based()) {
     std::remove_copy_if( ptr, ptr+count, 
                          range_inserter( entity_list ),
                          not_type_test(type) );
@@ -537,13 +616,17 @@ inline ErrorCode MeshSet::get_entities_by_type( EntityType type,
   //! return the number of entities with the given type contained in this meshset
 inline unsigned int MeshSet::num_entities_by_type(EntityType type) const
 {
-  unsigned int result;
-  size_t count;
-  const EntityHandle* ptr = get_contents( count );
   if (MBMAXTYPE == type) {
     return num_entities( );
   }
-  else if (vector_based()) {
+  else if (mCompressed) {
+    return contentList.cset->count( FIRST_HANDLE(type), LAST_HANDLE(type) );
+  }
+
+  unsigned int result;
+  size_t count;
+  const EntityHandle* ptr = get_contents( count );
+  if (vector_based()) {
     #ifndef __SUNPRO_CC
       result = std::count_if( ptr, ptr+count, type_test(type) );
     #else
@@ -577,6 +660,11 @@ inline ErrorCode MeshSet::get_entities_by_dimension( int dimension,
                                                          std::vector<EntityHandle> &entity_list
                                                          ) const
 {
+  if (mCompressed) {
+    contentList.cset->get_entities( FIRST_OF_DIM(dimension), LAST_OF_DIM(dimension), entity_list );
+    return MB_SUCCESS;
+  }
+
   size_t count;
   const EntityHandle* ptr = get_contents( count );
   if (vector_based()) {
@@ -610,6 +698,11 @@ inline ErrorCode MeshSet::get_entities_by_dimension( int dimension,
 inline ErrorCode MeshSet::get_entities_by_dimension( int dimension,
                                                          Range& entity_list) const
 {
+  if (mCompressed) {
+    contentList.cset->get_entities( FIRST_OF_DIM(dimension), LAST_OF_DIM(dimension), entity_list );
+    return MB_SUCCESS;
+  }
+
   size_t count;
   const EntityHandle* ptr = get_contents( count );
   if (vector_based()) {
@@ -643,6 +736,9 @@ inline ErrorCode MeshSet::get_entities_by_dimension( int dimension,
   //! return the number of entities with the given type contained in this meshset
 inline unsigned int MeshSet::num_entities_by_dimension(int dimension) const
 {
+  if (mCompressed)
+    return contentList.cset->count( FIRST_OF_DIM(dimension), LAST_OF_DIM(dimension) );
+
   unsigned int result;
   size_t count;
   const EntityHandle* ptr = get_contents( count );
@@ -678,6 +774,11 @@ inline unsigned int MeshSet::num_entities_by_dimension(int dimension) const
 
 inline ErrorCode MeshSet::get_non_set_entities( Range& range ) const
 {
+  if (mCompressed) {
+    contentList.cset->get_entities( 0, LAST_HANDLE( MBENTITYSET - 1 ), range );
+    return MB_SUCCESS;
+  }
+
   size_t count;
   const EntityHandle* ptr = get_contents( count );
   if (vector_based()) {
@@ -705,6 +806,14 @@ inline bool MeshSet::contains_entities(const EntityHandle *entities,
                                          int num_ents,
                                          const int op) const
 {
+  if (mCompressed) {
+    int found_count = 0;
+    for (int i = 0; i < num_ents; ++i)
+      if (contentList.cset->contains( entities[i] ))
+        ++found_count;
+    return found_count >= ((Interface::INTERSECT == op) ? num_ents : 1);
+  }
+
   size_t count;
   const EntityHandle* const ptr = get_contents( count );
   const EntityHandle* const end = ptr + count;
@@ -731,51 +840,68 @@ inline bool MeshSet::contains_entities(const EntityHandle *entities,
 //! subtract/intersect/unite meshset_2 from/with/into meshset_1; modifies meshset_1
 inline ErrorCode MeshSet::subtract(const MeshSet *meshset_2,
                                        EntityHandle my_handle,
-                                       AEntityFactory* adjacencies)
+                                       AEntityFactory* adjacencies,
+                                       SetListPool* pool)
 {
+  if (meshset_2->compressed()) {
+    Range other;
+    meshset_2->get_entities( other );
+    return remove_entity_ranges( other, my_handle, adjacencies, pool );
+  }
+
   size_t count;
   const EntityHandle* const ptr = meshset_2->get_contents( count );
   if (meshset_2->vector_based()) 
-    return remove_entity_vector( ptr, count, my_handle, adjacencies );
+    return remove_entity_vector( ptr, count, my_handle, adjacencies, pool );
   else
-    return remove_entity_ranges( ptr, count, my_handle, adjacencies );
+    return remove_entity_ranges( ptr, count, my_handle, adjacencies, pool );
 }
 
 inline ErrorCode MeshSet::unite(const MeshSet *meshset_2,
                                     EntityHandle my_handle,
-                                    AEntityFactory* adjacencies)
+                                    AEntityFactory* adjacencies,
+                                    SetListPool* pool)
 {
+  if (meshset_2->compressed()) {
+    Range other;
+    meshset_2->get_entities( other );
+    return insert_entity_ranges( other, my_handle, adjacencies, pool );
+  }
+
   size_t count;
   const EntityHandle* const ptr = meshset_2->get_contents( count );
   if (meshset_2->vector_based()) 
-    return insert_entity_vector( ptr, count, my_handle, adjacencies );
+    return insert_entity_vector( ptr, count, my_handle, adjacencies, pool );
   else
-    return insert_entity_ranges( ptr, count, my_handle, adjacencies );
+    return insert_entity_ranges( ptr, count, my_handle, adjacencies, pool );
 }
 
 //! add these entities to this meshset
 inline ErrorCode MeshSet::add_entities(const EntityHandle *entity_handles,
                                            const int num_ents,
                                            EntityHandle my_handle,
-                                           AEntityFactory* adjacencies)
+                                           AEntityFactory* adjacencies,
+                                           SetListPool* pool)
 {
-  return insert_entity_vector( entity_handles, num_ents, my_handle, adjacencies );
+  return insert_entity_vector( entity_handles, num_ents, my_handle, adjacencies, pool );
 }
 
   //! add these entities to this meshset
 inline ErrorCode MeshSet::add_entities(const Range &entities,
                                            EntityHandle my_handle,
-                                           AEntityFactory* adjacencies)
+                                           AEntityFactory* adjacencies,
+                                           SetListPool* pool)
 {
-  return insert_entity_ranges( entities, my_handle, adjacencies );
+  return insert_entity_ranges( entities, my_handle, adjacencies, pool );
 }
 
   //! add these entities to this meshset
 inline ErrorCode MeshSet::remove_entities(const Range& entities,
                                               EntityHandle my_handle,
-                                              AEntityFactory* adjacencies)
+                                              AEntityFactory* adjacencies,
+                                              SetListPool* pool)
 {
-  return remove_entity_ranges(  entities, my_handle, adjacencies );
+  return remove_entity_ranges(  entities, my_handle, adjacencies, pool );
 }
 
 
@@ -783,14 +909,18 @@ inline ErrorCode MeshSet::remove_entities(const Range& entities,
 inline ErrorCode MeshSet::remove_entities(const EntityHandle *entities,
                                               const int num_ents,
                                               EntityHandle my_handle,
-                                              AEntityFactory* adjacencies)
+                                              AEntityFactory* adjacencies,
+                                              SetListPool* pool)
 {
-  return remove_entity_vector( entities, num_ents, my_handle, adjacencies );
+  return remove_entity_vector( entities, num_ents, my_handle, adjacencies, pool );
 }
 
   //! return the number of entities contained in this meshset
 unsigned int MeshSet::num_entities() const
 {
+  if (mCompressed)
+    return contentList.cset->size();
+
   size_t count;
   const EntityHandle* list = get_contents( count );
   if (vector_based())
@@ -448,6 +448,14 @@ ErrorCode MeshSetSequence::get_parent_child_meshsets( EntityHandle meshset,
       
       switch (link_type) {
       case CONTAINED:
+        if (ms_ptr->compressed()) {
+          Range sets;
+          ms_ptr->get_entities_by_type( MBENTITYSET, sets );
+          for (Range::iterator j = sets.begin(); j != sets.end(); ++j)
+            if (visited.insert(*j).second)
+              lists[1-index].push_back(*j);
+          continue;
+        }
         tmp_array = ms_ptr->get_contents(n);
         end = tmp_array + n;
         if (ms_ptr->vector_based()) {
@@ -22,8 +22,12 @@
 #include "Internals.hpp"
 #include "moab/Interface.hpp"
 #include "moab/CN.hpp"
+#include "moab/ReadUtilIface.hpp"
+#include "ThreadPool.hpp"
 
 #include <assert.h>
+#include <algorithm>
+#include <map>
 
 #define RR {if (MB_SUCCESS != result) return result;}
 
@@ -45,6 +49,282 @@ ErrorCode MeshTopoUtil::construct_aentities(const Range &vertices)
   return result;
 }
 
+namespace {
+
+  //! a side of an element, identified by its sorted corner vertices
+struct SideKey 
+{
+  EntityHandle corners[4]; //!< sorted corner vertices, padded with zeros
+  EntityHandle element;    //!< element having this side, or the side itself
+  const EntityHandle* conn;//!< connectivity of element
+  short numNodes;          //!< number of nodes in element
+  short side;              //!< side number in element
+
+    //! sort and pad the first num_corners corners
+  void set_corners( int num_corners )
+  {
+    std::sort( corners, corners + num_corners );
+    std::fill( corners + num_corners, corners + 4, (EntityHandle)0 );
+  }
+  
+  bool same_side( const EntityHandle* other_corners ) const
+    { return std::equal( corners, corners + 4, other_corners ); }
+  
+  size_t hash() const
+  {
+    size_t h = 0;
+    for (int i = 0; i < 4; ++i)
+      h = (h ^ corners[i]) * 1099511628211ul;
+    return h ^ (h >> 29);
+  }
+};
+
+  //! contiguous elements of one type with connectivity in one array
+struct ElemBlock
+{
+  EntityHandle start;
+  const EntityHandle* conn;
+  int count, numNodes, numSides;
+  size_t keyOffset;
+};
+
+  //! generate keys for a chunk of elements in construct_sides
+class SideKeyTask : public ThreadTask
+{
+public:
+  static const int CHUNK_SIZE = 16384;
+  
+  SideKeyTask( int dim, const std::vector<ElemBlock>& blocks, std::vector<SideKey>& keys )
+    : sideDim(dim), elemBlocks(blocks), sideKeys(keys)
+  {
+    for (size_t b = 0; b < blocks.size(); ++b) 
+      for (int i = 0; i < blocks[b].count; i += CHUNK_SIZE) {
+        Chunk chunk = { b, i, std::min( (int)CHUNK_SIZE, blocks[b].count - i ) };
+        chunkList.push_back( chunk );
+      }
+  }
+  
+  size_t num_chunks() const { return chunkList.size(); }
+  
+  ErrorCode execute( size_t item )
+  {
+    const Chunk& c = chunkList[item];
+    const ElemBlock& block = elemBlocks[c.block];
+    const EntityType type = TYPE_FROM_HANDLE(block.start);
+    SideKey* key = &sideKeys[block.keyOffset + (size_t)c.first * block.numSides];
+    for (int e = c.first; e < c.first + c.count; ++e) {
+      const EntityHandle* conn = block.conn + (size_t)e * block.numNodes;
+      for (int s = 0; s < block.numSides; ++s, ++key) {
+        EntityType side_type;
+        int num_corners;
+        const short* indices = CN::SubEntityVertexIndices( type, sideDim, s, side_type, num_corners );
+        for (int i = 0; i < num_corners; ++i)
+          key->corners[i] = conn[indices[i]];
+        key->set_corners( num_corners );
+        key->element = block.start + e;
+        key->conn = conn;
+        key->numNodes = block.numNodes;
+        key->side = s;
+      }
+    }
+    return MB_SUCCESS;
+  }
+
+private:
+  struct Chunk { size_t block; int first, count; };
+  
+  int sideDim;
+  const std::vector<ElemBlock>& elemBlocks;
+  std::vector<SideKey>& sideKeys;
+  std::vector<Chunk> chunkList;
+};
+
+} // namespace
+
+ErrorCode MeshTopoUtil::construct_sides(const Range &elements, const int dim,
+                                        Range &new_sides,
+                                        const bool record_adjacencies,
+                                        const unsigned num_threads)
+{
+  if (dim < 1 || dim > 2) return MB_TYPE_OUT_OF_RANGE;
+  
+  ErrorCode result;
+  std::vector<ElemBlock> blocks;
+  std::vector<EntityHandle> poly_elems, storage, tmp_storage;
+  std::vector<size_t> storage_offsets;
+  size_t num_keys = 0;
+  
+    // collect blocks of element connectivity, copying it for elements 
+    // without a connectivity array (i.e. structured elements)
+  Range::const_iterator it = elements.lower_bound( CN::TypeDimensionMap[dim+1].first );
+  while (it != elements.end()) {
+    const EntityType type = TYPE_FROM_HANDLE(*it);
+    if (MBENTITYSET == type)
+      break;
+    if (MBPOLYGON == type || MBPOLYHEDRON == type) {
+      poly_elems.push_back( *it );
+      ++it;
+      continue;
+    }
+    
+    ElemBlock block;
+    block.start = *it;
+    block.numSides = CN::NumSubEntities( type, dim );
+    block.keyOffset = num_keys;
+    EntityHandle* conn;
+    if (MB_SUCCESS == mbImpl->connect_iterate( it, elements.end(), conn, 
+                                               block.numNodes, block.count )) {
+      block.conn = conn;
+      blocks.push_back( block );
+      storage_offsets.push_back( 0 );
+    }
+    else {
+        // copy connectivity for the rest of the contiguous handles, stopping
+        // at any change in the number of nodes
+      const EntityHandle last = *it.end_of_block();
+      const EntityHandle* tmp_conn;
+      int len;
+      storage_offsets.push_back( storage.size() );
+      block.conn = 0;
+      block.numNodes = -1;
+      for (block.count = 0; block.start + block.count <= last; ++block.count) {
+        const EntityHandle h = block.start + block.count;
+        if (TYPE_FROM_HANDLE(h) != type) break;
+        result = mbImpl->get_connectivity( h, tmp_conn, len, false, &tmp_storage );RR;
+        if (block.numNodes != len && block.count) break;
+        block.numNodes = len;
+        storage.insert( storage.end(), tmp_conn, tmp_conn + len );
+      }
+      blocks.push_back( block );
+    }
+    
+    num_keys += (size_t)block.count * block.numSides;
+    it += block.count;
+  }
+  for (size_t b = 0; b < blocks.size(); ++b)
+    if (!blocks[b].conn)
+      blocks[b].conn = &storage[storage_offsets[b]];
+  
+    // generate keys for all sides in parallel
+  std::vector<SideKey> keys( num_keys );
+  {
+    SideKeyTask key_task( dim, blocks, keys );
+    ThreadPool pool( num_threads );
+    result = pool.run( key_task, key_task.num_chunks() );RR;
+  }
+  
+    // existing sides, to be reused
+  Range existing;
+  result = mbImpl->get_entities_by_dimension( 0, dim, existing );RR;
+  std::vector<SideKey> old_keys;
+  old_keys.reserve( existing.size() );
+  for (it = existing.begin(); it != existing.end(); ++it) {
+    if (MBPOLYGON == TYPE_FROM_HANDLE(*it)) continue;
+    const EntityHandle* conn;
+    int len;
+    result = mbImpl->get_connectivity( *it, conn, len, true, &tmp_storage );RR;
+    SideKey key;
+    std::copy( conn, conn + len, key.corners );
+    key.set_corners( len );
+    key.element = *it;
+    old_keys.push_back( key );
+  }
+  
+    // find the distinct sides with an open-addressing hash table of 
+    // group indices (plus one, zero marking empty slots), keeping for each 
+    // group its first side key or existing entity; the table is kept at
+    // most half full so that probing always reaches an empty slot
+  size_t table_size = 16;
+  while (table_size < 2 * (num_keys + old_keys.size()))
+    table_size *= 2;
+  std::vector<size_t> table( table_size, 0 );
+  std::vector<const SideKey*> group_keys;
+  std::vector<EntityHandle> side_handles;
+  std::vector<size_t> key_groups( num_keys );
+  for (size_t k = 0; k < old_keys.size() + num_keys; ++k) {
+    const bool old = k < old_keys.size();
+    const SideKey& key = old ? old_keys[k] : keys[k - old_keys.size()];
+    size_t slot = key.hash() & (table_size - 1);
+    while (table[slot] && !key.same_side( group_keys[table[slot]-1]->corners ))
+      slot = (slot + 1) & (table_size - 1);
+    if (!table[slot]) {
+      group_keys.push_back( &key );
+      side_handles.push_back( old ? key.element : 0 );
+      table[slot] = group_keys.size();
+    }
+    if (!old)
+      key_groups[k - old_keys.size()] = table[slot] - 1;
+  }
+  std::vector<size_t>().swap( table );
+  
+    // group sides to create by type and number of nodes
+  typedef std::map< std::pair<EntityType,int>, std::vector<size_t> > NewSideMap;
+  NewSideMap new_groups;
+  for (size_t g = 0; g < group_keys.size(); ++g) {
+    if (side_handles[g]) continue;
+    const SideKey& key = *group_keys[g];
+    EntityType side_type;
+    int num_nodes, indices[27];
+    CN::SubEntityNodeIndices( TYPE_FROM_HANDLE(key.element), key.numNodes, dim, key.side,
+                              side_type, num_nodes, indices );
+    new_groups[std::make_pair( side_type, num_nodes )].push_back( g );
+  }
+  
+    // create new sides in one sequence per type and number of nodes, 
+    // using the connectivity of the side in the first element having it
+  if (!new_groups.empty()) {
+    ReadUtilIface* read_iface;
+    result = mbImpl->query_interface( read_iface );RR;
+    for (NewSideMap::const_iterator m = new_groups.begin(); m != new_groups.end(); ++m) {
+      const std::vector<size_t>& groups = m->second;
+      const int num_nodes = m->first.second;
+      EntityHandle start, *conn;
+      result = read_iface->get_element_connect( groups.size(), num_nodes, m->first.first, 
+                                                0, start, conn );
+      if (MB_SUCCESS != result) break;
+      for (size_t i = 0; i < groups.size(); ++i) {
+        const SideKey& key = *group_keys[groups[i]];
+        EntityType side_type;
+        int n, indices[27];
+        CN::SubEntityNodeIndices( TYPE_FROM_HANDLE(key.element), key.numNodes, dim, key.side,
+                                  side_type, n, indices );
+        for (int j = 0; j < num_nodes; ++j)
+          conn[i*num_nodes + j] = key.conn[indices[j]];
+        side_handles[groups[i]] = start + i;
+      }
+      result = read_iface->update_adjacencies( start, groups.size(), num_nodes, conn );
+      if (MB_SUCCESS != result) break;
+      new_sides.insert( start, start + groups.size() - 1 );
+    }
+    mbImpl->release_interface( read_iface );
+    RR;
+  }
+  
+  if (record_adjacencies) {
+    for (size_t k = 0; k < num_keys; ++k) {
+      result = mbImpl->add_adjacencies( keys[k].element, &side_handles[key_groups[k]], 1, true );RR;
+    }
+  }
+  
+    // sides of polygons and polyhedra are created one element at a time
+  if (!poly_elems.empty()) {
+    Range before, after;
+    result = mbImpl->get_entities_by_dimension( 0, dim, before );RR;
+    std::vector<EntityHandle> sides;
+    for (size_t i = 0; i < poly_elems.size(); ++i) {
+      sides.clear();
+      result = mbImpl->get_adjacencies( &poly_elems[i], 1, dim, true, sides );RR;
+      if (record_adjacencies && !sides.empty()) {
+        result = mbImpl->add_adjacencies( poly_elems[i], &sides[0], sides.size(), true );RR;
+      }
+    }
+    result = mbImpl->get_entities_by_dimension( 0, dim, after );RR;
+    new_sides.merge( subtract( after, before ) );
+  }
+  
+  return MB_SUCCESS;
+}
+
 //! given an entity, get its average position (avg vertex locations)
 ErrorCode MeshTopoUtil::get_average_position(Range &entities,
                                                double *avg_position) 
@@ -0,0 +1,141 @@
+#include "moab/ParallelFor.hpp"
+#include "moab/ChunkIterator.hpp"
+#include "moab/Interface.hpp"
+#include "moab/Range.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace moab {
+
+  // Split entities into chunks and run the task for each chunk
+class ParallelForChunks : public ThreadTask
+{
+public:
+  static const int DEFAULT_CHUNK_SIZE = 16384;
+
+  ParallelForChunks( ChunkTask& task ) : chunkTask( task ) {}
+
+    // Gather all chunks, using ChunkIterator to find the storage
+  ErrorCode get_chunks( Interface* mb,
+                        const Range& entities,
+                        bool coordinates,
+                        bool connectivity,
+                        const Tag* tags,
+                        int num_tags,
+                        int max_chunk_size )
+  {
+    if (max_chunk_size < 1)
+      max_chunk_size = DEFAULT_CHUNK_SIZE;
+
+    ChunkIterator iter( mb, entities, coordinates, connectivity, tags, num_tags );
+    ErrorCode rval = iter.reset();
+    if (MB_SUCCESS != rval)
+      return rval;
+    std::vector<int> tag_bytes( num_tags );
+    for (int t = 0; t < num_tags; ++t) {
+      rval = mb->tag_get_bytes( tags[t], tag_bytes[t] );
+      if (MB_SUCCESS != rval)
+        return rval;
+    }
+
+    size_t index = 0;
+    for (; MB_SUCCESS == rval && !iter.at_end(); rval = iter.next()) {
+      for (int off = 0; off < iter.count(); off += max_chunk_size) {
+        chunkList.push_back( EntityChunk() );
+        EntityChunk& c = chunkList.back();
+        c.startHandle = iter.start_handle() + off;
+        c.chunkCount = std::min( max_chunk_size, iter.count() - off );
+        c.rangeIndex = index + off;
+        std::fill( c.coordPtrs, c.coordPtrs + 3, (double*)0 );
+        std::fill( c.floatPtrs, c.floatPtrs + 3, (float*)0 );
+        if (coordinates && iter.float_coordinates()) {
+          c.floatPtrs[0] = iter.x_float() + off;
+          c.floatPtrs[1] = iter.y_float() + off;
+          c.floatPtrs[2] = iter.z_float() + off;
+        }
+        else if (coordinates) {
+          c.coordPtrs[0] = iter.x() + off;
+          c.coordPtrs[1] = iter.y() + off;
+          c.coordPtrs[2] = iter.z() + off;
+        }
+        c.nodesPerElem = connectivity ? iter.nodes_per_element() : 0;
+        c.connPtr = connectivity ? iter.connectivity() + (size_t)off * c.nodesPerElem : 0;
+        c.tagPtrs.resize( num_tags );
+        for (int t = 0; t < num_tags; ++t)
+          c.tagPtrs[t] = reinterpret_cast<char*>(iter.tag_data(t)) + (size_t)off * tag_bytes[t];
+      }
+      index += iter.count();
+    }
+    return rval;
+  }
+
+  size_t num_chunks() const { return chunkList.size(); }
+
+  ErrorCode execute( size_t item )
+    { return chunkTask.execute( chunkList[item] ); }
+
+private:
+  ChunkTask& chunkTask;
+  std::vector<EntityChunk> chunkList;
+};
+
+ErrorCode parallel_for( Interface* mb,
+                        const Range& entities,
+                        ChunkTask& task,
+                        bool coordinates,
+                        bool connectivity,
+                        const Tag* tags,
+                        int num_tags,
+                        unsigned num_threads,
+                        int max_chunk_size )
+{
+    // The *_iterate methods may allocate storage, so find
+    // all chunks before starting any threads.
+  ParallelForChunks chunks( task );
+  ErrorCode rval = chunks.get_chunks( mb, entities, coordinates, connectivity,
+                                      tags, num_tags, max_chunk_size );
+  if (MB_SUCCESS != rval)
+    return rval;
+
+  ThreadPool pool( num_threads );
+  return pool.run( chunks, chunks.num_chunks() );
+}
+
+ErrorCode parallel_for( Interface* mb,
+                        EntityType type,
+                        ChunkTask& task,
+                        bool coordinates,
+                        bool connectivity,
+                        const Tag* tags,
+                        int num_tags,
+                        unsigned num_threads,
+                        int max_chunk_size )
+{
+  Range entities;
+  ErrorCode rval = mb->get_entities_by_type( 0, type, entities );
+  if (MB_SUCCESS != rval)
+    return rval;
+  return parallel_for( mb, entities, task, coordinates, connectivity,
+                       tags, num_tags, num_threads, max_chunk_size );
+}
+
+ErrorCode parallel_for( Interface* mb,
+                        int dimension,
+                        ChunkTask& task,
+                        bool coordinates,
+                        bool connectivity,
+                        const Tag* tags,
+                        int num_tags,
+                        unsigned num_threads,
+                        int max_chunk_size )
+{
+  Range entities;
+  ErrorCode rval = mb->get_entities_by_dimension( 0, dimension, entities );
+  if (MB_SUCCESS != rval)
+    return rval;
+  return parallel_for( mb, entities, task, coordinates, connectivity,
+                       tags, num_tags, num_threads, max_chunk_size );
+}
+
+} // namespace moab
@@ -32,43 +32,349 @@
 #include "moab/Range.hpp"
 #include "Internals.hpp"
 #include "moab/CN.hpp"
+#include "moab/MemoryCounter.hpp"
 #include <iostream>
 #include <string>
-
-#ifdef HAVE_BOOST_POOL_SINGLETON_POOL_HPP
-#  include <boost/pool/singleton_pool.hpp>
-   typedef boost::singleton_pool< moab::Range::PairNode , sizeof(moab::Range::PairNode) > 
-    PairAlloc;
-//   static inline moab::Range::PairNode* alloc_pair()
-//    { return new (PairAlloc::malloc()) moab::Range::PairNode; }
-   static inline moab::Range::PairNode* alloc_pair(moab::Range::PairNode* n, moab::Range::PairNode* p, moab::EntityHandle f, moab::EntityHandle s)
-    { return new (PairAlloc::malloc()) moab::Range::PairNode(n,p,f,s); }
-   static inline void free_pair( moab::Range::PairNode* node )
-    { node->~PairNode(); PairAlloc::free( node ); }
-#else
-//   static inline moab::Range::PairNode* alloc_pair()
-//    { return new moab::Range::PairNode; }
-   static inline moab::Range::PairNode* alloc_pair(moab::Range::PairNode* n, moab::Range::PairNode* p, moab::EntityHandle f, moab::EntityHandle s)
-    { return new moab::Range::PairNode(n,p,f,s); }
-   static inline void free_pair( moab::Range::PairNode* node )
-    { delete node; }
-#endif
+#include <algorithm>
+#include <new>
 
 namespace moab {
 
-/*! 
-  returns the number of values this list represents
- */
-size_t Range::size() const
+Range::PairNode Range::emptySentinels[2];
+bool Range::countMemory = false;
+
+static inline EntityHandle pair_size( const Range::PairNode* node )
+  { return node->second - node->first + 1; }
+
+  // compare a pair to a handle by the end of the pair
+struct PairEndLess {
+  bool operator()( const Range::PairNode& node, EntityHandle h ) const
+    { return node.second < h; }
+};
+
+  // compare a pair to a handle by the start of the pair
+struct PairStartNotAfter {
+  bool operator()( const Range::PairNode& node, EntityHandle h ) const
+    { return node.first <= h; }
+};
+
+  // compare a position in a range to the running count of a pair
+struct PairCountLess {
+  EntityHandle base;
+  PairCountLess( EntityHandle b ) : base(b) {}
+  bool operator()( EntityHandle pos, const Range::PairNode& node ) const
+    { return pos < node.mCount - base; }
+};
+
+Range::PairNode* Range::find_pair( EntityHandle val ) const
 {
-  // go through each pair and add up the number of values
-  // we have.
-  size_t sz=0;
-  for(PairNode* iter = mHead.mNext; iter != &mHead; iter = iter->mNext)
+  return std::lower_bound( mFirst, mLast, val, PairEndLess() );
+}
+
+  // Find the first pair in [iter,end) for which less(pair,val) is
+  // false, searching in exponentially increasing steps from iter.
+  // Used by the set operations to skip runs of pairs in one range
+  // in time logarithmic in the length of the run.
+template <class Compare> static inline 
+const Range::PairNode* gallop( const Range::PairNode* iter, 
+                               const Range::PairNode* end,
+                               EntityHandle val,
+                               Compare less )
+{
+  if (iter == end || !less( *iter, val ))
+    return iter;
+  size_t step = 1;
+  while (step < (size_t)(end - iter) && less( iter[step], val )) {
+    iter += step;
+    step *= 2;
+  }
+  end = iter + std::min( step, (size_t)(end - iter) );
+  return std::lower_bound( iter + 1, end, val, less );
+}
+
+  // Readers for the sorted input to Range::merge_sorted.  Each 
+  // provides the current pair as 'first' and 'second', with
+  // first == 0 once the input is exhausted.
+
+  // sorted list of handles, read as runs of consecutive values
+struct SortedHandleReader {
+  const EntityHandle *iter, *end;
+  EntityHandle first, second;
+  SortedHandleReader( const EntityHandle* b, const EntityHandle* e )
+    : iter(b), end(e) 
+  { 
+    while (iter != end && !*iter)
+      ++iter;
+    advance();
+  }
+  void advance() 
+  {
+    if (iter == end) {
+      first = 0;
+      return;
+    }
+    first = second = *iter;
+    for (++iter; iter != end && *iter - second <= 1; ++iter)
+      second = *iter;
+  }
+};
+
+  // list of {first,second} pairs sorted by first value
+struct SortedPairReader {
+  const EntityHandle *iter, *end;
+  EntityHandle first, second;
+  SortedPairReader( const EntityHandle* pairs, size_t num_pairs )
+    : iter(pairs), end(pairs + 2*num_pairs)
+    { advance(); }
+  void advance()
+  {
+    for (first = 0; !first && iter != end; iter += 2) 
+      if (iter[0] <= iter[1] && iter[1]) {
+        first = iter[0] ? iter[0] : 1;
+        second = iter[1];
+      }
+  }
+};
+
+  // the values of a Range in [begin,end)
+struct RangeReader {
+  const Range::PairNode *node, *last;
+  EntityHandle stop, first, second;
+  RangeReader( const Range::PairNode* begin_node, EntityHandle begin_val,
+               const Range::PairNode* end_node, EntityHandle end_val )
+    : node(begin_node), last(end_node), stop(end_val), 
+      first(begin_val), second(begin_node->second)
+    { clip(); }
+  void clip()
   {
-    sz += ((iter->second - iter->first) + 1);
+    if (node == last) {
+      if (stop > first)
+        second = stop - 1;
+      else
+        first = 0;
+    }
+  }
+  void advance() 
+  {
+    if (node == last) {
+      first = 0;
+      return;
+    }
+    ++node;
+    first = node->first;
+    second = node->second;
+    clip();
+  }
+};
+
+void Range::append_pair( EntityHandle first, EntityHandle second )
+{
+  if (mFirst != mLast && first - 1 <= mLast[-1].second) {
+    if (second > mLast[-1].second) {
+      mLast->mCount += second - mLast[-1].second;
+      mLast[-1].second = second;
+    }
+    return;
+  }
+  
+  PairNode* node = make_gap( mLast, 1 );
+  node->first = first;
+  node->second = second;
+  node->mCount = mLast->mCount;
+  mLast->mCount += second - first + 1;
+}
+
+void Range::append_pairs( const PairNode* begin, const PairNode* end )
+{
+    // Pairs that overlap the current last pair must be merged with it.
+    // After that, the remaining pairs can be copied as a block.
+  while (begin != end && mFirst != mLast && begin->first - 1 <= mLast[-1].second) {
+    append_pair( begin->first, begin->second );
+    ++begin;
+  }
+  if (begin == end)
+    return;
+  
+  const EntityHandle offset = mLast->mCount - begin->mCount;
+  PairNode* out = make_gap( mLast, end - begin );
+  for (; begin != end; ++begin, ++out) {
+    *out = *begin;
+    out->mCount += offset;
+  }
+  mLast->mCount = end->mCount + offset;
+}
+
+template <class PairSource>
+void Range::merge_sorted( PairSource source )
+{
+  if (!source.first)
+    return;
+  
+    // If appending, just add the input to the end of this range.
+  if (empty() || source.first >= mLast[-1].first) {
+    for (; source.first; source.advance())
+      append_pair( source.first, source.second );
+    return;
+  }
+  
+    // Otherwise merge the two into new storage, copying blocks of
+    // existing pairs between input pairs.
+  Range result;
+  result.reset_storage( psize() + 4 );
+  const PairNode* iter = mFirst;
+  for (; source.first; source.advance()) {
+    const PairNode* stop = gallop( iter, mLast, source.first, PairStartNotAfter() );
+    result.append_pairs( iter, stop );
+    result.append_pair( source.first, source.second );
+    iter = stop;
   }
-  return sz;
+  result.append_pairs( iter, mLast );
+  swap( result );
+}
+
+Range::iterator Range::insert_sorted_list( const EntityHandle* begin_iter,
+                                           const EntityHandle* end_iter )
+{
+  SortedHandleReader reader( begin_iter, end_iter );
+  if (!reader.first)
+    return end();
+  EntityHandle first = reader.first;
+  merge_sorted( reader );
+  return find( first );
+}
+
+Range::iterator Range::insert_sorted_pairs( const EntityHandle* pairs,
+                                            size_t num_pairs )
+{
+  SortedPairReader reader( pairs, num_pairs );
+  if (!reader.first)
+    return end();
+  EntityHandle first = reader.first;
+  merge_sorted( reader );
+  return find( first );
+}
+
+Range::PairNode* Range::make_gap( PairNode* pos, size_t count )
+{
+  const size_t before = pos - mFirst, after = mLast - pos;
+  const size_t front_room = mBuffer ? mFirst - mBuffer - 1 : 0;
+  const size_t back_room = mBuffer ? mBufferEnd - mLast - 1 : 0;
+
+    // Move whichever side of the insertion point is shorter (and
+    // has room to move into), including its sentinel.
+  if (front_room >= count && (before <= after || back_room < count)) {
+    std::copy( mFirst - 1, pos, mFirst - 1 - count );
+    mFirst -= count;
+    return pos - count;
+  }
+  if (back_room >= count) {
+    std::copy_backward( pos, mLast + 1, mLast + 1 + count );
+    mLast += count;
+    return pos;
+  }
+
+    // Reallocate, leaving spare room at the end being appended to 
+    // (or on both sides if inserting in the middle).
+  const size_t num_pairs = before + after + count;
+  const size_t spare = std::max( num_pairs, (size_t)4 );
+  size_t front_spare;
+  if (!after)
+    front_spare = 0;
+  else if (!before)
+    front_spare = spare;
+  else
+    front_spare = spare / 2;
+
+  PairNode* buffer = allocate_buffer( num_pairs + spare + 2 );
+  PairNode* first = buffer + 1 + front_spare;
+  std::copy( mFirst - 1, pos, first - 1 );
+  std::copy( pos, mLast + 1, first + before + count );
+  free_buffer( mBuffer, mBufferEnd );
+  mBuffer = buffer;
+  mBufferEnd = buffer + num_pairs + spare + 2;
+  mFirst = first;
+  mLast = first + num_pairs;
+  return first + before;
+}
+
+Range::PairNode* Range::remove_pairs( PairNode* pos, size_t count )
+{
+  const size_t before = pos - mFirst, after = mLast - pos - count;
+  if (before < after) {
+    std::copy_backward( mFirst - 1, pos, pos + count );
+    mFirst += count;
+    return pos + count;
+  }
+  else {
+    std::copy( pos + count, mLast + 1, pos );
+    mLast -= count;
+    return pos;
+  }
+}
+
+void Range::update_counts( PairNode* begin, PairNode* end )
+{
+    // Counts are only compared relative to mFirst->mCount, so 
+    // either the counts from 'begin' through the end sentinel
+    // or those from mFirst through 'end' may be recalculated.
+  if (mLast - begin <= end - mFirst) {
+    EntityHandle count = 0;
+    if (begin != mFirst)
+      count = begin[-1].mCount + pair_size(begin-1);
+    for (; begin != mLast; ++begin) {
+      begin->mCount = count;
+      count += pair_size(begin);
+    }
+    mLast->mCount = count;
+  }
+  else {
+    EntityHandle count = end->mCount;
+    while (end != mFirst) {
+      --end;
+      count -= pair_size(end);
+      end->mCount = count;
+    }
+  }
+}
+
+Range::PairNode* Range::allocate_buffer( size_t count )
+{
+  MemoryCounter* counter = countMemory ? &MemoryCounter::category( MEM_RANGES ) : 0;
+  void* mem = MemoryCounter::allocate( count * sizeof(PairNode), counter );
+  if (!mem)
+    throw std::bad_alloc();
+  PairNode* buffer = static_cast<PairNode*>(mem);
+  for (size_t i = 0; i < count; ++i)
+    new (buffer + i) PairNode;
+  return buffer;
+}
+
+void Range::count_memory( bool enable )
+{
+  countMemory = enable;
+}
+
+bool Range::counting_memory()
+{
+  return countMemory;
+}
+
+void Range::free_buffer( PairNode* buffer, PairNode* )
+{
+    // PairNode is trivially destructible
+  MemoryCounter::deallocate( buffer );
+}
+
+void Range::reset_storage( size_t count )
+{
+  if (!mBuffer || (size_t)(mBufferEnd - mBuffer) < count + 2) {
+    free_buffer( mBuffer, mBufferEnd );
+    mBuffer = allocate_buffer( count + 2 );
+    mBufferEnd = mBuffer + count + 2;
+  }
+  mFirst = mLast = mBuffer + 1;
+  mFirst[-1] = PairNode();
+  *mLast = PairNode();
 }
 
 /*!
@@ -96,12 +402,12 @@ Range::const_iterator& Range::const_iterator::operator+=( EntityID sstep )
 
     // For each node we are stepping past, decrement step
     // by the size of the node.
-  PairNode* node = mNode->mNext;
+  PairNode* node = mNode + 1;
   EntityHandle node_size = node->second - node->first + 1;
   while (step >= node_size)
   {
     step -= node_size;
-    node = node->mNext;
+    ++node;
     node_size = node->second - node->first + 1;
   }
   
@@ -139,12 +445,12 @@ Range::const_iterator& Range::const_iterator::operator-=( EntityID sstep )
 
     // For each node we are stepping past, decrement step
     // by the size of the node.
-  PairNode* node = mNode->mPrev;
+  PairNode* node = mNode - 1;
   EntityHandle node_size = node->second - node->first + 1;
   while (step >= node_size)
   {
     step -= node_size;
-    node = node->mPrev;
+    --node;
     node_size = node->second - node->first + 1;
   }
   
@@ -160,57 +466,41 @@ Range::const_iterator& Range::const_iterator::operator-=( EntityID sstep )
 
   //! another constructor that takes an initial range
 Range::Range( EntityHandle val1, EntityHandle val2 )
+  : mFirst(emptySentinels+1), mLast(emptySentinels+1),
+    mBuffer(0), mBufferEnd(0)
 {
-  mHead.mNext = mHead.mPrev = alloc_pair(&mHead, &mHead, val1, val2);
-  mHead.first = mHead.second = 0;
+  insert( val1, val2 );
 }
 
   //! copy constructor
 Range::Range(const Range& copy)
+  : mFirst(emptySentinels+1), mLast(emptySentinels+1),
+    mBuffer(0), mBufferEnd(0)
 {
-    // set the head node to point to itself
-  mHead.mNext = mHead.mPrev = &mHead;
-  mHead.first = mHead.second = 0;
-
-  const PairNode* copy_node = copy.mHead.mNext;
-  PairNode* new_node = &mHead;
-  for(; copy_node != &(copy.mHead); copy_node = copy_node->mNext)
-  {
-    PairNode* tmp_node = alloc_pair(new_node->mNext, new_node, copy_node->first,
-                                      copy_node->second);
-    new_node->mNext->mPrev = tmp_node;
-    new_node->mNext = tmp_node;
-    new_node = tmp_node;
+  if (!copy.empty()) {
+    reset_storage( copy.psize() );
+    mLast = std::copy( copy.mFirst, copy.mLast + 1, mFirst ) - 1;
   }
 }
 
   //! clears the contents of the list 
 void Range::clear()
 {
-  PairNode* tmp_node = mHead.mNext;
-  while(tmp_node != &mHead)
-  {
-    PairNode* to_delete = tmp_node;
-    tmp_node = tmp_node->mNext;
-    free_pair( to_delete );
-  }
-  mHead.mNext = &mHead;
-  mHead.mPrev = &mHead;
+  free_buffer( mBuffer, mBufferEnd );
+  mBuffer = mBufferEnd = 0;
+  mFirst = mLast = emptySentinels + 1;
 }
 
 Range& Range::operator=(const Range& copy)
 {
-  clear();
-  const PairNode* copy_node = copy.mHead.mNext;
-  PairNode* new_node = &mHead;
-  for(; copy_node != &(copy.mHead); copy_node = copy_node->mNext)
-  {
-    PairNode* tmp_node = alloc_pair(new_node->mNext, new_node, copy_node->first,
-                                      copy_node->second);
-    new_node->mNext->mPrev = tmp_node;
-    new_node->mNext = tmp_node;
-    new_node = tmp_node;
+  if (this == &copy)
+    return *this;
+  if (copy.empty()) {
+    clear();
+    return *this;
   }
+  reset_storage( copy.psize() );
+  mLast = std::copy( copy.mFirst, copy.mLast + 1, mFirst ) - 1;
   return *this;
 }
 
@@ -221,71 +511,7 @@ Range& Range::operator=(const Range& copy)
 
 Range::iterator Range::insert( Range::iterator hint, EntityHandle val )
 {
-  // don't allow zero-valued handles in Range
-  if(val == 0)
-    return end();
-
-  // if this is empty, just add it and return an iterator to it
-  if(&mHead == mHead.mNext)
-  {
-    mHead.mNext = mHead.mPrev = alloc_pair(&mHead, &mHead, val, val);
-    return iterator(mHead.mNext, val);
-  }
-  
-  // find the location in the list where we can safely insert
-  // new items and keep it ordered
-  PairNode* hter = hint.mNode;
-  PairNode* jter = hter->first <= val ? hter : mHead.mNext;
-  for( ; (jter != &mHead) && (jter->second < val); jter=jter->mNext);
-  PairNode* iter = jter;
-  jter = jter->mPrev;
-
-  // if this val is already in the list
-  if( (iter->first <= val && iter->second >= val) && (iter != &mHead) )
-  {
-    // return an iterator pointing to this location
-    return iterator( iter, val );
-  }
-
-  // one of a few things can happen at this point
-  // 1. this range needs to be backwardly extended
-  // 2. the previous range needs to be forwardly extended
-  // 3. a new range needs to be added
-
-  
-  // extend this range back a bit
-  else if( (iter->first == (val+1)) && (iter != &mHead) )
-  {
-    iter->first = val;
-    // see if we need to merge two ranges
-    if( (iter != mHead.mNext) && (jter->second == (val-1)))
-    {
-      jter->second = iter->second;
-      iter->mPrev->mNext = iter->mNext;
-      iter->mNext->mPrev = iter->mPrev;
-      free_pair( iter );
-      return iterator( jter, val );
-    }
-    else
-    {
-      return iterator( iter, val );
-    }
-
-  }
-  // extend the previous range forward a bit
-  else if( (jter->second == (val-1)) && (iter != mHead.mNext) )
-  {
-    jter->second = val;
-    return iterator(jter, val);
-  }
-  // make a new range
-  else
-  {
-    PairNode* new_node = alloc_pair(iter, iter->mPrev, val, val);
-    iter->mPrev = new_node->mPrev->mNext = new_node;
-    return iterator(new_node, val);
-  }
-
+  return insert( hint, val, val );
 }
 
 Range::iterator Range::insert( Range::iterator prev,
@@ -295,69 +521,46 @@ Range::iterator Range::insert( Range::iterator prev,
   if(val1 == 0 || val1 > val2)
     return end();
 
-  // Empty 
-  if (mHead.mNext == &mHead)
-  {
-    assert( prev == end() );
-    PairNode* new_node = alloc_pair( &mHead, &mHead, val1, val2 );
-    mHead.mNext = mHead.mPrev = new_node;
-    return iterator( mHead.mNext, val1 );
-  }
-  
+    // Find the first pair that intersects or is adjacent to
+    // [val1,val2], or the next pair if there is none.  Check
+    // the hint and the pair after it before doing a search.
   PairNode* iter = prev.mNode;
-    // If iterator is at end, set it to last.
-    // Thus if the hint was to append, we start searching
-    // at the end of the list.
-  if (iter == &mHead) 
-    iter = mHead.mPrev;
-    // if hint (prev) is past insert position, reset it to the beginning.
-  if (iter != &mHead && iter->first > val2+1)
-    iter = mHead.mNext;
-  
-    // If hint is bogus then search backwards
-  while (iter != mHead.mNext && iter->mPrev->second >= val1-1)
-    iter = iter->mPrev;
-  
-  // Input range is before beginning?
-  if (iter->mPrev == &mHead && val2 < iter->first - 1)
-  {
-    PairNode* new_node = alloc_pair( iter, &mHead,  val1, val2 );
-    mHead.mNext = iter->mPrev = new_node;
-    return iterator( mHead.mNext, val1 );
+  if (iter < mFirst || iter > mLast)
+    iter = find_pair( val1 - 1 );
+  else if (iter != mFirst && iter[-1].second >= val1 - 1)
+    iter = find_pair( val1 - 1 );
+  else if (iter != mLast && iter->second < val1 - 1) {
+    ++iter;
+    if (iter != mLast && iter->second < val1 - 1)
+      iter = find_pair( val1 - 1 );
   }
   
-  // Find first intersecting list entry, or the next entry
-  // if none intersects.
-  while (iter != &mHead && iter->second+1 < val1)
-    iter = iter->mNext;
-  
-  // Need to insert new pair (don't intersect any existing pair)?
-  if (iter == &mHead || iter->first-1 > val2)
+    // Need to insert new pair (don't intersect any existing pair)?
+  if (iter == mLast || iter->first - 1 > val2)
   {
-    PairNode* new_node = alloc_pair( iter, iter->mPrev, val1, val2 );
-    iter->mPrev = iter->mPrev->mNext = new_node;
-    return iterator( iter->mPrev, val1 );
+    iter = make_gap( iter, 1 );
+    iter->first = val1;
+    iter->second = val2;
+    update_counts( iter, iter + 1 );
+    return iterator( iter, val1 );
   }
   
-  // Make the first intersecting pair the union of itself with [val1,val2]
+    // Make the first intersecting pair the union of itself with [val1,val2]
   if (iter->first > val1)
     iter->first = val1;
-  if (iter->second >= val2)  
-    return iterator( iter, val1 );
-  iter->second = val2;
-  
-  // Merge any remaining pairs that intersect [val1,val2]
-  while (iter->mNext != &mHead && iter->mNext->first <= val2 + 1)
-  {
-    PairNode* dead = iter->mNext;
-    iter->mNext = dead->mNext;
-    dead->mNext->mPrev = iter;
-    
-    if (dead->second > val2)
-      iter->second = dead->second;
-    free_pair( dead );
+  if (iter->second < val2) {
+      // Merge any remaining pairs that intersect [val1,val2]
+    PairNode* dead = iter + 1;
+    while (dead != mLast && dead->first - 1 <= val2)
+      ++dead;
+    iter->second = std::max( val2, dead[-1].second );
+    if (dead != iter + 1) {
+      const size_t idx = iter - mFirst;
+      remove_pairs( iter + 1, dead - iter - 1 );
+      iter = mFirst + idx;
+    }
   }
-  
+  update_counts( iter, iter + 1 );
   return iterator( iter, val1 );
 }
     
@@ -376,40 +579,39 @@ Range::iterator Range::erase(iterator iter)
   if(iter == end())
     return end();
 
-  // the iterator most likely to be returned
-  iterator new_iter = iter;
-  ++new_iter;
-
   PairNode* kter = iter.mNode;
   
   // just remove the range
   if(kter->first == kter->second)
   {
-    kter->mNext->mPrev = kter->mPrev;
-    kter->mPrev->mNext = kter->mNext;
-    free_pair( kter );
-    return new_iter;
+    kter = remove_pairs( kter, 1 );
+    update_counts( kter, kter );
+    return iterator( kter, kter->first );
   }
   // shrink it
   else if(kter->first == iter.mValue)
   {
     kter->first++;
-    return new_iter;
+    update_counts( kter, kter + 1 );
+    return iterator( kter, kter->first );
   }
   // shrink it the other way
   else if(kter->second == iter.mValue)
   {
     kter->second--;
-    return new_iter;
+    update_counts( kter, kter + 1 );
+    return iterator( kter + 1, kter[1].first );
   }
   // split the range
   else
   {
-    PairNode* new_node = alloc_pair(iter.mNode->mNext, iter.mNode, iter.mValue+1, kter->second);
-    new_node->mPrev->mNext = new_node->mNext->mPrev = new_node;
-    iter.mNode->second = iter.mValue - 1;
-    new_iter = const_iterator(new_node, new_node->first);
-    return new_iter;
+    PairNode* new_node = make_gap( kter + 1, 1 );
+    kter = new_node - 1;
+    new_node->first = iter.mValue + 1;
+    new_node->second = kter->second;
+    kter->second = iter.mValue - 1;
+    update_counts( kter, new_node + 1 );
+    return iterator( new_node, new_node->first );
   }
 
 }
@@ -418,8 +620,11 @@ Range::iterator Range::erase(iterator iter)
   //! remove a range of items from the list
 Range::iterator Range::erase( iterator iter1, iterator iter2)
 {
-  iterator result;
-  
+    // Nothing to remove.  Return before touching any pair, as an
+    // empty range may be using the sentinels shared by all ranges.
+  if (empty() || iter1 == iter2 || iter1.mNode == mLast)
+    return iter2;
+
   if (iter1.mNode == iter2.mNode) {
     if (iter2.mValue <= iter1.mValue) {
         // empty range OK, otherwise invalid input
@@ -434,60 +639,45 @@ Range::iterator Range::erase( iterator iter1, iterator iter2)
     
     PairNode* node = iter1.mNode;
     if (iter1.mValue == node->first) {
-        node->first = iter2.mValue;
-        result = iter2;
+      node->first = iter2.mValue;
+      update_counts( node, node + 1 );
+      return iterator( node, node->first );
     }
     else {
-      PairNode* new_node = alloc_pair( node->mNext, node, iter2.mValue, node->second );
-      new_node->mNext->mPrev = new_node;
-      new_node->mPrev->mNext = new_node;
+      PairNode* new_node = make_gap( node + 1, 1 );
+      node = new_node - 1;
+      new_node->first = iter2.mValue;
+      new_node->second = node->second;
       node->second = iter1.mValue - 1;
-      result = iterator( new_node, new_node->first );
+      update_counts( node, new_node + 1 );
+      return iterator( new_node, new_node->first );
     }
   }
-  else {
-    if (iter1.mNode == &mHead)
-      return iter1;
-    PairNode* dn = iter1.mNode;
-    if (iter1.mValue > dn->first) {
-      dn->second = iter1.mValue-1;
-      dn = dn->mNext;
-    }
-    if (iter2.mNode != &mHead) 
-      iter2.mNode->first = iter2.mValue;
-    while (dn != iter2.mNode) {
-      PairNode* dead = dn;
-      dn = dn->mNext;
-
-      dead->mPrev->mNext = dead->mNext;
-      dead->mNext->mPrev = dead->mPrev;
-      dead->mPrev = dead->mNext = 0;
-      delete dead;
-    }
-    
-    result = iter2;
-  }
-  
-  return result;
-}
 
-void Range::delete_pair_node( PairNode* node )
-{
-  if (node != &mHead) { // pop_front() and pop_back() rely on this check
-    node->mPrev->mNext = node->mNext;
-    node->mNext->mPrev = node->mPrev;
-    free_pair( node );
+  PairNode* dn = iter1.mNode;
+  PairNode* last = iter2.mNode;
+  if (iter1.mValue > dn->first) {
+    dn->second = iter1.mValue-1;
+    ++dn;
   }
+  if (last != mLast) 
+    last->first = iter2.mValue;
+  
+  const size_t changed = iter1.mNode - mFirst;
+  last = remove_pairs( dn, last - dn );
+  update_counts( mFirst + changed, last == mLast ? last : last + 1 );
+  return iterator( last, iter2.mValue );
 }
 
   //! remove first entity from range
 EntityHandle Range::pop_front()
 {
   EntityHandle retval = front();
-  if (mHead.mNext->first == mHead.mNext->second) // need to remove pair from range
-    delete_pair_node( mHead.mNext );
+  if (mFirst->first == mFirst->second) // need to remove pair from range
+    remove_pairs( mFirst, 1 );
   else 
-    ++(mHead.mNext->first); // otherwise just adjust start value of pair
+    ++(mFirst->first); // otherwise just adjust start value of pair
+  update_counts( mFirst, mFirst + (mFirst != mLast) );
 
   return retval;
 }
@@ -496,10 +686,11 @@ EntityHandle Range::pop_front()
 EntityHandle Range::pop_back()
 {
   EntityHandle retval = back();
-  if (mHead.mPrev->first == mHead.mPrev->second) // need to remove pair from range
-    delete_pair_node( mHead.mPrev );
+  if (mLast[-1].first == mLast[-1].second) // need to remove pair from range
+    remove_pairs( mLast - 1, 1 );
   else
-    --(mHead.mPrev->second); // otherwise just adjust end value of pair
+    --(mLast[-1].second); // otherwise just adjust end value of pair
+  update_counts( mLast - (mFirst != mLast), mLast );
 
   return retval;
 }
@@ -511,10 +702,23 @@ EntityHandle Range::pop_back()
 */
 Range::const_iterator Range::find(EntityHandle val) const
 {
-  // iterator through the list
-  PairNode* iter = mHead.mNext;
-  for( ; iter != &mHead && (val > iter->second); iter=iter->mNext );
-  return ((iter->second >= val) && (iter->first <= val)) ? const_iterator(iter,val) : end();
+  PairNode* iter = find_pair( val );
+  return (iter != mLast && iter->first <= val) ? const_iterator(iter,val) : end();
+}
+
+EntityHandle Range::operator[](EntityID indexp) const
+{
+  const PairNode* iter = std::upper_bound( mFirst, mLast, (EntityHandle)indexp,
+                                           PairCountLess(mFirst->mCount) ) - 1;
+  return iter->first + (indexp - (iter->mCount - mFirst->mCount));
+}
+
+int Range::index(EntityHandle handle) const 
+{
+  const PairNode* iter = find_pair( handle );
+  if (iter == mLast || iter->first > handle)
+    return -1;
+  return (iter->mCount - mFirst->mCount) + (handle - iter->first);
 }
 
 /*!
@@ -526,64 +730,33 @@ void Range::insert( Range::const_iterator begini,
 {
   if (begini == endi)
     return;
-  
-  PairNode* node = begini.mNode;
-  if (endi.mNode == node)
-  {
-    insert( *begini, (*endi)-1 );
+    // merging a range with itself is a no-op, and inserting could
+    // otherwise invalidate the input iterators.
+  if (begini.mNode >= mFirst && begini.mNode <= mLast)
     return;
-  }
-  
-  Range::iterator hint = insert( *begini, node->second );
-  node = node->mNext;
-  while (node != endi.mNode)
-  {
-    hint = insert( hint, node->first, node->second );
-    node = node->mNext;
-  }
   
-  if (*endi > node->first)
-  {
-    if (*endi <= node->second)
-      insert( hint, node->first, *(endi) - 1 );
-    else
-      insert( hint, node->first, node->second );
-  }
+  merge_sorted( RangeReader( begini.mNode, begini.mValue, 
+                             endi.mNode, endi.mValue ) );
 }
 
-  
-  
-
-#include <algorithm>
-
-
 // checks the range to make sure everything is A-Ok.
 void Range::sanity_check() const
 {
-  if(empty())
-    return;
+    // are the sentinels intact?
+  assert(mFirst[-1].first == 0 && mFirst[-1].second == 0);
+  assert(mLast->first == 0 && mLast->second == 0);
+  assert(mFirst <= mLast);
+  assert(!mBuffer || (mBuffer < mFirst && mLast < mBufferEnd));
 
-  const PairNode* node = mHead.mNext;
-  std::vector<const PairNode*> seen_before;
-  bool stop_it = false;
-  
-  for(; stop_it == false; node = node->mNext)
+  for(const PairNode* node = mFirst; node != mLast; ++node)
   {
-    // have we seen this node before?
-    assert(std::find(seen_before.begin(), seen_before.end(), node) == seen_before.end());
-    seen_before.push_back(node);
-
-    // is the connection correct?
-    assert(node->mNext->mPrev == node);
-
     // are the values right?
     assert(node->first <= node->second);
-    if(node != &mHead && node->mPrev != &mHead)
-      assert(node->mPrev->second < node->first);
-
-    if(node == &mHead)
-      stop_it = true;
+    if(node != mFirst)
+      assert(node[-1].second < node->first);
 
+    // is the count right?
+    assert(node[1].mCount - node->mCount == node->second - node->first + 1);
   }
 
 }
@@ -621,39 +794,29 @@ void Range::print(std::ostream& stream, const char *indent_prefix) const
 }
 
   // intersect two ranges, placing the results in the return range
-#define MAX(a,b) (a < b ? b : a)
-#define MIN(a,b) (a > b ? b : a)
 Range intersect(const Range &range1, const Range &range2) 
 {
-  Range::const_pair_iterator r_it[2] = { range1.const_pair_begin(), 
-                                           range2.const_pair_begin() };
-  EntityHandle low_it, high_it;
-  
   Range lhs;
-  Range::iterator hint = lhs.begin();
+  if (range1.empty() || range2.empty())
+    return lhs;
   
-    // terminate the while loop when at least one "start" iterator is at the
-    // end of the list
-  while (r_it[0] != range1.end() && r_it[1] != range2.end()) {
-    
-    if (r_it[0]->second < r_it[1]->first)
-        // 1st subrange completely below 2nd subrange
-      r_it[0]++;
-    else if (r_it[1]->second < r_it[0]->first) 
-        // 2nd subrange completely below 1st subrange
-      r_it[1]++;
-    
+  const Range::PairNode *r_it0 = range1.mFirst, *r_it1 = range2.mFirst;
+  while (r_it0 != range1.mLast && r_it1 != range2.mLast) {
+    if (r_it0->second < r_it1->first)
+        // skip pairs in the 1st range completely below 2nd subrange
+      r_it0 = gallop( r_it0, range1.mLast, r_it1->first, PairEndLess() );
+    else if (r_it1->second < r_it0->first) 
+        // skip pairs in the 2nd range completely below 1st subrange
+      r_it1 = gallop( r_it1, range2.mLast, r_it0->first, PairEndLess() );
     else {
         // else ranges overlap; first find greater start and lesser end
-      low_it = MAX(r_it[0]->first, r_it[1]->first);
-      high_it = MIN(r_it[0]->second, r_it[1]->second);
-      
-        // insert into result
-      hint = lhs.insert(hint, low_it, high_it);
+      EntityHandle low_it = std::max( r_it0->first, r_it1->first );
+      EntityHandle high_it = std::min( r_it0->second, r_it1->second );
+      lhs.append_pair( low_it, high_it );
       
         // now find bounds of this insertion and increment corresponding iterator
-      if (high_it == r_it[0]->second) r_it[0]++;
-      if (high_it == r_it[1]->second) r_it[1]++;
+      if (high_it == r_it0->second) ++r_it0;
+      if (high_it == r_it1->second) ++r_it1;
     }
   }
   
@@ -662,117 +825,90 @@ Range intersect(const Range &range1, const Range &range2)
 
 Range subtract(const Range &range1, const Range &range2) 
 {
-  const bool braindead = false;
-  
-  if (braindead) {
-      // brain-dead implementation right now
-    Range res( range1 );
-    for (Range::const_iterator rit = range2.begin(); rit != range2.end(); rit++)
-      res.erase(*rit);
-
-    return res;
+  Range lhs;
+  if (range2.empty()) {
+    lhs = range1;
+    return lhs;
   }
-  else {
-    Range lhs( range1 );
-  
-    Range::pair_iterator r_it0 = lhs.pair_begin();
-    Range::const_pair_iterator r_it1 = range2.const_pair_begin();
+  if (range1.empty())
+    return lhs;
   
-      // terminate the while loop when at least one "start" iterator is at the
-      // end of the list
-    while (r_it0 != lhs.end() && r_it1 != range2.end()) {
-        // case a: pair wholly within subtracted pair
-      if (r_it0->first >= r_it1->first && r_it0->second <= r_it1->second) {
-        Range::PairNode *rtmp = r_it0.node();
-        r_it0++;
-        lhs.delete_pair_node(rtmp);
-      }
-        // case b: pair overlaps upper part of subtracted pair
-      else if (r_it0->first <= r_it1->second &&
-               r_it0->first >= r_it1->first) {
-        r_it0->first = r_it1->second + 1;
-        r_it1++;
-      }
-        // case c: pair overlaps lower part of subtracted pair
-      else if (r_it0->second >= r_it1->first &&
-               r_it0->second <= r_it1->second) {
-        r_it0->second = r_it1->first - 1;
-        r_it0++;
-      }
-        // case d: pair completely surrounds subtracted pair
-      else if (r_it0->first < r_it1->first && 
-               r_it0->second > r_it1->second) {
-        Range::PairNode* new_node = alloc_pair(r_it0.node(), r_it0.node()->mPrev, 
-                                        r_it0->first, r_it1->first - 1);
-        new_node->mPrev->mNext = new_node->mNext->mPrev = new_node;
-        r_it0.node()->first = r_it1->second+1;
-        r_it1++;
-      }
-      else {
-        while (r_it0->second < r_it1->first && r_it0 != lhs.end()) r_it0++;
-        if (r_it0 == lhs.end()) break;
-        while (r_it1->second < r_it0->first && r_it1 != range2.end()) r_it1++;
-      }
+  lhs.reset_storage( range1.psize() + 4 );
+  const Range::PairNode* r_it1 = range2.mFirst;
+  const Range::PairNode* r_it0 = range1.mFirst;
+  while (r_it0 != range1.mLast) {
+      // copy pairs entirely below the next subtracted pair
+    if (r_it1 == range2.mLast) {
+      lhs.append_pairs( r_it0, range1.mLast );
+      break;
     }
+    const Range::PairNode* stop = gallop( r_it0, range1.mLast, r_it1->first, PairEndLess() );
+    lhs.append_pairs( r_it0, stop );
+    if ((r_it0 = stop) == range1.mLast)
+      break;
     
-    return lhs;
+      // skip subtracted pairs entirely below this pair
+    r_it1 = gallop( r_it1, range2.mLast, r_it0->first, PairEndLess() );
+    
+      // remove each subtracted pair that overlaps this one
+    EntityHandle start = r_it0->first;
+    bool remaining = true;
+    for (; r_it1 != range2.mLast && r_it1->first <= r_it0->second; ++r_it1) {
+      if (r_it1->first > start) 
+        lhs.append_pair( start, r_it1->first - 1 );
+      if (r_it1->second >= r_it0->second) {
+        remaining = false;
+        break;
+      }
+      start = r_it1->second + 1;
+    }
+    if (remaining) 
+      lhs.append_pair( start, r_it0->second );
+    ++r_it0;
   }
+  
+  return lhs;
 }
 
 Range &Range::operator-=(const Range &range2) 
 {
-  const bool braindead = false;
-  
-  if (braindead) {
-      // brain-dead implementation right now
-    Range res( *this );
-    for (Range::const_iterator rit = range2.begin(); rit != range2.end(); rit++)
-      res.erase(*rit);
+  if (!empty() && !range2.empty()) {
+    Range result( subtract( *this, range2 ) );
+    swap( result );
+  }
+  return *this;
+}
 
-    return *this;
+Range unite( const Range& range1, const Range& range2 )
+{
+  Range lhs;
+  if (range1.empty()) {
+    lhs = range2;
+    return lhs;
+  }
+  if (range2.empty()) {
+    lhs = range1;
+    return lhs;
   }
-  else {
-    Range::pair_iterator r_it0 = this->pair_begin();
-    Range::const_pair_iterator r_it1 = range2.const_pair_begin();
   
-      // terminate the while loop when at least one "start" iterator is at the
-      // end of the list
-    while (r_it0 != this->end() && r_it1 != range2.end()) {
-        // case a: pair wholly within subtracted pair
-      if (r_it0->first >= r_it1->first && r_it0->second <= r_it1->second) {
-        Range::PairNode *rtmp = r_it0.node();
-        r_it0++;
-        this->delete_pair_node(rtmp);
-      }
-        // case b: pair overlaps upper part of subtracted pair
-      else if (r_it0->first <= r_it1->second &&
-               r_it0->first >= r_it1->first) {
-        r_it0->first = r_it1->second + 1;
-        r_it1++;
-      }
-        // case c: pair overlaps lower part of subtracted pair
-      else if (r_it0->second >= r_it1->first &&
-               r_it0->second <= r_it1->second) {
-        r_it0->second = r_it1->first - 1;
-        r_it0++;
-      }
-        // case d: pair completely surrounds subtracted pair
-      else if (r_it0->first < r_it1->first && 
-               r_it0->second > r_it1->second) {
-        Range::PairNode* new_node = alloc_pair(r_it0.node(), r_it0.node()->mPrev, 
-                                        r_it0->first, r_it1->first - 1);
-        new_node->mPrev->mNext = new_node->mNext->mPrev = new_node;
-        r_it0.node()->first = r_it1->second+1;
-        r_it1++;
-      }
-      else {
-        while (r_it0->second < r_it1->first && r_it0 != this->end()) r_it0++;
-        if (r_it0 == this->end()) break;
-        while (r_it1->second < r_it0->first && r_it1 != range2.end()) r_it1++;
-      }
+    // alternately copy blocks of pairs from each range
+  lhs.reset_storage( std::max( range1.psize(), range2.psize() ) + 4 );
+  const Range::PairNode *r_it0 = range1.mFirst, *r_it1 = range2.mFirst;
+  while (r_it0 != range1.mLast && r_it1 != range2.mLast) {
+    if (r_it0->first <= r_it1->first) {
+      const Range::PairNode* stop = gallop( r_it0, range1.mLast, r_it1->first, PairStartNotAfter() );
+      lhs.append_pairs( r_it0, stop );
+      r_it0 = stop;
+    }
+    else {
+      const Range::PairNode* stop = gallop( r_it1, range2.mLast, r_it0->first, PairStartNotAfter() );
+      lhs.append_pairs( r_it1, stop );
+      r_it1 = stop;
     }
-    return *this;
   }
+  lhs.append_pairs( r_it0, range1.mLast );
+  lhs.append_pairs( r_it1, range2.mLast );
+  return lhs;
 }
 
   
@@ -784,12 +920,11 @@ operator-( const Range::const_iterator& it2, const Range::const_iterator& it1 )
     return *it2 - *it1;
   }
 
-  EntityID result = it1.mNode->second - it1.mValue + 1;
-  for (Range::PairNode* n = it1.mNode->mNext; n != it2.mNode; n = n->mNext)
-    result += n->second - n->first + 1;
-  if (it2.mValue) // (it2.mNode != &mHead)
-    result += it2.mValue - it2.mNode->first;
-  return result;
+    // The end() iterator is the sentinel pair (0,0), the count of 
+    // which is the total number of handles in the range.
+  EntityHandle pos1 = it1.mNode->mCount + (it1.mValue - it1.mNode->first);
+  EntityHandle pos2 = it2.mNode->mCount + (it2.mValue - it2.mNode->first);
+  return pos2 - pos1;
 }
 
 
@@ -797,19 +932,19 @@ Range::const_iterator Range::lower_bound(Range::const_iterator first,
                                              Range::const_iterator last,
                                              EntityHandle val)
 {
-    // Find the first pair whose end is >= val
-  PairNode* iter;
-  for (iter = first.mNode; iter != last.mNode; iter = iter->mNext)
-  {
+  PairNode* iter = first.mNode;
+  if (iter != last.mNode) {
+      // Check the first pair, which may be partially
+      // before 'first', then search the remaining ones
+      // for the first pair whose end is >= val.
     if (iter->second >= val)
-    {
-        // This is the correct pair.  Either 'val' is in the range, or
-        // the range starts before 'val' and iter->first IS the lower_bound.
-      if (iter->first > val)
-        return const_iterator(iter, iter->first);
-      return const_iterator(iter, val);
-    }
+      return const_iterator( iter, std::max( val, first.mValue ) );
+    iter = std::lower_bound( iter + 1, last.mNode, val, PairEndLess() );
+    if (iter != last.mNode)
+      return const_iterator( iter, std::max( val, iter->first ) );
   }
+  else if (val <= first.mValue)
+    return first;
   
   if (iter->first >= val)
     return const_iterator( iter, iter->first );
@@ -943,22 +1078,10 @@ unsigned Range::num_of_dimension( int dim ) const
 //! BY SUBSTITUTION AND THE FUNCTION WON'T WORK RIGHT!
 void Range::swap( Range &range )
 {
-    // update next/prev nodes of head of both ranges
-  bool range_empty = (range.mHead.mNext == &(range.mHead));
-  bool this_empty = (mHead.mNext == &mHead);
-
-  range.mHead.mNext->mPrev = (range_empty ? &(range.mHead) : &mHead);
-  range.mHead.mPrev->mNext = (range_empty ? &(range.mHead) : &mHead);
-  mHead.mNext->mPrev = (this_empty ? &mHead : &(range.mHead));
-  mHead.mPrev->mNext = (this_empty ? &mHead : &(range.mHead));
-
-    // switch data in head nodes of both ranges
-  PairNode *range_next = range.mHead.mNext, *range_prev = range.mHead.mPrev;
-  range.mHead.mNext = (this_empty ? &(range.mHead) : mHead.mNext);
-  range.mHead.mPrev = (this_empty ? &(range.mHead) : mHead.mPrev);
-  mHead.mNext = (range_empty ? &mHead : range_next);
-  mHead.mPrev = (range_empty ? &mHead : range_prev);
-
+  std::swap( mFirst, range.mFirst );
+  std::swap( mLast, range.mLast );
+  std::swap( mBuffer, range.mBuffer );
+  std::swap( mBufferEnd, range.mBufferEnd );
 }
 
     //! return a subset of this range, by type
@@ -992,23 +1115,21 @@ Range Range::subset_by_dimension( int d ) const
 
 bool operator==( const Range& r1, const Range& r2 )
 {
+  if (r1.psize() != r2.psize())
+    return false;
   Range::const_pair_iterator i1, i2;
   i1 = r1.const_pair_begin();
   i2 = r2.const_pair_begin();
   for ( ; i1 != r1.const_pair_end(); ++i1, ++i2) 
-    if (i2 == r2.const_pair_end() ||
-        i1->first != i2->first ||
+    if (i1->first != i2->first ||
         i1->second != i2->second)
       return false;
-  return i2 == r2.const_pair_end();
+  return true;
 }
 
 unsigned long Range::get_memory_use() const
 {
-  unsigned long result = 0;
-  for (const PairNode* n = mHead.mNext; n != &mHead; n = n->mNext)
-    result += sizeof(PairNode);
-  return result;
+  return (mBufferEnd - mBuffer) * sizeof(PairNode);
 }
 
 bool Range::contains( const Range& othr ) const
@@ -1019,15 +1140,15 @@ bool Range::contains( const Range& othr ) const
     return false;
   
     // neither range is empty, so both have valid pair nodes
-    // other than dummy mHead
-  const PairNode* this_node = mHead.mNext;
-  const PairNode* othr_node = othr.mHead.mNext;
+    // other than the sentinels
+  const PairNode* this_node = mFirst;
+  const PairNode* othr_node = othr.mFirst;
   for(;;) {
       // Loop while the node in this list is entirely before
       // the node in the other list.
-    while (this_node->second < othr_node->first) {
-      this_node = this_node->mNext;
-      if (this_node == &mHead)
+    if (this_node->second < othr_node->first) {
+      this_node = find_pair( othr_node->first );
+      if (this_node == mLast)
         return false;
     }
       // If other node is not entirely contained in this node
@@ -1036,8 +1157,8 @@ bool Range::contains( const Range& othr ) const
       break;
       // Loop while other node is entirely contained in this node.
     while (othr_node->second <= this_node->second) {
-      othr_node = othr_node->mNext;
-      if (othr_node == &othr.mHead)
+      ++othr_node;
+      if (othr_node == othr.mLast)
         return true;
     }
       // If other node overlapped end of this node
@@ -38,26 +38,26 @@ ReadUtil::ReadUtil(Core* mdb, Error* error_handler)
 {
 }
 
-ErrorCode ReadUtil::get_node_coords(
-    const int /*num_arrays*/,
-    const int num_nodes, 
-    const int preferred_start_id,
-    EntityHandle& actual_start_handle, 
-    std::vector<double*>& arrays,
-    int sequence_size)
+ErrorCode ReadUtil::create_node_sequence( const int num_nodes, 
+                                          const int preferred_start_id,
+                                          const bool single_precision,
+                                          EntityHandle& actual_start_handle, 
+                                          VertexSequence*& vseq,
+                                          int sequence_size )
 {
   ErrorCode error;
   EntitySequence* seq = 0;
   
   if (num_nodes < 1) {
     actual_start_handle = 0;
-    arrays.clear();
     return MB_INDEX_OUT_OF_RANGE;
   }
 
   // create an entity sequence for these nodes 
+  const int precision = single_precision ? VertexSequence::FLOAT_COORDS 
+                                         : VertexSequence::DOUBLE_COORDS;
   error = mMB->sequence_manager()->create_entity_sequence(
-    MBVERTEX, num_nodes, 0, preferred_start_id, 
+    MBVERTEX, num_nodes, precision, preferred_start_id, 
     actual_start_handle,
     seq, sequence_size);
 
@@ -69,9 +69,53 @@ ErrorCode ReadUtil::get_node_coords(
       seq->end_handle() - actual_start_handle + 1 < (unsigned)num_nodes)
     return MB_FAILURE;
 
+  vseq = static_cast<VertexSequence*>(seq);
+  return MB_SUCCESS;
+}
+
+ErrorCode ReadUtil::get_node_coords(
+    const int /*num_arrays*/,
+    const int num_nodes, 
+    const int preferred_start_id,
+    EntityHandle& actual_start_handle, 
+    std::vector<double*>& arrays,
+    int sequence_size)
+{
+  arrays.clear();
+  VertexSequence* seq = 0;
+  ErrorCode error = create_node_sequence( num_nodes, preferred_start_id, false,
+                                          actual_start_handle, seq, sequence_size );
+  if (MB_SUCCESS != error)
+    return error;
+
   arrays.resize(3);
 
-  error = static_cast<VertexSequence*>(seq)->get_coordinate_arrays(arrays[0], arrays[1], arrays[2]);
+  error = seq->get_coordinate_arrays(arrays[0], arrays[1], arrays[2]);
+  for (unsigned i = 0; i< arrays.size(); ++i)
+    if (arrays[i])
+      arrays[i] += (actual_start_handle - seq->start_handle());
+  
+  return error;
+}
+
+ErrorCode ReadUtil::get_node_coords(
+    const int /*num_arrays*/,
+    const int num_nodes, 
+    const int preferred_start_id,
+    EntityHandle& actual_start_handle, 
+    std::vector<float*>& arrays,
+    int sequence_size)
+{
+  arrays.clear();
+  VertexSequence* seq = 0;
+  ErrorCode error = create_node_sequence( num_nodes, preferred_start_id, true,
+                                          actual_start_handle, seq, sequence_size );
+  if (MB_SUCCESS != error)
+    return error;
+
+  arrays.resize(3);
+
+  error = seq->get_coordinate_arrays(arrays[0], arrays[1], arrays[2]);
   for (unsigned i = 0; i< arrays.size(); ++i)
     if (arrays[i])
       arrays[i] += (actual_start_handle - seq->start_handle());
@@ -157,20 +201,14 @@ ErrorCode ReadUtil::update_adjacencies(
       const EntityHandle* conn_array)
 {
 
-  EntityHandle tmp_hndl = start_handle;
   AEntityFactory* adj_fact = mMB->a_entity_factory();
 
-  // iterator over the elements and update adjacency information
-  if(adj_fact != NULL && adj_fact->vert_elem_adjacencies())
-  {
-    int j=0;
-    for(int i=0; i<number_elements; i++)
-    {
-      adj_fact->notify_create_entity( tmp_hndl, (conn_array+j), number_vertices_per_element);
-      tmp_hndl++;
-      j+=number_vertices_per_element;
-    }
-  }
+  // update adjacency information for all elements at once.  As when
+  // this was done per element, a failure to update the list of some
+  // vertex is not reported to the reader.
+  if(adj_fact != NULL)
+    adj_fact->notify_create_entities( start_handle, number_elements,
+                                      number_vertices_per_element, conn_array );
   return MB_SUCCESS;
 }
 
@@ -26,6 +26,7 @@ namespace moab {
 
 class Core;
 class Error;
+class VertexSequence;
 
 class ReadUtil : public ReadUtilIface
 {
@@ -50,6 +51,16 @@ public:
       std::vector<double*>& arrays,
       int sequence_size = -1);
 
+  //! get float arrays for coordinate data from the MB
+  ErrorCode get_node_coords(
+      const int num_arrays,
+      const int num_nodes, 
+      const int preferred_start_id,
+      EntityHandle& actual_start_handle, 
+      std::vector<float*>& arrays,
+      int sequence_size = -1);
+
+
   //! get array for connectivity data from the MB
   ErrorCode get_element_connect(
       const int num_elements, 
@@ -114,6 +125,16 @@ public:
 
   //! Get entity handle of an existing gather set
   ErrorCode get_gather_set(EntityHandle& gather_set);
+
+private:
+
+  //! create vertex sequence for get_node_coords
+  ErrorCode create_node_sequence( const int num_nodes, 
+                                  const int preferred_start_id,
+                                  const bool single_precision,
+                                  EntityHandle& actual_start_handle, 
+                                  VertexSequence*& seq,
+                                  int sequence_size );
 };
   
 } // namespace moab
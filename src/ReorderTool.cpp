@@ -6,15 +6,19 @@
 #include "moab/ReorderTool.hpp"
 #include "moab/Core.hpp"
 #include "moab/Range.hpp"
+#include "moab/CN.hpp"
 
 #include "SequenceManager.hpp"
 #include "TypeSequenceManager.hpp"
 #include "EntitySequence.hpp"
+#include "SequenceData.hpp"
+#include "AEntityFactory.hpp"
 
 #include <algorithm>
 #include <numeric>
 #include <set>
 #include <iostream>
+#include <typeinfo>
 
 namespace moab {
 
@@ -233,7 +237,390 @@ ReorderTool::handle_order_from_sets_and_adj( const Range& sets,
   return MB_SUCCESS;
 }
   
-    // Compare function to use for a map keyed on pointers to sorted vectors
+    // Bits per coordinate in curve indices, such that the index of a 
+  // 3D point fits in a non-negative int.
+static const int CURVE_BITS = 10;
+
+  // Index of a point along a Morton curve: interleaved coordinate bits
+static int morton_index( unsigned x, unsigned y, unsigned z )
+{
+  int result = 0;
+  for (int b = CURVE_BITS - 1; b >= 0; --b)
+    result = (result << 3) | (((x >> b) & 1) << 2) | (((y >> b) & 1) << 1) | ((z >> b) & 1);
+  return result;
+}
+
+  // Index of a point along a Hilbert curve.  Convert coordinates to the
+  // "transposed" Hilbert index, for which interleaving the bits gives 
+  // the index. See J. Skilling, "Programming the Hilbert curve", 
+  // AIP Conf. Proc. 707, 2004.
+static int hilbert_index( unsigned x, unsigned y, unsigned z )
+{
+  unsigned X[3] = { x, y, z };
+  const unsigned M = 1u << (CURVE_BITS - 1);
+  
+    // inverse undo excess work
+  for (unsigned Q = M; Q > 1; Q >>= 1) {
+    const unsigned P = Q - 1;
+    for (int i = 0; i < 3; ++i) {
+      if (X[i] & Q) 
+        X[0] ^= P;
+      else {
+        const unsigned t = (X[0] ^ X[i]) & P;
+        X[0] ^= t;
+        X[i] ^= t;
+      }
+    }
+  }
+  
+    // Gray encode
+  X[1] ^= X[0];
+  X[2] ^= X[1];
+  unsigned t = 0;
+  for (unsigned Q = M; Q > 1; Q >>= 1)
+    if (X[2] & Q)
+      t ^= Q - 1;
+  for (int i = 0; i < 3; ++i)
+    X[i] ^= t;
+  
+  return morton_index( X[0], X[1], X[2] );
+}
+
+  // Get all entities of the specified type that are not in structured mesh
+static void get_unstructured_entities( Core* moab, EntityType t, Range& ents )
+{
+  Range::iterator hint = ents.begin();
+  TypeSequenceManager& seqs = moab->sequence_manager()->entity_map(t);
+  TypeSequenceManager::iterator s;
+  for (s = seqs.begin(); s != seqs.end(); ++s) {
+    EntitySequence* seq = *s;
+    if (typeid(*seq->data()) == typeid(SequenceData))
+      hint = ents.insert( hint, seq->start_handle(), seq->end_handle() );
+  }
+}
+
+ErrorCode ReorderTool::handle_order_from_curve( CurveType curve,
+                                                Tag& handle_tag )
+{
+  ErrorCode rval;
+  
+    // get bounding box of mesh
+  Range verts;
+  rval = mMB->get_entities_by_type( 0, MBVERTEX, verts );
+  CHKERR;
+  if (verts.empty())
+    return MB_ENTITY_NOT_FOUND;
+  std::vector<double> coords( 3 * verts.size() );
+  rval = mMB->get_coords( verts, &coords[0] );
+  CHKERR;
+  double min[3], max[3];
+  std::copy( coords.begin(), coords.begin() + 3, min );
+  std::copy( coords.begin(), coords.begin() + 3, max );
+  for (size_t i = 3; i < coords.size(); i += 3) {
+    for (int d = 0; d < 3; ++d) {
+      min[d] = std::min( min[d], coords[i+d] );
+      max[d] = std::max( max[d], coords[i+d] );
+    }
+  }
+  
+    // Scale bounding box to curve index space.  Use the same scale
+    // for each dimension so that curve cells are cubes.
+  double extent = std::max( std::max( max[0] - min[0], max[1] - min[1] ), max[2] - min[2] );
+  const double scale = extent > 0.0 ? ((1 << CURVE_BITS) - 1) / extent : 0.0;
+  
+  Tag order_tag;
+  const int negone = -1;
+  rval = mMB->tag_get_handle( 0, 1, MB_TYPE_INTEGER, order_tag,
+                              MB_TAG_DENSE|MB_TAG_CREAT|MB_TAG_EXCL, &negone );
+  CHKERR;
+  
+    // Tag each vertex and element, except those in structured
+    // mesh, with its index along the curve
+  std::vector<int> index;
+  for (EntityType t = MBVERTEX; t < MBENTITYSET; ++t) {
+    Range ents;
+    get_unstructured_entities( mMB, t, ents );
+    if (ents.empty())
+      continue;
+    
+    coords.resize( 3 * ents.size() );
+    rval = mMB->get_coords( ents, &coords[0] );
+    if (MB_SUCCESS != rval) {
+      mMB->tag_delete( order_tag );
+      return error(rval);
+    }
+    index.resize( ents.size() );
+    for (size_t i = 0; i < index.size(); ++i) {
+      unsigned ijk[3];
+      for (int d = 0; d < 3; ++d)
+        ijk[d] = (unsigned)(scale * (coords[3*i+d] - min[d]) + 0.5);
+      if (curve == HILBERT_CURVE)
+        index[i] = hilbert_index( ijk[0], ijk[1], ijk[2] );
+      else
+        index[i] = morton_index( ijk[0], ijk[1], ijk[2] );
+    }
+    rval = mMB->tag_set_data( order_tag, ents, &index[0] );
+    if (MB_SUCCESS != rval) {
+      mMB->tag_delete( order_tag );
+      return error(rval);
+    }
+  }
+  
+  rval = handle_order_from_int_tag( order_tag, negone, handle_tag );
+  mMB->tag_delete( order_tag );
+  CHKERR;
+  return MB_SUCCESS;
+}
+
+  // Append to the graph in compressed row form the position in \c ents 
+  // of each entity in \c nbrs, other than \c self, and end the row.
+static void add_graph_row( const Range& ents, 
+                           EntityHandle self,
+                           std::vector<EntityHandle>& nbrs,
+                           std::vector<size_t>& offsets,
+                           std::vector<size_t>& adj )
+{
+  std::sort( nbrs.begin(), nbrs.end() );
+  nbrs.erase( std::unique( nbrs.begin(), nbrs.end() ), nbrs.end() );
+  for (size_t i = 0; i < nbrs.size(); ++i) {
+    if (nbrs[i] == self)
+      continue;
+    int idx = ents.index( nbrs[i] );
+    if (idx >= 0)
+      adj.push_back( idx );
+  }
+  offsets.push_back( adj.size() );
+}
+
+  // Build graph in which vertices are adjacent if they are
+  // connected by an element of dimension \c dim.
+static ErrorCode vertex_graph( Interface* moab,
+                               const Range& verts,
+                               int dim,
+                               std::vector<size_t>& offsets,
+                               std::vector<size_t>& adj )
+{
+  ErrorCode rval;
+  std::vector<EntityHandle> elems, nbrs, storage;
+  const EntityHandle* conn;
+  int len;
+  offsets.clear();
+  offsets.push_back( 0 );
+  for (Range::const_iterator v = verts.begin(); v != verts.end(); ++v) {
+    EntityHandle vtx = *v;
+    elems.clear();
+    rval = moab->get_adjacencies( &vtx, 1, dim, false, elems );
+    CHKERR;
+    nbrs.clear();
+    for (size_t i = 0; i < elems.size(); ++i) {
+      rval = moab->get_connectivity( elems[i], conn, len, false, &storage );
+      CHKERR;
+      nbrs.insert( nbrs.end(), conn, conn + len );
+    }
+    add_graph_row( verts, vtx, nbrs, offsets, adj );
+  }
+  return MB_SUCCESS;
+}
+
+  // Build graph in which elements of dimension \c dim are
+  // adjacent if they share a side of dimension \c dim - 1.
+  // Sides are identified by their vertices (or by the faces
+  // of polyhedra) such that no side entities are created.
+static ErrorCode element_graph( Interface* moab,
+                                const Range& elems,
+                                int dim,
+                                std::vector<size_t>& offsets,
+                                std::vector<size_t>& adj )
+{
+  ErrorCode rval;
+  std::vector<EntityHandle> nbrs, side, shared, storage;
+  const EntityHandle* conn;
+  int len, num_side_verts;
+  EntityType side_type;
+  offsets.clear();
+  offsets.push_back( 0 );
+  for (Range::const_iterator e = elems.begin(); e != elems.end(); ++e) {
+    const EntityType type = TYPE_FROM_HANDLE(*e);
+    rval = moab->get_connectivity( *e, conn, len, true, &storage );
+    CHKERR;
+    nbrs.clear();
+    if (MBPOLYHEDRON == type) {
+      rval = moab->get_adjacencies( conn, len, dim, false, nbrs, Interface::UNION );
+      CHKERR;
+    }
+    else {
+      const int num_sides = MBPOLYGON == type ? len : CN::NumSubEntities( type, dim - 1 );
+      for (int s = 0; s < num_sides; ++s) {
+        if (MBPOLYGON == type) {
+          side.resize( 2 );
+          side[0] = conn[s];
+          side[1] = conn[(s+1)%len];
+        }
+        else {
+          const short* idx = CN::SubEntityVertexIndices( type, dim - 1, s, 
+                                                         side_type, num_side_verts );
+          side.resize( num_side_verts );
+          for (int i = 0; i < num_side_verts; ++i)
+            side[i] = conn[idx[i]];
+        }
+        shared.clear();
+        rval = moab->get_adjacencies( &side[0], side.size(), dim, false, shared );
+        CHKERR;
+        nbrs.insert( nbrs.end(), shared.begin(), shared.end() );
+      }
+    }
+    add_graph_row( elems, *e, nbrs, offsets, adj );
+  }
+  return MB_SUCCESS;
+}
+
+  // Breadth-first search from \c start, marking each node reached 
+  // with \c stamp.  Passes back nodes in the order they are reached
+  // and the level of each.  Returns the number of the last level.
+static size_t graph_levels( const std::vector<size_t>& offsets,
+                            const std::vector<size_t>& adj,
+                            size_t start,
+                            size_t stamp,
+                            std::vector<size_t>& mark,
+                            std::vector<size_t>& nodes,
+                            std::vector<size_t>& level )
+{
+  nodes.clear();
+  nodes.push_back( start );
+  mark[start] = stamp;
+  level[start] = 0;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    const size_t u = nodes[i];
+    for (size_t j = offsets[u]; j < offsets[u+1]; ++j) {
+      const size_t v = adj[j];
+      if (mark[v] != stamp) {
+        mark[v] = stamp;
+        level[v] = level[u] + 1;
+        nodes.push_back( v );
+      }
+    }
+  }
+  return level[nodes.back()];
+}
+
+  // Reverse Cuthill-McKee ordering of a graph in compressed row form,
+  // where the neighbors of node i are adj[offsets[i]] through 
+  // adj[offsets[i+1]-1].  Passes back the new position of each node.
+  // Each connected component is started from a pseudo-peripheral node
+  // found by the method of Gibbs, Poole, and Stockmeyer.
+static void rcm_order( const std::vector<size_t>& offsets,
+                       const std::vector<size_t>& adj,
+                       std::vector<int>& position )
+{
+  const size_t n = offsets.size() - 1;
+  std::vector< std::pair<size_t,size_t> > by_degree( n ), nbrs;
+  for (size_t i = 0; i < n; ++i)
+    by_degree[i] = std::pair<size_t,size_t>( offsets[i+1] - offsets[i], i );
+  std::sort( by_degree.begin(), by_degree.end() );
+  
+  std::vector<size_t> order, mark( n, 0 ), nodes, level( n );
+  std::vector<bool> visited( n, false );
+  order.reserve( n );
+  size_t stamp = 0;
+  for (size_t k = 0; k < n; ++k) {
+    size_t start = by_degree[k].second;
+    if (visited[start])
+      continue;
+    
+      // Move start to the node of least degree in the last level
+    size_t depth = graph_levels( offsets, adj, start, ++stamp, mark, nodes, level );
+    for (;;) {
+      size_t next = nodes.back();
+      for (size_t i = nodes.size(); i > 0 && level[nodes[i-1]] == depth; --i)
+        if (offsets[nodes[i-1]+1] - offsets[nodes[i-1]] < offsets[next+1] - offsets[next])
+          next = nodes[i-1];
+      const size_t next_depth = graph_levels( offsets, adj, next, ++stamp, mark, nodes, level );
+      if (next_depth <= depth)
+        break;
+      start = next;
+      depth = next_depth;
+    }
+    
+      // Cuthill-McKee: breadth-first, visiting neighbors by increasing degree
+    visited[start] = true;
+    size_t j = order.size();
+    order.push_back( start );
+    for (; j < order.size(); ++j) {
+      const size_t u = order[j];
+      nbrs.clear();
+      for (size_t a = offsets[u]; a < offsets[u+1]; ++a) {
+        const size_t v = adj[a];
+        if (!visited[v]) {
+          visited[v] = true;
+          nbrs.push_back( std::pair<size_t,size_t>( offsets[v+1] - offsets[v], v ) );
+        }
+      }
+      std::sort( nbrs.begin(), nbrs.end() );
+      for (size_t a = 0; a < nbrs.size(); ++a)
+        order.push_back( nbrs[a].second );
+    }
+  }
+  
+  position.resize( n );
+  for (size_t k = 0; k < n; ++k)
+    position[order[k]] = n - 1 - k;
+}
+
+ErrorCode ReorderTool::handle_order_from_rcm( Tag& handle_tag )
+{
+  ErrorCode rval;
+  
+    // Vertices are connected by elements of the largest dimension
+  int max_dim = 3, count = 0;
+  for (; max_dim > 0; --max_dim) {
+    rval = mMB->get_number_entities_by_dimension( 0, max_dim, count );
+    CHKERR;
+    if (count)
+      break;
+  }
+  
+  Tag order_tag;
+  const int negone = -1;
+  rval = mMB->tag_get_handle( 0, 1, MB_TYPE_INTEGER, order_tag,
+                              MB_TAG_DENSE|MB_TAG_CREAT|MB_TAG_EXCL, &negone );
+  CHKERR;
+  
+    // Order all vertices and all elements of each dimension, except 
+    // those in structured mesh, as one graph.  The relative order is
+    // preserved when the entities are grouped by type and size.
+  std::vector<size_t> offsets, adj;
+  std::vector<int> position;
+  for (int dim = max_dim ? 0 : 1; dim <= max_dim; ++dim) {
+    Range ents;
+    for (EntityType t = CN::TypeDimensionMap[dim].first; 
+         t <= CN::TypeDimensionMap[dim].second; ++t)
+      get_unstructured_entities( mMB, t, ents );
+    if (ents.empty())
+      continue;
+    
+    if (dim)
+      rval = element_graph( mMB, ents, dim, offsets, adj );
+    else
+      rval = vertex_graph( mMB, ents, max_dim, offsets, adj );
+    if (MB_SUCCESS == rval) {
+      rcm_order( offsets, adj, position );
+      rval = mMB->tag_set_data( order_tag, ents, &position[0] );
+    }
+    if (MB_SUCCESS != rval) {
+      mMB->tag_delete( order_tag );
+      return error(rval);
+    }
+    offsets.clear();
+    adj.clear();
+  }
+  
+  rval = handle_order_from_int_tag( order_tag, negone, handle_tag );
+  mMB->tag_delete( order_tag );
+  CHKERR;
+  return MB_SUCCESS;
+}
+
+  // Compare function to use for a map keyed on pointers to sorted vectors
 struct CompSortedVect {
   bool operator()( const std::vector<EntityHandle>* v1,
                    const std::vector<EntityHandle>* v2 ) const
@@ -488,6 +875,186 @@ ErrorCode ReorderTool::reorder_entities( Tag new_handles )
   return MB_SUCCESS;
 }
 
+ErrorCode ReorderTool::compact_handles( Range& old_handles,
+                                        std::vector<EntityHandle>& new_handles_out )
+{
+  ErrorCode rval;
+  old_handles.clear();
+  new_handles_out.clear();
+
+  EntityHandle zero = 0;
+  Tag new_handles;
+  rval = mMB->tag_get_handle( 0, 1, MB_TYPE_HANDLE, new_handles,
+                              MB_TAG_DENSE|MB_TAG_CREAT|MB_TAG_EXCL, &zero );
+  CHKERR;
+
+    // For each (type,size) grouping, create entities at unused
+    // handles to swap with the entities to be moved.
+  Range placeholders;
+  std::vector< std::pair<EntityHandle,EntityHandle> > moves;
+  for (EntityType t = MBVERTEX; t < MBENTITYSET; ++t) {
+    TypeSequenceManager& seqs = mMB->sequence_manager()->entity_map(t);
+    TypeSequenceManager::iterator i;
+    std::set<int> values;
+    for (i = seqs.begin(); i != seqs.end(); ++i) {
+      EntitySequence* seq = *i;
+      if (t == MBVERTEX || 0 < seq->values_per_entity())
+        values.insert( seq->values_per_entity() );
+    }
+  
+    std::set<int>::iterator j;
+    for (j = values.begin(); j != values.end(); ++j) {
+      rval = compact_handles( t, *j, new_handles, placeholders, moves );
+      if (MB_SUCCESS != rval) {
+        mMB->delete_entities( placeholders );
+        mMB->tag_delete( new_handles );
+        return error(rval);
+      }
+    }
+  }
+  
+  if (moves.empty()) 
+    return mMB->tag_delete( new_handles );
+  
+    // Move adjacency lists to the new handles first, while each entity
+    // is still at its old handle so that the lists of adjacent entities
+    // referring to it can be found and updated, and only then swap the
+    // entities themselves with reorder_entities.  The placeholder
+    // entities have no lists, so we need not swap them.  Lists holding
+    // one-way adjacencies to moved entities cannot be found from the
+    // moved entities, so replace the handles in all lists.
+  std::sort( moves.begin(), moves.end() );
+  AEntityFactory* adj_fact = mMB->a_entity_factory();
+  for (size_t i = 0; i < moves.size(); ++i) {
+    rval = adj_fact->move_adjacencies( moves[i].first, moves[i].second );
+    UNRECOVERABLE(rval);
+  }
+  rval = adj_fact->replace_adjacent_handles( moves );
+  UNRECOVERABLE(rval);
+  
+    // Swap the entities with the placeholders
+  rval = reorder_entities( new_handles );
+  UNRECOVERABLE(rval);
+  rval = mMB->tag_delete( new_handles );
+  UNRECOVERABLE(rval);
+  
+    // The placeholders are now at the old handles.
+  new_handles_out.resize( moves.size() );
+  Range::iterator hint = old_handles.begin();
+  for (size_t i = 0; i < moves.size(); ++i) {
+    hint = old_handles.insert( hint, moves[i].first );
+    new_handles_out[i] = moves[i].second;
+  }
+  rval = mMB->delete_entities( old_handles );
+  UNRECOVERABLE(rval);
+  
+  return MB_SUCCESS;
+}
+
+ErrorCode ReorderTool::compact_handles( EntityType t,
+                                        int vals_per_ent,
+                                        Tag new_handles,
+                                        Range& placeholders,
+                                        std::vector< std::pair<EntityHandle,EntityHandle> >& moves )
+{
+  ErrorCode rval;
+  
+    // Get entities and the blocks of storage containing them.
+    // Structured mesh is stored in types derived from SequenceData,
+    // and must not be moved into or out of.
+  Range entities;
+  std::vector<SequenceData*> blocks;
+  TypeSequenceManager& seqs = mMB->sequence_manager()->entity_map(t);
+  TypeSequenceManager::iterator s;
+  for (s = seqs.begin(); s != seqs.end(); ++s) {
+    EntitySequence* seq = *s;
+    SequenceData* data = seq->data();
+    if (seq->values_per_entity() != vals_per_ent || typeid(*data) != typeid(SequenceData))
+      continue;
+    entities.insert( seq->start_handle(), seq->end_handle() );
+    if (blocks.empty() || blocks.back() != data)
+      blocks.push_back( data );
+  }
+  
+    // The entities belong in the first entities.size() handles of 
+    // the blocks.  Entities after those are moved, in order, into the
+    // unused handles among them.
+  Range targets;
+  EntityID remaining = entities.size();
+  for (size_t b = 0; remaining && b < blocks.size(); ++b) {
+    EntityID n = std::min( remaining, blocks[b]->size() );
+    targets.insert( blocks[b]->start_handle(), blocks[b]->start_handle() + n - 1 );
+    remaining -= n;
+  }
+  Range movers = subtract( entities, targets );
+  Range holes = subtract( targets, entities );
+  assert( movers.size() == holes.size() );
+  if (movers.empty())
+    return MB_SUCCESS;
+  
+    // Create placeholder entities in the unused handles, one
+    // run of handles within a single block at a time.
+  size_t b = 0;
+  Range::const_pair_iterator p;
+  for (p = holes.const_pair_begin(); p != holes.const_pair_end(); ++p) {
+    EntityHandle start = p->first;
+    while (start <= p->second) {
+      while (blocks[b]->end_handle() < start)
+        ++b;
+      const EntityHandle end = std::min( p->second, blocks[b]->end_handle() );
+      EntityHandle h;
+      EntitySequence* seq;
+      rval = mMB->sequence_manager()->create_entity_sequence( t, end - start + 1, 
+                                        vals_per_ent, ID_FROM_HANDLE(start), h, seq, -1 );
+      CHKERR;
+      placeholders.insert( h, h + (end - start) );
+      if (h != start) 
+        return error(MB_FAILURE);
+      start = end + 1;
+    }
+  }
+  
+    // Give the placeholders the data of the entities they will
+    // be swapped with, such that they are valid entities.
+  std::vector<EntityHandle> old_list( movers.begin(), movers.end() );
+  std::vector<EntityHandle> new_list( holes.begin(), holes.end() );
+  if (MBVERTEX == t) {
+    std::vector<double> coords( 3 * movers.size() );
+    rval = mMB->get_coords( movers, &coords[0] );
+    CHKERR;
+    rval = mMB->set_coords( holes, &coords[0] );
+    CHKERR;
+  }
+  else {
+    std::vector<EntityHandle> conn;
+    rval = mMB->get_connectivity( &old_list[0], old_list.size(), conn, false );
+    CHKERR;
+    Range::const_iterator i = holes.begin();
+    size_t offset = 0;
+    while (i != holes.end()) {
+      EntityHandle* ptr;
+      int len, count;
+      rval = mMB->connect_iterate( i, holes.end(), ptr, len, count );
+      CHKERR;
+      std::copy( conn.begin() + offset, conn.begin() + offset + len*count, ptr );
+      for (int k = 0; k < count; ++k, ++i, offset += len) {
+        rval = mMB->a_entity_factory()->notify_create_entity( *i, ptr + k*len, len );
+        CHKERR;
+      }
+    }
+  }
+  
+    // Store the swap
+  rval = mMB->tag_set_data( new_handles, movers, &new_list[0] );
+  CHKERR;
+  rval = mMB->tag_set_data( new_handles, holes, &old_list[0] );
+  CHKERR;
+  for (size_t i = 0; i < old_list.size(); ++i)
+    moves.push_back( std::make_pair( old_list[i], new_list[i] ) );
+  
+  return MB_SUCCESS;
+}
+
 ErrorCode ReorderTool::reorder_tag_data( EntityType etype, Tag new_handles, Tag tag )
 {
   ErrorCode rval;
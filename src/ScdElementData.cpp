@@ -68,6 +68,58 @@ ScdElementData::ScdElementData(
 
 ScdElementData::~ScdElementData() 
 {
+  for (std::vector<VertexDataRef>::const_iterator it = vertexSeqRefs.begin();
+       it != vertexSeqRefs.end(); it++) {
+    std::vector<ScdElementData*>& list = (*it).srcSeq->elementData;
+    list.erase( std::remove( list.begin(), list.end(), this ), list.end() );
+  }
+}
+
+void ScdElementData::remove_vsequence(const ScdVertexData *vseq)
+{
+  size_t w = 0;
+  for (size_t r = 0; r < vertexSeqRefs.size(); ++r)
+    if (vertexSeqRefs[r].srcSeq != vseq)
+      vertexSeqRefs[w++] = vertexSeqRefs[r];
+  vertexSeqRefs.erase( vertexSeqRefs.begin() + w, vertexSeqRefs.end() );
+}
+
+void ScdElementData::get_vertex_adjacencies(const ScdVertexData *vseq, EntityHandle vertex,
+                                            std::vector<EntityHandle>& adjacencies) const
+{
+  int i, j, k;
+  if (MB_SUCCESS != vseq->get_params(vertex, i, j, k)) return;
+  const int dim = CN::Dimension(TYPE_FROM_HANDLE(start_handle()));
+  
+  for (std::vector<VertexDataRef>::const_iterator it = vertexSeqRefs.begin();
+       it != vertexSeqRefs.end(); it++) {
+    if ((*it).srcSeq != vseq) continue;
+    
+      // vertex params in this element sequence's parameter space
+    HomCoord p = HomCoord(i, j, k) * (*it).xform;
+    if (!(*it).contains(p)) continue;
+    
+      // elements with params one less than the vertex's in any direction 
+      // spanned by the element and with more than one layer of vertices
+      // also contain the vertex
+    int lo[3];
+    for (int d = 0; d < 3; d++)
+      lo[d] = (d < dim && dIJKm1[d] ? p[d] - 1 : p[d]);
+    
+    for (int kk = lo[2]; kk <= p[2]; kk++) {
+      for (int jj = lo[1]; jj <= p[1]; jj++) {
+        for (int ii = lo[0]; ii <= p[0]; ii++) {
+          int ei = ii, ej = jj;
+          if (isPeriodic[0])
+            ei = i_min() + ((ii - i_min()) % dIJKm1[0] + dIJKm1[0]) % dIJKm1[0];
+          if (isPeriodic[1])
+            ej = j_min() + ((jj - j_min()) % dIJKm1[1] + dIJKm1[1]) % dIJKm1[1];
+          if (contains(HomCoord(ei, ej, kk)))
+            adjacencies.push_back(get_element(ei, ej, kk));
+        }
+      }
+    }
+  }
 }
 
 bool ScdElementData::boundary_complete() const
@@ -142,6 +142,13 @@ public:
     //! get connectivity of an entity given entity's parameters
   inline ErrorCode get_params_connectivity(const int i, const int j, const int k,
                                        std::vector<EntityHandle>& connectivity) const;
+
+    //! append the elements that have vertex in their connectivity, computed 
+    //! from the parameters of the vertex in vseq (which should be the vertex's
+    //! sequence data); result is not sorted and may include handles for 
+    //! elements that have been deleted
+  void get_vertex_adjacencies(const ScdVertexData *vseq, EntityHandle vertex,
+                              std::vector<EntityHandle>& adjacencies) const;
   
     //! add a vertex seq ref to this element sequence;
     //! if bb_input is true, bounding box (in eseq-local coords) of vseq being added 
@@ -156,6 +163,9 @@ public:
                              const HomCoord &bb_min = HomCoord::unitv[0],
                              const HomCoord &bb_max = HomCoord::unitv[0]);
 
+    //! remove all references to a vertex block, e.g. when it is destroyed
+  void remove_vsequence(const ScdVertexData *vseq);
+
 
   SequenceData* subset( EntityHandle start, 
                         EntityHandle end,
@@ -318,6 +328,9 @@ inline ErrorCode ScdElementData::add_vsequence(ScdVertexData *vseq,
 
     // add to the list
   vertexSeqRefs.push_back(tmp_seq_ref);
+  if (std::find( vseq->elementData.begin(), vseq->elementData.end(), this )
+      == vseq->elementData.end())
+    vseq->elementData.push_back( this );
   
   return MB_SUCCESS;
 }
@@ -14,6 +14,7 @@
  */
 
 #include "ScdVertexData.hpp"
+#include "ScdElementData.hpp"
 #include <assert.h>
 
 namespace moab {
@@ -42,6 +43,13 @@ ScdVertexData::ScdVertexData(const EntityHandle start_vertex,
   create_sequence_data( 2, sizeof(double) );
 }
 
+ScdVertexData::~ScdVertexData()
+{
+  for (std::vector<ScdElementData*>::iterator i = elementData.begin();
+       i != elementData.end(); ++i)
+    (*i)->remove_vsequence( this );
+}
+
 SequenceData* ScdVertexData::subset( EntityHandle /*start*/, 
                                      EntityHandle /*end*/,
                                      const int* /*sequence_data_sizes*/,
@@ -26,9 +26,12 @@
 
 #include "SequenceData.hpp"
 #include "moab/HomXform.hpp"
+#include <vector>
 
 namespace moab {
 
+class ScdElementData;
+
 class ScdVertexData : public SequenceData
 {
 
@@ -45,6 +48,13 @@ private:
     //! each parametric direction)
   int dIJKm1[3];
 
+    //! element blocks bounded by this vertex block, maintained by
+    //! ScdElementData so that adjacency queries need not search all
+    //! element sequences
+  std::vector<ScdElementData*> elementData;
+
+  friend class ScdElementData;
+
 public:
 
     //! constructor
@@ -52,7 +62,11 @@ public:
                 const int imin, const int jmin, const int kmin,
                 const int imax, const int jmax, const int kmax) ;
   
-  virtual ~ScdVertexData() {}
+  virtual ~ScdVertexData();
+
+    //! element blocks bounded by this vertex block
+  const std::vector<ScdElementData*>& element_data() const
+    { return elementData; }
 
     //! get handle of vertex at i, j, k
   EntityHandle get_vertex(const int i, const int j, const int k) const;
@@ -8,13 +8,24 @@ namespace moab {
 SequenceData::~SequenceData()
 {
   for (int i = -numSequenceData; i <= (int)numTagData; ++i)
-    free( arraySet[i] );
+    MemoryCounter::deallocate( arraySet[i] );
   free( arraySet - numSequenceData );
 }
 
-void* SequenceData::create_data( int index, int bytes_per_ent, const void* initial_value )
+MemoryCounter* SequenceData::sequence_counter() const
+{
+  switch (TYPE_FROM_HANDLE(startHandle)) {
+    case MBVERTEX:    return &MemoryCounter::category( MEM_SEQUENCES );
+    case MBENTITYSET: return &MemoryCounter::category( MEM_SETS );
+    default:          return &MemoryCounter::category( MEM_CONNECTIVITY );
+  }
+}
+
+void* SequenceData::create_data( int index, int bytes_per_ent, 
+                                 MemoryCounter* counter,
+                                 const void* initial_value )
 {  
-  char* array = (char*)malloc( bytes_per_ent * size() );
+  char* array = (char*)MemoryCounter::allocate_aligned( bytes_per_ent * size(), counter );
   if (initial_value)
     SysUtil::setmem( array, initial_value, bytes_per_ent, size() );
   
@@ -29,7 +40,7 @@ void* SequenceData::create_sequence_data( int array_num,
   const int index = -1 - array_num;
   assert( array_num < numSequenceData );
   assert( !arraySet[index] );
-  return create_data( index, bytes_per_ent, initial_value );
+  return create_data( index, bytes_per_ent, sequence_counter(), initial_value );
 }
 
 
@@ -39,7 +50,7 @@ void* SequenceData::create_custom_data( int array_num, size_t total_bytes )
   assert( array_num < numSequenceData );
   assert( !arraySet[index] );
 
-  void* array = malloc( total_bytes );
+  void* array = MemoryCounter::allocate_aligned( total_bytes, sequence_counter() );
   arraySet[index] = array;
   return array;
 }
@@ -48,11 +59,17 @@ SequenceData::AdjacencyDataType* SequenceData::allocate_adjacency_data()
 {
   assert( !arraySet[0] );
   const size_t s = sizeof(AdjacencyDataType*) * size();
-  arraySet[0] = malloc( s );
+  arraySet[0] = MemoryCounter::allocate( s, &MemoryCounter::category( MEM_ADJACENCIES ) );
   memset( arraySet[0], 0, s );
   return reinterpret_cast<AdjacencyDataType*>(arraySet[0]);
 }
 
+void SequenceData::release_adjacency_data()
+{
+  MemoryCounter::deallocate( arraySet[0] );
+  arraySet[0] = 0;
+}
+
 void SequenceData::increase_tag_count( unsigned amount )
 {
   void** list = arraySet - numSequenceData;
@@ -63,13 +80,15 @@ void SequenceData::increase_tag_count( unsigned amount )
   numTagData += amount;
 }
 
-void* SequenceData::allocate_tag_array( int tag_num, int bytes_per_ent, const void* default_value )
+void* SequenceData::allocate_tag_array( int tag_num, int bytes_per_ent, 
+                                        MemoryCounter* counter,
+                                        const void* default_value )
 {
   if ((unsigned)tag_num >= numTagData)
     increase_tag_count( tag_num - numTagData + 1 );
   
   assert( !arraySet[tag_num + 1] );
-  return create_data( tag_num + 1, bytes_per_ent, default_value );
+  return create_data( tag_num + 1, bytes_per_ent, counter, default_value );
 }
 
 SequenceData* SequenceData::subset( EntityHandle start,
@@ -114,7 +133,8 @@ void SequenceData::copy_data_subset( int index,
   if (!source)
     arraySet[index] = 0;
   else {
-    arraySet[index] = malloc( count * size_per_ent );
+    arraySet[index] = MemoryCounter::allocate_aligned( count * size_per_ent, 
+                                                       MemoryCounter::owner( source ) );
     memcpy( arraySet[index], 
             (const char*)source + offset * size_per_ent, 
             count * size_per_ent );
@@ -139,7 +159,8 @@ void SequenceData::move_tag_data( SequenceData* destination, const int* tag_size
     
     const int tag_size = tag_sizes[i-1];
     if (!destination->arraySet[i])
-      destination->arraySet[i] = malloc( count * tag_size );
+      destination->arraySet[i] = MemoryCounter::allocate_aligned( count * tag_size, 
+                                                         MemoryCounter::owner( arraySet[i] ) );
     memcpy( destination->arraySet[i], 
             reinterpret_cast<char*>(arraySet[i]) + offset * tag_size,
             count * tag_size );
@@ -163,7 +184,7 @@ void SequenceData::release_tag_data( int tag_num, int tag_size )
       for (; iter != end; ++iter)
         iter->clear();
     }
-    free( arraySet[tag_num+1] );
+    MemoryCounter::deallocate( arraySet[tag_num+1] );
     arraySet[tag_num+1] = 0;
   }
 }
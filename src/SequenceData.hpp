@@ -3,6 +3,7 @@
 
 
 #include "TypeSequenceManager.hpp"
+#include "moab/MemoryCounter.hpp"
 
 #include <vector>
 #include <stdlib.h>
@@ -10,6 +11,13 @@
 
 namespace moab {
 
+/**\brief Storage for a block of entity handles
+ *
+ * Per-entity arrays of EntitySequence-specific data (coordinates, 
+ * connectivity, etc.) and of dense tag values are allocated aligned
+ * to MB_ARRAY_ALIGNMENT bytes and zero-padded to a multiple of that 
+ * size, such that vectorized loops over them may use aligned loads.
+ */
 class SequenceData
 {
 public:
@@ -90,14 +98,24 @@ public:
    */
   AdjacencyDataType* allocate_adjacency_data();
   
+  /**\brief Free array for storing adjacency data.
+   *
+   * Free the array of adjacency list pointers.  The caller is
+   * responsible for the lists themselves.
+   */
+  void release_adjacency_data();
+  
   /**\brief Allocate array of dense tag data
    *
    * Allocate an array of dense tag data.
    *\param index        Dense tag ID for which to allocate array.
    *\param bytes_per_ent  Bytes to allocate for each entity.
+   *\param counter      Memory counter of the tag
    *\return The newly allocated array, or NULL if error.
    */
-  void* allocate_tag_array( int index, int bytes_per_ent, const void* default_value = 0 );
+  void* allocate_tag_array( int index, int bytes_per_ent, 
+                            MemoryCounter* counter,
+                            const void* default_value = 0 );
   
   /**\brief Create new SequenceData that is a copy of a subset of this one
     *
@@ -136,7 +154,12 @@ private:
 
   void increase_tag_count( unsigned by_this_many );
 
-  void* create_data( int index, int bytes_per_ent, const void* initial_val = 0 );
+  void* create_data( int index, int bytes_per_ent, 
+                     MemoryCounter* counter,
+                     const void* initial_val = 0 );
+
+  //! Counter for arrays of per-entity sequence data
+  MemoryCounter* sequence_counter() const;
   void copy_data_subset( int index, 
                          int size_per_ent, 
                          const void* source, 
@@ -47,8 +47,17 @@ void SequenceManager::clear()
     // now re-create TypeSequenceManager instances
   for (EntityType t = MBVERTEX; t < MBMAXTYPE; ++t)
     new (typeData+t) TypeSequenceManager();
+  
+    // entity set lists were owned by the destroyed sets
+  setListPool.release();
 }  
 
+void SequenceManager::set_read_only_phase( bool read_only )
+{
+  for (EntityType t = MBVERTEX; t < MBMAXTYPE; ++t)
+    typeData[t].set_read_only_phase( read_only );
+}
+
 void SequenceManager::get_entities( Range& entities_out ) const
 {
   for (EntityType t = MBENTITYSET; t >= MBVERTEX; --t)
@@ -158,21 +167,23 @@ ErrorCode SequenceManager::create_vertex( const double coords[3],
 {
   const EntityHandle start = CREATE_HANDLE( MBVERTEX, MB_START_ID );
   const EntityHandle   end = CREATE_HANDLE( MBVERTEX,   MB_END_ID );
+  const int precision = floatCoords ? VertexSequence::FLOAT_COORDS 
+                                    : VertexSequence::DOUBLE_COORDS;
   bool append;
-  TypeSequenceManager::iterator seq = typeData[MBVERTEX].find_free_handle( start, end, append );
+  TypeSequenceManager::iterator seq = typeData[MBVERTEX].find_free_handle( start, end, append, precision );
   VertexSequence* vseq;
   
   if (seq == typeData[MBVERTEX].end()) {
     SequenceData* seq_data = 0;
     EntityID seq_data_size = 0;
-    handle = typeData[MBVERTEX].find_free_sequence( DEFAULT_VERTEX_SEQUENCE_SIZE, start, end, seq_data, seq_data_size );
+    handle = typeData[MBVERTEX].find_free_sequence( DEFAULT_VERTEX_SEQUENCE_SIZE, start, end, seq_data, seq_data_size, precision );
     if (!handle) 
       return MB_FAILURE;
     
     if (seq_data) 
-      vseq = new VertexSequence( handle, 1, seq_data );
+      vseq = new VertexSequence( handle, 1, seq_data, floatCoords );
     else
-      vseq = new VertexSequence( handle, 1, DEFAULT_VERTEX_SEQUENCE_SIZE );
+      vseq = new VertexSequence( handle, 1, DEFAULT_VERTEX_SEQUENCE_SIZE, floatCoords );
       
     ErrorCode rval = typeData[MBVERTEX].insert_sequence( vseq );
     if (MB_SUCCESS != rval) {
@@ -456,15 +467,17 @@ SequenceManager::create_entity_sequence( EntityType type,
     return MB_TYPE_OUT_OF_RANGE;
   
   case MBVERTEX:
-    if (size != 0)
+    if (size != VertexSequence::DOUBLE_COORDS && size != VertexSequence::FLOAT_COORDS)
       return MB_INDEX_OUT_OF_RANGE;
 
     if (data)
-      sequence = new VertexSequence( handle, count, data );
+      sequence = new VertexSequence( handle, count, data, 
+                                     size == VertexSequence::FLOAT_COORDS );
     else {
       if (!data_size)
         data_size = new_sequence_size(handle, count, sequence_size);
-      sequence = new VertexSequence( handle, count, data_size );
+      sequence = new VertexSequence( handle, count, data_size, 
+                                     size == VertexSequence::FLOAT_COORDS );
     }
     break;
   
@@ -787,6 +800,9 @@ void SequenceManager::get_memory_use( EntityType type,
                                       unsigned long& total_storage ) const
 {
   typeData[type].get_memory_use( total_entity_storage, total_storage );
+    // unused space in pooled set lists
+  if (MBENTITYSET == type)
+    total_storage += setListPool.slack_bytes();
 }
 
 void SequenceManager::get_memory_use( const Range& entities,
@@ -820,6 +836,13 @@ void SequenceManager::get_memory_use( const Range& entities,
       total_amortized_storage += temp_total;
     }
   }
+  
+    // share of unused space in pooled set lists
+  const EntityID num_sets = typeData[MBENTITYSET].get_number_entities();
+  if (num_sets && setListPool.slack_bytes()) {
+    const size_t count = std::min( (EntityID)entities.num_of_type( MBENTITYSET ), num_sets );
+    total_amortized_storage += (unsigned long)((double)setListPool.slack_bytes() * count / num_sets);
+  }
 }
 
 ErrorCode SequenceManager::reserve_tag_array( Error* error_handler, 
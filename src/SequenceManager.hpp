@@ -3,6 +3,7 @@
 
 #include "TypeSequenceManager.hpp"
 #include "TagInfo.hpp"
+#include "SetListPool.hpp"
 #include <vector>
 
 namespace moab {
@@ -14,6 +15,8 @@ class SequenceManager
 {
   public:
     
+    SequenceManager() : floatCoords( false ) {}
+    
     ~SequenceManager();
     
       /** Delete all contained data */
@@ -66,6 +69,14 @@ class SequenceManager
       /** Count entities of a given EntityType */
     EntityID get_number_entities( ) const;
       
+      /** Enable or disable read-only phase for all entity types.
+       *  See TypeSequenceManager::set_read_only_phase */
+    void set_read_only_phase( bool read_only );
+    
+      /** Test if in read-only phase */
+    bool read_only_phase() const
+      { return typeData[MBVERTEX].read_only_phase(); }
+      
       /** Get most recently accessed sequence for a given type */
     const EntitySequence* get_last_accessed_sequence( EntityType type ) const
       { return typeData[type].get_last_accessed(); }
@@ -129,8 +140,9 @@ class SequenceManager
        *\param type The type of of entity for which to allocate handles
        *\param num_entities Number of entities to allocate
        *\param nodes_per_entity Number of nodes in connectivity for elements,
-       *                    ignored MBVERTEX, MBPOLYGON, MBPOLYHEDRON, and
-       *                    MBENTITYSET types.
+       *                    ignored MBPOLYGON, MBPOLYHEDRON, and
+       *                    MBENTITYSET types.  For MBVERTEX, one of
+       *                    VertexSequence::DOUBLE_COORDS or FLOAT_COORDS.
        *\param start_id_hint Preferred ID portion for first handle.  
        *                    May be ignored if not available.
        *\param first_handle_out First allocated handle.  Allocated handles
@@ -236,6 +248,17 @@ class SequenceManager
     const TypeSequenceManager& entity_map( EntityType type ) const
       { return typeData[type]; }
     
+      /** Store coordinates of vertices subsequently created by 
+       *  create_vertex as float rather than double. */
+    void set_float_coordinates( bool enable )
+      { floatCoords = enable; }
+    bool float_coordinates() const
+      { return floatCoords; }
+    
+      /** Allocator for entity set contents and parent/child lists */
+    SetListPool* set_list_pool()
+      { return &setListPool; }
+    
     void get_memory_use( unsigned long& total_entity_storage,
                          unsigned long& total_storage ) const;
                          
@@ -320,6 +343,10 @@ class SequenceManager
     TypeSequenceManager typeData[MBMAXTYPE];
     
     std::vector<int> tagSizes;
+    
+    SetListPool setListPool;
+    
+    bool floatCoords; //!< precision for vertices from create_vertex
 
 };
 
@@ -0,0 +1,181 @@
+#include "SetListPool.hpp"
+#include "moab/MemoryCounter.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <algorithm>
+
+namespace moab {
+
+SetListPool::SetListPool()
+  : largeList(0), allocBytes(0), liveBytes(0)
+{
+  for (unsigned c = 0; c < NUM_CLASSES; ++c)
+    partialSlabs[c] = 0;
+}
+
+unsigned SetListPool::size_class( size_t count )
+{
+  unsigned c = 0;
+  while (class_size(c) < count)
+    ++c;
+  return c;
+}
+
+void SetListPool::link( Block*& list, Block* block )
+{
+  block->prev = 0;
+  block->next = list;
+  if (list)
+    list->prev = block;
+  list = block;
+}
+
+void SetListPool::unlink( Block*& list, Block* block )
+{
+  if (block->prev)
+    block->prev->next = block->next;
+  else
+    list = block->next;
+  if (block->next)
+    block->next->prev = block->prev;
+}
+
+size_t SetListPool::free_blocks( Block* list )
+{
+  size_t count = 0;
+  for (; list; ++count) {
+    Block* next = list->next;
+    free( list );
+    list = next;
+  }
+  return count;
+}
+
+SetListPool::Slab* SetListPool::new_slab( unsigned c )
+{
+  Slab* slab = (Slab*)malloc( SLAB_SIZE );
+  slabIndex.insert( std::upper_bound( slabIndex.begin(), slabIndex.end(), slab ), slab );
+  allocBytes += SLAB_SIZE;
+  MemoryCounter::category( MEM_SETS ).add( SLAB_SIZE );
+
+    // split slab into arrays and put them on its free list
+  slab->freeList = 0;
+  slab->sizeClass = c;
+  slab->used = 0;
+  const size_t size = class_size(c);
+  EntityHandle* array = reinterpret_cast<EntityHandle*>(slab + 1);
+  EntityHandle* const end = array + (SLAB_SIZE - sizeof(Slab)) / sizeof(EntityHandle);
+  for (; array + size <= end; array += size) {
+    *reinterpret_cast<EntityHandle**>(array) = slab->freeList;
+    slab->freeList = array;
+  }
+  link( partialSlabs[c], slab );
+  return slab;
+}
+
+void SetListPool::free_slab( Slab* slab )
+{
+  unlink( partialSlabs[slab->sizeClass], slab );
+  slabIndex.erase( std::lower_bound( slabIndex.begin(), slabIndex.end(), slab ) );
+  allocBytes -= SLAB_SIZE;
+  MemoryCounter::category( MEM_SETS ).remove( SLAB_SIZE );
+  free( slab );
+}
+
+SetListPool::Slab* SetListPool::find_slab( const EntityHandle* array ) const
+{
+  const Slab* key = reinterpret_cast<const Slab*>(array);
+  std::vector<Slab*>::const_iterator i;
+  i = std::upper_bound( slabIndex.begin(), slabIndex.end(), key );
+  assert( i != slabIndex.begin() );
+  return *--i;
+}
+
+EntityHandle* SetListPool::allocate( size_t count )
+{
+  liveBytes += capacity( count );
+  if (count > MAX_POOLED) {
+    const size_t bytes = sizeof(Block) + count * sizeof(EntityHandle);
+    Block* block = (Block*)malloc( bytes );
+    link( largeList, block );
+    allocBytes += bytes;
+    MemoryCounter::category( MEM_SETS ).add( bytes );
+    return reinterpret_cast<EntityHandle*>(block + 1);
+  }
+
+  const unsigned c = size_class( count );
+  Slab* slab = static_cast<Slab*>(partialSlabs[c]);
+  if (!slab)
+    slab = new_slab( c );
+  EntityHandle* array = slab->freeList;
+  slab->freeList = *reinterpret_cast<EntityHandle**>(array);
+  ++slab->used;
+  if (!slab->freeList)
+    unlink( partialSlabs[c], slab );
+  return array;
+}
+
+void SetListPool::deallocate( EntityHandle* array, size_t count )
+{
+  liveBytes -= capacity( count );
+  if (count > MAX_POOLED) {
+    Block* block = reinterpret_cast<Block*>(array) - 1;
+    unlink( largeList, block );
+    allocBytes -= sizeof(Block) + count * sizeof(EntityHandle);
+    MemoryCounter::category( MEM_SETS ).remove( sizeof(Block) + count * sizeof(EntityHandle) );
+    free( block );
+    return;
+  }
+
+  Slab* slab = find_slab( array );
+  assert( slab->sizeClass == size_class( count ) );
+  if (!slab->freeList)
+    link( partialSlabs[slab->sizeClass], slab );
+  *reinterpret_cast<EntityHandle**>(array) = slab->freeList;
+  slab->freeList = array;
+  
+    // Return an empty slab to the heap unless it is the only
+    // one in its size class with free space.
+  if (!--slab->used && (slab->prev || slab->next))
+    free_slab( slab );
+}
+
+EntityHandle* SetListPool::reallocate( EntityHandle* array, size_t old_count, size_t new_count )
+{
+  if (old_count > MAX_POOLED && new_count > MAX_POOLED) {
+    Block* block = reinterpret_cast<Block*>(array) - 1;
+    unlink( largeList, block );
+    block = (Block*)realloc( block, sizeof(Block) + new_count * sizeof(EntityHandle) );
+    link( largeList, block );
+    allocBytes = allocBytes - old_count * sizeof(EntityHandle) + new_count * sizeof(EntityHandle);
+    liveBytes = liveBytes - old_count * sizeof(EntityHandle) + new_count * sizeof(EntityHandle);
+    MemoryCounter::category( MEM_SETS ).resize( old_count * sizeof(EntityHandle),
+                                                new_count * sizeof(EntityHandle) );
+    return reinterpret_cast<EntityHandle*>(block + 1);
+  }
+
+  if (capacity( old_count ) == capacity( new_count ))
+    return array;
+
+  EntityHandle* result = allocate( new_count );
+  memcpy( result, array, (old_count < new_count ? old_count : new_count) * sizeof(EntityHandle) );
+  deallocate( array, old_count );
+  return result;
+}
+
+void SetListPool::release()
+{
+  for (size_t i = 0; i < slabIndex.size(); ++i)
+    free( slabIndex[i] );
+  const size_t count = slabIndex.size() + free_blocks( largeList );
+  MemoryCounter::category( MEM_SETS ).remove( allocBytes, count );
+  std::vector<Slab*>().swap( slabIndex );
+  largeList = 0;
+  for (unsigned c = 0; c < NUM_CLASSES; ++c)
+    partialSlabs[c] = 0;
+  allocBytes = liveBytes = 0;
+}
+
+} // namespace moab
@@ -0,0 +1,121 @@
+#ifndef MB_SET_LIST_POOL_HPP
+#define MB_SET_LIST_POOL_HPP
+
+#ifndef IS_BUILDING_MB
+#error "SetListPool.hpp isn't supposed to be included into an application"
+#endif
+
+#include "moab/Types.hpp"
+#include <stddef.h>
+#include <vector>
+
+namespace moab {
+
+/**\brief Pool allocator for entity set handle lists
+ *
+ * Entity sets with more than two parents, children, or contained
+ * ranges keep the handles in a separately allocated array.  Most such
+ * arrays are short, so arrays of up to MAX_POOLED handles are carved
+ * out of large slabs and recycled through a free list for each size
+ * class rather than allocated individually from the heap.  Longer
+ * arrays are allocated from the heap, but are also tracked by the
+ * pool.
+ *
+ * The capacity of an array is determined by its length, so callers
+ * need only pass the current length when resizing or freeing an
+ * array.  Each slab holds arrays of a single size class and keeps its
+ * own free list, so a slab is returned to the heap once all of its
+ * arrays are freed, except for one retained per size class to avoid
+ * repeatedly allocating and freeing a slab.  All memory is released
+ * when the pool is cleared or destroyed, including any arrays that
+ * were never deallocated.  Heap allocations are counted in the
+ * MEM_SETS MemoryCounter.
+ */
+class SetListPool
+{
+public:
+
+  SetListPool();
+  ~SetListPool() { release(); }
+
+    //! Allocate array of \c count handles
+  EntityHandle* allocate( size_t count );
+
+    //! Free array of \c count handles
+  void deallocate( EntityHandle* array, size_t count );
+
+    /**\brief Resize array, preserving contents
+     *
+     * Returns \c array if it has sufficient capacity for the
+     * new length.  Otherwise a new array is allocated and the
+     * first <code>min(old_count,new_count)</code> handles copied.
+     */
+  EntityHandle* reallocate( EntityHandle* array, size_t old_count, size_t new_count );
+
+    //! Free all memory
+  void release();
+
+    //! Bytes reserved for an array of \c count handles
+  static size_t capacity( size_t count )
+    { return sizeof(EntityHandle) * (count > MAX_POOLED ? count : class_size(size_class(count))); }
+
+    //! Total bytes allocated from the heap
+  unsigned long memory_use() const { return allocBytes; }
+
+    //! Bytes of allocated memory that are in use for handle arrays
+  unsigned long live_bytes() const { return liveBytes; }
+
+    //! Bytes of allocated memory not in use for handle arrays:
+    //! free arrays in slabs, unused slab tails, and block headers
+  unsigned long slack_bytes() const { return allocBytes - liveBytes; }
+
+    //! Number of slabs currently allocated
+  size_t num_slabs() const { return slabIndex.size(); }
+
+private:
+
+  SetListPool( const SetListPool& );
+  SetListPool& operator=( const SetListPool& );
+
+  enum {
+    MIN_POOLED = 4,                  //!< handles in smallest size class
+    NUM_CLASSES = 5,                 //!< size classes 4, 8, 16, 32, 64
+    MAX_POOLED = MIN_POOLED << (NUM_CLASSES-1),
+    SLAB_SIZE = 16384                //!< bytes in each slab
+  };
+
+    //! Header of each slab and each large array
+  struct Block {
+    Block* prev;
+    Block* next;
+  };
+
+    //! Header of each slab.  A slab is linked into the list for its
+    //! size class while it has free arrays.
+  struct Slab : public Block {
+    EntityHandle* freeList;  //!< first free array in slab
+    unsigned sizeClass;      //!< size class of all arrays in slab
+    unsigned used;           //!< number of arrays allocated from slab
+  };
+
+  static unsigned size_class( size_t count );
+  static size_t class_size( unsigned c ) { return (size_t)MIN_POOLED << c; }
+
+  Slab* new_slab( unsigned c );
+  void free_slab( Slab* slab );
+  Slab* find_slab( const EntityHandle* array ) const;
+
+  static void link( Block*& list, Block* block );
+  static void unlink( Block*& list, Block* block );
+  static size_t free_blocks( Block* list ); //!< returns number of blocks
+
+  Block* partialSlabs[NUM_CLASSES];    //!< slabs with free arrays, per class
+  std::vector<Slab*> slabIndex;        //!< all slabs, sorted by address
+  Block* largeList;                    //!< arrays longer than MAX_POOLED
+  unsigned long allocBytes;
+  unsigned long liveBytes;
+};
+
+} // namespace moab
+
+#endif
@@ -1136,7 +1136,7 @@ ErrorCode Skinner::find_skin_vertices_1D( Tag tag,
   // intersection with the input range and the edges adjacent to a vertex.
 
   ErrorCode rval;
-  Range::iterator hint = skin_verts.begin();
+  std::vector<EntityHandle> corners; // skin vertices, in sorted order
   
   // All input entities must be edges.
   if (!edges.all_of_dimension(1))
@@ -1172,10 +1172,12 @@ ErrorCode Skinner::find_skin_vertices_1D( Tag tag,
 #endif    
       // If adjacent to only one input edge, then vertex is on skin
     if (n == 1) {
-      hint = skin_verts.insert( hint, *it );
+      corners.push_back( *it );
     }
   }
   
+  if (!corners.empty())
+    skin_verts.insert_sorted_list( &corners[0], &corners[0] + corners.size() );
   return MB_SUCCESS;
 }
 
@@ -1548,9 +1550,7 @@ ErrorCode Skinner::find_skin_vertices_2D( Tag tag,
 
   ErrorCode rval;
   std::vector<EntityHandle>::iterator i, j;
-  Range::iterator hint;
-  if (skin_verts)
-    hint = skin_verts->begin();
+  std::vector<EntityHandle> corners; // skin vertices, in sorted order
   std::vector<EntityHandle> storage;
   const EntityHandle *conn;
   int len;
@@ -1657,7 +1657,7 @@ ErrorCode Skinner::find_skin_vertices_2D( Tag tag,
       // If user requested Range of *vertices* on the skin...
     if (skin_verts) {
         // Put skin vertex in output list
-      hint = skin_verts->insert( hint, *it );
+      corners.push_back( *it );
  
         // Add mid edge nodes to vertex list
       if (!corners_only && higher_order) {
@@ -1726,6 +1726,8 @@ ErrorCode Skinner::find_skin_vertices_2D( Tag tag,
 
   } // end for each vertex
   
+  if (!corners.empty())
+    skin_verts->insert_sorted_list( &corners[0], &corners[0] + corners.size() );
   return MB_SUCCESS;
 }
   
@@ -1771,9 +1773,7 @@ ErrorCode Skinner::find_skin_vertices_3D( Tag tag,
 
   ErrorCode rval;
   std::vector<EntityHandle>::iterator i, j;
-  Range::iterator hint;
-  if (skin_verts)
-    hint = skin_verts->begin();
+  std::vector<EntityHandle> corners; // skin vertices, in sorted order
   std::vector<EntityHandle> storage, storage2; // temp storage for conn lists
   const EntityHandle *conn, *conn2;
   int len, len2;
@@ -1921,7 +1921,7 @@ ErrorCode Skinner::find_skin_vertices_3D( Tag tag,
       // If user requested that skin *vertices* be passed back...
     if (skin_verts) {
         // Put skin vertex in output list
-      hint = skin_verts->insert( hint, *it );
+      corners.push_back( *it );
  
         // Add mid-edge and mid-face nodes to vertex list
       if (!corners_only && higher_order) {
@@ -2046,6 +2046,8 @@ ErrorCode Skinner::find_skin_vertices_3D( Tag tag,
     }
   } // end for each vertex
   
+  if (!corners.empty())
+    skin_verts->insert_sorted_list( &corners[0], &corners[0] + corners.size() );
   return MB_SUCCESS;
 }
 
@@ -47,11 +47,206 @@ namespace moab {
   return MB_INVALID_SIZE;
 }
 
+SparseTagMap::SparseTagMap( int value_size, MemoryCounter* counter )
+  : mAllocator(counter), mTable(0), tableSize(0), numEntries(0), 
+    slotSize(sizeof(EntityHandle) + sizeof(void*)),
+    valueSize(value_size), recordSize(0), 
+    poolBytes(0), poolNext(0), poolEnd(0), freeList(0)
+{
+    // keep slots and pooled values aligned to handle size, and leave
+    // room in pooled values for the free list pointer
+  const size_t align = sizeof(EntityHandle);
+  slotSize = (slotSize + align - 1) / align * align;
+  if (value_size <= MAX_POOLED_SIZE) {
+    recordSize = std::max( (size_t)value_size, sizeof(void*) );
+    recordSize = (recordSize + align - 1) / align * align;
+  }
+}
+
+SparseTagMap::~SparseTagMap()
+  { clear(); }
+
+void SparseTagMap::clear()
+{
+  if (!recordSize)
+    for (size_t i = 0; i < tableSize; ++i)
+      if (key(i) != EMPTY_SLOT)
+        mAllocator.destroy( value(i) );
+  release_pool();
+  MemoryCounter::deallocate( mTable );
+  mTable = 0;
+  tableSize = numEntries = 0;
+}
+
+void* SparseTagMap::allocate_value()
+{
+  if (!recordSize)
+    return mAllocator.allocate( valueSize );
+  
+  if (freeList) {
+    void* result = freeList;
+    freeList = *reinterpret_cast<void**>(freeList);
+    return result;
+  }
+  
+  if (poolNext == poolEnd) {
+      // start with small blocks so that tags on few entities stay
+      // small, and grow blocks with the number of values
+    const size_t min_count = 16, max_count = 4096;
+    size_t count = std::max( min_count, std::min( max_count, poolBytes / recordSize ) );
+    poolNext = reinterpret_cast<unsigned char*>(
+      MemoryCounter::allocate( count * recordSize, mAllocator.counter() ));
+    poolEnd = poolNext + count * recordSize;
+    poolBlocks.push_back( poolNext );
+    poolBytes += count * recordSize;
+  }
+  
+  void* result = poolNext;
+  poolNext += recordSize;
+  return result;
+}
+
+void SparseTagMap::release_value( void* ptr )
+{
+  if (!recordSize) {
+    mAllocator.destroy( ptr );
+    return;
+  }
+  
+  *reinterpret_cast<void**>(ptr) = freeList;
+  freeList = ptr;
+}
+
+void SparseTagMap::release_pool()
+{
+  for (size_t i = 0; i < poolBlocks.size(); ++i)
+    MemoryCounter::deallocate( poolBlocks[i] );
+  std::vector<unsigned char*>().swap( poolBlocks );
+  poolBytes = 0;
+  poolNext = poolEnd = 0;
+  freeList = 0;
+}
+
+void SparseTagMap::resize( size_t new_size )
+{
+  unsigned char* old_table = mTable;
+  const size_t old_size = tableSize;
+  
+  mTable = reinterpret_cast<unsigned char*>(
+    MemoryCounter::allocate( new_size * slotSize, mAllocator.counter() ));
+  tableSize = new_size;
+  for (size_t i = 0; i < tableSize; ++i)
+    key(i) = EMPTY_SLOT;
+  
+  for (size_t i = 0; i < old_size; ++i) {
+    const unsigned char* slot = old_table + i * slotSize;
+    const EntityHandle h = *reinterpret_cast<const EntityHandle*>(slot);
+    if (h != EMPTY_SLOT)
+      memcpy( mTable + find_slot(h) * slotSize, slot, slotSize );
+  }
+  MemoryCounter::deallocate( old_table );
+}
+
+void SparseTagMap::reserve( size_t count )
+{
+    // keep table at most 3/4 full
+  size_t new_size = tableSize ? tableSize : 16;
+  while (4 * count > 3 * new_size)
+    new_size *= 2;
+  if (new_size != tableSize)
+    resize( new_size );
+}
+
+void* SparseTagMap::insert( EntityHandle h )
+{
+  if (4 * (numEntries + 1) > 3 * tableSize)
+    reserve( numEntries + 1 );
+  return insert_no_resize( h );
+}
+
+inline void* SparseTagMap::insert_no_resize( EntityHandle h )
+{
+  size_t i = find_slot( h );
+  if (key(i) == EMPTY_SLOT) {
+    key(i) = h;
+    ++numEntries;
+    value(i) = allocate_value();
+  }
+  return value(i);
+}
+
+EntityHandle SparseTagMap::get_values( const Range& entities, void* data,
+                                       const void* default_value ) const
+{
+  unsigned char* ptr = reinterpret_cast<unsigned char*>(data);
+  Range::const_pair_iterator p;
+  for (p = entities.const_pair_begin(); p != entities.const_pair_end(); ++p) {
+    for (EntityHandle h = p->first; h <= p->second; ++h, ptr += valueSize) {
+      const void* value = find_value( h );
+      if (!value && !(value = default_value))
+        return h;
+      memcpy( ptr, value, valueSize );
+    }
+  }
+  return 0;
+}
+
+void SparseTagMap::set_values( const Range& entities, const void* data, bool same_value )
+{
+    // Size table once for the whole range rather than growing it
+    // repeatedly while inserting.
+  reserve( numEntries + entities.size() );
+  const unsigned char* ptr = reinterpret_cast<const unsigned char*>(data);
+  const size_t step = same_value ? 0 : valueSize;
+  Range::const_pair_iterator p;
+  for (p = entities.const_pair_begin(); p != entities.const_pair_end(); ++p)
+    for (EntityHandle h = p->first; h <= p->second; ++h, ptr += step)
+      memcpy( insert_no_resize( h ), ptr, valueSize );
+}
+
+bool SparseTagMap::erase( EntityHandle h )
+{
+  if (!numEntries)
+    return false;
+  size_t i = find_slot( h );
+  if (key(i) != h)
+    return false;
+  
+  release_value( value(i) );
+  if (!--numEntries)
+    release_pool();
+  
+    // Move back any following entries that would no longer be 
+    // reachable from their home slot once slot i is empty.
+  const size_t mask = tableSize - 1;
+  for (size_t j = (i + 1) & mask; key(j) != EMPTY_SLOT; j = (j + 1) & mask) {
+    size_t k = home( key(j) );
+      // leave entry j in place if its home slot is cyclically in (i,j]
+    if (i <= j ? (i < k && k <= j) : (i < k || k <= j))
+      continue;
+    memcpy( mTable + i*slotSize, mTable + j*slotSize, slotSize );
+    i = j;
+  }
+  key(i) = EMPTY_SLOT;
+  return true;
+}
+
+unsigned long SparseTagMap::memory_use() const
+{
+  unsigned long result = tableSize * slotSize;
+  if (recordSize)
+    result += poolBytes;
+  else
+    result += numEntries * valueSize;
+  return result;
+}
+
 SparseTag::SparseTag(const char* name,
                      int size,
                      DataType type,
                      const void* default_value)
-  : TagInfo( name, size, type, default_value, size )
+  : TagInfo( name, size, type, default_value, size ),
+    mData( size, memory_counter() )
   { }
 
 SparseTag::~SparseTag()
@@ -62,56 +257,28 @@ TagType SparseTag::get_storage_type() const
 
 ErrorCode SparseTag::release_all_data( SequenceManager*, Error*, bool )
 {
-  for(MapType::iterator i = mData.begin(); i != mData.end(); ++i)
-    mAllocator.destroy(i->second);
   mData.clear();
   return MB_SUCCESS;
 }
 
 ErrorCode SparseTag::set_data(Error*, EntityHandle entity_handle, const void* data)
 {
-#ifdef HAVE_UNORDERED_MAP
-  MapType::iterator iter = mData.find(entity_handle);
-#else
-  MapType::iterator iter = mData.lower_bound(entity_handle);
-#endif
-  
-  // data space already exists
-  if (iter!= mData.end() && iter->first == entity_handle)
-  {
-    memcpy( iter->second, data, get_size());
-  }
-  // we need to make some data space
-  else 
-  {
-    void *new_data = allocate_data(entity_handle, iter, false);
-    memcpy(new_data, data, get_size());
-  }
-
+  memcpy( mData.insert(entity_handle), data, get_size() );
   return MB_SUCCESS;
 }
 
-ErrorCode SparseTag::get_data_ptr(EntityHandle entity_handle, const void*& ptr, bool allocate) const
+ErrorCode SparseTag::get_data_ptr(EntityHandle entity_handle, const void*& ptr) const
 {
-  MapType::const_iterator iter = mData.find(entity_handle);
-
-  if (iter != mData.end())
-    ptr = iter->second;
-  else if (get_default_value() && allocate)
-    ptr = const_cast<SparseTag*>(this)->allocate_data(entity_handle, iter, allocate);
-  else 
-    return MB_FAILURE;
-  
-  return MB_SUCCESS;
+  ptr = mData.find_value(entity_handle);
+  return ptr ? MB_SUCCESS : MB_FAILURE;
 }
 
 ErrorCode SparseTag::get_data(Error* error, EntityHandle entity_handle, void* data) const
 {
-  const void* ptr = 0;
-  ErrorCode rval = get_data_ptr(entity_handle, ptr, false);
-  if (MB_SUCCESS == rval) {
+  const void* ptr = mData.find_value(entity_handle);
+  if (ptr) {
     memcpy( data, ptr, get_size() );
-    return rval;
+    return MB_SUCCESS;
   }
   else if (get_default_value()) {
     memcpy( data, get_default_value(), get_size() );
@@ -123,12 +290,8 @@ ErrorCode SparseTag::get_data(Error* error, EntityHandle entity_handle, void* da
 
 ErrorCode SparseTag::remove_data( Error* error, EntityHandle entity_handle )
 {
-  MapType::iterator i = mData.find(entity_handle);
-  if (i == mData.end()) 
+  if (!mData.erase(entity_handle))
     return not_found(error, get_name(), entity_handle);
-  
-  mAllocator.destroy(i->second);
-  mData.erase(i);
   return MB_SUCCESS;
 }
 
@@ -151,12 +314,9 @@ ErrorCode SparseTag::get_data( const SequenceManager*,
                                const Range& entities,
                                void* data ) const
 {
-  ErrorCode rval;
-  unsigned char* ptr = reinterpret_cast<unsigned char*>(data);
-  Range::const_iterator i;
-  for (i = entities.begin(); i != entities.end(); ++i, ptr += get_size())
-    if (MB_SUCCESS != (rval = get_data(error, *i, ptr)))
-      return rval;
+  EntityHandle missing = mData.get_values( entities, data, get_default_value() );
+  if (missing)
+    return not_found(error, get_name(), missing);
   return MB_SUCCESS;
 }
 
@@ -222,6 +382,7 @@ ErrorCode SparseTag::set_data( SequenceManager* seqman,
   if (MB_SUCCESS != rval)
     return rval;
 
+  mData.reserve( std::max( mData.size(), num_entities ) );
   const unsigned char* ptr = reinterpret_cast<const unsigned char*>(data);
   for (size_t i = 0; i < num_entities; ++i, ptr += get_size())
     if (MB_SUCCESS != (rval = set_data(error, entities[i], ptr)))
@@ -238,11 +399,7 @@ ErrorCode SparseTag::set_data( SequenceManager* seqman,
   if (MB_SUCCESS != rval)
     return rval;
 
-  const unsigned char* ptr = reinterpret_cast<const unsigned char*>(data);
-  Range::const_iterator i;
-  for (i = entities.begin(); i != entities.end(); ++i, ptr += get_size())
-    if (MB_SUCCESS != (rval = set_data(error, *i, ptr)))
-      return rval;
+  mData.set_values( entities, data, false );
   return MB_SUCCESS;
 }
 
@@ -261,6 +418,7 @@ ErrorCode SparseTag::set_data( SequenceManager* seqman,
   if (MB_SUCCESS != rval)
     return rval;
   
+  mData.reserve( std::max( mData.size(), num_entities ) );
   for (size_t i = 0; i < num_entities; ++i, ++pointers)
     if (MB_SUCCESS != (rval = set_data(error, entities[i], *pointers)))
       return rval;
@@ -281,6 +439,7 @@ ErrorCode SparseTag::set_data( SequenceManager* seqman,
   if (MB_SUCCESS != rval)
     return rval;
   
+  mData.reserve( std::max( mData.size(), entities.size() ) );
   Range::const_iterator i;
   for (i = entities.begin(); i != entities.end(); ++i, ++pointers)
     if (MB_SUCCESS != (rval = set_data(error, *i, *pointers)))
@@ -302,6 +461,7 @@ ErrorCode SparseTag::clear_data( SequenceManager* seqman,
   if (MB_SUCCESS != rval)
     return rval;
   
+  mData.reserve( std::max( mData.size(), num_entities ) );
   for (size_t i = 0; i < num_entities; ++i)
     if (MB_SUCCESS != (rval = set_data(error, entities[i], value_ptr)))
       return rval;
@@ -321,10 +481,7 @@ ErrorCode SparseTag::clear_data( SequenceManager* seqman,
   if (MB_SUCCESS != rval)
     return rval;
   
-  Range::const_iterator i;
-  for (i = entities.begin(); i != entities.end(); ++i)
-    if (MB_SUCCESS != (rval = set_data(error, *i, value_ptr)))
-      return rval;
+  mData.set_values( entities, value_ptr, true );
   return MB_SUCCESS;
 }
 
@@ -379,8 +536,10 @@ ErrorCode SparseTag::tag_iterate( SequenceManager* seqman,
   rval = get_data_ptr(*iter, ptr );
   if (MB_SUCCESS == rval) 
     data_ptr = const_cast<void*>(ptr);
-  else if (get_default_value() && allocate)
-    ptr = allocate_data(*iter, mData.end());
+  else if (get_default_value() && allocate) {
+    data_ptr = mData.insert(*iter);
+    memcpy( data_ptr, get_default_value(), get_size() );
+  }
   else {
       // if allocation was not requested, need to increment the iterator so that
       // the count can be computed properly
@@ -398,24 +557,25 @@ void get_tagged( const SparseTag::MapType& mData,
                  EntityType type,
                  Container& output_range )
 {
+    // Table order is arbitrary, so sort handles before inserting
+    // them such that each insertion is an append to the range.
+  std::vector<EntityHandle> handles;
   SparseTag::MapType::const_iterator iter;
-  typename Container::iterator hint = output_range.begin();
   if (MBMAXTYPE == type) {
+    handles.reserve( mData.size() );
     for (iter = mData.begin(); iter != mData.end(); ++iter)
-      hint = output_range.insert( hint, iter->first );
+      handles.push_back( iter->first );
   }
   else {
-#ifdef HAVE_UNORDERED_MAP
     for (iter = mData.begin(); iter != mData.end(); ++iter)
       if (TYPE_FROM_HANDLE(iter->first) == type)
-        hint = output_range.insert( hint, iter->first );    
-#else
-    iter = mData.lower_bound( FIRST_HANDLE(type) );
-    SparseTag::MapType::const_iterator end = mData.lower_bound( LAST_HANDLE(type)+1 );
-    for (; iter != end; ++iter)
-      hint = output_range.insert( hint, iter->first );
-#endif
+        handles.push_back( iter->first );
   }
+  std::sort( handles.begin(), handles.end() );
+  
+  typename Container::iterator hint = output_range.begin();
+  for (size_t i = 0; i < handles.size(); ++i)
+    hint = output_range.insert( hint, handles[i] );
 }
 
 template <class Container> static inline
@@ -424,10 +584,9 @@ void get_tagged( const SparseTag::MapType& mData,
                  Range::const_iterator end,
                  Container& output_range )
 {
-  SparseTag::MapType::const_iterator iter;
   typename Container::iterator hint = output_range.begin();
   for (Range::const_iterator i = begin; i != end; ++i)
-    if (mData.find(*i) != mData.end())
+    if (mData.find_value(*i))
       hint = output_range.insert( hint, *i );
 }
 
@@ -482,8 +641,6 @@ ErrorCode SparseTag::find_entities_with_value(
   if (value_bytes && value_bytes != get_size())
     return invalid_size( error, get_name(), get_size(), value_bytes );
   
-  MapType::const_iterator iter, end;
-#ifdef HAVE_UNORDERED_MAP
   if (intersect_entities) {
     std::pair<Range::iterator,Range::iterator> r;
     if (type == MBMAXTYPE) {
@@ -511,36 +668,13 @@ ErrorCode SparseTag::find_entities_with_value(
                            tmp.begin(), tmp.end(),
                            mData, output_entities );
   }
-#else
-  if (intersect_entities) {
-    for (Range::const_pair_iterator p = intersect_entities->begin();
-         p != intersect_entities->end(); ++p) {
-      iter = mData.lower_bound( p->first );
-      end = mData.upper_bound( p->second );
-      find_tag_values_equal( *this, value, get_size(), iter, end, 
-                             output_entities);
-    }
-  }
-  else {
-    if (type == MBMAXTYPE) {
-      iter = mData.begin();
-      end = mData.end();
-    }
-    else {
-      iter = mData.lower_bound( CREATE_HANDLE( type, MB_START_ID ) );
-      end = mData.upper_bound( CREATE_HANDLE( type, MB_END_ID ) );
-    }
-    find_tag_values_equal( *this, value, get_size(), iter, end, 
-                           output_entities);
-  }
-#endif
   
   return MB_SUCCESS;
 }
 
 bool SparseTag::is_tagged( const SequenceManager*, EntityHandle h ) const
 {
-  return mData.find(h) != mData.end();
+  return 0 != mData.find_value(h);
 }
   
 ErrorCode SparseTag::get_memory_use( const SequenceManager*,
@@ -548,9 +682,9 @@ ErrorCode SparseTag::get_memory_use( const SequenceManager*,
                                      unsigned long& per_entity ) const
 
 {
-  per_entity = get_size() + 4*sizeof(void*);
-  total = (mData.size() * per_entity)
-        + sizeof(*this) + TagInfo::get_memory_use();
+  const unsigned long table = mData.memory_use();
+  per_entity = mData.empty() ? 0 : table / mData.size();
+  total = table + sizeof(*this) + TagInfo::get_memory_use();
       
   return MB_SUCCESS;
 }
@@ -26,14 +26,8 @@
 #endif
 
 
-#define STRINGIFY_(X) #X
-#define STRINGIFY(X) STRINGIFY_(X)
-#ifdef HAVE_UNORDERED_MAP
-# include STRINGIFY(HAVE_UNORDERED_MAP)
-#else
-# include <map>
-#endif
 #include <vector>
+#include <utility>
 
 #include "TagInfo.hpp"
 #include <stdlib.h>
@@ -45,15 +39,201 @@ class SparseTagDataAllocator
 {
 public:
   //! constructor
-  SparseTagDataAllocator(){}
+  SparseTagDataAllocator( MemoryCounter* counter = 0 ) : mCounter(counter) {}
   //! destructor
   ~SparseTagDataAllocator(){}
   //! allocates memory of size and returns pointer
-  void* allocate(size_t data_size) { return malloc(data_size); }
+  void* allocate(size_t data_size) { return MemoryCounter::allocate(data_size, mCounter); }
   //! frees the memory
-  void destroy(void* p){ free(p); }
+  void destroy(void* p){ MemoryCounter::deallocate(p); }
+  //! counter charged for allocated memory
+  MemoryCounter* counter() const { return mCounter; }
+private:
+  MemoryCounter* mCounter;
+};
+
+/**\brief Hash table of sparse tag values
+ *
+ * Open-addressing table of slots, each holding an entity handle 
+ * and a pointer to the tag value.  Collisions are resolved
+ * by linear probing, and removal shifts the following entries back so
+ * that lookups never need to skip deleted slots.
+ *
+ * Values are never stored in the table itself, so that pointers to 
+ * them remain valid when the table is resized or entries are moved.
+ * Values of at most MAX_POOLED_SIZE bytes are carved out of blocks 
+ * of memory shared by many values, avoiding a separate allocation 
+ * per entity; the space of removed values is reused for new values, 
+ * and the blocks are released once the table is empty.  Larger
+ * values are allocated individually.
+ */
+class SparseTagMap
+{
+public:
+
+  enum { MAX_POOLED_SIZE = 4 * sizeof(EntityHandle) };
+
+  SparseTagMap( int value_size, MemoryCounter* counter = 0 );
+  ~SparseTagMap();
+
+  size_t size() const { return numEntries; }
+  bool empty() const { return 0 == numEntries; }
+
+  //! get pointer to value for entity, or NULL if entity is not in the table
+  inline void* find_value( EntityHandle h ) const;
+  
+  //! get pointer to value for entity, adding an entry with an 
+  //! uninitialized value if the entity is not in the table.
+  void* insert( EntityHandle h );
+  
+  //! remove entry for entity, returns false if entity is not in the table
+  bool erase( EntityHandle h );
+  
+  //! remove all entries and release all memory
+  void clear();
+  
+  //! grow the table such that it can hold at least \c count entries
+  //! without being resized
+  void reserve( size_t count );
+  
+  //! Copy the values of a range of entities to consecutive locations
+  //! in 'data', using 'default_value' for entities not in the table.
+  //! Returns zero, or the first entity not in the table if there is
+  //! no default value (the values for preceding entities are copied).
+  EntityHandle get_values( const Range& entities, void* data,
+                           const void* default_value ) const;
+  
+  //! Set the values of a range of entities from consecutive values
+  //! in 'data', or all to the single value in 'data' if 'same_value'
+  //! is true.  The table is resized at most once.
+  void set_values( const Range& entities, const void* data, bool same_value );
+  
+  //! bytes allocated for the table and values, including unused
+  //! space in pooled value blocks
+  unsigned long memory_use() const;
+
+  //! Iterate over entries in the table in no particular order.  Has
+  //! the same interface as a const_iterator of std::map<EntityHandle,void*>
+  class const_iterator
+  {
+  public:
+    typedef std::pair<EntityHandle,const void*> value_type;
+    const_iterator() : mMap(0), mSlot(0) {}
+    bool operator==( const const_iterator& other ) const
+      { return mSlot == other.mSlot; }
+    bool operator!=( const const_iterator& other ) const
+      { return mSlot != other.mSlot; }
+    const value_type& operator*() const { return mValue; }
+    const value_type* operator->() const { return &mValue; }
+    const_iterator& operator++() { ++mSlot; advance(); return *this; }
+    const_iterator operator++(int) 
+      { const_iterator tmp(*this); ++*this; return tmp; }
+  private:
+    friend class SparseTagMap;
+    const_iterator( const SparseTagMap* map, size_t slot )
+      : mMap(map), mSlot(slot) { advance(); }
+    inline void advance();
+    const SparseTagMap* mMap;
+    size_t mSlot;
+    value_type mValue;
+  };
+  
+  const_iterator begin() const { return const_iterator( this, 0 ); }
+  const_iterator end() const { return const_iterator( this, tableSize ); }
+  inline const_iterator find( EntityHandle h ) const;
+
+private:
+
+  SparseTagMap( const SparseTagMap& );
+  SparseTagMap& operator=( const SparseTagMap& );
+
+  static const EntityHandle EMPTY_SLOT = ~(EntityHandle)0;
+
+  EntityHandle& key( size_t slot ) const
+    { return *reinterpret_cast<EntityHandle*>(mTable + slot * slotSize); }
+  void*& value( size_t slot ) const
+    { return *reinterpret_cast<void**>(mTable + slot * slotSize + sizeof(EntityHandle)); }
+  
+  //! first slot to check for entity
+  size_t home( EntityHandle h ) const
+    {
+      size_t x = h;
+      x ^= x >> (4*sizeof(size_t));
+      x *= (size_t)0x9E3779B1u;
+      x ^= x >> (2*sizeof(size_t));
+      return x & (tableSize - 1);
+    }
+  
+  //! slot containing entity, or first empty slot in the entity's probe sequence
+  inline size_t find_slot( EntityHandle h ) const;
+  
+  //! as insert, for a table known to have room for another entry
+  inline void* insert_no_resize( EntityHandle h );
+  
+  void resize( size_t new_size );
+  
+  //! get storage for a value
+  void* allocate_value();
+  //! release storage for a value
+  void release_value( void* ptr );
+  //! release all pooled value blocks
+  void release_pool();
+
+  //! allocator for values too large to pool
+  SparseTagDataAllocator mAllocator;
+
+  unsigned char* mTable;  //!< tableSize slots of slotSize bytes
+  size_t tableSize;       //!< number of slots, zero or a power of two
+  size_t numEntries;      //!< number of occupied slots
+  size_t slotSize;        //!< bytes per slot: handle plus value pointer
+  size_t valueSize;       //!< bytes per tag value
+  size_t recordSize;      //!< bytes per pooled value, zero if not pooled
+  
+  std::vector<unsigned char*> poolBlocks; //!< blocks of pooled values
+  size_t poolBytes;       //!< total size of poolBlocks
+  unsigned char* poolNext;  //!< first unused value in last block
+  unsigned char* poolEnd;   //!< end of last block
+  void* freeList;         //!< released pooled values, linked through first word
 };
 
+inline size_t SparseTagMap::find_slot( EntityHandle h ) const
+{
+  const size_t mask = tableSize - 1;
+  size_t i = home(h);
+  for (;;) {
+    EntityHandle k = key(i);
+    if (k == h || k == EMPTY_SLOT)
+      return i;
+    i = (i + 1) & mask;
+  }
+}
+
+inline void* SparseTagMap::find_value( EntityHandle h ) const
+{
+  if (!numEntries)
+    return 0;
+  size_t i = find_slot( h );
+  return key(i) == h ? value(i) : 0;
+}
+
+inline SparseTagMap::const_iterator SparseTagMap::find( EntityHandle h ) const
+{
+  if (!numEntries)
+    return end();
+  size_t i = find_slot( h );
+  return key(i) == h ? const_iterator( this, i ) : end();
+}
+
+inline void SparseTagMap::const_iterator::advance()
+{
+  while (mSlot < mMap->tableSize && mMap->key(mSlot) == EMPTY_SLOT)
+    ++mSlot;
+  if (mSlot < mMap->tableSize) {
+    mValue.first = mMap->key(mSlot);
+    mValue.second = mMap->value(mSlot);
+  }
+}
+
 
 //! Sparse tag data
 class SparseTag : public TagInfo
@@ -409,20 +589,13 @@ public:
 
 
   //! map of entity id and tag data
-#ifdef HAVE_UNORDERED_MAP
-  typedef UNORDERED_MAP_NS::unordered_map<EntityHandle,void*> MapType;
-#else
-  typedef std::map<EntityHandle,void*> MapType;
-#endif
+  typedef SparseTagMap MapType;
 
 private:
   
   SparseTag( const SparseTag& );
   SparseTag& operator=( const SparseTag& );
 
-    //! allocate an entry for this sparse tag w/o setting its value (yet)
-  inline void *allocate_data(EntityHandle h, MapType::const_iterator iter, bool copy_default = true);
-  
   //! set the tag data for an entity id
   //!\NOTE Will fail with MB_VARIABLE_DATA_LENGTH if called for 
   //!      variable-length tag.
@@ -435,33 +608,17 @@ private:
   inline
   ErrorCode get_data(Error*, EntityHandle entity_handle, void* data) const;
 
-  //! get the variable-length data for an entity id
+  //! get pointer to the stored tag data for an entity id
   inline
-  ErrorCode get_data_ptr(EntityHandle entity_handle, const void*& data, bool allocate = true) const;
+  ErrorCode get_data_ptr(EntityHandle entity_handle, const void*& data) const;
 
   //! removes the data
   inline
   ErrorCode remove_data(Error*, EntityHandle entity_handle);
 
-  //! allocator for this collection
-  SparseTagDataAllocator mAllocator;
-
   MapType mData;
 };
 
-inline void *SparseTag::allocate_data(EntityHandle h, MapType::const_iterator iter, bool copy_default) 
-{
-  void* new_data = mAllocator.allocate(get_size());
-#ifdef HAVE_UNORDERED_MAP
-  mData.insert(iter, std::pair<const EntityHandle,void*>(h, new_data));
-#else
-  mData[h] = new_data;
-#endif
-  if (copy_default)
-    memcpy(new_data, get_default_value(), get_size());
-  return new_data;
-}
-
 } // namespace moab
 
 #endif // SPARSE_TAG_HPP
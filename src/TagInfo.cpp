@@ -1,4 +1,5 @@
 #include "TagInfo.hpp"
+#include "TagValueIndex.hpp"
 #include "moab/Error.hpp"
 #include <string.h>  /* memcpy */
 #include <stdlib.h>  /* realloc & free */
@@ -14,7 +15,9 @@ TagInfo::TagInfo( const char* name,
  : mDefaultValue(0),
    mDefaultValueSize(default_value_size),
    mDataSize(size),
-   dataType(type)
+   dataType(type),
+   valueIndex(0),
+   memCounter( &MemoryCounter::category( MEM_TAGS ) )
 {
   if (default_value) {
     mDefaultValue = malloc( mDefaultValueSize );
@@ -26,11 +29,36 @@ TagInfo::TagInfo( const char* name,
 
 TagInfo::~TagInfo() 
 {
+  delete valueIndex;
   free( mDefaultValue );
   mDefaultValue = 0;
   mDefaultValueSize = 0;
 }
 
+ErrorCode TagInfo::set_value_index( bool enable )
+{
+  if (!enable) {
+    delete valueIndex;
+    valueIndex = 0;
+  }
+  else if (!valueIndex) {
+    TagType storage = get_storage_type();
+    if (variable_length() || (MB_TAG_SPARSE != storage && MB_TAG_DENSE != storage)
+     || get_size() > TagValueIndex::MAX_VALUE_SIZE)
+      return MB_TYPE_OUT_OF_RANGE;
+    valueIndex = new TagValueIndex( this );
+  }
+  return MB_SUCCESS;
+}
+
+unsigned long TagInfo::get_memory_use() const
+{
+  unsigned long total = get_default_value_size() + get_name().size();
+  if (valueIndex)
+    total += valueIndex->memory_use();
+  return total;
+}
+
 int TagInfo::size_from_data_type( DataType t )
 {
   static const int sizes[] = { 1, 
@@ -2,6 +2,7 @@
 #define TAG_INFO_HPP
 
 #include "moab/Range.hpp"
+#include "moab/MemoryCounter.hpp"
 #include <string>
 
 namespace moab {
@@ -9,6 +10,7 @@ namespace moab {
 class SequenceManager;
 class Range;
 class Error;
+class TagValueIndex;
 
 // ! stores information about a tag
 class TagInfo
@@ -19,7 +21,9 @@ public:
   TagInfo() : mDefaultValue(0),
               mDefaultValueSize(0),
               mDataSize(0), 
-              dataType(MB_TYPE_OPAQUE)
+              dataType(MB_TYPE_OPAQUE),
+              valueIndex(0),
+              memCounter( &MemoryCounter::category( MEM_TAGS ) )
               {}
 
   //! constructor that takes all parameters
@@ -93,6 +97,20 @@ public:
   virtual
   TagType get_storage_type() const = 0;
 
+    //! Get index of entities by tag value, or NULL if not enabled
+  TagValueIndex* value_index() const { return valueIndex; }
+  
+    /**\brief Create or destroy index of entities by tag value
+     *
+     *\return MB_TYPE_OUT_OF_RANGE if enabling an index for a 
+     *        variable-length tag or a tag with bit or mesh storage.
+     */
+  ErrorCode set_value_index( bool enable );
+
+    //! Counter for memory allocated to store values of this tag
+  MemoryCounter* memory_counter() { return &memCounter; }
+  const MemoryCounter* memory_counter() const { return &memCounter; }
+
   /**\brief Get tag value for passed entities
    * 
    * Get tag values for specified entities.
@@ -412,10 +430,7 @@ public:
 
 protected:    
 
-  unsigned long get_memory_use() const
-  {
-    return get_default_value_size() + get_name().size();
-  }
+  unsigned long get_memory_use() const;
 
 private:
   
@@ -443,6 +458,12 @@ private:
 
   //! stores the tag name
   std::string mTagName;
+  
+  //! optional index of entities by tag value
+  TagValueIndex* valueIndex;
+
+  //! memory allocated for tag values, also counted in MEM_TAGS
+  MemoryCounter memCounter;
 };
 
 } // namespace moab
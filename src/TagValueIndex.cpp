@@ -0,0 +1,173 @@
+#include "TagValueIndex.hpp"
+#include "TagInfo.hpp"
+#include "moab/Error.hpp"
+#include "Internals.hpp"
+#include <assert.h>
+
+namespace moab {
+
+TagValueIndex::TagValueIndex( const TagInfo* tag )
+  : tagInfo( tag ), isValid( false )
+{}
+
+void TagValueIndex::update( const SequenceManager* seqman, 
+                            const EntityHandle* entities, 
+                            size_t num_entities,
+                            bool insert )
+{
+  if (!isValid || !num_entities)
+    return;
+  
+    // Read current values.  Errors (for entities without a value or
+    // entities that no longer exist) are expected, so don't let them
+    // clobber the error message of the caller.
+  Error error;
+  const size_t size = tagInfo->get_size();
+  valueBuffer.resize( size * num_entities );
+  bool all_valid = 
+    (MB_SUCCESS == tagInfo->get_data( seqman, &error, entities, num_entities, &valueBuffer[0] ));
+  
+  for (size_t i = 0; i < num_entities; ++i) {
+    const unsigned char* value = &valueBuffer[i*size];
+    if (!all_valid && 
+        MB_SUCCESS != tagInfo->get_data( seqman, &error, entities+i, 1, &valueBuffer[i*size] ))
+      continue;
+    if (tagInfo->equals_default_value( value ))
+      continue;
+    
+    Key key;
+    make_key( value, key );
+    if (insert) {
+      Entry& entry = valueMap[key];
+      if (entry.multi)
+        entry.multi->insert( entities[i] );
+      else if (!entry.single || entry.single == entities[i])
+        entry.single = entities[i];
+      else {
+        entry.multi = new Range;
+        entry.multi->insert( entry.single );
+        entry.multi->insert( entities[i] );
+      }
+    }
+    else {
+      MapType::iterator j = valueMap.find( key );
+      if (j == valueMap.end())
+        continue;
+      Entry& entry = j->second;
+      if (entry.multi) {
+        entry.multi->erase( entities[i] );
+        if (entry.multi->empty()) {
+          delete entry.multi;
+          valueMap.erase( j );
+        }
+      }
+      else if (entry.single == entities[i])
+        valueMap.erase( j );
+    }
+  }
+}
+
+void TagValueIndex::remove( const SequenceManager* seqman, 
+                            const EntityHandle* entities, size_t num_entities )
+{
+  update( seqman, entities, num_entities, false );
+}
+
+void TagValueIndex::add( const SequenceManager* seqman, 
+                         const EntityHandle* entities, size_t num_entities )
+{
+  update( seqman, entities, num_entities, true );
+}
+
+void TagValueIndex::remove( const SequenceManager* seqman, const Range& entities )
+{
+  if (!isValid || entities.empty())
+    return;
+  std::vector<EntityHandle> list( entities.begin(), entities.end() );
+  update( seqman, &list[0], list.size(), false );
+}
+
+void TagValueIndex::add( const SequenceManager* seqman, const Range& entities )
+{
+  if (!isValid || entities.empty())
+    return;
+  std::vector<EntityHandle> list( entities.begin(), entities.end() );
+  update( seqman, &list[0], list.size(), true );
+}
+
+void TagValueIndex::make_key( const void* value, Key& key ) const
+{
+  const size_t size = tagInfo->get_size();
+  memcpy( key.bytes, value, size );
+  memset( key.bytes + size, 0, sizeof(key.bytes) - size );
+}
+
+void TagValueIndex::clear()
+{
+  for (MapType::iterator i = valueMap.begin(); i != valueMap.end(); ++i)
+    delete i->second.multi;
+  valueMap.clear();
+  std::vector<unsigned char>().swap( valueBuffer );
+}
+
+void TagValueIndex::rebuild( const SequenceManager* seqman )
+{
+  clear();
+  isValid = true;
+  Range tagged;
+  if (MB_SUCCESS != tagInfo->get_tagged_entities( seqman, tagged ))
+    return;
+  
+    // Populate in blocks to limit size of temporary arrays
+  const size_t block = 4096;
+  std::vector<EntityHandle> list;
+  list.reserve( block );
+  for (Range::const_iterator i = tagged.begin(); i != tagged.end(); ++i) {
+    list.push_back( *i );
+    if (list.size() == block) {
+      update( seqman, &list[0], list.size(), true );
+      list.clear();
+    }
+  }
+  if (!list.empty())
+    update( seqman, &list[0], list.size(), true );
+  std::vector<unsigned char>().swap( valueBuffer );
+}
+
+void TagValueIndex::find( const void* value,
+                          Range& results,
+                          EntityType type ) const
+{
+  assert( isValid );
+  Key key;
+  make_key( value, key );
+  MapType::const_iterator i = valueMap.find( key );
+  if (i == valueMap.end())
+    return;
+  
+  const Entry& entry = i->second;
+  if (!entry.multi) {
+    if (MBMAXTYPE == type || TYPE_FROM_HANDLE( entry.single ) == type)
+      results.insert( entry.single );
+  }
+  else if (MBMAXTYPE == type) 
+    results.merge( *entry.multi );
+  else {
+    std::pair<Range::const_iterator,Range::const_iterator> p 
+      = entry.multi->equal_range( type );
+    results.merge( p.first, p.second );
+  }
+}
+
+unsigned long TagValueIndex::memory_use() const
+{
+    // map node: key, entry, color and three pointers
+  const unsigned long node = sizeof(Key) + sizeof(Entry) + 4*sizeof(void*);
+  unsigned long total = sizeof(*this) + valueBuffer.capacity() + node * valueMap.size();
+  for (MapType::const_iterator i = valueMap.begin(); i != valueMap.end(); ++i)
+    if (i->second.multi)
+      total += i->second.multi->get_memory_use();
+  return total;
+}
+
+} // namespace moab
@@ -0,0 +1,126 @@
+#ifndef TAG_VALUE_INDEX_HPP
+#define TAG_VALUE_INDEX_HPP
+
+#ifndef IS_BUILDING_MB
+#error "TagValueIndex.hpp isn't supposed to be included into an application"
+#endif
+
+#include "moab/Range.hpp"
+#include <map>
+#include <vector>
+#include <string.h>
+
+namespace moab {
+
+class TagInfo;
+class SequenceManager;
+
+/**\brief Inverted index from tag values to tagged entities
+ *
+ * Optional lookup table for fixed-length tags that maps each tag
+ * value to the entities having that value, so that queries
+ * for entities with a specific value need not compare the value
+ * of every tagged entity.  Entities with the default value are not
+ * indexed: there is no way to distinguish them from untagged
+ * entities for dense tags anyway.
+ *
+ * Values are stored as fixed-size keys, so only tags with values of
+ * at most MAX_VALUE_SIZE bytes can be indexed.  A value held by a 
+ * single entity is stored inline; a Range is allocated only for values
+ * held by more than one entity.
+ *
+ * The index is built by \c rebuild, which Core calls when the index
+ * is enabled.  It does not intercept changes to the tag data.  Core calls
+ * \c remove before and \c add after any change to the tag values of
+ * a list of entities, and both read the current values from the tag.
+ * Changes that cannot be tracked (e.g. writes through the pointers
+ * returned by tag_iterate) must be followed by a call to \c invalidate,
+ * after which the index must not be used until it is rebuilt.  
+ * \c find never modifies the index, so it may be called concurrently
+ * during a read-only phase.
+ */
+class TagValueIndex
+{
+public:
+
+    //! Largest tag value size (in bytes) that can be indexed
+  enum { MAX_VALUE_SIZE = 24 };
+
+  TagValueIndex( const TagInfo* tag );
+  ~TagValueIndex() { clear(); }
+
+    //! Remove entities from index according to their current tag values
+  void remove( const SequenceManager* seqman, 
+               const EntityHandle* entities, size_t num_entities );
+    //! Remove entities from index according to their current tag values
+  void remove( const SequenceManager* seqman, const Range& entities );
+  
+    //! Add entities to index according to their current tag values
+  void add( const SequenceManager* seqman, 
+            const EntityHandle* entities, size_t num_entities );
+    //! Add entities to index according to their current tag values
+  void add( const SequenceManager* seqman, const Range& entities );
+  
+    //! Discard contents (e.g. all tag data was deleted)
+  void clear();
+  
+    //! Discard contents and mark index as out of date until next rebuild()
+  void invalidate() { clear(); isValid = false; }
+
+    //! Populate index from current tag values
+  void rebuild( const SequenceManager* seqman );
+  
+    //! False if the index has been invalidated and not rebuilt
+  bool valid() const { return isValid; }
+  
+    /**\brief Get entities with tag value
+     *
+     * Must not be called for an invalid index.
+     *
+     *\param value    Tag value, must not be the default value
+     *\param results  Entities with value are \a appended to this range
+     *\param type     If not MBMAXTYPE, limit results to this type
+     */
+  void find( const void* value,
+             Range& results,
+             EntityType type = MBMAXTYPE ) const;
+  
+    //! Number of distinct values in index
+  size_t num_values() const { return valueMap.size(); }
+  
+  unsigned long memory_use() const;
+
+private:
+
+  TagValueIndex( const TagValueIndex& );
+  TagValueIndex& operator=( const TagValueIndex& );
+
+  struct Key {
+    unsigned char bytes[MAX_VALUE_SIZE];
+    bool operator<( const Key& other ) const
+      { return memcmp( bytes, other.bytes, sizeof(bytes) ) < 0; }
+  };
+  
+    //! Entities with a value: either a single handle or a Range
+  struct Entry {
+    EntityHandle single;
+    Range* multi;
+    Entry() : single( 0 ), multi( 0 ) {}
+  };
+
+  void make_key( const void* value, Key& key ) const;
+
+  void update( const SequenceManager* seqman, 
+               const EntityHandle* entities, size_t num_entities,
+               bool insert );
+  
+  const TagInfo* tagInfo;
+  bool isValid;
+  typedef std::map<Key, Entry> MapType;
+  MapType valueMap;
+  std::vector<unsigned char> valueBuffer;
+};
+
+} // namespace moab
+
+#endif
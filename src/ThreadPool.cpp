@@ -0,0 +1,168 @@
+#include "ThreadPool.hpp"
+
+#include <stdlib.h>
+#ifdef MOAB_HAVE_PTHREAD
+#  include <unistd.h>
+#endif
+
+namespace moab {
+
+ThreadPool::ThreadPool( unsigned num_threads )
+  : numThreads( num_threads ? num_threads : default_num_threads() ),
+    currentTask( 0 ), numItems( 0 ), nextItem( 0 ), failedItem( 0 ),
+    failedResult( MB_SUCCESS )
+{
+#ifdef MOAB_HAVE_PTHREAD
+  threadList = 0;
+  generation = 0;
+  numBusy = 0;
+  shutDown = false;
+  if (numThreads < 2)
+    return;
+
+  pthread_mutex_init( &poolMutex, 0 );
+  pthread_cond_init( &workReady, 0 );
+  pthread_cond_init( &workDone, 0 );
+  threadList = new pthread_t[numThreads-1];
+  for (unsigned i = 0; i < numThreads - 1; ++i) {
+    if (pthread_create( threadList + i, 0, &ThreadPool::worker, this )) {
+        // run with however many threads we got
+      numThreads = i + 1;
+      break;
+    }
+  }
+#else
+  numThreads = 1;
+#endif
+}
+
+ThreadPool::~ThreadPool()
+{
+#ifdef MOAB_HAVE_PTHREAD
+  if (!threadList)
+    return;
+
+  pthread_mutex_lock( &poolMutex );
+  shutDown = true;
+  pthread_cond_broadcast( &workReady );
+  pthread_mutex_unlock( &poolMutex );
+  for (unsigned i = 0; i < numThreads - 1; ++i)
+    pthread_join( threadList[i], 0 );
+  delete [] threadList;
+
+  pthread_cond_destroy( &workDone );
+  pthread_cond_destroy( &workReady );
+  pthread_mutex_destroy( &poolMutex );
+#endif
+}
+
+unsigned ThreadPool::env_num_threads()
+{
+#ifdef MOAB_HAVE_PTHREAD
+  const char* str = getenv( "MOAB_NUM_THREADS" );
+  if (str) {
+    int n = atoi( str );
+    if (n > 0)
+      return n;
+  }
+#endif
+  return 0;
+}
+
+unsigned ThreadPool::default_num_threads()
+{
+#ifdef MOAB_HAVE_PTHREAD
+  if (unsigned n = env_num_threads())
+    return n;
+#  ifdef _SC_NPROCESSORS_ONLN
+  long n = sysconf( _SC_NPROCESSORS_ONLN );
+  if (n > 0)
+    return n;
+#  endif
+#endif
+  return 1;
+}
+
+ErrorCode ThreadPool::run( ThreadTask& task, size_t num_items )
+{
+  currentTask = &task;
+  numItems = num_items;
+  nextItem = 0;
+  failedItem = num_items;
+  failedResult = MB_SUCCESS;
+
+#ifdef MOAB_HAVE_PTHREAD
+  if (threadList && num_items > 1) {
+    pthread_mutex_lock( &poolMutex );
+    numBusy = numThreads - 1;
+    ++generation;
+    pthread_cond_broadcast( &workReady );
+    pthread_mutex_unlock( &poolMutex );
+
+    do_work();
+
+    pthread_mutex_lock( &poolMutex );
+    while (numBusy)
+      pthread_cond_wait( &workDone, &poolMutex );
+    pthread_mutex_unlock( &poolMutex );
+  }
+  else
+#endif
+    do_work();
+
+  currentTask = 0;
+  return failedResult;
+}
+
+void ThreadPool::do_work()
+{
+  for (;;) {
+    const size_t item = atomic_fetch_add( nextItem, (size_t)1 );
+    if (item >= numItems)
+      break;
+
+    ErrorCode rval = currentTask->execute( item );
+    if (MB_SUCCESS != rval) {
+#ifdef MOAB_HAVE_PTHREAD
+      if (threadList)
+        pthread_mutex_lock( &poolMutex );
+#endif
+      if (item < failedItem) {
+        failedItem = item;
+        failedResult = rval;
+      }
+#ifdef MOAB_HAVE_PTHREAD
+      if (threadList)
+        pthread_mutex_unlock( &poolMutex );
+#endif
+    }
+  }
+}
+
+#ifdef MOAB_HAVE_PTHREAD
+void* ThreadPool::worker( void* ptr )
+{
+  ThreadPool* pool = reinterpret_cast<ThreadPool*>(ptr);
+  unsigned long done_generation = 0;
+
+  pthread_mutex_lock( &pool->poolMutex );
+  for (;;) {
+    while (!pool->shutDown && pool->generation == done_generation)
+      pthread_cond_wait( &pool->workReady, &pool->poolMutex );
+    if (pool->shutDown)
+      break;
+    done_generation = pool->generation;
+    pthread_mutex_unlock( &pool->poolMutex );
+
+    pool->do_work();
+
+    pthread_mutex_lock( &pool->poolMutex );
+    if (0 == --pool->numBusy)
+      pthread_cond_signal( &pool->workDone );
+  }
+  pthread_mutex_unlock( &pool->poolMutex );
+  return 0;
+}
+#endif
+
+} // namespace moab
@@ -0,0 +1,125 @@
+/**
+ * MOAB, a Mesh-Oriented datABase, is a software component for creating,
+ * storing and accessing finite element mesh data.
+ *
+ * Copyright 2004 Sandia Corporation.  Under the terms of Contract
+ * DE-AC04-94AL85000 with Sandia Coroporation, the U.S. Government
+ * retains certain rights in this software.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+#ifndef MB_THREAD_POOL_HPP
+#define MB_THREAD_POOL_HPP
+
+#include "moab/Types.hpp"
+#include <stddef.h>
+
+#ifdef MOAB_HAVE_PTHREAD
+#  include <pthread.h>
+#endif
+
+namespace moab {
+
+/**\brief A unit of work that can be split into independent items */
+class ThreadTask
+{
+public:
+  virtual ~ThreadTask() {}
+
+  /**\brief Process a single work item
+   *
+   * Called concurrently from several threads, each time with
+   * a different item index.
+   */
+  virtual ErrorCode execute( size_t item ) = 0;
+};
+
+/**\brief Fixed set of worker threads for bulk operations
+ *
+ * The worker threads are created with the pool and wait for work
+ * until the pool is destroyed, so one pool may be used for several
+ * consecutive passes of an algorithm without recreating threads.
+ * The calling thread participates in the work, so a pool of one
+ * thread runs everything serially in the caller.  If MOAB was
+ * configured without thread support, all pools have one thread.
+ */
+class ThreadPool
+{
+public:
+
+  /**\param num_threads Number of threads (including the calling thread)
+   *                    to use, or zero for default_num_threads().
+   */
+  ThreadPool( unsigned num_threads = 0 );
+  ~ThreadPool();
+
+  unsigned num_threads() const { return numThreads; }
+
+  /**\brief Call task.execute(i) for each i in [0,num_items)
+   *
+   * Items are handed out in increasing order, but may complete in
+   * any order.  Blocks until all items have been processed.
+   *\return MB_SUCCESS or the error from the lowest-numbered failed item
+   */
+  ErrorCode run( ThreadTask& task, size_t num_items );
+
+  /**\brief Number of threads to use if not specified
+   *
+   * The value of the MOAB_NUM_THREADS environment variable if
+   * set, otherwise the number of online processors.
+   */
+  static unsigned default_num_threads();
+
+  /**\brief Number of threads requested in the environment
+   *
+   * The value of the MOAB_NUM_THREADS environment variable, or zero
+   * if it is not set to a positive number or MOAB was built without
+   * thread support.
+   */
+  static unsigned env_num_threads();
+
+private:
+
+  ThreadPool( const ThreadPool& );
+  ThreadPool& operator=( const ThreadPool& );
+
+  void do_work();
+
+  unsigned numThreads;
+  ThreadTask* currentTask;
+  size_t numItems, nextItem, failedItem;
+  ErrorCode failedResult;
+
+#ifdef MOAB_HAVE_PTHREAD
+  static void* worker( void* pool );
+
+  pthread_t* threadList;
+  pthread_mutex_t poolMutex;
+  pthread_cond_t workReady, workDone;
+  unsigned long generation; //!< incremented each time run() posts work
+  unsigned numBusy;
+  bool shutDown;
+#endif
+};
+
+/**\brief Atomically add to a shared counter, returning the old value */
+template <typename T> inline
+T atomic_fetch_add( T& value, T amount )
+{
+#ifdef MOAB_HAVE_PTHREAD
+  return __sync_fetch_and_add( &value, amount );
+#else
+  T old = value;
+  value += amount;
+  return old;
+#endif
+}
+
+} // namespace moab
+
+#endif
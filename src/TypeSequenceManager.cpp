@@ -32,6 +32,8 @@ TypeSequenceManager::~TypeSequenceManager()
     }
   }
   sequenceSet.clear();
+  sequenceIndex.clear();
+  indexValid = true;
   
     // case a) above
   for (data_iterator i = availableList.begin(); i != availableList.end(); ++i)
@@ -39,13 +41,35 @@ TypeSequenceManager::~TypeSequenceManager()
   availableList.clear();
 }
 
+TypeSequenceManager::iterator 
+TypeSequenceManager::insert_internal( iterator hint, EntitySequence* seq )
+{
+  indexValid = false;
+  staleLookups = 0;
+  return sequenceSet.insert( hint, seq );
+}
+
+void TypeSequenceManager::erase_internal( iterator j )
+{
+  indexValid = false;
+  staleLookups = 0;
+  sequenceSet.erase( j );
+}
+
+void TypeSequenceManager::rebuild_index() const
+{
+  sequenceIndex.assign( sequenceSet.begin(), sequenceSet.end() );
+  indexValid = true;
+  staleLookups = 0;
+}
+
 ErrorCode TypeSequenceManager::merge_internal( iterator i, iterator j )
 {
   EntitySequence* dead = *j;
-  sequenceSet.erase( j );
+  erase_internal( j );
   ErrorCode rval = (*i)->merge( *dead );
   if (MB_SUCCESS != rval) {
-    sequenceSet.insert( dead );
+    insert_internal( i, dead );
     return rval;
   }
   
@@ -112,12 +136,12 @@ ErrorCode TypeSequenceManager::insert_sequence( EntitySequence* seq_ptr )
       return MB_ALREADY_ALLOCATED;
   }
 
-  i = sequenceSet.insert( i, seq_ptr );
+  i = insert_internal( i, seq_ptr );
   
     // merge with previous sequence ?
   if (seq_ptr->start_handle() > seq_ptr->data()->start_handle() && i != begin()) {
     if (MB_SUCCESS != check_merge_prev( i )) {
-      sequenceSet.erase( i );
+      erase_internal( i );
       return MB_FAILURE;
     }
   }
@@ -125,7 +149,7 @@ ErrorCode TypeSequenceManager::insert_sequence( EntitySequence* seq_ptr )
     // merge with next sequence ?
   if ((*i)->end_handle() < (*i)->data()->end_handle()) {
     if (MB_SUCCESS != check_merge_next( i )) {
-      sequenceSet.erase( i );
+      erase_internal( i );
       return MB_FAILURE;
     }
   }
@@ -202,7 +226,7 @@ ErrorCode TypeSequenceManager::replace_subsequence( EntitySequence* seq_ptr,
     iterator dead = i; ++i;
     if (p == dead)
       p = i;
-    sequenceSet.erase( dead );
+    erase_internal( dead );
 
       // delete old sequence 
     delete seq;
@@ -284,7 +308,7 @@ TypeSequenceManager::iterator TypeSequenceManager::erase( iterator i )
     
     // remove sequence, updating i to be next sequence
   j = i++;
-  sequenceSet.erase( j );
+  erase_internal( j );
   
     // Make sure lastReferenced isn't stale.  It can only be NULL if
     // no sequences.
@@ -311,7 +335,7 @@ ErrorCode TypeSequenceManager::remove_sequence( const EntitySequence* seq_ptr,
   iterator i = lower_bound( seq_ptr->start_handle() );
   if (i == end() || *i != seq_ptr)
     return MB_ENTITY_NOT_FOUND;
-  sequenceSet.erase( i );
+  erase_internal( i );
   
     // check if this is the only sequence referencing its data
   if (seq_ptr->using_entire_data()) 
@@ -706,7 +730,7 @@ TypeSequenceManager::split_sequence( iterator i, EntityHandle h )
   if (!seq)
     return end();
   
-  i = sequenceSet.insert( i, seq );
+  i = insert_internal( i, seq );
   assert( check_valid_data( *i ) );
   return i;
 }
@@ -6,6 +6,7 @@
 
 #include <set>
 #include <vector>
+#include <algorithm>
 
 namespace moab {
 
@@ -47,6 +48,16 @@ public:
         { return 0; }
   };
 
+  /**\brief Comparision function for lookup in sorted array of sequences
+   *
+   * Used with std::lower_bound to find the first sequence in
+   * a sorted array that does not end before the specified handle.
+   */
+  class SequenceEndCompare {
+    public: bool operator()( const EntitySequence* a, EntityHandle h ) const
+      { return a->end_handle() < h; }
+  };
+
   /**\brief Type of container for organizing EntitySequence instances */
   typedef std::set<EntitySequence*,SequenceCompare> set_type;
   /**\brief Iterator for set_type */
@@ -65,10 +76,28 @@ public:
   };
 private:
   mutable EntitySequence* lastReferenced;//!< Last accessed EntitySequence - Null only if no sequences
+  bool readOnlyPhase;            //!< If true, lookups do not update lastReferenced
   set_type sequenceSet;          //!< Set of all managed EntitySequence instances
+  mutable std::vector<EntitySequence*> sequenceIndex; //!< Contents of sequenceSet as sorted array, for fast lookup
+  mutable bool indexValid;       //!< False if sequenceSet changed since sequenceIndex was built
+  mutable size_t staleLookups;   //!< Lookups in sequenceSet since indexValid was cleared
   data_set_type availableList;   //!< SequenceData containing unused entries
 
   iterator erase( iterator i );  //!< Remove a sequence
+
+    // Insert sequence into sequenceSet, invalidating sequenceIndex.
+  iterator insert_internal( iterator hint, EntitySequence* seq );
+    // Remove sequence from sequenceSet, invalidating sequenceIndex.
+    // Sequence must not overlap any other sequence when this is called.
+  void erase_internal( iterator i );
+    // Binary search of sequenceIndex. Returns NULL if no sequence
+    // contains the handle.  While the index is invalid, searches
+    // sequenceSet instead, and rebuilds the index once the lookups
+    // since it was invalidated outnumber the sequences, so that
+    // runs of insertions or removals do not each copy the index.
+  inline EntitySequence* index_find( EntityHandle h ) const;
+    // Copy sequenceSet into sequenceIndex
+  void rebuild_index() const;
   
   iterator split_sequence( iterator i, EntityHandle h ); //!< split a sequence
 
@@ -133,7 +162,8 @@ public:
                                  const int* tag_sizes,
                                  int num_tag_sizes );
   
-  TypeSequenceManager() : lastReferenced(0) {}
+  TypeSequenceManager() 
+    : lastReferenced(0), readOnlyPhase(false), indexValid(true), staleLookups(0) {}
   
   ~TypeSequenceManager();
 
@@ -183,6 +213,23 @@ public:
   inline ErrorCode find( EntityHandle h, EntitySequence*& );
   inline ErrorCode find( EntityHandle h, const EntitySequence*& ) const;
   inline const EntitySequence* get_last_accessed() const;
+
+    /**\brief Enable or disable read-only phase
+     *
+     * While in a read-only phase, the find() methods do not update
+     * the cached last-referenced sequence, so that concurrent lookups
+     * from multiple threads do not write to shared state.  Sequences
+     * must not be inserted or removed while in a read-only phase.
+     * The lookup index is brought up to date on entering the phase.
+     */
+  void set_read_only_phase( bool read_only )
+    { 
+      if (read_only && !indexValid)
+        rebuild_index();
+      readOnlyPhase = read_only;
+    }
+  bool read_only_phase() const
+    { return readOnlyPhase; }
   
     /**\brief Get handles for all entities in all sequences. */
   inline void get_entities( Range& entities_out ) const;
@@ -350,6 +397,21 @@ public:
   EntityID get_occupied_size( const SequenceData* ) const;
 };
 
+inline EntitySequence* TypeSequenceManager::index_find( EntityHandle h ) const
+{
+  if (!indexValid) {
+    if (readOnlyPhase || ++staleLookups < sequenceSet.size()) {
+      const_iterator s = lower_bound( h );
+      return (s == end() || (*s)->start_handle() > h) ? 0 : *s;
+    }
+    rebuild_index();
+  }
+  
+  std::vector<EntitySequence*>::const_iterator i;
+  i = std::lower_bound( sequenceIndex.begin(), sequenceIndex.end(), h, SequenceEndCompare() );
+  return (i == sequenceIndex.end() || (*i)->start_handle() > h) ? 0 : *i;
+}
+
 inline EntitySequence* TypeSequenceManager::find( EntityHandle h ) const
 {
   if (!lastReferenced) // only null if empty
@@ -357,9 +419,10 @@ inline EntitySequence* TypeSequenceManager::find( EntityHandle h ) const
   else if (h >= lastReferenced->start_handle() && h <= lastReferenced->end_handle())
     return lastReferenced;
   else {
-    DummySequence seq(h);
-    const_iterator i = sequenceSet.find( &seq );
-    return i == end() ? 0 : (lastReferenced = *i);
+    EntitySequence* seq = index_find( h );
+    if (seq && !readOnlyPhase)
+      lastReferenced = seq;
+    return seq;
   }
 }   
 inline EntitySequence* TypeSequenceManager::find( EntityHandle h )
@@ -369,9 +432,10 @@ inline EntitySequence* TypeSequenceManager::find( EntityHandle h )
   else if (h >= lastReferenced->start_handle() && h <= lastReferenced->end_handle())
     return lastReferenced;
   else {
-    DummySequence seq(h);
-    iterator i = sequenceSet.find( &seq );
-    return i == end() ? 0 : (lastReferenced = *i);
+    EntitySequence* seq = index_find( h );
+    if (seq && !readOnlyPhase)
+      lastReferenced = seq;
+    return seq;
   }
 }   
 
@@ -386,16 +450,13 @@ inline ErrorCode TypeSequenceManager::find( EntityHandle h, EntitySequence*& seq
     return MB_SUCCESS;
   }
   else {
-    DummySequence ds(h);
-    iterator i = sequenceSet.lower_bound( &ds );
-    if (i == end() || (*i)->start_handle() > h ) {
-      seq = 0;
+    EntitySequence* found = index_find( h );
+    seq = found;
+    if (!found) 
       return MB_ENTITY_NOT_FOUND;
-    }
-    else {
-      seq = lastReferenced = *i;
-      return MB_SUCCESS;
-    }
+    if (!readOnlyPhase)
+      lastReferenced = found;
+    return MB_SUCCESS;
   }
 }   
 
@@ -410,16 +471,13 @@ inline ErrorCode TypeSequenceManager::find( EntityHandle h, const EntitySequence
     return MB_SUCCESS;
   }
   else {
-    DummySequence ds(h);
-    const_iterator i = sequenceSet.lower_bound( &ds );
-    if (i == end() || (*i)->start_handle() > h ) {
-      seq = 0;
+    EntitySequence* found = index_find( h );
+    seq = found;
+    if (!found) 
       return MB_ENTITY_NOT_FOUND;
-    }
-    else {
-      seq = lastReferenced = *i;
-      return MB_SUCCESS;
-    }
+    if (!readOnlyPhase)
+      lastReferenced = found;
+    return MB_SUCCESS;
   }
 }   
 
@@ -31,6 +31,21 @@ static ErrorCode not_found( Error* error, std::string name, EntityHandle h )
   return MB_TAG_NOT_FOUND;
 }
 
+    // total arena space, including alignment padding, for the values
+    // that will be stored in the arena
+static size_t arena_bytes( const int* lengths, size_t count, bool one_value )
+{
+  if (one_value)
+    return (unsigned)*lengths > VarLenTagData::INLINE_COUNT ? 
+           count * VarLenTagArena::padded_size( *lengths ) : 0;
+  
+  size_t result = 0;
+  for (size_t i = 0; i < count; ++i)
+    if ((unsigned)lengths[i] > VarLenTagData::INLINE_COUNT)
+      result += VarLenTagArena::padded_size( lengths[i] );
+  return result;
+}
+
 static ErrorCode not_var_len( Error* error, std::string name )
 {
   error->set_last_error( "No size specified for variable-length tag %s data", name.c_str());
@@ -43,7 +58,8 @@ VarLenDenseTag::VarLenDenseTag( int index,
                                 const void* default_value,
                                 int default_value_size )
   : TagInfo( name, MB_VARIABLE_LENGTH, type, default_value, default_value_size ), 
-    mySequenceArray(index)
+    mySequenceArray(index),
+    mArena( memory_counter() )
   {}
 
 VarLenDenseTag* VarLenDenseTag::create_tag( SequenceManager* seqman,
@@ -78,12 +94,40 @@ ErrorCode VarLenDenseTag::release_all_data( SequenceManager* seqman,
   ErrorCode rval = remove_data( seqman, error, all_ents );
   if (MB_SUCCESS == rval) {
     rval = seqman->release_tag_array( error, mySequenceArray, delete_pending );
-    if (MB_SUCCESS == rval && delete_pending)
+    if (MB_SUCCESS == rval && delete_pending) {
       mySequenceArray = -1;
+      mArena.clear( meshValue );
+      mArena.release();
+    }
   }
   return rval;
 }
 
+void VarLenDenseTag::compact_if_needed( SequenceManager* seqman )
+{
+  if (!mArena.should_compact())
+    return;
+  
+  mArena.compact_begin();
+  mArena.compact_value( meshValue );
+  for (EntityType t = MBVERTEX; t <= MBENTITYSET; ++t) {
+    TypeSequenceManager& map = seqman->entity_map(t);
+    SequenceData* prev_data = 0;
+    for (TypeSequenceManager::iterator i = map.begin(); i != map.end(); ++i) {
+      SequenceData* data = (*i)->data();
+      void* mem = data->get_tag_data(mySequenceArray);
+      if (!mem || data == prev_data) 
+        continue;
+      prev_data = data;
+      
+      VarLenTag* array = reinterpret_cast<VarLenTag*>(mem);
+      for (EntityID j = 0; j < data->size(); ++j)
+        mArena.compact_value( array[j] );
+    }
+  }
+  mArena.compact_end();
+}
+
 ErrorCode VarLenDenseTag::get_array( const SequenceManager* seqman, 
                                      Error* error, 
                                      EntityHandle h, 
@@ -138,7 +182,7 @@ ErrorCode VarLenDenseTag::get_array( SequenceManager* seqman,
   
   void* mem = seq->data()->get_tag_data( mySequenceArray );
   if (!mem && allocate) {
-    mem = seq->data()->allocate_tag_array( mySequenceArray, sizeof(VarLenTag) );
+    mem = seq->data()->allocate_tag_array( mySequenceArray, sizeof(VarLenTag), memory_counter() );
     if (!mem) {
       error->set_last_error( "Memory allocation for var-len tag data failed" );
       return MB_MEMORY_ALLOCATION_FAILED;
@@ -307,16 +351,18 @@ ErrorCode VarLenDenseTag::set_data( SequenceManager* seqman,
   size_t junk;
   const size_t step = one_value ? 0 : 1;
   
+  mArena.reserve( arena_bytes( lengths, num_entities, one_value ) );
   for (const EntityHandle* i = entities; i != end; ++i ) {
     rval = get_array( seqman, error, *i, array, junk, true );
     if (MB_SUCCESS != rval)
       return rval;
     
-    array->set( *pointers, *lengths );
+    mArena.set( *array, *pointers, *lengths );
     pointers += step;
     lengths += step;
   }
 
+  compact_if_needed( seqman );
   return MB_SUCCESS;
 }
 
@@ -335,6 +381,7 @@ ErrorCode VarLenDenseTag::set_data( SequenceManager* seqman,
   size_t avail;
   const size_t step = one_value ? 0 : 1;
 
+  mArena.reserve( arena_bytes( lengths, entities.size(), one_value ) );
   for (Range::const_pair_iterator p = entities.const_pair_begin(); 
        p != entities.const_pair_end(); ++p) {
        
@@ -346,7 +393,7 @@ ErrorCode VarLenDenseTag::set_data( SequenceManager* seqman,
       
       const EntityHandle end = std::min<EntityHandle>(p->second + 1, start + avail );
       while (start != end) {
-        array->set( *pointers, *lengths );
+        mArena.set( *array, *pointers, *lengths );
         ++start;
         ++array;
         pointers += step;
@@ -355,6 +402,7 @@ ErrorCode VarLenDenseTag::set_data( SequenceManager* seqman,
     }
   }
   
+  compact_if_needed( seqman );
   return MB_SUCCESS;
 }
                       
@@ -419,9 +467,10 @@ ErrorCode VarLenDenseTag::remove_data( SequenceManager* seqman,
       return rval;
     
     if (array) 
-      array->clear();
+      mArena.clear( *array );
   }
 
+  compact_if_needed( seqman );
   return MB_SUCCESS;
 }
 
@@ -445,7 +494,7 @@ ErrorCode VarLenDenseTag::remove_data( SequenceManager* seqman,
       const EntityHandle end = std::min<EntityHandle>(p->second + 1, start + avail );
       if (array) {
         while (start != end) {
-          array->clear();
+          mArena.clear( *array );
           ++start;
           ++array;
         }
@@ -456,6 +505,7 @@ ErrorCode VarLenDenseTag::remove_data( SequenceManager* seqman,
     }
   }
   
+  compact_if_needed( seqman );
   return MB_SUCCESS;
 }
 
@@ -661,6 +711,7 @@ ErrorCode VarLenDenseTag::get_memory_use( const SequenceManager* seqman,
   total *= sizeof(VarLenTag);
   total += per_entity + sizeof(*this) + TagInfo::get_memory_use();
   total += meshValue.mem() + sizeof(meshValue);
+  total += mArena.memory_use();
   if (count)
     per_entity /= count;
   per_entity += sizeof(VarLenTag);
@@ -23,6 +23,9 @@ private:
   int mySequenceArray; //!< Array index in SequenceManager used to store tag data.
                       
   VarLenTag meshValue;
+  
+  //! storage for values too large to be stored inline in VarLenTag
+  VarLenTagArena mArena;
 
   VarLenDenseTag( int array_index,
                   const char* name, 
@@ -457,6 +460,9 @@ private:
                       bool one_value,
                       void const* const* pointers,
                       const int* lengths );
+
+  //! copy values to new arena blocks if most arena space is unused
+  void compact_if_needed( SequenceManager* seqman );
 };
 
 
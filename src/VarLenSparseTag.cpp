@@ -49,7 +49,8 @@ VarLenSparseTag::VarLenSparseTag( const char* name,
                                   DataType type,
                                   const void* default_value,
                                   int default_value_bytes )
-  : TagInfo( name, MB_VARIABLE_LENGTH, type, default_value, default_value_bytes )
+  : TagInfo( name, MB_VARIABLE_LENGTH, type, default_value, default_value_bytes ),
+    mArena( memory_counter() )
   { }
 
 VarLenSparseTag::~VarLenSparseTag()
@@ -61,9 +62,32 @@ TagType VarLenSparseTag::get_storage_type() const
 ErrorCode VarLenSparseTag::release_all_data( SequenceManager*, Error*, bool )
 {
   mData.clear();
+  mArena.release();
   return MB_SUCCESS;
 }
 
+void VarLenSparseTag::compact_if_needed()
+{
+  if (!mArena.should_compact())
+    return;
+  
+  mArena.compact_begin();
+  for (MapType::iterator i = mData.begin(); i != mData.end(); ++i)
+    mArena.compact_value( i->second );
+  mArena.compact_end();
+}
+
+    // total arena space, including alignment padding, for the values
+    // that will be stored in the arena
+static size_t arena_bytes( const int* lengths, size_t count )
+{
+  size_t result = 0;
+  for (size_t i = 0; i < count; ++i)
+    if ((unsigned)lengths[i] > VarLenTagData::INLINE_COUNT)
+      result += VarLenTagArena::padded_size( lengths[i] );
+  return result;
+}
+
 ErrorCode VarLenSparseTag::get_data_ptr( Error* error,
                                          EntityHandle entity_handle, 
                                          const void*& ptr,
@@ -168,17 +192,17 @@ ErrorCode VarLenSparseTag::set_data( SequenceManager* seqman,
   if (MB_SUCCESS != rval)
     return rval;
   
+  mArena.reserve( arena_bytes( lengths, num_entities ) );
   for (size_t i = 0; i < num_entities; ++i) {
     if (lengths[i])
-      mData[entities[i]].set( pointers[i], lengths[i] );
+      mArena.set( mData[entities[i]], pointers[i], lengths[i] );
     else {
       MapType::iterator iter = mData.find(entities[i]);
-      if (iter != mData.end()) {
-        iter->second.clear();
-        mData.erase(iter);
-      }
+      if (iter != mData.end())
+        erase(iter);
     }
   }
+  compact_if_needed();
   return MB_SUCCESS;
 }
 
@@ -196,18 +220,18 @@ ErrorCode VarLenSparseTag::set_data( SequenceManager* seqman,
   if (MB_SUCCESS != rval)
     return rval;
   
+  mArena.reserve( arena_bytes( lengths, entities.size() ) );
   Range::const_iterator i;
   for (i = entities.begin(); i != entities.end(); ++i, ++pointers, ++lengths) {
     if (*lengths)
-      mData[*i].set( *pointers, *lengths );
+      mArena.set( mData[*i], *pointers, *lengths );
     else {
       MapType::iterator iter = mData.find(*i);
-      if (iter != mData.end()) {
-        iter->second.clear();
-        mData.erase(iter);
-      }
+      if (iter != mData.end())
+        erase(iter);
     }
   }
+  compact_if_needed();
   return MB_SUCCESS;
 }
 
@@ -231,8 +255,11 @@ ErrorCode VarLenSparseTag::clear_data( SequenceManager* seqman,
   if (MB_SUCCESS != rval)
     return rval;
   
+  if ((unsigned)value_len > VarLenTagData::INLINE_COUNT)
+    mArena.reserve( num_entities * VarLenTagArena::padded_size( value_len ) );
   for (size_t i = 0; i < num_entities; ++i)
-    mData[entities[i]].set( value_ptr, value_len );
+    mArena.set( mData[entities[i]], value_ptr, value_len );
+  compact_if_needed();
   return MB_SUCCESS;
 }
 
@@ -255,9 +282,12 @@ ErrorCode VarLenSparseTag::clear_data( SequenceManager* seqman,
   if (MB_SUCCESS != rval)
     return rval;
   
+  if ((unsigned)value_len > VarLenTagData::INLINE_COUNT)
+    mArena.reserve( entities.size() * VarLenTagArena::padded_size( value_len ) );
   Range::const_iterator i;
   for (i = entities.begin(); i != entities.end(); ++i)
-    mData[*i].set( value_ptr, value_len );
+    mArena.set( mData[*i], value_ptr, value_len );
+  compact_if_needed();
 
   return MB_SUCCESS;
 }
@@ -272,11 +302,10 @@ ErrorCode VarLenSparseTag::remove_data( SequenceManager*,
     MapType::iterator p = mData.find(entities[i]);
     if (p == mData.end())
       result = not_found(error, get_name(), entities[i]);
-    else {
-      p->second.clear();
-      mData.erase(p);
-    }
+    else 
+      erase(p);
   }
+  compact_if_needed();
   return result;
 }
 
@@ -289,11 +318,10 @@ ErrorCode VarLenSparseTag::remove_data( SequenceManager*,
     MapType::iterator p = mData.find(*i);
     if (p == mData.end())
       result = not_found(error, get_name(), *i);
-    else {
-      p->second.clear();
-      mData.erase(p);
-    }
+    else 
+      erase(p);
   }
+  compact_if_needed();
   return result;
 }
 
@@ -468,6 +496,7 @@ ErrorCode VarLenSparseTag::get_memory_use( const SequenceManager*,
   total = mData.size() * (3*sizeof(void*) + sizeof(VarLenTag));
   for (MapType::const_iterator i = mData.begin(); i != mData.end(); ++i)
     total += i->second.mem();
+  total += mArena.memory_use();
   if (mData.size())
     per_entity = total / mData.size();
   total += sizeof(*this) + TagInfo::get_memory_use();
@@ -412,9 +412,24 @@ private:
                           const void*& data,
                           int& size) const;
 
+  //! remove the value for an entity
+  inline void erase( MapType::iterator iter );
+
+  //! copy values to new arena blocks if most arena space is unused
+  void compact_if_needed();
+
   MapType mData;
+  
+  //! storage for values too large to be stored inline in VarLenTag
+  VarLenTagArena mArena;
 };
 
+inline void VarLenSparseTag::erase( MapType::iterator iter )
+{
+  mArena.clear( iter->second );
+  mData.erase( iter );
+}
+
 } // namespace moab
 
 #endif // VAR_LEN_SPARSE_TAG_HPP
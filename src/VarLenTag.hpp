@@ -1,8 +1,10 @@
 #ifndef VAR_LEN_TAG_HPP
 #define VAR_LEN_TAG_HPP
 
+#include "moab/MemoryCounter.hpp"
 #include <stdlib.h>
 #include <string.h>
+#include <assert.h>
 
 namespace moab {
 
@@ -129,6 +131,18 @@ typedef VarLenTagDataTemplate<sizeof(unsigned char*) - sizeof(unsigned)> VarLenT
 class VarLenTag {
 protected:
   VarLenTagData mData;
+  
+  friend class VarLenTagArena;
+  
+    //! Bit set in size field if the value is stored in memory
+    //! owned by a VarLenTagArena rather than allocated with malloc
+  static const unsigned ARENA_FLAG = ~(~0u >> 1);
+  
+    //! Point to arena storage, discarding any previous value
+    //! without releasing it.
+  inline void set_arena_array( unsigned char* array, unsigned sz )
+    { mData.mData.mPointer.array = array; 
+      mData.mData.mPointer.size = sz | ARENA_FLAG; }
 public:
   inline VarLenTag() { mData.mData.mPointer.size = 0; }
   inline VarLenTag( unsigned size );
@@ -136,7 +150,12 @@ public:
   inline VarLenTag( const VarLenTag& copy );
   inline VarLenTag( unsigned size, const void* data );
   
-  inline unsigned size() const { return mData.mData.mPointer.size; }
+  inline unsigned size() const 
+    { return mData.mData.mPointer.size & ~ARENA_FLAG; }
+  
+    //! True if value is stored in memory owned by a VarLenTagArena
+  inline bool in_arena() const 
+    { return 0 != (mData.mData.mPointer.size & ARENA_FLAG); }
 
   inline unsigned char* data() 
 #ifdef VAR_LEN_TAG_ELIDE_DATA    
@@ -149,28 +168,46 @@ public:
 
   inline unsigned long mem() const
 #ifdef VAR_LEN_TAG_ELIDE_DATA    
-    { return size() <= VarLenTagData::INLINE_COUNT ? 0 : size(); }
+    { return size() <= VarLenTagData::INLINE_COUNT || in_arena() ? 0 : size(); }
 #else
-    { return size(); }
+    { return in_arena() ? 0 : size(); }
 #endif
 
   inline const unsigned char* data() const 
     { return const_cast<VarLenTag*>(this)->data(); }
   
+    //! Change size of value, preserving leading bytes.  A value stored
+    //! in a VarLenTagArena is moved out of it into separately allocated
+    //! memory; its arena space is reclaimed when the arena is compacted.
+    //! Resize through the arena instead to keep the value there.
   inline unsigned char* resize( unsigned size );
   
   inline void clear();
   
+    //! Copy value, moving it out of any VarLenTagArena as for resize
   inline void set( const void* dat, unsigned sz )
     { memcpy( resize(sz), dat, sz ); }
     
+    //! Copy value, moving it out of any VarLenTagArena as for resize.
+    //! Use VarLenTagArena::set to keep the copy in an arena.
   inline VarLenTag& operator=( const VarLenTag& other )
-    { set( other.data(), other.size() ); return *this; }
+    { if (this != &other) set( other.data(), other.size() ); return *this; }
   
 };
   
 inline unsigned char* VarLenTag::resize( unsigned s ) 
 {
+  if (in_arena()) {
+      // forget the arena memory without freeing it, then copy
+      // from it into the storage of what is now an empty value
+    const unsigned char* old_array = mData.mData.mPointer.array;
+    const unsigned keep = size() < s ? size() : s;
+    mData.mData.mPointer.size = 0;
+    unsigned char* new_array = resize( s );
+    memcpy( new_array, old_array, keep );
+    return new_array;
+  }
+  
 #ifdef VAR_LEN_TAG_ELIDE_DATA
   if (s <= VarLenTagData::INLINE_COUNT) {
     if (size() > VarLenTagData::INLINE_COUNT) {
@@ -208,9 +245,9 @@ inline VarLenTag::VarLenTag( unsigned sz )
 inline void VarLenTag::clear()
 {
 #ifdef VAR_LEN_TAG_ELIDE_DATA
-  if (size() > VarLenTagData::INLINE_COUNT)
+  if (size() > VarLenTagData::INLINE_COUNT && !in_arena())
 #else
-  if (size())
+  if (size() && !in_arena())
 #endif
     free( mData.mData.mPointer.array );
   mData.mData.mPointer.size = 0;
@@ -223,6 +260,7 @@ inline VarLenTag::VarLenTag( const VarLenTag& copy )
   if (size() > VarLenTagData::INLINE_COUNT)
 #endif
   {
+    mData.mData.mPointer.size = copy.size();
     mData.mData.mPointer.array = reinterpret_cast<unsigned char*>(malloc(size()));
     memcpy( mData.mData.mPointer.array, copy.mData.mData.mPointer.array, size() );
   }
@@ -235,6 +273,225 @@ inline VarLenTag::VarLenTag( unsigned sz, const void* dat )
     memcpy( resize(sz), dat, sz );
 }
 
+/**\brief Block allocator for variable-length tag values
+ *
+ * Values too large to be stored inline in a VarLenTag are carved
+ * sequentially out of large blocks, avoiding a heap allocation for
+ * each entity.  Space for values that are removed or replaced is not
+ * reused until the owning tag compacts its data by passing every
+ * value to compact_value between calls to compact_begin and
+ * compact_end.  All values must be set and cleared through the same
+ * arena so that it can track how much of its space is still in use.
+ */
+class VarLenTagArena {
+public:
+    //! Charge allocated blocks to \c counter, if not null
+  inline VarLenTagArena( MemoryCounter* counter = 0 ) 
+    : blockList(0), oldBlocks(0), nextFree(0), blockEnd(0), 
+      allocBytes(0), liveBytes(0), mCounter(counter) {}
+  inline ~VarLenTagArena() { release(); }
+  
+    //! Replace value of \c tag with a copy of \c data
+  inline void set( VarLenTag& tag, const void* data, unsigned size );
+  
+    //! Change size of value of \c tag, preserving leading bytes
+  inline unsigned char* resize( VarLenTag& tag, unsigned size );
+  
+    //! Remove value of \c tag
+  inline void clear( VarLenTag& tag );
+  
+    //! Make room for values totaling at least \c bytes without
+    //! allocating more than one additional block
+  inline void reserve( size_t bytes );
+  
+    //! Free all memory.  Any values stored in the arena must have
+    //! been cleared or discarded first.
+  inline void release();
+  
+    //! Bytes allocated for blocks, including unused space
+  unsigned long memory_use() const { return allocBytes; }
+  
+    //! Space taken in a block by a value of \c bytes, which is
+    //! padded to keep the following value aligned
+  static size_t padded_size( size_t bytes )
+    { return (bytes + ALIGN - 1) & ~(size_t)(ALIGN - 1); }
+  
+    //! True if most of the allocated space is no longer in use
+  bool should_compact() const 
+    { return allocBytes > 4*BLOCK_SIZE && 2*liveBytes < allocBytes; }
+  
+  inline void compact_begin();
+  inline void compact_value( VarLenTag& tag );
+  inline void compact_end();
+
+private:
+
+  VarLenTagArena( const VarLenTagArena& );
+  VarLenTagArena& operator=( const VarLenTagArena& );
+
+  enum { BLOCK_SIZE = 65536, ALIGN = sizeof(double) };
+  
+    //! Header at start of each block, padded to keep values aligned
+  union Block {
+    Block* next;
+    double align;
+  };
+  
+  inline unsigned char* allocate( size_t bytes );
+  inline void new_block( size_t bytes );
+  static inline void free_blocks( Block* list );
+
+  Block* blockList;          //!< all blocks, most recent first
+  Block* oldBlocks;          //!< blocks being emptied by compaction
+  unsigned char* nextFree;   //!< next unused byte in current block
+  unsigned char* blockEnd;   //!< end of current block
+  size_t allocBytes;         //!< total size of allocated blocks
+  size_t liveBytes;          //!< total size of values in arena, including
+                             //!< any moved out by VarLenTag itself until
+                             //!< the next compaction
+  MemoryCounter* mCounter;   //!< counter charged for blocks
+};
+
+inline void VarLenTagArena::free_blocks( Block* list )
+{
+  while (list) {
+    Block* next = list->next;
+    MemoryCounter::deallocate( list );
+    list = next;
+  }
+}
+
+inline void VarLenTagArena::new_block( size_t bytes )
+{
+  if (bytes < BLOCK_SIZE)
+    bytes = BLOCK_SIZE;
+  Block* block = reinterpret_cast<Block*>(
+    MemoryCounter::allocate( sizeof(Block) + bytes, mCounter ));
+  block->next = blockList;
+  blockList = block;
+  nextFree = reinterpret_cast<unsigned char*>(block + 1);
+  blockEnd = nextFree + bytes;
+  allocBytes += bytes;
+}
+
+inline unsigned char* VarLenTagArena::allocate( size_t bytes )
+{
+  bytes = padded_size( bytes );
+  if ((size_t)(blockEnd - nextFree) < bytes)
+    new_block( bytes );
+  unsigned char* result = nextFree;
+  nextFree += bytes;
+  return result;
+}
+
+inline void VarLenTagArena::reserve( size_t bytes )
+{
+  if ((size_t)(blockEnd - nextFree) < bytes)
+    new_block( bytes );
+}
+
+inline void VarLenTagArena::release()
+{
+  free_blocks( blockList );
+  free_blocks( oldBlocks );
+  blockList = oldBlocks = 0;
+  nextFree = blockEnd = 0;
+  allocBytes = liveBytes = 0;
+}
+
+inline void VarLenTagArena::set( VarLenTag& tag, const void* data, unsigned size )
+{
+  if (tag.in_arena()) {
+    liveBytes -= tag.size();
+    if (size <= tag.size() && size > VarLenTagData::INLINE_COUNT) {
+      memmove( tag.mData.mData.mPointer.array, data, size );
+      tag.mData.mData.mPointer.size = size | VarLenTag::ARENA_FLAG;
+      liveBytes += size;
+      return;
+    }
+  }
+  
+  if (size <= VarLenTagData::INLINE_COUNT) {
+    tag.set( data, size );
+  }
+  else {
+    unsigned char* array = allocate( size );
+    memcpy( array, data, size );
+    tag.clear();
+    tag.set_arena_array( array, size );
+    liveBytes += size;
+  }
+}
+
+inline unsigned char* VarLenTagArena::resize( VarLenTag& tag, unsigned size )
+{
+  if (!tag.in_arena() && size <= tag.size())
+    return tag.resize( size );
+  
+  if (tag.in_arena()) {
+    liveBytes -= tag.size();
+    if (size <= tag.size() && size > VarLenTagData::INLINE_COUNT) {
+      tag.mData.mData.mPointer.size = size | VarLenTag::ARENA_FLAG;
+      liveBytes += size;
+      return tag.mData.mData.mPointer.array;
+    }
+  }
+  
+  if (size <= VarLenTagData::INLINE_COUNT)
+    return tag.resize( size );
+  
+  unsigned char* array = allocate( size );
+  memcpy( array, tag.data(), tag.size() );
+  tag.clear();
+  tag.set_arena_array( array, size );
+  liveBytes += size;
+  return array;
+}
+
+inline void VarLenTagArena::clear( VarLenTag& tag )
+{
+  if (tag.in_arena())
+    liveBytes -= tag.size();
+  tag.clear();
+}
+
+inline void VarLenTagArena::compact_begin()
+{
+  free_blocks( oldBlocks );
+  oldBlocks = blockList;
+  blockList = 0;
+  nextFree = blockEnd = 0;
+  allocBytes = 0;
+  size_t bytes = liveBytes;
+  liveBytes = 0;
+  if (bytes)
+    new_block( bytes + bytes / 8 );
+}
+
+inline void VarLenTagArena::compact_value( VarLenTag& tag )
+{
+  if (tag.in_arena()) {
+    unsigned char* array = allocate( tag.size() );
+    memcpy( array, tag.mData.mData.mPointer.array, tag.size() );
+    tag.set_arena_array( array, tag.size() );
+    liveBytes += tag.size();
+  }
+}
+
+inline void VarLenTagArena::compact_end()
+{
+  free_blocks( oldBlocks );
+  oldBlocks = 0;
+    // liveBytes overestimates when values left the arena on their own,
+    // so the block reserved by compact_begin may not have been needed
+  if (!liveBytes) {
+    free_blocks( blockList );
+    blockList = 0;
+    nextFree = blockEnd = 0;
+    allocBytes = 0;
+  }
+}
+
 } // namespace moab
 
 #endif
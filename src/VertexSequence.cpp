@@ -7,10 +7,14 @@ VertexSequence::~VertexSequence() {}
 EntitySequence* VertexSequence::split( EntityHandle here )
   { return new VertexSequence( *this, here ); }
 
+int VertexSequence::values_per_entity() const
+  { return singlePrecision ? FLOAT_COORDS : DOUBLE_COORDS; }
+
 SequenceData* VertexSequence::create_data_subset( EntityHandle start,
                                                   EntityHandle end ) const
 {
-  const int sizes[] = { sizeof(double), sizeof(double), sizeof(double) };
+  const int size = singlePrecision ? sizeof(float) : sizeof(double);
+  const int sizes[] = { size, size, size };
   return data()->subset(start, end, sizes );
 }
   
@@ -22,7 +26,7 @@ ErrorCode VertexSequence::push_front( EntityID count )
 
 void VertexSequence::get_const_memory_use( unsigned long& per_ent, unsigned long& seq ) const
 {
-  per_ent = 3 * sizeof(double);
+  per_ent = 3 * (singlePrecision ? sizeof(float) : sizeof(double));
   seq = sizeof(*this);
 }
 
@@ -10,24 +10,43 @@ class VertexSequence : public EntitySequence
 {
 public:
 
+    /**\brief Values of values_per_entity() for vertex sequences
+     *
+     * Vertex coordinates are stored either as doubles or, to halve
+     * the memory and bandwidth needed for them, as floats.  Vertices
+     * with different coordinate precision are never stored in the 
+     * same SequenceData.
+     */
+  enum { DOUBLE_COORDS = 0, FLOAT_COORDS = 1 };
+
   VertexSequence( EntityHandle start,
                   EntityID count,
-                  SequenceData* dat )
-    : EntitySequence( start, count, dat )
+                  SequenceData* dat,
+                  bool single_precision = false )
+    : EntitySequence( start, count, dat ),
+      singlePrecision( single_precision )
     {}
   
   VertexSequence( EntityHandle start,
                   EntityID count,
-                  EntityID data_size )
-    : EntitySequence( start, count, new SequenceData( 3, start, start+data_size-1 ) )
+                  EntityID data_size,
+                  bool single_precision = false )
+    : EntitySequence( start, count, new SequenceData( 3, start, start+data_size-1 ) ),
+      singlePrecision( single_precision )
     {
-      data()->create_sequence_data( X, sizeof(double) );
-      data()->create_sequence_data( Y, sizeof(double) );
-      data()->create_sequence_data( Z, sizeof(double) );
+      const int size = single_precision ? sizeof(float) : sizeof(double);
+      data()->create_sequence_data( X, size );
+      data()->create_sequence_data( Y, size );
+      data()->create_sequence_data( Z, size );
     } 
   
   virtual ~VertexSequence();
   
+    //! True if coordinates are stored as float rather than double
+  bool single_precision() const { return singlePrecision; }
+  
+  int values_per_entity() const;
+  
   inline ErrorCode get_coordinates( EntityHandle handle,
                                       double& x,
                                       double& y,
@@ -36,6 +55,7 @@ public:
   inline ErrorCode get_coordinates( EntityHandle handle,
                                       double coords[3] ) const;
 
+    //! Fails with MB_TYPE_OUT_OF_RANGE for single-precision coordinates
   inline ErrorCode get_coordinates_ref( EntityHandle handle,
                                           const double*& x,
                                           const double*& y,
@@ -49,13 +69,25 @@ public:
   inline ErrorCode set_coordinates( EntityHandle entity,
                                       const double xyz[3] );
 
+    //! Fails with MB_TYPE_OUT_OF_RANGE for single-precision coordinates
   inline ErrorCode get_coordinate_arrays( double*& x, 
                                             double*& y, 
                                             double*& z );
 
+    //! Fails with MB_TYPE_OUT_OF_RANGE for single-precision coordinates
   inline ErrorCode get_coordinate_arrays( const double*& x,
                                             const double*& y,
                                             const double*& z ) const;
+
+    //! Fails with MB_TYPE_OUT_OF_RANGE for double-precision coordinates
+  inline ErrorCode get_coordinate_arrays( float*& x, 
+                                            float*& y, 
+                                            float*& z );
+
+    //! Fails with MB_TYPE_OUT_OF_RANGE for double-precision coordinates
+  inline ErrorCode get_coordinate_arrays( const float*& x,
+                                            const float*& y,
+                                            const float*& z ) const;
  
   EntitySequence* split( EntityHandle here );
   
@@ -80,6 +112,16 @@ private:
   { 
     return reinterpret_cast<const double*>(data()->get_sequence_data( coord ));
   }
+
+  inline float* float_array( Coord coord )
+  { 
+    return reinterpret_cast<float*>(data()->get_sequence_data( coord ));
+  }
+
+  inline const float* float_array( Coord coord ) const
+  { 
+    return reinterpret_cast<const float*>(data()->get_sequence_data( coord ));
+  }
   
   inline double* x_array() { return array(X); }
   inline double* y_array() { return array(Y); }
@@ -90,8 +132,11 @@ private:
   inline const double* z_array() const { return array(Z); }
   
   VertexSequence( VertexSequence& split_from, EntityHandle here )
-    : EntitySequence( split_from, here )
+    : EntitySequence( split_from, here ),
+      singlePrecision( split_from.singlePrecision )
     {}
+  
+  bool singlePrecision;
 };
 
   
@@ -101,6 +146,12 @@ ErrorCode VertexSequence::get_coordinates( EntityHandle handle,
                                              double& z ) const
 {
   EntityID offset = handle - data()->start_handle();
+  if (singlePrecision) {
+    x = float_array(X)[offset];
+    y = float_array(Y)[offset];
+    z = float_array(Z)[offset];
+    return MB_SUCCESS;
+  }
   x = x_array()[offset];
   y = y_array()[offset];
   z = z_array()[offset];
@@ -110,11 +161,7 @@ ErrorCode VertexSequence::get_coordinates( EntityHandle handle,
 ErrorCode VertexSequence::get_coordinates( EntityHandle handle,
                                              double coords[3] ) const
 {
-  EntityID offset = handle - data()->start_handle();
-  coords[X] = x_array()[offset];
-  coords[Y] = y_array()[offset];
-  coords[Z] = z_array()[offset];
-  return MB_SUCCESS;
+  return get_coordinates( handle, coords[X], coords[Y], coords[Z] );
 }
   
 
@@ -123,6 +170,8 @@ ErrorCode VertexSequence::get_coordinates_ref( EntityHandle handle,
                                                  const double*& y,
                                                  const double*& z ) const
 {
+  if (singlePrecision)
+    return MB_TYPE_OUT_OF_RANGE;
   EntityID offset = handle - data()->start_handle();
   x = x_array()+offset;
   y = y_array()+offset;
@@ -136,6 +185,12 @@ ErrorCode VertexSequence::set_coordinates( EntityHandle entity,
                                              double z )
 {
   EntityID offset = entity - data()->start_handle();
+  if (singlePrecision) {
+    float_array(X)[offset] = (float)x;
+    float_array(Y)[offset] = (float)y;
+    float_array(Z)[offset] = (float)z;
+    return MB_SUCCESS;
+  }
   x_array()[offset] = x;
   y_array()[offset] = y;
   z_array()[offset] = z;
@@ -145,17 +200,15 @@ ErrorCode VertexSequence::set_coordinates( EntityHandle entity,
 ErrorCode VertexSequence::set_coordinates( EntityHandle entity,
                                              const double* xyz )
 {
-  EntityID offset = entity - data()->start_handle();
-  x_array()[offset] = xyz[0];
-  y_array()[offset] = xyz[1];
-  z_array()[offset] = xyz[2];
-  return MB_SUCCESS;
+  return set_coordinates( entity, xyz[0], xyz[1], xyz[2] );
 }
 
 ErrorCode VertexSequence::get_coordinate_arrays( double*& x, 
                                                    double*& y, 
                                                    double*& z )
 {
+  if (singlePrecision)
+    return MB_TYPE_OUT_OF_RANGE;
   EntityID offset = start_handle() - data()->start_handle();
   x = x_array()+offset;
   y = y_array()+offset;
@@ -170,6 +223,32 @@ ErrorCode VertexSequence::get_coordinate_arrays( const double*& x,
   return get_coordinates_ref( start_handle(), x, y, z ); 
 }
 
+ErrorCode VertexSequence::get_coordinate_arrays( float*& x, 
+                                                   float*& y, 
+                                                   float*& z )
+{
+  if (!singlePrecision)
+    return MB_TYPE_OUT_OF_RANGE;
+  EntityID offset = start_handle() - data()->start_handle();
+  x = float_array(X)+offset;
+  y = float_array(Y)+offset;
+  z = float_array(Z)+offset;
+  return MB_SUCCESS;
+}
+  
+ErrorCode VertexSequence::get_coordinate_arrays( const float*& x,
+                                                   const float*& y,
+                                                   const float*& z ) const
+{
+  if (!singlePrecision)
+    return MB_TYPE_OUT_OF_RANGE;
+  EntityID offset = start_handle() - data()->start_handle();
+  x = float_array(X)+offset;
+  y = float_array(Y)+offset;
+  z = float_array(Z)+offset;
+  return MB_SUCCESS;
+}
+
 } // namespace moab
 
 #endif
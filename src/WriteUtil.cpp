@@ -33,6 +33,7 @@
 #include <errno.h>
 #include <assert.h>
 #include <iostream>
+#include <algorithm>
 
 #ifdef WIN32
 #  define stat _stat
@@ -142,6 +143,28 @@ ErrorCode WriteUtil::get_node_coords(
   return result;
 }
 
+  // Copy one coordinate (or all three, interleaved, if which_array
+  // is -1) for count vertices beginning at offset in a VertexSequence
+  // with coordinates stored as T.
+template <typename T> static
+void copy_coords( const VertexSequence* vseq, int which_array,
+                  EntityHandle offset, EntityHandle count, double* output )
+{
+  const T* coord_array[3];
+  vseq->get_coordinate_arrays( coord_array[0], coord_array[1], coord_array[2]);
+  if (-1 != which_array) {
+    std::copy( coord_array[which_array] + offset, 
+               coord_array[which_array] + offset + count, output );
+  }
+  else {
+    for (unsigned int i = 0; i < count; i++) {
+      *output = coord_array[0][i+offset]; output++;
+      *output = coord_array[1][i+offset]; output++;
+      *output = coord_array[2][i+offset]; output++;
+    }
+  }
+}
+
 ErrorCode WriteUtil::get_node_coords(
     const int which_array, /* 0->X, 1->Y, 2->Z, -1->all */
     Range::const_iterator iter,
@@ -193,27 +216,16 @@ ErrorCode WriteUtil::get_node_coords(
     assert( *iter >= (*seq_iter)->start_handle() );
     EntityHandle offset = *iter - (*seq_iter)->start_handle();
     
-      // Get coordinate arrays from sequence
-    double* coord_array[3];
-    static_cast<VertexSequence*>(*seq_iter)
-      ->get_coordinate_arrays( coord_array[0], coord_array[1], coord_array[2]);
-    
       // Copy data to ouput buffer
-    if (-1 != which_array) {
-      if (output_iter + count > output_end)
-        return MB_FAILURE;
-      memcpy( output_iter, coord_array[which_array] + offset, count * sizeof(double) );
-      output_iter += count;
-    }
-    else {
-      if (output_iter + 3*count > output_end)
-        return MB_FAILURE;
-      for (unsigned int i = 0; i < count; i++) {
-        *output_iter = coord_array[0][i+offset]; output_iter++;
-        *output_iter = coord_array[1][i+offset]; output_iter++;
-        *output_iter = coord_array[2][i+offset]; output_iter++;
-      }
-    }
+    const size_t len = -1 == which_array ? 3*count : count;
+    if (output_iter + len > output_end)
+      return MB_FAILURE;
+    const VertexSequence* vseq = static_cast<VertexSequence*>(*seq_iter);
+    if (vseq->single_precision())
+      copy_coords<float>( vseq, which_array, offset, count, output_iter );
+    else
+      copy_coords<double>( vseq, which_array, offset, count, output_iter );
+    output_iter += len;
     
       // Iterate
     iter += count;
@@ -763,7 +775,7 @@ ErrorCode WriteUtil::get_adjacencies( EntityHandle entity,
   int num_adj, id;
 
     // Get handles of adjacent entities 
-  rval = mMB->a_entity_factory()->get_adjacencies( entity, adj_array, num_adj );
+  rval = mMB->a_entity_factory()->get_adjacencies( entity, adj_array, num_adj, adjStorage );
   if (MB_SUCCESS != rval)
   {
     adj.clear();
@@ -793,7 +805,7 @@ ErrorCode WriteUtil::get_adjacencies( EntityHandle entity,
                                           const EntityHandle*& adj_array,
                                           int& num_adj )
 {
-  return mMB->a_entity_factory()->get_adjacencies( entity, adj_array, num_adj );
+  return mMB->a_entity_factory()->get_adjacencies( entity, adj_array, num_adj, adjStorage );
 }
 
 ErrorCode WriteUtil::get_tag_list( std::vector<Tag>& result_list,
@@ -877,6 +889,7 @@ ErrorCode WriteUtil::get_entity_list_pointers( Range::const_iterator begin,
                                                int* lengths,
                                                unsigned char* flags )
 {
+  setContents.clear();
   RangeSeqIntersectIter iter(mMB->sequence_manager());
   ErrorCode rval = iter.init( begin, end );
   while (MB_SUCCESS == rval) {
@@ -890,7 +903,15 @@ ErrorCode WriteUtil::get_entity_list_pointers( Range::const_iterator begin,
       for (EntityHandle h = iter.get_start_handle(); h <= iter.get_end_handle(); ++h) {
         set = seq->get_set(h);
         switch (relation) {
-          case CONTENTS: *pointers = set->get_contents( clen ); len = clen; break;
+          case CONTENTS: 
+            if (set->compressed()) {
+              setContents.push_back( std::vector<EntityHandle>() );
+              *pointers = set->get_contents( clen, setContents.back() );
+            }
+            else
+              *pointers = set->get_contents( clen ); 
+            len = clen; 
+            break;
           case CHILDREN: *pointers = set->get_children( len ); break;
           case PARENTS:  *pointers = set->get_parents( len ); break;
         }
@@ -941,6 +962,7 @@ ErrorCode WriteUtil::get_entity_list_pointers( EntityHandle const* entities,
                                                int* lengths,
                                                unsigned char* flags )
 {
+  setContents.clear();
   SequenceManager *sm = mMB->sequence_manager();
   const EntitySequence *tmp_seq;
   ErrorCode rval = MB_SUCCESS;
@@ -956,7 +978,15 @@ ErrorCode WriteUtil::get_entity_list_pointers( EntityHandle const* entities,
       int len = 0; size_t clen;
       set = seq->get_set(entities[i]);
       switch (relation) {
-        case CONTENTS: *pointers = set->get_contents( clen ); len = clen; break;
+        case CONTENTS: 
+          if (set->compressed()) {
+            setContents.push_back( std::vector<EntityHandle>() );
+            *pointers = set->get_contents( clen, setContents.back() );
+          }
+          else
+            *pointers = set->get_contents( clen ); 
+          len = clen; 
+          break;
         case CHILDREN: *pointers = set->get_children( len ); break;
         case PARENTS:  *pointers = set->get_parents( len ); break;
       }
@@ -22,6 +22,8 @@
 #endif
 
 #include "moab/WriteUtilIface.hpp"
+#include <list>
+#include <vector>
 
 namespace moab {
 
@@ -34,6 +36,10 @@ private:
   //! pointer to the Core
   Core* mMB;
   Error* mError;
+  //! Contents of compressed sets returned by get_entity_list_pointers
+  std::list< std::vector<EntityHandle> > setContents;
+  //! Adjacencies of structured vertices returned by get_adjacencies
+  std::vector<EntityHandle> adjStorage;
 public:
 
   //! constructor takes Core pointer
@@ -217,6 +217,7 @@ ReadHDF5::ReadHDF5( Interface* iface )
     debugTrack( false ),
     dbgOut(stderr),
     blockedCoordinateIO(DEFAULT_BLOCKED_COORDINATE_IO),
+    floatCoords(false),
     bcastSummary(DEFAULT_BCAST_SUMMARY),
     bcastDuplicateReads(DEFAULT_BCAST_DUPLICATE_READS),
     setMeta(0)
@@ -317,6 +318,7 @@ ErrorCode ReadHDF5::set_up_read( const char* filename,
   debugTrack = (MB_SUCCESS == opts.get_null_option("DEBUG_BINIO"));
   
   opts.get_toggle_option("BLOCKED_COORDINATE_IO",DEFAULT_BLOCKED_COORDINATE_IO,blockedCoordinateIO);
+  opts.get_toggle_option("FLOAT_COORDS",false,floatCoords);
   opts.get_toggle_option("BCAST_SUMMARY",        DEFAULT_BCAST_SUMMARY,        bcastSummary);
   opts.get_toggle_option("BCAST_DUPLICATE_READS",DEFAULT_BCAST_DUPLICATE_READS,bcastDuplicateReads);
   bool bglockless = (MB_SUCCESS == opts.get_null_option("BGLOCKLESS"));
@@ -1395,50 +1397,21 @@ ErrorCode ReadHDF5::search_tag_values( hid_t tag_table,
   return MB_SUCCESS;
 }
 
-ErrorCode ReadHDF5::read_nodes( const Range& node_file_ids )
+template <typename T>
+ErrorCode ReadHDF5::read_node_coords( hid_t data_id,
+                                      const Range& node_file_ids,
+                                      hid_t mem_type,
+                                      std::vector<T*>& arrays,
+                                      int cdim )
 {
-  ErrorCode rval;
-  mhdf_Status status;
   const int dim = fileInfo->nodes.vals_per_ent;
-  Range range;
-
-  CHECK_OPEN_HANDLES;
-  
-  if (node_file_ids.empty())
-    return MB_SUCCESS;
-  
-  int cdim;
-  rval = iFace->get_dimension( cdim );
-  if (MB_SUCCESS != rval)
-    return error(rval);
-  
-  if (cdim < dim)
-  {
-    rval = iFace->set_dimension( dim );
-    if (MB_SUCCESS != rval)
-      return error(rval);
-  }
-  
-  hid_t data_id = mhdf_openNodeCoordsSimple( filePtr, &status );
-  if (is_error(status))
-    return error(MB_FAILURE);
-
-  EntityHandle handle;
-  std::vector<double*> arrays(dim);
   const size_t num_nodes = node_file_ids.size();
-  rval = readUtil->get_node_coords( dim, (int)num_nodes, 0, handle, arrays );
-  if (MB_SUCCESS != rval)
-  {
-    mhdf_closeData( filePtr, data_id, &status );
-    return error(rval);
-  }
-
   if (blockedCoordinateIO) {
     try {
       for (int d = 0; d < dim; ++d) {
         ReadHDF5Dataset reader( "blocked coords", data_id, nativeParallel, mpiComm, false );
         reader.set_column( d );
-        reader.set_file_ids( node_file_ids, fileInfo->nodes.start_id, num_nodes, H5T_NATIVE_DOUBLE );
+        reader.set_file_ids( node_file_ids, fileInfo->nodes.start_id, num_nodes, mem_type );
         dbgOut.printf( 3, "Reading %lu chunks for coordinate dimension %d\n", reader.get_read_count(), d );
         // should normally only have one read call, unless sparse nature
         // of file_ids caused reader to do something strange
@@ -1450,25 +1423,23 @@ ErrorCode ReadHDF5::read_nodes( const Range& node_file_ids )
           offset += count;
         }
         if (offset != num_nodes) {
-          mhdf_closeData( filePtr, data_id, &status );
           assert(false);
           return MB_FAILURE;
         }
       }
     }
     catch (ReadHDF5Dataset::Exception) {
-      mhdf_closeData( filePtr, data_id, &status );
       return error(MB_FAILURE);
     }
   }
   else { // !blockedCoordinateIO
-    double* buffer = (double*)dataBuffer;
-    long chunk_size = bufferSize / (3*sizeof(double));
+    T* buffer = (T*)dataBuffer;
+    long chunk_size = bufferSize / (3*sizeof(T));
     long coffset = 0;
     int nn = 0;
     try {
       ReadHDF5Dataset reader( "interleaved coords", data_id, nativeParallel, mpiComm, false );
-      reader.set_file_ids( node_file_ids, fileInfo->nodes.start_id, chunk_size, H5T_NATIVE_DOUBLE );
+      reader.set_file_ids( node_file_ids, fileInfo->nodes.start_id, chunk_size, mem_type );
       dbgOut.printf( 3, "Reading %lu chunks for coordinate coordinates\n", reader.get_read_count() );
       while (!reader.done()) {
         dbgOut.tprintf(3,"Reading chunk %d of node coords\n", ++nn);
@@ -1483,15 +1454,62 @@ ErrorCode ReadHDF5::read_nodes( const Range& node_file_ids )
       }
     }
     catch (ReadHDF5Dataset::Exception) {
-      mhdf_closeData( filePtr, data_id, &status );
       return error(MB_FAILURE);
     }
   }
 
+  for (int d = dim; d < cdim; ++d)
+    memset( arrays[d], 0, num_nodes*sizeof(T) );
+  return MB_SUCCESS;
+}
+
+ErrorCode ReadHDF5::read_nodes( const Range& node_file_ids )
+{
+  ErrorCode rval;
+  mhdf_Status status;
+  const int dim = fileInfo->nodes.vals_per_ent;
+  Range range;
+
+  CHECK_OPEN_HANDLES;
+  
+  if (node_file_ids.empty())
+    return MB_SUCCESS;
+  
+  int cdim;
+  rval = iFace->get_dimension( cdim );
+  if (MB_SUCCESS != rval)
+    return error(rval);
+  
+  if (cdim < dim)
+  {
+    rval = iFace->set_dimension( dim );
+    if (MB_SUCCESS != rval)
+      return error(rval);
+  }
+  
+  hid_t data_id = mhdf_openNodeCoordsSimple( filePtr, &status );
+  if (is_error(status))
+    return error(MB_FAILURE);
+
+  EntityHandle handle;
+  const size_t num_nodes = node_file_ids.size();
+  if (floatCoords) {
+    std::vector<float*> arrays(dim);
+    rval = readUtil->get_node_coords( dim, (int)num_nodes, 0, handle, arrays );
+    if (MB_SUCCESS == rval)
+      rval = read_node_coords( data_id, node_file_ids, H5T_NATIVE_FLOAT, arrays, cdim );
+  }
+  else {
+    std::vector<double*> arrays(dim);
+    rval = readUtil->get_node_coords( dim, (int)num_nodes, 0, handle, arrays );
+    if (MB_SUCCESS == rval)
+      rval = read_node_coords( data_id, node_file_ids, H5T_NATIVE_DOUBLE, arrays, cdim );
+  }
+
   dbgOut.print(3,"Closing node coordinate table\n");
   mhdf_closeData( filePtr, data_id, &status );
-  for (int d = dim; d < cdim; ++d)
-    memset( arrays[d], 0, num_nodes*sizeof(double) );
+  if (MB_SUCCESS != rval)
+    return error(rval);
     
   dbgOut.printf(3,"Updating ID to handle map for %lu nodes\n", (unsigned long)node_file_ids.size());
   return insert_in_id_map( node_file_ids, handle );
@@ -3433,7 +3451,11 @@ void ReadHDF5::convert_range_to_handle( const EntityHandle* ranges,
                                         Range& merge )
 {
   RangeMap<long,EntityHandle>::iterator it = id_map.begin();
-  Range::iterator hint = merge.begin();
+    // Collect the handle pairs so that they can be merged into
+    // 'merge' in a single pass if they are in order.
+  std::vector<EntityHandle> pairs;
+  pairs.reserve( 2*num_ranges );
+  bool sorted = true;
   for (size_t i = 0; i < num_ranges; ++i) {
     long id = ranges[2*i];
     const long end = id + ranges[2*i+1];
@@ -3454,7 +3476,11 @@ void ReadHDF5::convert_range_to_handle( const EntityHandle* ranges,
       // we are done with this range, go to the next one
       if (count <= 0)
         break;
-      hint = merge.insert( hint, it->value + off, it->value + off + count - 1 );
+      const EntityHandle start = it->value + off;
+      if (!pairs.empty() && start < pairs[pairs.size()-2])
+        sorted = false;
+      pairs.push_back( start );
+      pairs.push_back( start + count - 1 );
       id += count;
       if (id < end)
       {
@@ -3465,6 +3491,17 @@ void ReadHDF5::convert_range_to_handle( const EntityHandle* ranges,
       }
     }
   }
+  
+  if (pairs.empty())
+    return;
+  if (sorted) {
+    merge.insert_sorted_pairs( &pairs[0], pairs.size()/2 );
+  }
+  else {
+    Range::iterator hint = merge.begin();
+    for (size_t i = 0; i < pairs.size(); i += 2)
+      hint = merge.insert( hint, pairs[i], pairs[i+1] );
+  }
 }
 
 ErrorCode ReadHDF5::convert_range_to_handle( const EntityHandle* array,
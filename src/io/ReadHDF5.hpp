@@ -166,6 +166,7 @@ private:
   //! Flags for some behavior that can be changed through
   //! reader options
   bool blockedCoordinateIO;
+  bool floatCoords;         //!< store vertex coordinates in single precision
   bool bcastSummary;
   bool bcastDuplicateReads;
   
@@ -197,6 +198,16 @@ private:
   ErrorCode get_partition( Range& tmp_file_ids, int num_parts, int part_number );
   
   ErrorCode read_nodes( const Range& node_file_ids );
+
+  //! Read node coordinates from open table into arrays of type T,
+  //! as returned from ReadUtilIface::get_node_coords, zeroing 
+  //! arrays for any dimensions up to \c cdim not in the file.
+  template <typename T>
+  ErrorCode read_node_coords( hid_t data_id,
+                              const Range& node_file_ids,
+                              hid_t mem_type,
+                              std::vector<T*>& arrays,
+                              int cdim );
   
     // Read elements in fileInfo->elems[index]
   ErrorCode read_elems( int index );
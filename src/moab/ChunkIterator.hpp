@@ -0,0 +1,147 @@
+#ifndef MB_CHUNK_ITERATOR_HPP
+#define MB_CHUNK_ITERATOR_HPP
+
+#include "moab/Interface.hpp"
+#include "moab/Range.hpp"
+#include <vector>
+
+namespace moab {
+
+/** \class ChunkIterator
+ * \brief Iterate over contiguous storage for several kinds of entity data at once
+ *
+ * Walk a Range of entities in chunks such that, for each chunk, the 
+ * vertex coordinates or element connectivity and the values of any
+ * number of dense tags are all stored contiguously in MOAB's internal
+ * arrays.  This combines the results of coords_iterate, connect_iterate,
+ * and tag_iterate, which each return chunks limited only by their own
+ * storage, so that a loop over a chunk can access all of the data
+ * through direct pointers without copying.
+ *
+ * BEWARE, THIS GIVES ACCESS TO MOAB'S INTERNAL STORAGE, USE WITH CAUTION!
+ * Pointers are valid only until entities are created or deleted.
+ * Chunks do not span vertices with double- and single-precision
+ * coordinates; check float_coordinates() for each chunk.
+ * The returned pointers are aligned only as required for their element
+ * type; MOAB does not align chunk boundaries to vector widths.  Use
+ * peel_count() to find how many leading entities of a chunk to handle
+ * separately before all arrays reach a wider alignment.
+ *
+ *\Example:
+ *\code
+ * ChunkIterator iter( &mb, hexes, false, true, &tag, 1 );
+ * for (err = iter.reset(); MB_SUCCESS == err && !iter.at_end(); err = iter.next()) {
+ *   const EntityHandle* conn = iter.connectivity();
+ *   double* values = reinterpret_cast<double*>(iter.tag_data(0));
+ *   for (int i = 0; i < iter.count(); ++i, conn += iter.nodes_per_element())
+ *     values[i] = ...;
+ * }
+ *\endcode
+ */
+class ChunkIterator
+{
+public:
+
+    /**\param mb           MOAB instance
+     *\param entities     Entities to iterate over.  The Range is not copied
+     *                    and must not be changed while it is iterated over.
+     *\param coordinates  Return vertex coordinates.  If true, all 
+     *                    entities must be vertices.
+     *\param connectivity Return element connectivity.  If true, all
+     *                    entities must be non-polyhedral elements.
+     *\param tags         Dense tags for which to return values.
+     *\param num_tags     Length of \c tags array
+     */
+  ChunkIterator( Interface* mb,
+                 const Range& entities,
+                 bool coordinates,
+                 bool connectivity,
+                 const Tag* tags = 0,
+                 int num_tags = 0 );
+
+    /**\brief Position iterator at first chunk
+     *
+     * Must be called before the first chunk is accessed.
+     *\return MB_TYPE_OUT_OF_RANGE if a tag is not a dense, fixed-length
+     *        tag, or the error returned by one of the *_iterate methods.
+     */
+  ErrorCode reset();
+  
+    //! Advance to next chunk
+  ErrorCode next();
+  
+    //! True if there are no more chunks
+  bool at_end() const { return currIter == allEnts->end(); }
+  
+    //! Number of entities in current chunk
+  int count() const { return chunkCount; }
+  
+    //! First entity in current chunk
+  EntityHandle start_handle() const { return *currIter; }
+  
+    //! Position of first entity of current chunk in range
+  Range::const_iterator position() const { return currIter; }
+  
+    //! True if vertex coordinates for current chunk are stored in
+    //! single precision (see Core::set_float_coordinates), in which
+    //! case they are returned by x_float() etc. and x() etc. are null.
+  bool float_coordinates() const { return 0 != floatPtrs[0]; }
+  
+    //! Vertex X coordinates for current chunk
+  double* x() const { return coordPtrs[0]; }
+    //! Vertex Y coordinates for current chunk
+  double* y() const { return coordPtrs[1]; }
+    //! Vertex Z coordinates for current chunk
+  double* z() const { return coordPtrs[2]; }
+  
+    //! Single-precision vertex X coordinates for current chunk
+  float* x_float() const { return floatPtrs[0]; }
+    //! Single-precision vertex Y coordinates for current chunk
+  float* y_float() const { return floatPtrs[1]; }
+    //! Single-precision vertex Z coordinates for current chunk
+  float* z_float() const { return floatPtrs[2]; }
+  
+    //! Element connectivity for current chunk
+  EntityHandle* connectivity() const { return connPtr; }
+  
+    //! Number of vertices in connectivity of each element in current chunk
+  int nodes_per_element() const { return nodesPerElem; }
+  
+    //! Values of the i-th tag passed to the constructor for current chunk
+  void* tag_data( int i ) const { return tagPtrs[i]; }
+  
+    /**\brief Number of leading entities to skip for aligned access
+     *
+     * Get the smallest number of entities at the start of the current
+     * chunk after which every array returned for the chunk begins at
+     * a multiple of \c alignment bytes.
+     *\param alignment  Required alignment in bytes, a power of two
+     *\return  The number of entities to process before the aligned
+     *         part of the chunk, or count() if the arrays never
+     *         become aligned together within the chunk.
+     */
+  int peel_count( size_t alignment ) const;
+
+private:
+
+    //! Get pointers for chunk beginning at currIter
+  ErrorCode get_chunk();
+
+  Interface* mbImpl;
+  const Range* allEnts;
+  bool wantCoords, wantConnect;
+  std::vector<Tag> tagList;
+  std::vector<int> tagBytes;
+  
+  Range::const_iterator currIter;
+  int chunkCount;
+  double* coordPtrs[3];
+  float* floatPtrs[3];
+  EntityHandle* connPtr;
+  int nodesPerElem;
+  std::vector<void*> tagPtrs;
+};
+
+} // namespace moab
+
+#endif
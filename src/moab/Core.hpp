@@ -172,6 +172,14 @@ public:
                                    double*& ycoords_ptr,
                                    double*& zcoords_ptr,
                                    int& count);
+
+    //! get pointers to single-precision coordinate data
+  virtual ErrorCode coords_iterate(Range::const_iterator iter,
+                                   Range::const_iterator end,
+                                   float*& xcoords_ptr,
+                                   float*& ycoords_ptr,
+                                   float*& zcoords_ptr,
+                                   int& count);
   
   //! get the coordinate information for this handle if it is of type Vertex
   //! otherwise, return an error
@@ -821,6 +829,58 @@ public:
                                     void const* const* tag_data,
                                     const int* tag_sizes = 0 );
 
+    /**\brief Set tag data from a packed array of values
+     *
+     * Set values for a list of entities from a single buffer containing
+     * the concatenation of all values.  The value for the i-th entity
+     * begins at <code>offsets[i]</code> and ends before
+     * <code>offsets[i+1]</code>.  This is intended for filling 
+     * variable-length tags for many entities in one pass.  For
+     * fixed-length tags all values must have the tag length.
+     *\note  This function may not be used for bit tags.
+     *\param tag_handle     The tag
+     *\param entity_handles An array of entity handles for which to set tag values.
+     *\param num_entities   The length of the 'entity_handles' array.
+     *\param tag_data       Concatenated tag values.
+     *\param offsets        Array of length 'num_entities'+1 containing 
+     *                      the position of each value in 'tag_data',
+     *                      in units of the tag data type, followed by 
+     *                      the end of the last value.  Offsets must be
+     *                      non-negative and non-decreasing, so that the
+     *                      values lie within the first 'offsets[num_entities]'
+     *                      units of 'tag_data'; otherwise nothing is set
+     *                      and MB_INDEX_OUT_OF_RANGE is returned.
+     */
+  virtual ErrorCode  tag_set_packed_data( Tag tag_handle, 
+                                          const EntityHandle* entity_handles, 
+                                          int num_entities,
+                                          const void* tag_data,
+                                          const int* offsets );
+
+    /**\brief Set tag data from a packed array of values
+     *
+     * Set values for a list of entities from a single buffer containing
+     * the concatenation of all values.  The value for the i-th entity
+     * begins at <code>offsets[i]</code> and ends before
+     * <code>offsets[i+1]</code>.  This is intended for filling 
+     * variable-length tags for many entities in one pass.  For
+     * fixed-length tags all values must have the tag length.
+     *\note  This function may not be used for bit tags.
+     *\param tag_handle     The tag
+     *\param entity_handles The entity handles for which to set tag values.
+     *\param tag_data       Concatenated tag values.
+     *\param offsets        Array of length 'entity_handles.size()'+1 
+     *                      containing the position of each value in 
+     *                      'tag_data', in units of the tag data type,
+     *                      followed by the end of the last value.
+     *                      Offsets must be non-negative and non-decreasing,
+     *                      as for the array version.
+     */
+  virtual ErrorCode  tag_set_packed_data( Tag tag_handle, 
+                                          const Range& entity_handles,
+                                          const void* tag_data,
+                                          const int* offsets );
+
     /**\brief Set tag data given value.
      *
      * For a tag, set the values for a list of passed entity handles to
@@ -879,6 +939,13 @@ public:
   //! Removes the tag from the database and deletes all of its associated data.
   virtual ErrorCode  tag_delete(Tag tag_handle);
 
+    //! Maintain an index of entities by tag value
+  virtual ErrorCode tag_set_value_index( Tag tag_handle, bool enable = true );
+
+    //! Get counter of memory allocated for values of a tag
+  virtual ErrorCode tag_get_memory_counter( Tag tag_handle, 
+                                            const MemoryCounter*& counter_out );
+
   /**\brief Access tag data via direct pointer into contiguous blocks
    *
    * Iteratively obtain direct access to contiguous blocks of tag
@@ -1147,6 +1214,70 @@ public:
     //! check some adjacencies for consistency
   ErrorCode check_adjacencies(const EntityHandle *ents, int num_ents);
   
+    /**\brief Store coordinates of new vertices in single precision
+     *
+     * Store the coordinates of vertices subsequently created with
+     * create_vertex or create_vertices as float rather than double,
+     * halving the memory for them.  Coordinates are converted to and
+     * from double by get_coords and set_coords, and accessed directly
+     * through the float version of coords_iterate.  Precision is a 
+     * property of each vertex sequence, so existing vertices and those
+     * created by readers are not affected (but see the FLOAT_COORDS
+     * option of the native HDF5 reader.)
+     */
+  void set_float_coordinates( bool enable );
+  
+    //! True if new vertices store coordinates in single precision
+  bool float_coordinates() const;
+
+    /**\brief Store vertex to element adjacencies in a compact, read-only form
+     * See Interface::compact_vert_elem_adjacencies
+     */
+  virtual ErrorCode compact_vert_elem_adjacencies();
+
+    /**\brief Threads used to build vertex to element adjacencies
+     *
+     * Vertex to element adjacencies are built, and packed by
+     * compact_vert_elem_adjacencies, using this many threads.  Zero
+     * (the default) uses the value of the MOAB_NUM_THREADS environment
+     * variable if set, otherwise one thread, because the adjacencies
+     * are usually built inside an unrelated query.
+     */
+  void set_adjacency_threads( unsigned num_threads );
+
+    //! Value from set_adjacency_threads
+  unsigned adjacency_threads() const;
+
+    /**\brief Limit the memory used for adjacency lists
+     *
+     * Vertex to element adjacencies are created by the first adjacency
+     * query that needs them and are otherwise kept until the mesh is
+     * deleted.  With a budget, each adjacency query first checks the
+     * memory of all adjacency lists of this instance, and if it exceeds
+     * \c bytes, reduces the vertex lists of the least recently used pages
+     * of consecutive vertices to the adjacencies that were explicitly 
+     * created (e.g. with add_adjacencies), until the lists use at most 
+     * three quarters of the budget.  Pages used by the query itself are
+     * not released.  The removed entries are recomputed from the 
+     * connectivity of the removed elements when a list of the page is 
+     * next needed.
+     * This trades query time for memory when only parts of a large mesh
+     * are queried at a time.  Lists in the compact form of
+     * compact_vert_elem_adjacencies are not released.
+     *
+     * Pointers from adjacencies_iterate to vertex lists are invalidated
+     * by any subsequent adjacency query while a budget is set.
+     *\param bytes Memory limit, or zero (the default) for no limit.
+     *             Setting zero restores all released lists.
+     */
+  ErrorCode set_adjacency_memory_budget( size_t bytes );
+
+    //! Memory limit for adjacency lists, or zero if none
+  size_t adjacency_memory_budget() const;
+
+    //! Memory currently used by adjacency lists of this instance
+  size_t adjacency_memory_use() const;
+
     //! return whether the input handle is valid or not
   bool is_valid(const EntityHandle this_ent) const;
   
@@ -1185,6 +1316,19 @@ public:
      */
   ErrorCode get_set_iterators(EntityHandle meshset,
                               std::vector<SetIterator *> &set_iters);
+
+//-----------------Concurrent Access Functions------------------//
+
+    /**\brief Begin a phase in which the database may be queried from multiple threads
+     * See Interface::begin_read_only_phase
+     */
+  virtual ErrorCode begin_read_only_phase( bool create_vert_elem_adjacencies = true );
+
+    //! End a read-only phase, allowing modification of the database.
+  virtual ErrorCode end_read_only_phase();
+
+    //! Test if database is in a read-only phase.
+  virtual bool is_read_only_phase() const;
   
 
 //-----------------Memory Functions------------------//
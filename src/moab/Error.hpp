@@ -55,15 +55,19 @@ class Error
 {
   //! string to hold the last error that occurred in MB
   std::string mLastError;
+  
+  //! if true, errors are not recorded (see Interface::begin_read_only_phase)
+  bool mReadOnly;
 
 public:
 
-  Error() {}
+  Error() : mReadOnly(false) {}
   ~Error(){}
 
   ErrorCode set_last_error(const std::string& error) 
   { 
-    mLastError = error; 
+    if (!mReadOnly)
+      mLastError = error; 
     return MB_SUCCESS; 
   }
 
@@ -71,6 +75,8 @@ public:
   
   ErrorCode set_last_error( const char* fmt, va_list args )
   {
+    if (mReadOnly)
+      return MB_SUCCESS;
     char text[1024];
     VSNPRINTF( text, sizeof(text), fmt, args );
     mLastError = text;
@@ -83,6 +89,13 @@ public:
     return MB_SUCCESS;
   }
 
+  //! Stop (or resume) recording error messages, so that the
+  //! shared message buffer is not written by concurrent readers.
+  void set_read_only( bool read_only )
+  {
+    mReadOnly = read_only;
+  }
+
 };
 
 inline ErrorCode Error::set_last_error(const char* fmt, ...)
@@ -22,6 +22,7 @@
 namespace moab {
 
 class Interface;
+class MemoryCounter;
 class Range;
 class SetIterator;
 class ProcConfig;
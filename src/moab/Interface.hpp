@@ -374,7 +374,7 @@ public:
     /** BEWARE, THIS GIVES ACCESS TO MOAB'S INTERNAL STORAGE, USE WITH CAUTION!
      * This function returns pointers to MOAB's internal storage for vertex coordinates.
      * Access is similar to tag_iterate, see documentation for that function for details
-     * about arguments and a coding example.
+     * about arguments, alignment of the returned arrays, and a coding example.
      */
   virtual ErrorCode coords_iterate(Range::const_iterator iter,
                                      /**< Iterator to first entity you want coordinates for */
@@ -390,6 +390,19 @@ public:
                                      /**< Number of entities for which returned pointers are valid/contiguous */
                                    ) = 0;
 
+    //! get pointers to single-precision coordinate data
+    /** As above, for vertices with coordinates stored as float rather
+     * than double (see Core::set_float_coordinates.)  Each version of
+     * coords_iterate fails with MB_TYPE_OUT_OF_RANGE for vertices with
+     * coordinates stored in the other precision.
+     */
+  virtual ErrorCode coords_iterate(Range::const_iterator iter,
+                                   Range::const_iterator end,
+                                   float*& xcoords_ptr,
+                                   float*& ycoords_ptr,
+                                   float*& zcoords_ptr,
+                                   int& count) = 0;
+
     //! Gets xyz coordinate information for range of vertices
     /** Length of 'coords' should be at least 3*<em>entity_handles.size()</em> before making call.
         \param entity_handles Range of vertex handles (error if not of type MeshVertex)
@@ -680,7 +693,8 @@ public:
      * const version of this function is given, because adjacency data is managed more carefully in MOAB
      * and should be treated as read-only by applications.  If adjacencies have not yet been initialized,
      * adjs_ptr will be NULL (i.e. adjs_ptr == NULL).  There may also be NULL entries for individual entities,
-     * i.e. adjs_ptr[i] == NULL.
+     * i.e. adjs_ptr[i] == NULL.  Returns MB_NOT_IMPLEMENTED for vertices of structured mesh that has
+     * structured elements, whose adjacencies to those elements are computed rather than stored.
      * \param iter Iterator to beginning of entity range desired
      * \param end End iterator for which adjacencies are requested
      * \param adjs_ptr Pointer to pointer to const std::vector<EntityHandle>; each member of that array is 
@@ -691,6 +705,18 @@ public:
                                         Range::const_iterator end,
                                         const std::vector<EntityHandle> **& adjs_ptr,
                                         int& count) = 0;
+
+    /**\brief Store vertex to element adjacencies in a compact, read-only form
+     *
+     * Create vertex to element adjacencies if they do not already exist, 
+     * and pack them into a single array of handles per block of vertices
+     * rather than a separately allocated list per vertex.  This uses 
+     * considerably less memory for meshes that are not modified.  The
+     * per-vertex lists are restored automatically the first time the 
+     * adjacencies are modified (e.g. when an element is created or deleted)
+     * or when they are requested through adjacencies_iterate.
+     */
+  virtual ErrorCode compact_vert_elem_adjacencies() = 0;
     /**@}*/
 
     //! Enumerated type used in get_adjacencies() and other functions
@@ -1436,6 +1462,19 @@ public:
      *                      tag value corresponding to each entity handle.
      *\param tag_sizes      The length of each tag value.  Optional for 
      *                      fixed-length tags.  Required for variable-length tags.
+     *
+     *\Note For an entity that has no value for a tag with a default
+     *      value, the returned pointer is to the default value of the tag,
+     *      which is shared by all such entities.  It must not be written
+     *      through; use tag_set_data or tag_iterate instead.
+     *      A pointer to the value of a fixed-length sparse tag remains 
+     *      valid until the value of that entity is deleted or all values
+     *      of the tag are removed.
+     *      Values of variable-length tags, dense or sparse, are stored in
+     *      shared blocks that are compacted once most of their space is
+     *      unused, so setting or deleting the value of any entity for such
+     *      a tag may move the values of others and invalidate pointers to
+     *      them.
      */
   virtual ErrorCode  tag_get_by_ptr(const Tag tag_handle, 
                                   const EntityHandle* entity_handles, 
@@ -1454,6 +1493,8 @@ public:
      *                      tag value corresponding to each entity handle.
      *\param tag_sizes      The length of each tag value.  Optional for 
      *                      fixed-length tags.  Required for variable-length tags.
+     *
+     *\Note See the previous function for the lifetime of the pointers.
      */
   virtual ErrorCode  tag_get_by_ptr(const Tag tag_handle, 
                                     const Range& entity_handles, 
@@ -1497,6 +1538,58 @@ public:
                                     void const* const* tag_data,
                                     const int* tag_sizes = 0 ) = 0;
 
+    /**\brief Set tag data from a packed array of values
+     *
+     * Set values for a list of entities from a single buffer containing
+     * the concatenation of all values.  The value for the i-th entity
+     * begins at <code>offsets[i]</code> and ends before
+     * <code>offsets[i+1]</code>.  This is intended for filling 
+     * variable-length tags for many entities in one pass.  For
+     * fixed-length tags all values must have the tag length.
+     *\note  This function may not be used for bit tags.
+     *\param tag_handle     The tag
+     *\param entity_handles An array of entity handles for which to set tag values.
+     *\param num_entities   The length of the 'entity_handles' array.
+     *\param tag_data       Concatenated tag values.
+     *\param offsets        Array of length 'num_entities'+1 containing 
+     *                      the position of each value in 'tag_data',
+     *                      in units of the tag data type, followed by 
+     *                      the end of the last value.  Offsets must be
+     *                      non-negative and non-decreasing, so that the
+     *                      values lie within the first 'offsets[num_entities]'
+     *                      units of 'tag_data'; otherwise nothing is set
+     *                      and MB_INDEX_OUT_OF_RANGE is returned.
+     */
+  virtual ErrorCode  tag_set_packed_data( Tag tag_handle, 
+                                          const EntityHandle* entity_handles, 
+                                          int num_entities,
+                                          const void* tag_data,
+                                          const int* offsets ) = 0;
+
+    /**\brief Set tag data from a packed array of values
+     *
+     * Set values for a list of entities from a single buffer containing
+     * the concatenation of all values.  The value for the i-th entity
+     * begins at <code>offsets[i]</code> and ends before
+     * <code>offsets[i+1]</code>.  This is intended for filling 
+     * variable-length tags for many entities in one pass.  For
+     * fixed-length tags all values must have the tag length.
+     *\note  This function may not be used for bit tags.
+     *\param tag_handle     The tag
+     *\param entity_handles The entity handles for which to set tag values.
+     *\param tag_data       Concatenated tag values.
+     *\param offsets        Array of length 'entity_handles.size()'+1 
+     *                      containing the position of each value in 
+     *                      'tag_data', in units of the tag data type,
+     *                      followed by the end of the last value.
+     *                      Offsets must be non-negative and non-decreasing,
+     *                      as for the array version.
+     */
+  virtual ErrorCode  tag_set_packed_data( Tag tag_handle, 
+                                          const Range& entity_handles,
+                                          const void* tag_data,
+                                          const int* offsets ) = 0;
+
     /**\brief Set tag data given value.
      *
      * For a tag, set the values for a list of passed entity handles to
@@ -1575,6 +1668,14 @@ public:
    *      even though MOAB would normally not explicitly store tag values
    *      for such entities.
    *
+   *\Note For sparse tags, the returned pointer remains valid until the
+   *      tag value of the entity is deleted.
+   *
+   *\Note Dense tag storage is allocated in blocks aligned to and padded
+   *      to a multiple of MB_ARRAY_ALIGNMENT bytes.  The returned pointer
+   *      is aligned only if \c iter is the first entity of such a block, 
+   *      so vectorized loops should test the alignment of the pointer.
+   *
    *\Example:
    *\code
    * Range ents; // range to iterate over
@@ -1610,6 +1711,42 @@ public:
      */
   virtual ErrorCode  tag_delete(Tag tag_handle) = 0;
 
+    /**\brief Maintain an index of entities by tag value
+     *
+     * Enable or disable an index from values of a tag to the entities
+     * having each value.  When enabled, get_entities_by_type_and_tag
+     * uses the index to find entities with a specific (non-default)
+     * tag value rather than comparing the value for every tagged 
+     * entity.  The index is built when it is enabled and is 
+     * updated incrementally as tag values are set, cleared, or
+     * deleted; queries never modify it.  Because values may be written
+     * through the pointers it returns, tag_iterate (outside of a
+     * read-only phase) marks the index as out of date, after which
+     * queries ignore it until it is rebuilt by calling this function 
+     * again with \c enable == true.
+     *
+     * This is intended for tags such as MATERIAL_SET or GLOBAL_ID
+     * that are frequently queried by value.  It makes changes to
+     * tag values more expensive.
+     *
+     *\param tag_handle  A fixed-length sparse or dense tag
+     *\param enable      Create the index if true, destroy it if false.
+     *\return MB_TYPE_OUT_OF_RANGE if enabling the index for a 
+     *        variable-length tag, a bit or mesh tag, or a tag with
+     *        values larger than 24 bytes.
+     */
+  virtual ErrorCode tag_set_value_index( Tag tag_handle, bool enable = true ) = 0;
+
+    /**\brief Get counter of memory allocated for values of a tag
+     *
+     * Get the live count of bytes and allocations used to store
+     * values of the tag, which is also included in the global
+     * MEM_TAGS counter (see MemoryCounter.)  The counter remains valid
+     * until the tag is deleted.
+     */
+  virtual ErrorCode tag_get_memory_counter( Tag tag_handle, 
+                                            const MemoryCounter*& counter_out ) = 0;
+
     /**@}*/
 
     /** \name Sets */
@@ -1981,6 +2118,45 @@ public:
                                         SetIterator *&set_iter) = 0;
     /**@}*/
 
+    /** \name Concurrent access */
+
+    /**@{*/
+
+    /**\brief Begin a phase in which the database may be queried from multiple threads
+     *
+     * MOAB is not generally thread-safe: even query functions update
+     * internal caches.  Between a call to begin_read_only_phase and the
+     * corresponding call to end_read_only_phase, the query functions below
+     * do not modify any shared state and may be called concurrently from
+     * multiple threads:
+     * type_from_handle, id_from_handle, dimension_from_handle, get_coords,
+     * coords_iterate, get_connectivity, connect_iterate, get_adjacencies 
+     * (with create_if_missing == false), get_entities_by_*,
+     * get_number_entities_by_*, get_parent_meshsets, get_child_meshsets,
+     * contains_entities, tag_get_data, tag_get_by_ptr, and tag_iterate 
+     * (with allocate == false).
+     *
+     * The application must not modify the mesh, entity sets, or tag 
+     * values while in the read-only phase.  Error messages are not recorded 
+     * (see get_last_error) during the read-only phase.
+     *
+     *\param create_vert_elem_adjacencies If true, create vertex-to-element
+     *                 adjacencies before entering the read-only phase if 
+     *                 they do not already exist.  Otherwise get_adjacencies
+     *                 will fail during the read-only phase for any query
+     *                 other than element-to-vertex unless the adjacencies 
+     *                 have already been created.
+     */
+  virtual ErrorCode begin_read_only_phase( bool create_vert_elem_adjacencies = true ) = 0;
+
+    //! End a read-only phase, allowing modification of the database.
+  virtual ErrorCode end_read_only_phase() = 0;
+
+    //! Test if database is in a read-only phase.
+  virtual bool is_read_only_phase() const = 0;
+
+    /**@}*/
+
 };
 
 //! predicate for STL algorithms.  Returns true if the entity handle is
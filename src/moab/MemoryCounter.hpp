@@ -0,0 +1,117 @@
+#ifndef MOAB_MEMORY_COUNTER_HPP
+#define MOAB_MEMORY_COUNTER_HPP
+
+#include <stddef.h>
+
+namespace moab {
+
+/**\brief Subsystems for which MOAB counts allocated memory */
+enum MemoryCategory {
+  MEM_SEQUENCES = 0,   //!< vertex coordinates and other per-sequence arrays
+  MEM_CONNECTIVITY,    //!< element connectivity arrays
+  MEM_ADJACENCIES,     //!< adjacency lists and their per-sequence arrays
+  MEM_TAGS,            //!< tag values (sum of counters for all tags)
+  MEM_SETS,            //!< entity set contents, parent and child lists
+  MEM_RANGES,          //!< storage for Range objects, if Range::count_memory(true) (off by default)
+  MEM_NUM_CATEGORIES
+};
+
+/**\class MemoryCounter
+ * \brief Live count of memory allocated by MOAB for one purpose
+ *
+ * MOAB updates a counter at each allocation and release of the bulk
+ * storage for each subsystem listed in MemoryCategory, and for the
+ * values of each tag, such that the current number of bytes and of
+ * allocations, as well as the largest number of bytes allocated at any
+ * time, can be queried cheaply at any point.  Counts are of the sizes
+ * requested, not including any overhead of the heap itself.
+ *
+ * Counters for each category are global to the process, not per
+ * MOAB instance, because some storage (e.g. Range) has no
+ * association with an instance.  Counters for tags are per-tag
+ * (see Interface::tag_get_memory_counter) and are also accumulated
+ * in the MEM_TAGS category.
+ *
+ * Counters are updated atomically when MOAB is built with thread
+ * support.  Range storage is allocated and freed so often, including
+ * by temporaries in concurrent queries, that MEM_RANGES is only
+ * updated while enabled with Range::count_memory, and so reads zero
+ * by default.  Operations that create or release many blocks at once,
+ * such as building vertex-to-element adjacencies, total their changes
+ * and update the counter once at the end, so peak_bytes() reflects the
+ * state between such operations rather than within them.
+ */
+class MemoryCounter
+{
+public:
+
+    //! Create counter, optionally adding all changes also to \c parent
+  MemoryCounter( MemoryCounter* parent = 0 )
+    : numBytes(0), numAllocs(0), peakBytes(0), parentCounter(parent) {}
+
+    //! Bytes currently allocated
+  size_t bytes() const { return numBytes; }
+    //! Number of blocks currently allocated
+  size_t allocations() const { return numAllocs; }
+    //! Largest value of bytes() since creation or last call to reset_peak()
+  size_t peak_bytes() const { return peakBytes; }
+
+    //! Set peak_bytes() to current bytes()
+  void reset_peak() { peakBytes = numBytes; }
+
+    //! Record allocation of \c count blocks totaling \c bytes
+  void add( size_t bytes, size_t count = 1 );
+    //! Record release of \c count blocks totaling \c bytes
+  void remove( size_t bytes, size_t count = 1 );
+    //! Record change in size of an allocated block
+  void resize( size_t old_bytes, size_t new_bytes )
+    { if (new_bytes > old_bytes) add( new_bytes - old_bytes, 0 );
+      else if (new_bytes < old_bytes) remove( old_bytes - new_bytes, 0 ); }
+
+    //! Global counter for a subsystem
+  static MemoryCounter& category( MemoryCategory cat );
+    //! Name of a subsystem
+  static const char* category_name( MemoryCategory cat );
+    //! Reset peak of all global counters
+  static void reset_all_peaks();
+
+    /**\brief Allocate memory charged to a counter
+     *
+     * Allocate \c bytes with malloc, recording the allocation in
+     * \c counter.  The counter is remembered with the memory such that
+     * it need not be passed to reallocate or deallocate. \c counter
+     * may be null, in which case no counts are kept for the memory.
+     * Each block is preceded by a 16-byte header holding its size and
+     * counter, which is present even if \c counter is null and is not
+     * included in the count.
+     */
+  static void* allocate( size_t bytes, MemoryCounter* counter );
+    /**\brief Allocate aligned, padded memory charged to a counter
+     *
+     * As allocate(), except that the returned memory begins at an
+     * address that is a multiple of MB_ARRAY_ALIGNMENT and \c bytes 
+     * is rounded up to a multiple of MB_ARRAY_ALIGNMENT, with the
+     * padding zeroed.  The counter is charged for the padded size.
+     * The memory may be passed to reallocate, deallocate, and owner
+     * as for memory from allocate().
+     */
+  static void* allocate_aligned( size_t bytes, MemoryCounter* counter );
+    //! Resize memory from allocate() or allocate_aligned(), updating its counter
+  static void* reallocate( void* ptr, size_t bytes );
+    //! Free memory from allocate() or allocate_aligned(), updating its counter
+  static void deallocate( void* ptr );
+    //! Get counter that memory from allocate() or allocate_aligned() is charged to
+  static MemoryCounter* owner( const void* ptr );
+
+private:
+
+  MemoryCounter( const MemoryCounter& );
+  MemoryCounter& operator=( const MemoryCounter& );
+
+  size_t numBytes, numAllocs, peakBytes;
+  MemoryCounter* parentCounter;
+};
+
+} // namespace moab
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef MOAB_MESH_BUILDER_HPP
+#define MOAB_MESH_BUILDER_HPP
+
+#include "moab/Types.hpp"
+#include <vector>
+#include <stddef.h>
+
+namespace moab {
+
+class Core;
+class Interface;
+class Range;
+class ReadUtilIface;
+class ThreadPool;
+
+/**\class MeshBuilder
+ * \brief Bulk creation of vertices and elements
+ *
+ * Create blocks of vertices or elements with contiguous handles,
+ * and fill in their coordinates or connectivity directly in the
+ * arrays in which MOAB stores them, rather than creating each entity
+ * with Interface::create_vertex or Interface::create_element.
+ *
+ * The arrays may be written from any number of threads, as filling
+ * them does not modify any other state of the MOAB instance.
+ * parallel_fill is provided as a convenience for doing so.  Once
+ * all arrays are filled, commit() updates adjacency information for
+ * all new elements in one pass.  Until then, the connectivity of the
+ * new elements is not valid and the elements should not be queried
+ * or modified through the Interface.  Entities not yet committed when
+ * the builder is destroyed are committed by the destructor.
+ * MeshBuilder requires that the Interface is a Core instance.
+ *
+ *\code
+ * MeshBuilder builder( mb );
+ * double *x, *y, *z;
+ * EntityHandle first_vtx, first_hex, *conn;
+ * builder.add_vertices( num_verts, first_vtx, x, y, z );
+ * builder.add_elements( MBHEX, num_hexes, 8, first_hex, conn );
+ * ... fill x, y, z, and conn ...
+ * builder.commit();
+ *\endcode
+ */
+class MeshBuilder
+{
+public:
+
+  MeshBuilder( Interface* moab );
+
+    //! Commit any remaining new entities
+  ~MeshBuilder();
+
+    /**\brief Create a block of vertices
+     *
+     * Create \c count vertices with consecutive handles and pass back
+     * the arrays in which their coordinates are to be stored.
+     *\param count  Number of vertices to create
+     *\param start  Output: handle of first vertex
+     *\param x      Output: X coordinate for each vertex, in handle order
+     *\param y      Output: Y coordinate for each vertex, in handle order
+     *\param z      Output: Z coordinate for each vertex, in handle order
+     *\return MB_TYPE_OUT_OF_RANGE if new vertices are to be stored in 
+     *        single precision (see Core::set_float_coordinates).
+     */
+  ErrorCode add_vertices( int count,
+                          EntityHandle& start,
+                          double*& x, double*& y, double*& z );
+
+    /**\brief Create a block of vertices with single precision coordinates
+     *
+     * As above, except that the vertices store their coordinates as float,
+     * regardless of Core::float_coordinates.
+     */
+  ErrorCode add_vertices( int count,
+                          EntityHandle& start,
+                          float*& x, float*& y, float*& z );
+
+    /**\brief Create a block of elements
+     *
+     * Create \c count elements with consecutive handles and pass back
+     * the array in which their connectivity is to be stored, with
+     * \c verts_per_elem vertex handles for each element, in handle
+     * order.
+     *\param type           Type of elements to create
+     *\param count          Number of elements to create
+     *\param verts_per_elem Number of vertices in each element
+     *\param start          Output: handle of first element
+     *\param conn           Output: connectivity array for elements
+     */
+  ErrorCode add_elements( EntityType type,
+                          int count,
+                          int verts_per_elem,
+                          EntityHandle& start,
+                          EntityHandle*& conn );
+
+    /**\brief Finish creation of all entities added since the last commit
+     *
+     * Update adjacency information for new elements, after their
+     * connectivity has been filled in.
+     *\param created If not null, all entities committed are
+     *               inserted into this range.
+     *\return MB_ENTITY_NOT_FOUND if the connectivity of some element was
+     *        not filled in (contains a zero handle), or the error from
+     *        updating the adjacencies of some vertex.  The entities are
+     *        committed regardless; it is up to the caller to delete them.
+     */
+  ErrorCode commit( Range* created = 0 );
+
+    //! Work done by parallel_fill
+  class FillTask
+  {
+  public:
+    virtual ~FillTask() {}
+      //! Fill values for items \c first through <code>first+count-1</code>
+    virtual ErrorCode fill( size_t first, size_t count ) = 0;
+  };
+
+    /**\brief Call task.fill concurrently for chunks of \c count items
+     *
+     * The worker threads are created by the first call and kept
+     * for later calls that ask for the same number of threads, until
+     * the builder is destroyed.
+     *\param task        Work to do for each chunk of items
+     *\param count       Total number of items
+     *\param num_threads Number of threads to use, or zero for the
+     *                   value of the MOAB_NUM_THREADS environment variable
+     *                   if set, otherwise the number of processors.
+     *\return MB_SUCCESS or the error returned for the first failed chunk
+     */
+  ErrorCode parallel_fill( FillTask& task, size_t count, unsigned num_threads = 0 );
+
+private:
+
+  MeshBuilder( const MeshBuilder& );
+  MeshBuilder& operator=( const MeshBuilder& );
+
+    //! A block of entities that has not been committed
+  struct Block {
+    EntityHandle start;
+    int count;
+    int verts_per_elem;   //!< zero for vertices
+    EntityHandle* conn;
+  };
+
+  Core* mbImpl;
+  ReadUtilIface* readUtil;
+  std::vector<Block> pendingBlocks;
+  ThreadPool* threadPool;   //!< created by first parallel_fill
+  unsigned poolThreads;     //!< number of threads requested for threadPool
+};
+
+} // namespace moab
+
+#endif
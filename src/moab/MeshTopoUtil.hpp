@@ -37,6 +37,23 @@ public:
     //! generate all the AEntities bounding the vertices
   ErrorCode construct_aentities(const Range &vertices);
 
+    //! create all the sides of dimension dim (1 or 2) of the elements in one bulk pass;
+    //! sides are matched by hashing their sorted corner vertices, existing sides are 
+    //! reused, and new sides are allocated contiguously for each type, much faster than
+    //! creating them element by element with get_adjacencies; sides of polygons and 
+    //! polyhedra are created individually
+    /** \param elements Elements whose sides are created; those of dimension <= dim are ignored
+        \param dim Dimension of sides to create
+        \param new_sides Sides created by this call are inserted here
+        \param record_adjacencies If true, also add explicit adjacencies between each element 
+                       and its sides
+        \param num_threads Threads used to generate the sides, or zero for the default
+    */
+  ErrorCode construct_sides(const Range &elements, const int dim,
+                            Range &new_sides,
+                            const bool record_adjacencies = false,
+                            const unsigned num_threads = 0);
+
     //! given an entity, get its average position (avg vertex locations)
   ErrorCode get_average_position(Range &entities,
                                    double *avg_position);
@@ -0,0 +1,158 @@
+#ifndef MOAB_PARALLEL_FOR_HPP
+#define MOAB_PARALLEL_FOR_HPP
+
+#include "moab/Types.hpp"
+#include <vector>
+#include <stddef.h>
+
+namespace moab {
+
+class Interface;
+class Range;
+
+/**\class EntityChunk
+ * \brief A chunk of entities passed to ChunkTask::execute
+ *
+ * Entities with consecutive handles for which the requested vertex
+ * coordinates or element connectivity and dense tag values are each
+ * stored contiguously, as returned by ChunkIterator.  The pointers
+ * are to MOAB's internal storage.
+ */
+class EntityChunk
+{
+public:
+
+    //! First entity in chunk
+  EntityHandle start_handle() const { return startHandle; }
+    //! Number of entities in chunk
+  int count() const { return chunkCount; }
+    //! Position of first entity of chunk in range passed to parallel_for
+  size_t index() const { return rangeIndex; }
+
+    //! True if vertex coordinates are stored in single precision, in
+    //! which case they are returned by x_float() etc. and x() etc. are null
+  bool float_coordinates() const { return 0 != floatPtrs[0]; }
+
+    //! Vertex X coordinates
+  double* x() const { return coordPtrs[0]; }
+    //! Vertex Y coordinates
+  double* y() const { return coordPtrs[1]; }
+    //! Vertex Z coordinates
+  double* z() const { return coordPtrs[2]; }
+
+    //! Single-precision vertex X coordinates
+  float* x_float() const { return floatPtrs[0]; }
+    //! Single-precision vertex Y coordinates
+  float* y_float() const { return floatPtrs[1]; }
+    //! Single-precision vertex Z coordinates
+  float* z_float() const { return floatPtrs[2]; }
+
+    //! Element connectivity
+  EntityHandle* connectivity() const { return connPtr; }
+    //! Number of vertices in connectivity of each element
+  int nodes_per_element() const { return nodesPerElem; }
+
+    //! Values of the i-th tag passed to parallel_for
+  void* tag_data( int i ) const { return tagPtrs[i]; }
+
+private:
+
+  friend class ParallelForChunks;
+
+  EntityHandle startHandle;
+  int chunkCount;
+  size_t rangeIndex;
+  double* coordPtrs[3];
+  float* floatPtrs[3];
+  EntityHandle* connPtr;
+  int nodesPerElem;
+  std::vector<void*> tagPtrs;
+};
+
+/**\brief Work done for each chunk by parallel_for */
+class ChunkTask
+{
+public:
+  virtual ~ChunkTask() {}
+
+    /**\brief Process one chunk of entities
+     *
+     * Called concurrently from several threads, each time with a
+     * different chunk.  The task may write the coordinates, connectivity,
+     * and tag values of the entities in the chunk, but must not modify
+     * the MOAB instance in any other way.  It may query the instance
+     * only during a read-only phase (see Core::begin_read_only_phase).
+     */
+  virtual ErrorCode execute( const EntityChunk& chunk ) = 0;
+};
+
+/**\brief Run a task on chunks of entities using several threads
+ *
+ * Split the entities into chunks along the boundaries of MOAB's
+ * internal storage, such that the requested vertex coordinates or element
+ * connectivity and the values of the requested dense tags are each
+ * stored contiguously for every chunk, as for ChunkIterator, and further
+ * into chunks of at most \c max_chunk_size entities.  Then call
+ * task.execute for each chunk from a pool of threads.
+ *
+ * Tag storage is allocated as necessary before any task is run.
+ *
+ *\param mb           MOAB instance
+ *\param entities     Entities to iterate over
+ *\param task         Work to do for each chunk
+ *\param coordinates  Pass vertex coordinates.  If true, all
+ *                    entities must be vertices.
+ *\param connectivity Pass element connectivity.  If true, all
+ *                    entities must be non-polyhedral elements.
+ *\param tags         Dense tags for which to pass values.
+ *\param num_tags     Length of \c tags array
+ *\param num_threads  Number of threads to use, or zero for the value of
+ *                    the MOAB_NUM_THREADS environment variable if set,
+ *                    otherwise the number of processors.
+ *\param max_chunk_size Maximum number of entities in a chunk, or zero
+ *                    for a default.
+ *\return MB_TYPE_OUT_OF_RANGE if a tag is not a dense, fixed-length
+ *        tag, an error from the *_iterate methods, or the error
+ *        returned by the task for the first failed chunk.
+ */
+ErrorCode parallel_for( Interface* mb,
+                        const Range& entities,
+                        ChunkTask& task,
+                        bool coordinates,
+                        bool connectivity,
+                        const Tag* tags = 0,
+                        int num_tags = 0,
+                        unsigned num_threads = 0,
+                        int max_chunk_size = 0 );
+
+/**\brief Run a task on chunks of all entities of a type using several threads
+ *
+ * As above, for all entities of type \c type in the instance.
+ */
+ErrorCode parallel_for( Interface* mb,
+                        EntityType type,
+                        ChunkTask& task,
+                        bool coordinates,
+                        bool connectivity,
+                        const Tag* tags = 0,
+                        int num_tags = 0,
+                        unsigned num_threads = 0,
+                        int max_chunk_size = 0 );
+
+/**\brief Run a task on chunks of all entities of a dimension using several threads
+ *
+ * As above, for all entities of dimension \c dimension in the instance.
+ */
+ErrorCode parallel_for( Interface* mb,
+                        int dimension,
+                        ChunkTask& task,
+                        bool coordinates,
+                        bool connectivity,
+                        const Tag* tags = 0,
+                        int num_tags = 0,
+                        unsigned num_threads = 0,
+                        int max_chunk_size = 0 );
+
+} // namespace moab
+
+#endif
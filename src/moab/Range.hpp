@@ -32,19 +32,22 @@
      STL container has.
  3.  Strengths:
      a. For contiguous values, storage is extremely minimal.
-     b. Searching through contiguous values, at best, is
-        a constant time operation.
+     b. Searching for a value is a logarithmic time operation
+        in the number of contiguous blocks.
      b. Fairly compatible with most STL algorithms.
-     c. Insertions of data from high value to low value
+     c. Insertions of data in increasing or decreasing order
         is a linear operation (constant for each insertion).
-     d. Removal of a value using an iterator is constant time.
+     d. size(), psize() and the difference of two iterators are
+        constant time, operator[] and index() are logarithmic.
 
  4.  Weaknesses:
      a. For non-contiguous values, storage is not minimal and is
-        on the order of 4x the storage space as using a vector.
-     b. Searching through non-contiguous values is linear
-        time operation.
-     c. Insertions of random data is VERY slow.
+        on the order of 3x the storage space as using a vector.
+     b. Insertions of random data is slow.
+     c. The blocks are stored in a single array, so inserting or
+        removing a block in the middle of a range is linear in the
+        number of blocks, and any insertion or removal may invalidate
+        all iterators other than the one returned by the operation.
 
    Given the above characteristics of Ranges, you can now
    decide between Range and another STL container for your
@@ -80,9 +83,11 @@
  2.  Prefer insert(val1, val2) over insert(val) where possible.
  
  3.  insert(val) and insert(val1, val2) have to perform searching
-     to find out where to insert an item.  Searches are started
-     from the beginning of the values.  Inserting larger values 
-     before smaller values will increase efficiency.
+     to find out where to insert an item.  If the hint passed to
+     insert is at or just before the insertion point the search
+     is skipped, so pass the iterator returned by the previous
+     insertion when inserting values in increasing order.  Inserting
+     at either end of the range is cheaper than in the middle.
 
      ie.
      std::set<int> my_set;
@@ -115,6 +120,9 @@
        results.swap(tmp_results);
      }
 
+ 6.  Do not keep iterators across an insert or erase; any iterator
+     other than the one returned may be invalidated (see weakness c.)
+
 
    ******* FAQ *******
  1. Why won't this code compile?
@@ -196,6 +204,7 @@ public:
  
   friend Range intersect( const Range&, const Range& );
   friend Range subtract( const Range&, const Range& );
+  friend Range unite( const Range&, const Range& );
 
     //! just like subtract, but as an operator
   Range &operator-=(const Range &rhs);
@@ -232,15 +241,24 @@ public:
   inline const_reverse_iterator rend() const;
 
   //! return the number of values this Ranges represents
-  size_t size() const;
+  inline size_t size() const;
 
   //! return the number of range pairs in the list
-  size_t psize() const;
+  inline size_t psize() const;
   
   //! return whether empty or not 
   //! always use "if(!Ranges::empty())" instead of "if(Ranges::size())"
   inline bool empty() const;
 
+  /* Any insert or erase may move the blocks of this range in memory,
+   * invalidating all iterators into it (including pair iterators and
+   * saved end() iterators) other than the one returned.  To modify a
+   * range while iterating over it, continue from the returned iterator,
+   * e.g. "i = range.erase( i );", and compare with end() afresh.
+   */
+
+  //! insert an item into the list, starting the search for its position
+  //! at hint, and return the iterator for the inserted item
   iterator insert( iterator hint, EntityHandle val );
 
   //! insert an item into the list and return the iterator for the inserted item
@@ -256,6 +274,9 @@ public:
   iterator insert(EntityHandle val1, EntityHandle val2)
     { return insert( begin(), val1, val2 ); }
     
+  //! insert a list of handles in any order and return an iterator
+  //! for the first handle in the last run of consecutive handles in
+  //! the sorted list, or begin() if the list is empty.
   template <typename T> 
   iterator insert_list( T begin_iter, T end_iter );
     
@@ -266,11 +287,25 @@ public:
   template <typename T> 
   iterator insert( const T* begin_iter, const T* end_iter )
     { return insert_list( begin_iter, end_iter ); }
+
+  //! insert a list of handles sorted in increasing order and return
+  //! an iterator for the first inserted item.  Duplicate and zero 
+  //! values are skipped.  Linear in the length of the list plus the
+  //! number of pairs in this range.
+  iterator insert_sorted_list( const EntityHandle* begin_iter, 
+                               const EntityHandle* end_iter );
+
+  //! insert a list of {first,last} handle pairs, sorted by the first
+  //! handle in each pair, and return an iterator for the first inserted
+  //! item.  Pairs may overlap or be adjacent.  Linear in the number of 
+  //! pairs in the list plus the number of pairs in this range.
+  iterator insert_sorted_pairs( const EntityHandle* pairs, size_t num_pairs );
   
     //! remove an item from this list and return an iterator to the next item
   iterator erase(iterator iter);
 
-  //! remove a range of items from the list
+  //! remove a range of items from the list and return an iterator to
+  //! the item after them.  Removing nothing modifies nothing.
   iterator erase( iterator iter1, iterator iter2);
 
   //! erases a value from this container
@@ -353,17 +388,32 @@ public:
   
     //! return a subset of this range, by dimension
   Range subset_by_dimension(int dim) const;
+
+    /**\brief Enable or disable counting of Range storage in MEM_RANGES
+     *
+     * Off by default, so that threads building ranges concurrently do
+     * not contend on the shared counter.  Storage allocated while
+     * counting is enabled is uncounted when released regardless of the
+     * setting at that time.  Change the setting only while no other
+     * thread is using Range.  Storage is obtained from
+     * MemoryCounter::allocate whether or not it is counted, so each
+     * buffer carries that function's 16-byte header.
+     */
+  static void count_memory( bool enable );
+    //! Whether Range storage is currently counted in MEM_RANGES
+  static bool counting_memory();
   
   struct PairNode : public std::pair<EntityHandle,EntityHandle>
   {
 
-    PairNode() : std::pair<EntityHandle,EntityHandle>(0, 0), mNext(NULL), mPrev(NULL) {}
-    PairNode(PairNode* next, PairNode* prev, 
-             EntityHandle _first, EntityHandle _second)
-      : std::pair<EntityHandle,EntityHandle>(_first,_second), mNext(next), mPrev(prev) {}
+    PairNode() : std::pair<EntityHandle,EntityHandle>(0, 0), mCount(0) {}
+    PairNode(EntityHandle _first, EntityHandle _second)
+      : std::pair<EntityHandle,EntityHandle>(_first,_second), mCount(0) {}
 
-    PairNode* mNext;
-    PairNode* mPrev;
+      //! Running count of handles in the pairs preceding this one.
+      //! Only differences between the counts of two pairs in the
+      //! same Range are meaningful.
+    EntityHandle mCount;
   };
 
   
@@ -373,12 +423,59 @@ public:
   
 protected:
 
-  //! the head of the list that contains pairs that represent the ranges 
-  //! this list is sorted and unique at all times
-  PairNode mHead;
-  
-  //! if dead_node is not mHead, remove it from the list and free it's memory.
-  void delete_pair_node( PairNode* dead_node );
+  //! the pairs that represent the ranges, stored contiguously.  This
+  //! list is sorted and unique at all times.  mFirst[-1] and *mLast
+  //! are (0,0) sentinel pairs marking rend() and end().
+  PairNode* mFirst;
+  PairNode* mLast;
+  //! the allocated storage containing the pairs and sentinels, or
+  //! NULL if nothing has been allocated.  There may be unused
+  //! space at either end of the buffer.
+  PairNode* mBuffer;
+  PairNode* mBufferEnd;
+
+  //! sentinels shared by all ranges that have no storage allocated
+  static PairNode emptySentinels[2];
+
+  //! whether newly allocated storage is charged to MEM_RANGES
+  static bool countMemory;
+
+  //! Open a gap of 'count' uninitialized pairs before 'pos', growing
+  //! the storage if necessary.  Returns the start of the gap.
+  PairNode* make_gap( PairNode* pos, size_t count );
+
+  //! Remove 'count' pairs beginning at 'pos'.  Returns the new
+  //! location of the pair that followed the removed ones.
+  PairNode* remove_pairs( PairNode* pos, size_t count );
+
+  //! Update the running counts after the pairs in [begin,end) were
+  //! changed.  Pairs outside that span must not have been resized.
+  void update_counts( PairNode* begin, PairNode* end );
+
+  //! Discard contents and allocate storage for at least 'count' pairs.
+  void reset_storage( size_t count );
+
+  //! Allocate and free storage for pairs, counted in MEM_RANGES
+  //! if count_memory(true) was in effect at allocation.
+  static PairNode* allocate_buffer( size_t count );
+  static void free_buffer( PairNode* buffer, PairNode* buffer_end );
+
+  //! Get the first pair with second >= val, or mLast if none.
+  PairNode* find_pair( EntityHandle val ) const;
+
+  //! Append [first,second] to the range, merging it with the last pair
+  //! if they overlap.  'first' must not be less than the start of the
+  //! last pair.
+  void append_pair( EntityHandle first, EntityHandle second );
+
+  //! Append a sequence of pairs from another range, subject to the 
+  //! same requirement as append_pair.
+  void append_pairs( const PairNode* begin, const PairNode* end );
+
+  //! Merge a sequence of pairs, sorted by their first value, into 
+  //! this range in a single pass.  PairSource is one of the readers 
+  //! defined in Range.cpp.
+  template <class PairSource> void merge_sorted( PairSource source );
 
 public:
 
@@ -398,7 +495,7 @@ public:
     
     pair_iterator& operator++()
     {
-      mNode = mNode->mNext;
+      ++mNode;
       return *this;
     }
     pair_iterator operator++(int)
@@ -410,7 +507,7 @@ public:
 
     pair_iterator& operator--()
     {
-      mNode = mNode->mPrev;
+      --mNode;
       return *this;
     }
     pair_iterator operator--(int)
@@ -463,7 +560,7 @@ public:
       // see if we need to increment the base iterator
       if(mValue == mNode->second)
       {
-        mNode = mNode->mNext;
+        ++mNode;
         mValue = mNode->first;
       }
       // if not, just increment the value in the range
@@ -489,7 +586,7 @@ public:
       // see if we need to decrement the base iterator
       if(mValue == mNode->first)
       {
-        mNode = mNode->mPrev;;
+        --mNode;
         mValue = mNode->second;
       }
       // if not, just decrement the value
@@ -668,10 +765,10 @@ public:
         { return myNode; }
       
       const_pair_iterator& operator--()
-        { myNode = myNode->mPrev; return *this; }
+        { --myNode; return *this; }
       
       const_pair_iterator& operator++()
-        { myNode = myNode->mNext; return *this; }
+        { ++myNode; return *this; }
       
       const_pair_iterator operator--(int)
         { const_pair_iterator rval(*this); this->operator--(); return rval; }
@@ -689,13 +786,13 @@ public:
       const PairNode* myNode;
   };
   
-  pair_iterator pair_begin() { return pair_iterator(mHead.mNext); }
-  pair_iterator pair_end() { return pair_iterator(&mHead); }
+  pair_iterator pair_begin() { return pair_iterator(mFirst); }
+  pair_iterator pair_end() { return pair_iterator(mLast); }
 
-  const_pair_iterator const_pair_begin() const { return const_pair_iterator( mHead.mNext ); }
-  const_pair_iterator const_pair_end() const { return const_pair_iterator( &mHead ); }
-  const_pair_iterator pair_begin() const { return const_pair_iterator( mHead.mNext ); }
-  const_pair_iterator pair_end() const { return const_pair_iterator( &mHead ); }
+  const_pair_iterator const_pair_begin() const { return const_pair_iterator( mFirst ); }
+  const_pair_iterator const_pair_end() const { return const_pair_iterator( mLast ); }
+  const_pair_iterator pair_begin() const { return const_pair_iterator( mFirst ); }
+  const_pair_iterator pair_end() const { return const_pair_iterator( mLast ); }
 
 };
 
@@ -707,8 +804,7 @@ Range intersect( const Range&, const Range& );
 Range subtract( const Range& from, const Range& );
 
     //! unite two ranges, placing the results in the return range
-inline Range unite( const Range& r1, const Range& r2 )
-  { Range r(r1); r.insert(r2.begin(), r2.end()); return r; }
+Range unite( const Range&, const Range& );
 
 
 inline Range::const_iterator 
@@ -764,11 +860,9 @@ public:
 
 
 inline Range::Range()
-{
-    // set the head node to point to itself
-  mHead.mNext = mHead.mPrev = &mHead;
-  mHead.first = mHead.second = 0;
-}
+  : mFirst(emptySentinels+1), mLast(emptySentinels+1),
+    mBuffer(0), mBufferEnd(0)
+{}
   
   //! destructor
 inline Range::~Range()
@@ -779,32 +873,32 @@ inline Range::~Range()
   //! return the beginning const iterator of this range
 inline Range::const_iterator Range::begin() const
 {
-  return const_iterator(mHead.mNext, mHead.mNext->first);
+  return const_iterator(mFirst, mFirst->first);
 }
   
   //! return the beginning const reverse iterator of this range
 inline Range::const_reverse_iterator Range::rbegin() const
 {
-  return const_reverse_iterator(mHead.mPrev, mHead.mPrev->second);
+  return const_reverse_iterator(mLast-1, mLast[-1].second);
 }
  
   //! return the ending const iterator for this range
 inline Range::const_iterator Range::end() const
 {
-  return const_iterator(&mHead, mHead.first);
+  return const_iterator(mLast, mLast->first);
 }
   
   //! return the ending const reverse iterator for this range
 inline Range::const_reverse_iterator Range::rend() const
 {
-  return const_reverse_iterator(&mHead, mHead.second);
+  return const_reverse_iterator(mFirst-1, mFirst[-1].second);
 }
 
   //! return whether empty or not 
   //! always use "if(!Ranges::empty())" instead of "if(Ranges::size())"
 inline bool Range::empty() const
 {
-  return (mHead.mNext == &mHead);
+  return (mFirst == mLast);
 }
 
   //! erases a value from this container
@@ -821,10 +915,10 @@ inline Range::const_iterator Range::const_iterator::start_of_block() const
 
   //! get first entity in range
 inline const EntityHandle& Range::front() const
-  { return mHead.mNext->first; }
+  { return mFirst->first; }
   //! get last entity in range
 inline const EntityHandle& Range::back() const
-  { return mHead.mPrev->second; }
+  { return mLast[-1].second; }
 
 inline std::ostream& operator<<( std::ostream& s, const Range& r )
   { r.print(s); return s; }
@@ -833,28 +927,6 @@ bool operator==( const Range& r1, const Range& r2 );
 inline bool operator!=( const Range& r1, const Range& r2 )
   { return !(r1 == r2); }
 
-inline EntityHandle Range::operator[](EntityID indexp) const
-{
-  Range::const_iterator i = begin();
-  i += indexp;
-  return *i;
-}
-
-inline int Range::index(EntityHandle handle) const 
-{
-  if (handle < *begin() || handle > *rbegin()) return -1;
-  
-  unsigned int i = 0;
-  Range::const_pair_iterator pit = const_pair_begin(); 
-  while (handle > (*pit).second && pit != const_pair_end()) {
-    i += (*pit).second - (*pit).first + 1;
-    pit++;
-  }
-  if (handle < (*pit).first || pit == const_pair_end()) return -1;
-  
-  return i + handle - (*pit).first;
-}
-
 inline double Range::compactness() const 
 {
   unsigned int num_ents = size();
@@ -868,27 +940,28 @@ Range::iterator Range::insert_list( Iterator begin_iter, Iterator end_iter )
   EntityHandle* sorted = new EntityHandle[n];
   std::copy( begin_iter, end_iter, sorted );
   std::sort( sorted, sorted + n );
-  iterator hint = begin();
-  size_t i = 0;
-  while (i < n) {
-    size_t j = i + 1;
-    while (j < n && sorted[j] == 1+sorted[j-1])
-      ++j;
-    hint = insert( hint, sorted[i], sorted[i] + ((j - i) - 1) );
-    i = j;
+  iterator result = begin();
+  if (n) {
+    insert_sorted_list( sorted, sorted + n );
+      // return the start of the last run of consecutive handles,
+      // as inserting the runs one at a time would
+    size_t last = n - 1;
+    while (last && sorted[last] == 1 + sorted[last-1])
+      --last;
+    result = sorted[last] ? find( sorted[last] ) : end();
   }
   delete [] sorted;
-  return hint;
+  return result;
 }
 
-inline size_t Range::psize() const 
+inline size_t Range::size() const
 {
-  size_t i = 0;
-  Range::const_pair_iterator pit;
-  for (pit = const_pair_begin(), i = 0; 
-       pit != const_pair_end(); pit++, i++);
+  return mLast->mCount - mFirst->mCount;
+}
 
-  return i;
+inline size_t Range::psize() const 
+{
+  return mLast - mFirst;
 }
 
 } // namespace moab 
@@ -58,6 +58,17 @@ public:
     const int sequence_size = -1
     ) = 0;
 
+    //! As above, but create vertices with coordinates stored in 
+    //! single precision and return pointers to the float arrays.
+  virtual ErrorCode get_node_coords(
+    const int num_arrays,
+    const int num_nodes, 
+    const int preferred_start_id,
+    EntityHandle& actual_start_handle, 
+    std::vector<float*>& arrays,
+    const int sequence_size = -1
+    ) = 0;
+
     //! Given requested number of elements, element type, and number of
     //! elements, returns pointer to memory space allocated to store connectivity
     //! of those elements; allows direct read of connectivity data into memory
@@ -8,6 +8,7 @@
 
 #include "moab/Types.hpp"
 #include <vector>
+#include <utility>
 
 namespace moab {
 
@@ -101,6 +102,56 @@ class ReorderTool
     ErrorCode handle_order_from_sets_and_adj( const Range& sets,
                                               Tag& new_handle_tag_out );
     
+    //! Space-filling curves for handle_order_from_curve
+    enum CurveType {
+      MORTON_CURVE,  //!< Morton (Z-order) curve: interleaved coordinate bits
+      HILBERT_CURVE  //!< Hilbert curve: better locality, slightly more costly
+    };
+    
+    /**\brief Calculate new handle order by spatial locality
+     *
+     * Calculate new order for vertices and elements such that entities
+     * of each type and connectivity length are ordered by the position
+     * of each vertex or element centroid along a space-filling curve
+     * through the bounding box of the mesh.  Entities that are close
+     * in space will then tend to be close in the handle space, and 
+     * thus in memory.  Entities in structured mesh are not re-ordered.
+     *
+     *\param curve         Space-filling curve to order by
+     *\param new_handle_tag_out  Passed back new tag handle containing the 
+     *                     entity mapping.  The returned tag will be anonymous.
+     *                     The caller is responsible for releasing the tag.  
+     *                     The value of this tag on each handle is the new 
+     *                     handle that the entity will will be moved to. The 
+     *                     tag value will be zero for entities that were not 
+     *                     re-ordered.
+     */
+    ErrorCode handle_order_from_curve( CurveType curve,
+                                       Tag& new_handle_tag_out );
+
+    /**\brief Calculate new handle order to reduce bandwidth
+     *
+     * Calculate new order for vertices and elements by the reverse
+     * Cuthill-McKee algorithm, such that the bandwidth of the adjacency
+     * graph is small when entities are numbered in handle order.  In the
+     * graph for vertices, two vertices are adjacent if they are connected
+     * by an element of the largest dimension in the mesh.  In the graph for
+     * elements of each dimension, two elements are adjacent if they share a
+     * side (e.g. a face of a 3D element.)  No side entities are created.
+     * A matrix assembled from the mesh in handle order will then have a
+     * banded sparsity pattern.  Entities in structured mesh are not
+     * re-ordered.
+     *
+     *\param new_handle_tag_out  Passed back new tag handle containing the
+     *                     entity mapping.  The returned tag will be anonymous.
+     *                     The caller is responsible for releasing the tag.
+     *                     The value of this tag on each handle is the new
+     *                     handle that the entity will will be moved to. The
+     *                     tag value will be zero for entities that were not
+     *                     re-ordered.
+     */
+    ErrorCode handle_order_from_rcm( Tag& new_handle_tag_out );
+
     /**\brief Do the re-ordering indicated by the passed handle tag.
      *
      * The specified re-ordering must be a permutation.  Each existing
@@ -121,6 +172,28 @@ class ReorderTool
      */
     ErrorCode reorder_entities( Tag new_handle_tag );
 
+    /**\brief Pack entities into the start of their storage after deletion.
+     *
+     * Deleting entities leaves unused handles in the blocks of storage
+     * allocated for them.  For each entity type (except entity sets) and
+     * connectivity length (or vertex coordinate precision), move the
+     * entities with the largest handles into the unused handles earlier in
+     * the handle space, such that the entities occupy the first handles
+     * of their storage, and release any storage that is left empty.  
+     * Relative order of the moved entities is preserved.  Structured mesh
+     * is not changed.
+     *
+     * As for reorder_entities, connectivity, tag data (including values
+     * of handle tags), set contents, and adjacencies are updated for the
+     * new handles.
+     *
+     *\param old_handles  Output: entities that were moved
+     *\param new_handles  Output: for each entity in \c old_handles, in 
+     *                    order, the handle it was moved to.
+     */
+    ErrorCode compact_handles( Range& old_handles,
+                               std::vector<EntityHandle>& new_handles );
+
   private:
    
     /**\brief helper function for reorder_entities
@@ -134,6 +207,22 @@ class ReorderTool
      */
     ErrorCode reorder_tag_data( EntityType type, Tag new_handles, Tag reorder_tag );
     
+    /**\brief helper function for compact_handles
+     *
+     * Find entities of the specified type and size that must be moved
+     * to pack them at the start of their storage, create entities at the
+     * unused handles to swap them with, and store the swap in the
+     * old->new handle mapping.
+     *\param new_handles  Tag in which to store old->new handle mapping
+     *\param placeholders Handles of created entities are appended
+     *\param moves        Old and new handle of each moved entity are appended
+     */
+    ErrorCode compact_handles( EntityType type,
+                               int vals_per_ent,
+                               Tag new_handles,
+                               Range& placeholders,
+                               std::vector< std::pair<EntityHandle,EntityHandle> >& moves );
+    
     /**\brief helper function for reorder_entities
      *
      * Update set contents for changed handles.
@@ -55,7 +55,14 @@ extern const char* const ErrorCodeStr[];
 
 /** Misc. integer constants, declared in enum for portability */
 enum Constants {
-  MB_VARIABLE_LENGTH = -1 /**< Length value for variable-length tags */ 
+  MB_VARIABLE_LENGTH = -1, /**< Length value for variable-length tags */ 
+  MB_ARRAY_ALIGNMENT = 64  /**< Alignment in bytes of the start of each 
+                                block of vertex coordinates, connectivity,
+                                and dense tag values (e.g. as returned from
+                                coords_iterate, connect_iterate, and 
+                                tag_iterate for the first entity in a 
+                                block.)  Each block is zero-padded to
+                                a multiple of this many bytes. */
 };
 
 /** Specify storage type for tags.  See MOAB users guide for more information. */
@@ -280,7 +280,9 @@ public:
    *
    * Get explicit adjacences stored in database.
    * Does not create any explicit adjacencies or search for
-   * implicit ones.
+   * implicit ones, except that the adjacencies of a structured
+   * vertex include its structured elements, as the stored
+   * adjacencies of an unstructured vertex include its elements.
    *
    *\param entity  The entity to retreive adjacencies for.
    *\param id_tag  The global ID tag
@@ -294,6 +296,12 @@ public:
   ) = 0;
   
   
+  /** Get explicit adjacencies as handles
+   *
+   * As above, returning handles rather than IDs.  For a structured
+   * vertex the array is held by this object and is valid only until
+   * the next call.
+   */
   virtual ErrorCode get_adjacencies( EntityHandle entity,
                                const EntityHandle*& adj_array,
                                int& num_adj ) = 0;
@@ -368,6 +376,11 @@ public:
    *\return MB_STRUCTURED_MESH if one or more input elements are stored as
    *          structured mesh and therefore do not have explicit storage.
    *        MB_TYPE_OUT_OF_RANGE if called for vertices.
+   *
+   *\Note Large sets of scattered handles are stored in a compressed form
+   *      rather than as a list.  For such sets the contents are copied to
+   *      a buffer owned by this object, which remains valid only until the
+   *      next call to get_entity_list_pointers.
    */
   virtual ErrorCode
   get_entity_list_pointers( Range::const_iterator query_begin,
@@ -398,6 +411,11 @@ public:
    *\return MB_STRUCTURED_MESH if one or more input elements are stored as
    *          structured mesh and therefore do not have explicit storage.
    *        MB_TYPE_OUT_OF_RANGE if called for vertices.
+   *
+   *\Note Large sets of scattered handles are stored in a compressed form
+   *      rather than as a list.  For such sets the contents are copied to
+   *      a buffer owned by this object, which remains valid only until the
+   *      next call to get_entity_list_pointers.
    */
   virtual ErrorCode
   get_entity_list_pointers( EntityHandle const* entities,
@@ -5117,31 +5117,33 @@ ErrorCode ParallelComm::resolve_shared_ents(EntityHandle this_set,
     }
 
     // Put into tmp_ents any entities which are not owned locally or
-    // who are already shared with to_proc
+    // who are already shared with to_proc.  Handles are collected in
+    // the (sorted) order of ents and inserted into the range in bulk.
     std::vector<unsigned char> shared_flags(ents.size()), shared_flags2;
     ErrorCode result = mbImpl->tag_get_data(pstatus_tag(), ents,
                                             &shared_flags[0]);
     RRA("Failed to get pstatus flag.");
-    Range::const_iterator rit, hint = tmp_ents.begin();;
+    std::vector<EntityHandle> kept;
+    Range::const_iterator rit;
     int i;
     if (op == PSTATUS_OR) {
       for (rit = ents.begin(), i = 0; rit != ents.end(); rit++, i++) 
         if (((shared_flags[i] & ~pstat)^shared_flags[i]) & pstat) {
-          hint = tmp_ents.insert(hint,*rit);
+          kept.push_back(*rit);
           if (-1 != to_proc) shared_flags2.push_back(shared_flags[i]);
         }
     }
     else if (op == PSTATUS_AND) {
       for (rit = ents.begin(), i = 0; rit != ents.end(); rit++, i++)
         if ((shared_flags[i] & pstat) == pstat) {
-          hint = tmp_ents.insert(hint,*rit);
+          kept.push_back(*rit);
           if (-1 != to_proc) shared_flags2.push_back(shared_flags[i]);
         }
     }
     else if (op == PSTATUS_NOT) {
       for (rit = ents.begin(), i = 0; rit != ents.end(); rit++, i++)
         if (!(shared_flags[i] & pstat)) {
-          hint = tmp_ents.insert(hint,*rit);
+          kept.push_back(*rit);
           if (-1 != to_proc) shared_flags2.push_back(shared_flags[i]);
         }
     }
@@ -5154,41 +5156,46 @@ ErrorCode ParallelComm::resolve_shared_ents(EntityHandle this_set,
 
       int sharing_procs[MAX_SHARING_PROCS];
       std::fill(sharing_procs, sharing_procs+MAX_SHARING_PROCS, -1);
-      Range tmp_ents2;
-      hint = tmp_ents2.begin();
+      size_t num_kept = 0;
 
-      for (rit = tmp_ents.begin(), i = 0; rit != tmp_ents.end(); rit++, i++) {
+      for (size_t k = 0; k < kept.size(); k++) {
         // we need to check sharing procs
-        if (shared_flags2[i] & PSTATUS_MULTISHARED) {
-          result = mbImpl->tag_get_data(sharedps_tag(), &(*rit), 1,
+        if (shared_flags2[k] & PSTATUS_MULTISHARED) {
+          result = mbImpl->tag_get_data(sharedps_tag(), &kept[k], 1,
                                         sharing_procs);
           assert(-1 != sharing_procs[0]);
           RRA(" ");
+          bool shared_with_proc = false;
           for (unsigned int j = 0; j < MAX_SHARING_PROCS; j++) {
             // if to_proc shares this entity, add it to list
             if (sharing_procs[j] == to_proc) {
-              hint = tmp_ents2.insert(hint, *rit);
+              shared_with_proc = true;
             }
             else if (sharing_procs[j] == -1) break;
 
             sharing_procs[j] = -1;
           }
+          if (shared_with_proc)
+            kept[num_kept++] = kept[k];
         }
-        else if (shared_flags2[i] & PSTATUS_SHARED) {
-          result = mbImpl->tag_get_data(sharedp_tag(), &(*rit), 1,
+        else if (shared_flags2[k] & PSTATUS_SHARED) {
+          result = mbImpl->tag_get_data(sharedp_tag(), &kept[k], 1,
                                         sharing_procs);
           RRA(" ");
           assert(-1 != sharing_procs[0]);
           if (sharing_procs[0] == to_proc) 
-            hint = tmp_ents2.insert(hint,*rit);
+            kept[num_kept++] = kept[k];
           sharing_procs[0] = -1;
         }
         else
           assert("should never get here" && false);
       }
 
-      tmp_ents.swap(tmp_ents2);
+      kept.resize(num_kept);
     }
+
+    if (!kept.empty())
+      tmp_ents.insert_sorted_list(&kept[0], &kept[0] + kept.size());
   
     if (returned_ents)
       returned_ents->swap(tmp_ents);
@@ -30,11 +30,13 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <map>
 #include <cstdio>
 #include <time.h>
 #include <assert.h>
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "moab/Interface.hpp"
 #include "MBTagConventions.hpp"
 #include "moab/Range.hpp"
@@ -55,10 +57,13 @@
 #include "Internals.hpp"
 #include "moab/Core.hpp"
 #include "SequenceManager.hpp"
+#include "AEntityFactory.hpp"
 #include "EntitySequence.hpp"
 #include "RangeSeqIntersectIter.hpp"
 #include "moab/Error.hpp"
 #include "moab/ScdInterface.hpp"
+#include "moab/MemoryCounter.hpp"
+#include "moab/MeshBuilder.hpp"
 
 using namespace std;
 using namespace moab;
@@ -8020,6 +8025,573 @@ ErrorCode mb_root_set_test()
   return MB_SUCCESS;
 }
 
+ErrorCode mb_read_only_phase_test()
+{
+  ErrorCode rval;
+  Core moab;
+  Interface* mb = &moab;
+  rval = create_some_mesh( mb );
+  CHKERR( rval );
+  CHECK( !mb->is_read_only_phase() );
+  
+  Range verts, hexes;
+  rval = mb->get_entities_by_type( 0, MBVERTEX, verts );
+  CHKERR( rval );
+  rval = mb->get_entities_by_type( 0, MBHEX, hexes );
+  CHKERR( rval );
+  CHECK_EQUAL( (size_t)8, hexes.size() );
+  
+    // enter read-only phase without vertex-to-element adjacencies
+  rval = mb->begin_read_only_phase( false );
+  CHKERR( rval );
+  CHECK( mb->is_read_only_phase() );
+  CHECK( !moab.a_entity_factory()->vert_elem_adjacencies() );
+  
+    // basic queries should work
+  const EntityHandle* conn;
+  int len;
+  rval = mb->get_connectivity( hexes.front(), conn, len );
+  CHKERR( rval );
+  CHECK_EQUAL( 8, len );
+  double coords[3];
+  rval = mb->get_coords( conn, 1, coords );
+  CHKERR( rval );
+  std::vector<EntityHandle> adj;
+  rval = mb->get_adjacencies( &hexes.front(), 1, 0, false, adj );
+  CHKERR( rval );
+  CHECK_EQUAL( (size_t)8, adj.size() );
+  
+    // up-adjacencies cannot be created in read-only phase
+  adj.clear();
+  rval = mb->get_adjacencies( &verts.front(), 1, 3, false, adj );
+  CHECK( MB_SUCCESS != rval );
+  CHECK( !moab.a_entity_factory()->vert_elem_adjacencies() );
+  
+  rval = mb->end_read_only_phase();
+  CHKERR( rval );
+  CHECK( !mb->is_read_only_phase() );
+  
+    // adjacencies should be created on entry into read-only phase
+  rval = mb->begin_read_only_phase();
+  CHKERR( rval );
+  CHECK( moab.a_entity_factory()->vert_elem_adjacencies() );
+  
+  adj.clear();
+  rval = mb->get_adjacencies( &verts.front(), 1, 3, false, adj );
+  CHKERR( rval );
+  CHECK_EQUAL( (size_t)1, adj.size() );
+  CHECK_EQUAL( hexes.front(), adj.front() );
+  
+    // queries must not change the cached sequence
+  const SequenceManager* seqman = moab.sequence_manager();
+  const EntitySequence* last = seqman->get_last_accessed_sequence( MBVERTEX );
+  rval = mb->get_coords( &verts.back(), 1, coords );
+  CHKERR( rval );
+  CHECK_EQUAL( last, seqman->get_last_accessed_sequence( MBVERTEX ) );
+
+  rval = mb->end_read_only_phase();
+  CHKERR( rval );
+  return MB_SUCCESS;
+}
+
+
+ErrorCode mb_compact_vert_adjacencies_test()
+{
+  ErrorCode rval;
+  Core moab, moab2;
+  Interface *mb = &moab, *mb2 = &moab2;
+  rval = create_some_mesh( mb );
+  CHKERR( rval );
+  rval = create_some_mesh( mb2 );
+  CHKERR( rval );
+  
+  std::vector<EntityHandle> verts;
+  Range hexes;
+  rval = mb->get_entities_by_type( 0, MBVERTEX, verts );
+  CHKERR( rval );
+  rval = mb->get_entities_by_type( 0, MBHEX, hexes );
+  CHKERR( rval );
+  
+    // add a degenerate edge and a set tracking one vertex
+  EntityHandle edge_conn[2] = { verts.front(), verts.front() }, edge, set;
+  for (int i = 0; i < 2; ++i) {
+    Interface* iface = i ? mb2 : mb;
+    rval = iface->create_element( MBEDGE, edge_conn, 2, edge );
+    CHKERR( rval );
+    rval = iface->create_meshset( MESHSET_TRACK_OWNER, set );
+    CHKERR( rval );
+    rval = iface->add_entities( set, &verts.back(), 1 );
+    CHKERR( rval );
+  }
+  
+    // get reference adjacencies using per-vertex lists
+  std::vector< std::vector<EntityHandle> > expected[4];
+  for (int dim = 1; dim <= 4; ++dim) {
+    expected[dim-1].resize( verts.size() );
+    for (size_t i = 0; i < verts.size(); ++i) {
+      rval = mb->get_adjacencies( &verts[i], 1, dim, false, expected[dim-1][i] );
+      CHKERR( rval );
+    }
+  }
+  CHECK_EQUAL( (size_t)2, expected[0].front().size() + expected[2].front().size() );
+  CHECK_EQUAL( (size_t)1, expected[3].back().size() );
+  
+  Range vert_range;
+  std::copy( verts.rbegin(), verts.rend(), range_inserter(vert_range) );
+  unsigned long dynamic_min, dynamic_am, compact_min, compact_am;
+  moab.estimated_memory_use( vert_range, &dynamic_min, &dynamic_am );
+  
+    // compact existing lists in one instance, and build compact 
+    // adjacencies from nothing in the other
+  rval = moab.compact_vert_elem_adjacencies();
+  CHKERR( rval );
+  CHECK( moab.a_entity_factory()->vert_elem_adjacencies_compact() );
+  CHECK( !moab2.a_entity_factory()->vert_elem_adjacencies() );
+  rval = mb2->compact_vert_elem_adjacencies();
+  CHKERR( rval );
+  CHECK( moab2.a_entity_factory()->vert_elem_adjacencies() );
+  CHECK( moab2.a_entity_factory()->vert_elem_adjacencies_compact() );
+  
+  moab.estimated_memory_use( vert_range, &compact_min, &compact_am );
+  CHECK( compact_min < dynamic_min );
+  
+  rval = mb->begin_read_only_phase();
+  CHKERR( rval );
+  std::vector<EntityHandle> adj;
+  for (int dim = 1; dim <= 4; ++dim) {
+    for (size_t i = 0; i < verts.size(); ++i) {
+      adj.clear();
+      rval = mb->get_adjacencies( &verts[i], 1, dim, false, adj );
+      CHKERR( rval );
+      CHECK( expected[dim-1][i] == adj );
+      adj.clear();
+      rval = mb2->get_adjacencies( &verts[i], 1, dim, false, adj );
+      CHKERR( rval );
+      CHECK( expected[dim-1][i] == adj );
+    }
+  }
+  rval = mb->end_read_only_phase();
+  CHKERR( rval );
+  CHECK( moab.a_entity_factory()->vert_elem_adjacencies_compact() );
+  
+    // deleting an element should restore the per-vertex lists
+  const EntityHandle* conn;
+  int len;
+  rval = mb->get_connectivity( hexes.back(), conn, len );
+  CHKERR( rval );
+  EntityHandle corner = conn[0];
+  rval = mb->delete_entities( &hexes.back(), 1 );
+  CHKERR( rval );
+  CHECK( !moab.a_entity_factory()->vert_elem_adjacencies_compact() );
+  adj.clear();
+  rval = mb->get_adjacencies( &corner, 1, 3, false, adj );
+  CHKERR( rval );
+  CHECK( std::find( adj.begin(), adj.end(), hexes.back() ) == adj.end() );
+  rval = moab.check_adjacencies( &corner, 1 );
+  CHKERR( rval );
+  
+    // adjacencies_iterate needs the per-vertex lists too
+  const std::vector<EntityHandle>** adjs_ptr;
+  int count;
+  rval = mb2->adjacencies_iterate( vert_range.begin(), vert_range.end(), adjs_ptr, count );
+  CHKERR( rval );
+  CHECK( !moab2.a_entity_factory()->vert_elem_adjacencies_compact() );
+  CHECK( adjs_ptr && adjs_ptr[0] );
+  adj = expected[0][0];
+  adj.insert( adj.end(), expected[2][0].begin(), expected[2][0].end() );
+  CHECK( adj == *adjs_ptr[0] );
+  
+  return MB_SUCCESS;
+}
+
+ErrorCode mb_vert_elem_adjacencies_threads_test()
+{
+  ErrorCode rval;
+  Core moab[2];
+  std::vector<EntityHandle> verts;
+  for (int i = 0; i < 2; ++i) {
+    Interface* mb = moab + i;
+    
+      // hex mesh large enough to be split into several work items
+    const int n[3] = { 31, 31, 21 };
+    std::vector<double> coords( 3*n[0]*n[1]*n[2] );
+    for (int k = 0; k < n[2]; ++k)
+      for (int j = 0; j < n[1]; ++j)
+        for (int l = 0; l < n[0]; ++l) {
+          double* c = &coords[3*((k*n[1] + j)*n[0] + l)];
+          c[0] = l; c[1] = j; c[2] = k;
+        }
+    Range grid;
+    rval = mb->create_vertices( &coords[0], n[0]*n[1]*n[2], grid );
+    CHKERR( rval );
+    for (int k = 0; k+1 < n[2]; ++k)
+      for (int j = 0; j+1 < n[1]; ++j)
+        for (int l = 0; l+1 < n[0]; ++l) {
+          const EntityHandle v = grid.front() + (k*n[1] + j)*n[0] + l;
+          EntityHandle hconn[8] = { v, v+1, v+1+n[0], v+n[0] }, hex;
+          for (int c = 0; c < 4; ++c)
+            hconn[c+4] = hconn[c] + n[0]*n[1];
+          rval = mb->create_element( MBHEX, hconn, 8, hex );
+          CHKERR( rval );
+        }
+      // unstructured mesh and a degenerate edge
+    rval = create_some_mesh( mb );
+    CHKERR( rval );
+    verts.clear();
+    rval = mb->get_entities_by_type( 0, MBVERTEX, verts );
+    CHKERR( rval );
+    EntityHandle conn[2] = { verts.back(), verts.back() }, edge, set;
+    rval = mb->create_element( MBEDGE, conn, 2, edge );
+    CHKERR( rval );
+      // existing adjacency list for one vertex
+    rval = mb->create_meshset( MESHSET_TRACK_OWNER, set );
+    CHKERR( rval );
+    rval = mb->add_entities( set, &verts.back(), 1 );
+    CHKERR( rval );
+    CHECK( !moab[i].a_entity_factory()->vert_elem_adjacencies() );
+  }
+  
+    // one thread unless requested, here through the instance option
+  CHECK_EQUAL( 0u, moab[1].adjacency_threads() );
+  if (!getenv( "MOAB_NUM_THREADS" ))
+    CHECK_EQUAL( 1u, moab[1].a_entity_factory()->thread_count() );
+  moab[1].set_adjacency_threads( 4 );
+  CHECK_EQUAL( 4u, moab[1].a_entity_factory()->thread_count() );
+  CHECK_EQUAL( 2u, moab[1].a_entity_factory()->thread_count( 2 ) );
+  rval = moab[0].a_entity_factory()->create_vert_elem_adjacencies( 1 );
+  CHKERR( rval );
+  rval = moab[1].a_entity_factory()->create_vert_elem_adjacencies();
+  CHKERR( rval );
+  CHECK( moab[1].a_entity_factory()->vert_elem_adjacencies() );
+  
+    // expected adjacencies from element connectivity
+  std::map< EntityHandle, std::vector<EntityHandle> > expected;
+  Range elems;
+  for (int dim = 1; dim <= 3; ++dim) {
+    rval = moab[0].get_entities_by_dimension( 0, dim, elems );
+    CHKERR( rval );
+  }
+  for (Range::iterator e = elems.begin(); e != elems.end(); ++e) {
+    std::vector<EntityHandle> conn;
+    rval = moab[0].get_connectivity( &*e, 1, conn );
+    CHKERR( rval );
+    for (size_t j = 0; j < conn.size(); ++j)
+      if (expected[conn[j]].empty() || expected[conn[j]].back() != *e)
+        expected[conn[j]].push_back( *e );
+  }
+  Range sets;
+  rval = moab[0].get_entities_by_type( 0, MBENTITYSET, sets );
+  CHKERR( rval );
+  expected[verts.back()].push_back( sets.back() );
+  
+  std::vector<EntityHandle> adj[2];
+  for (size_t i = 0; i < verts.size(); ++i) {
+    for (int j = 0; j < 2; ++j) {
+      rval = moab[j].a_entity_factory()->get_adjacencies( verts[i], adj[j] );
+      CHKERR( rval );
+    }
+    CHECK( expected[verts[i]] == adj[0] );
+    CHECK( expected[verts[i]] == adj[1] );
+  }
+  
+  return MB_SUCCESS;
+}
+
+ErrorCode mb_scd_vert_adjacencies_test()
+{
+  ErrorCode rval;
+  Core moab;
+  Interface* mb = &moab;
+  ScdInterface *scdi;
+  rval = mb->query_interface( scdi );
+  CHKERR( rval );
+  
+    // hex box, quad box periodic in i, and one quad layer periodic in i and j
+  ScdBox *boxes[3];
+  int periodic[3][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 } };
+  rval = scdi->construct_box( HomCoord(0, 0, 0), HomCoord(4, 3, 2), NULL, 0, boxes[0], periodic[0] );
+  CHKERR( rval );
+  rval = scdi->construct_box( HomCoord(0, 2, 0), HomCoord(4, 5, 0), NULL, 0, boxes[1], periodic[1] );
+  CHKERR( rval );
+  rval = scdi->construct_box( HomCoord(0, 0, 1), HomCoord(3, 3, 1), NULL, 0, boxes[2], periodic[2] );
+  CHKERR( rval );
+    // an unstructured hex sharing structured vertices
+  EntityHandle hconn[8], hex;
+  for (int c = 0; c < 8; ++c)
+    hconn[c] = boxes[0]->get_vertex( c & 1, (c & 2) >> 1, (c & 4) >> 2 );
+  rval = mb->create_element( MBHEX, hconn, 8, hex );
+  CHKERR( rval );
+  
+    // structured adjacencies are computed whether or not lists exist
+  for (int pass = 0; pass < 2; ++pass) {
+    if (pass) {
+        // deleted structured elements are not adjacent
+      EntityHandle dead[] = { boxes[0]->get_element( 0, 0, 0 ), 
+                              boxes[1]->get_element( 4, 2, 0 ) };
+      rval = mb->delete_entities( dead, 2 );
+      CHKERR( rval );
+    }
+    
+      // expected adjacencies from element connectivity
+    std::map< EntityHandle, std::vector<EntityHandle> > expected;
+    Range elems, verts;
+    for (int dim = 2; dim <= 3; ++dim) {
+      rval = mb->get_entities_by_dimension( 0, dim, elems );
+      CHKERR( rval );
+    }
+    for (Range::iterator e = elems.begin(); e != elems.end(); ++e) {
+      std::vector<EntityHandle> conn;
+      rval = mb->get_connectivity( &*e, 1, conn );
+      CHKERR( rval );
+      std::sort( conn.begin(), conn.end() );
+      conn.erase( std::unique( conn.begin(), conn.end() ), conn.end() );
+      for (size_t j = 0; j < conn.size(); ++j)
+        expected[conn[j]].push_back( *e );
+    }
+    
+    rval = mb->get_entities_by_type( 0, MBVERTEX, verts );
+    CHKERR( rval );
+    for (Range::iterator v = verts.begin(); v != verts.end(); ++v) {
+      std::vector<EntityHandle> adj, exp_dim;
+      for (int dim = 2; dim <= 3; ++dim) {
+        adj.clear();
+        rval = mb->get_adjacencies( &*v, 1, dim, false, adj );
+        CHKERR( rval );
+        exp_dim.clear();
+        for (size_t j = 0; j < expected[*v].size(); ++j)
+          if (mb->dimension_from_handle( expected[*v][j] ) == dim)
+            exp_dim.push_back( expected[*v][j] );
+        CHECK( exp_dim == adj );
+      }
+      
+        // nothing stored for structured elements
+      const EntityHandle* stored;
+      int num_stored;
+      rval = moab.a_entity_factory()->get_adjacencies( *v, stored, num_stored );
+      CHKERR( rval );
+      CHECK( num_stored <= 1 );
+    }
+  }
+  
+    // element lookup by connectivity finds structured elements
+  EntityHandle h = boxes[0]->get_element( 1, 1, 1 );
+  std::vector<EntityHandle> conn, adj;
+  rval = mb->get_connectivity( &h, 1, conn );
+  CHKERR( rval );
+  rval = mb->get_adjacencies( &conn[0], conn.size(), 3, false, adj );
+  CHKERR( rval );
+  CHECK( adj.size() == 1 && adj[0] == h );
+  
+    // created faces are adjacent to both structured hexes sharing them
+  adj.clear();
+  rval = mb->get_adjacencies( &h, 1, 2, true, adj );
+  CHKERR( rval );
+  CHECK_EQUAL( (size_t)6, adj.size() );
+  std::vector<EntityHandle> hexes;
+  rval = mb->get_adjacencies( &adj[0], 1, 3, false, hexes );
+  CHKERR( rval );
+  CHECK_EQUAL( (size_t)2, hexes.size() );
+  CHECK( std::find( hexes.begin(), hexes.end(), h ) != hexes.end() );
+  
+    // edges are created for a hex none of whose vertices have stored adjacencies
+  h = boxes[0]->get_element( 3, 2, 1 );
+  adj.clear();
+  rval = mb->get_adjacencies( &h, 1, 1, true, adj );
+  CHKERR( rval );
+  CHECK_EQUAL( (size_t)12, adj.size() );
+  
+    // vertices no longer find elements once their whole box is deleted
+  Range box_quads( boxes[1]->start_element(),
+                   boxes[1]->start_element() + boxes[1]->num_elements() - 1 );
+  box_quads.erase( boxes[1]->get_element( 4, 2, 0 ) ); // already deleted
+  rval = mb->delete_entities( box_quads );
+  CHKERR( rval );
+  adj.clear();
+  h = boxes[1]->start_vertex() + boxes[1]->num_vertices() - 1;
+  rval = mb->get_adjacencies( &h, 1, 2, false, adj );
+  CHKERR( rval );
+  CHECK( adj.empty() );
+  
+  rval = mb->release_interface( scdi );
+  CHKERR( rval );
+  return MB_SUCCESS;
+}
+
+ErrorCode mb_scd_raw_adjacencies_test()
+{
+  ErrorCode rval;
+  Core moab;
+  Interface* mb = &moab;
+  ScdInterface *scdi;
+  rval = mb->query_interface( scdi );
+  CHKERR( rval );
+  ScdBox *box;
+  rval = scdi->construct_box( HomCoord(0, 0, 0), HomCoord(2, 2, 2), NULL, 0, box );
+  CHKERR( rval );
+  rval = mb->release_interface( scdi );
+  CHKERR( rval );
+  
+  Range verts;
+  rval = mb->get_entities_by_type( 0, MBVERTEX, verts );
+  CHKERR( rval );
+  
+    // direct access to stored lists would miss the structured hexes
+  const std::vector<EntityHandle>** adjs_ptr;
+  int count;
+  rval = mb->adjacencies_iterate( verts.begin(), verts.end(), adjs_ptr, count );
+  CHECK_EQUAL( MB_NOT_IMPLEMENTED, rval );
+  
+    // writers see the same adjacencies as get_adjacencies
+  WriteUtilIface* tool = 0;
+  rval = mb->query_interface( tool );
+  CHKERR( rval );
+  const EntityHandle center = box->get_vertex( 1, 1, 1 );
+  std::vector<EntityHandle> hexes;
+  rval = mb->get_adjacencies( &center, 1, 3, false, hexes );
+  CHKERR( rval );
+  CHECK_EQUAL( (size_t)8, hexes.size() );
+  const EntityHandle* adj;
+  int num_adj;
+  rval = tool->get_adjacencies( center, adj, num_adj );
+  CHKERR( rval );
+  CHECK( std::vector<EntityHandle>( adj, adj + num_adj ) == hexes );
+  rval = mb->release_interface( tool );
+  CHKERR( rval );
+  
+    // stored adjacencies, such as to sets, are merged in
+  EntityHandle set;
+  rval = mb->create_meshset( MESHSET_TRACK_OWNER, set );
+  CHKERR( rval );
+  rval = mb->add_entities( set, &center, 1 );
+  CHKERR( rval );
+  std::vector<EntityHandle> storage;
+  rval = moab.a_entity_factory()->get_adjacencies( center, adj, num_adj, storage );
+  CHKERR( rval );
+  hexes.push_back( set );
+  CHECK( std::vector<EntityHandle>( adj, adj + num_adj ) == hexes );
+  
+  return MB_SUCCESS;
+}
+
+ErrorCode mb_topo_util_construct_sides_test()
+{
+  ErrorCode rval;
+  Core moab[2];
+  Range hexes[2];
+  for (int i = 0; i < 2; ++i) {
+    Interface* mb = moab + i;
+      // two disjoint hex meshes, one of them structured
+    rval = create_some_mesh( mb );
+    CHKERR( rval );
+    ScdInterface *scdi;
+    rval = mb->query_interface( scdi );
+    CHKERR( rval );
+    ScdBox *box;
+    rval = scdi->construct_box( HomCoord(0, 0, 0), HomCoord(2, 2, 2), NULL, 0, box );
+    CHKERR( rval );
+    rval = mb->release_interface( scdi );
+    CHKERR( rval );
+    rval = mb->get_entities_by_type( 0, MBHEX, hexes[i] );
+    CHKERR( rval );
+    CHECK_EQUAL( (size_t)16, hexes[i].size() );
+    
+      // an existing face, with vertices in a different order than in the hex
+    std::vector<EntityHandle> conn;
+    rval = mb->get_connectivity( &hexes[i].front(), 1, conn );
+    CHKERR( rval );
+    EntityHandle quad_conn[4] = { conn[3], conn[2], conn[1], conn[0] }, quad;
+    rval = mb->create_element( MBQUAD, quad_conn, 4, quad );
+    CHKERR( rval );
+  }
+  
+    // bulk creation vs. creation one element at a time
+  MeshTopoUtil mtu( moab );
+  Range new_faces, new_edges;
+  rval = mtu.construct_sides( hexes[0], 2, new_faces, true, 4 );
+  CHKERR( rval );
+  rval = mtu.construct_sides( hexes[0], 1, new_edges, false, 1 );
+  CHKERR( rval );
+  std::vector<EntityHandle> adj;
+  for (Range::iterator h = hexes[1].begin(); h != hexes[1].end(); ++h) {
+    for (int dim = 1; dim <= 2; ++dim) {
+      adj.clear();
+      rval = moab[1].get_adjacencies( &*h, 1, dim, true, adj );
+      CHKERR( rval );
+    }
+  }
+  
+  int count[2][2];
+  for (int i = 0; i < 2; ++i) {
+    rval = moab[i].get_number_entities_by_dimension( 0, 1, count[i][0] );
+    CHKERR( rval );
+    rval = moab[i].get_number_entities_by_dimension( 0, 2, count[i][1] );
+    CHKERR( rval );
+  }
+  CHECK_EQUAL( count[1][0], count[0][0] );
+  CHECK_EQUAL( count[1][1], count[0][1] );
+  CHECK_EQUAL( (size_t)count[0][0], new_edges.size() );
+  CHECK_EQUAL( (size_t)count[0][1] - 1, new_faces.size() );
+  CHECK_EQUAL( new_faces.size(), new_faces.num_of_type( MBQUAD ) );
+  
+    // each hex has the right sides, with connectivity from the hex
+  for (Range::iterator h = hexes[0].begin(); h != hexes[0].end(); ++h) {
+    std::vector<EntityHandle> hconn;
+    rval = moab[0].get_connectivity( &*h, 1, hconn );
+    CHKERR( rval );
+    std::sort( hconn.begin(), hconn.end() );
+    for (int dim = 1; dim <= 2; ++dim) {
+      adj.clear();
+      rval = moab[0].get_adjacencies( &*h, 1, dim, false, adj );
+      CHKERR( rval );
+      CHECK_EQUAL( (size_t)(dim == 1 ? 12 : 6), adj.size() );
+      for (size_t j = 0; j < adj.size(); ++j) {
+        std::vector<EntityHandle> sconn;
+        rval = moab[0].get_connectivity( &adj[j], 1, sconn );
+        CHKERR( rval );
+        std::sort( sconn.begin(), sconn.end() );
+        CHECK( std::includes( hconn.begin(), hconn.end(), sconn.begin(), sconn.end() ) );
+      }
+    }
+    
+      // explicit adjacencies were recorded for faces only
+    const EntityHandle* explicit_adj;
+    int num_explicit;
+    rval = moab[0].a_entity_factory()->get_adjacencies( *h, explicit_adj, num_explicit );
+    CHKERR( rval );
+    CHECK_EQUAL( 6, num_explicit );
+  }
+  
+    // nothing left to create
+  new_faces.clear();
+  rval = mtu.construct_sides( hexes[0], 2, new_faces );
+  CHKERR( rval );
+  CHECK( new_faces.empty() );
+  
+    // disjoint triangles, with more distinct sides than a power of two
+  Core moab2;
+  Interface* mb = &moab2;
+  const int num_tri = 11;
+  Range tris;
+  for (int i = 0; i < num_tri; ++i) {
+    const double tri_coords[] = { 2.0*i, 0, 0, 2.0*i+1, 0, 0, 2.0*i, 1, 0 };
+    Range verts;
+    rval = mb->create_vertices( tri_coords, 3, verts );
+    CHKERR( rval );
+    std::vector<EntityHandle> tri_conn( verts.begin(), verts.end() );
+    EntityHandle tri;
+    rval = mb->create_element( MBTRI, &tri_conn[0], 3, tri );
+    CHKERR( rval );
+    tris.insert( tri );
+  }
+  MeshTopoUtil mtu2( mb );
+  new_edges.clear();
+  rval = mtu2.construct_sides( tris, 1, new_edges );
+  CHKERR( rval );
+  CHECK_EQUAL( (size_t)(3*num_tri), new_edges.size() );
+  CHECK_EQUAL( new_edges.size(), new_edges.num_of_type( MBEDGE ) );
+  
+  return MB_SUCCESS;
+}
 
 /* Create a regular 2x2x2 hex mesh */
 ErrorCode create_some_mesh( Interface* iface )
@@ -8132,6 +8704,750 @@ ErrorCode check_valid_connectivity( Interface* iface )
   return result;
 }
 
+ErrorCode mb_memory_counter_test()
+{
+  size_t initial[MEM_NUM_CATEGORIES];
+  for (int i = 0; i < MEM_NUM_CATEGORIES; ++i) 
+    initial[i] = MemoryCounter::category( (MemoryCategory)i ).bytes();
+  const MemoryCounter& tags = MemoryCounter::category( MEM_TAGS );
+  
+  {
+    ErrorCode rval;
+    Core moab;
+    Interface* mb = &moab;
+    rval = create_some_mesh( mb );
+    CHKERR( rval );
+    CHECK( MemoryCounter::category( MEM_SEQUENCES ).bytes() > initial[MEM_SEQUENCES] );
+    CHECK( MemoryCounter::category( MEM_CONNECTIVITY ).bytes() > initial[MEM_CONNECTIVITY] );
+    
+    std::vector<EntityHandle> verts;
+    rval = mb->get_entities_by_type( 0, MBVERTEX, verts );
+    CHKERR( rval );
+    
+      // dense tag values are charged to the tag and to MEM_TAGS
+    Tag dense, sparse;
+    rval = mb->tag_get_handle( "mem_dense", 1, MB_TYPE_DOUBLE, dense, MB_TAG_DENSE|MB_TAG_EXCL );
+    CHKERR( rval );
+    rval = mb->tag_get_handle( "mem_sparse", 1, MB_TYPE_INTEGER, sparse, MB_TAG_SPARSE|MB_TAG_EXCL );
+    CHKERR( rval );
+    const MemoryCounter *dense_count, *sparse_count;
+    rval = mb->tag_get_memory_counter( dense, dense_count );
+    CHKERR( rval );
+    rval = mb->tag_get_memory_counter( sparse, sparse_count );
+    CHKERR( rval );
+    CHECK_EQUAL( (size_t)0, dense_count->bytes() );
+    CHECK_EQUAL( (size_t)0, sparse_count->bytes() );
+    
+    const size_t tags_before = tags.bytes();
+    std::vector<double> dvals( verts.size(), 1.0 );
+    rval = mb->tag_set_data( dense, &verts[0], verts.size(), &dvals[0] );
+    CHKERR( rval );
+    CHECK( dense_count->bytes() >= verts.size() * sizeof(double) );
+    CHECK( dense_count->allocations() > 0 );
+    std::vector<int> ivals( verts.size(), 2 );
+    rval = mb->tag_set_data( sparse, &verts[0], verts.size(), &ivals[0] );
+    CHKERR( rval );
+    CHECK( sparse_count->bytes() >= verts.size() * sizeof(int) );
+    CHECK_EQUAL( tags_before + dense_count->bytes() + sparse_count->bytes(), tags.bytes() );
+    
+      // releasing the values returns the memory to the counters
+    const size_t sparse_peak = sparse_count->peak_bytes();
+    rval = mb->tag_delete_data( sparse, &verts[0], verts.size() );
+    CHKERR( rval );
+    CHECK( sparse_count->peak_bytes() == sparse_peak );
+    rval = mb->tag_delete( dense );
+    CHKERR( rval );
+    CHECK_EQUAL( tags_before + sparse_count->bytes(), tags.bytes() );
+    CHECK( tags.peak_bytes() >= tags_before + sparse_peak );
+    
+      // adjacency lists
+    const size_t adj_before = MemoryCounter::category( MEM_ADJACENCIES ).bytes();
+    std::vector<EntityHandle> adj;
+    rval = mb->get_adjacencies( &verts[0], 1, 3, false, adj );
+    CHKERR( rval );
+    CHECK( MemoryCounter::category( MEM_ADJACENCIES ).bytes() > adj_before );
+    
+      // set contents
+    const size_t sets_before = MemoryCounter::category( MEM_SETS ).bytes();
+    EntityHandle set;
+    rval = mb->create_meshset( MESHSET_ORDERED, set );
+    CHKERR( rval );
+    rval = mb->add_entities( set, &verts[0], verts.size() );
+    CHKERR( rval );
+    CHECK( MemoryCounter::category( MEM_SETS ).bytes() > sets_before );
+    
+      // range storage, counted only when enabled
+    const size_t ranges_before = MemoryCounter::category( MEM_RANGES ).bytes();
+    Range r;
+    for (size_t i = 0; i < verts.size(); i += 2)
+      r.insert( verts[i] );
+    CHECK_EQUAL( ranges_before, MemoryCounter::category( MEM_RANGES ).bytes() );
+    Range::count_memory( true );
+    Range r2;
+    for (size_t i = 0; i < verts.size(); i += 2)
+      r2.insert( verts[i] );
+    Range::count_memory( false );
+    CHECK( MemoryCounter::category( MEM_RANGES ).bytes() > ranges_before );
+      // counted storage is uncounted when released after disabling
+    r2.clear();
+    r2.insert( verts[0] );
+    CHECK_EQUAL( ranges_before, MemoryCounter::category( MEM_RANGES ).bytes() );
+  }
+  
+    // everything should be released with the instance
+  for (int i = 0; i < MEM_NUM_CATEGORIES; ++i) {
+    const MemoryCounter& c = MemoryCounter::category( (MemoryCategory)i );
+    CHECK_EQUAL( initial[i], c.bytes() );
+    CHECK( c.peak_bytes() >= c.bytes() );
+  }
+  
+  return MB_SUCCESS;
+}
+
+
+ErrorCode mb_float_coords_test()
+{
+  ErrorCode rval;
+  Core moab;
+  Interface* mb = &moab;
+  
+    // one vertex with double coordinates
+  const double dcoords[3] = { 0.1, 0.2, 0.3 };
+  EntityHandle dvtx;
+  rval = mb->create_vertex( dcoords, dvtx );
+  CHKERR( rval );
+  
+    // some vertices with float coordinates
+  CHECK( !moab.float_coordinates() );
+  moab.set_float_coordinates( true );
+  CHECK( moab.float_coordinates() );
+  const int N = 5;
+  double fcoords[3*N];
+  for (int i = 0; i < 3*N; ++i)
+    fcoords[i] = 0.1 * i;
+  Range fverts;
+  rval = mb->create_vertices( fcoords, N, fverts );
+  CHKERR( rval );
+  CHECK_EQUAL( (size_t)N, fverts.size() );
+  CHECK( fverts.psize() == 1 );
+  
+    // get_coords converts to double
+  double result[3*N];
+  rval = mb->get_coords( fverts, result );
+  CHKERR( rval );
+  for (int i = 0; i < 3*N; ++i)
+    CHECK_EQUAL( (double)(float)fcoords[i], result[i] );
+  rval = mb->get_coords( &dvtx, 1, result );
+  CHKERR( rval );
+  CHECK_EQUAL( dcoords[0], result[0] );
+  
+    // mixed precision in blocked form
+  Range all( fverts );
+  all.insert( dvtx );
+  std::vector<double> x( N+1 ), y( N+1 ), z( N+1 );
+  rval = mb->get_coords( all, &x[0], &y[0], &z[0] );
+  CHKERR( rval );
+  CHECK_EQUAL( dcoords[2], z[0] );
+  for (int i = 0; i < N; ++i) {
+    CHECK_EQUAL( (double)(float)fcoords[3*i  ], x[i+1] );
+    CHECK_EQUAL( (double)(float)fcoords[3*i+1], y[i+1] );
+    CHECK_EQUAL( (double)(float)fcoords[3*i+2], z[i+1] );
+  }
+  
+    // set_coords converts to float
+  const double new_coords[3] = { 1.5, -2.25, 1e-3 };
+  rval = mb->set_coords( &fverts.back(), 1, new_coords );
+  CHKERR( rval );
+  rval = mb->get_coords( &fverts.back(), 1, result );
+  CHKERR( rval );
+  CHECK_EQUAL( 1.5, result[0] );
+  CHECK_EQUAL( -2.25, result[1] );
+  CHECK_EQUAL( (double)1e-3f, result[2] );
+  
+    // coords_iterate exposes only the native type
+  double *dx, *dy, *dz;
+  float *fx, *fy, *fz;
+  int count;
+  rval = mb->coords_iterate( fverts.begin(), fverts.end(), dx, dy, dz, count );
+  CHECK_EQUAL( MB_TYPE_OUT_OF_RANGE, rval );
+  rval = mb->coords_iterate( fverts.begin(), fverts.end(), fx, fy, fz, count );
+  CHKERR( rval );
+  CHECK_EQUAL( N, count );
+  CHECK_EQUAL( 1.5f, fx[N-1] );
+  CHECK_EQUAL( (float)fcoords[1], fy[0] );
+  Range drange( dvtx, dvtx );
+  rval = mb->coords_iterate( drange.begin(), drange.end(), fx, fy, fz, count );
+  CHECK_EQUAL( MB_TYPE_OUT_OF_RANGE, rval );
+  rval = mb->coords_iterate( drange.begin(), drange.end(), dx, dy, dz, count );
+  CHKERR( rval );
+  CHECK_EQUAL( 1, count );
+  CHECK_EQUAL( dcoords[1], *dy );
+  
+    // a double-precision vertex must not be created in space 
+    // freed in a float-precision sequence, or vice versa
+  EntityHandle freed = fverts[2];
+  rval = mb->delete_entities( &freed, 1 );
+  CHKERR( rval );
+  moab.set_float_coordinates( false );
+  EntityHandle dvtx2;
+  rval = mb->create_vertex( dcoords, dvtx2 );
+  CHKERR( rval );
+  CHECK( dvtx2 != freed );
+  Range drange2( dvtx2, dvtx2 );
+  rval = mb->coords_iterate( drange2.begin(), drange2.end(), dx, dy, dz, count );
+  CHKERR( rval );
+  CHECK_EQUAL( dcoords[2], *dz );
+  moab.set_float_coordinates( true );
+  EntityHandle fvtx;
+  rval = mb->create_vertex( new_coords, fvtx );
+  CHKERR( rval );
+  Range frange( fvtx, fvtx );
+  rval = mb->coords_iterate( frange.begin(), frange.end(), fx, fy, fz, count );
+  CHKERR( rval );
+  CHECK_EQUAL( -2.25f, *fy );
+  
+    // coords_iterate stops at the end of each sequence, even if
+    // the handles in the next sequence follow on contiguously
+  for (int pass = 0; pass < 2; ++pass) {
+    Core moab2;
+    const int M = 10;
+    std::vector<double> coords( 3*M, 1.0 );
+    Range first, second, both;
+    rval = moab2.create_vertices( &coords[0], M, first );
+    CHKERR( rval );
+    moab2.set_float_coordinates( 0 == pass );
+    rval = moab2.create_vertices( &coords[0], M, second );
+    CHKERR( rval );
+    both.merge( first );
+    both.merge( second );
+    CHECK_EQUAL( (size_t)1, both.psize() );
+    rval = moab2.coords_iterate( both.begin(), both.end(), dx, dy, dz, count );
+    CHKERR( rval );
+    CHECK_EQUAL( M, count );
+    Range::const_iterator rest = both.begin() + M;
+    if (pass) 
+      rval = moab2.coords_iterate( rest, both.end(), dx, dy, dz, count );
+    else
+      rval = moab2.coords_iterate( rest, both.end(), fx, fy, fz, count );
+    CHKERR( rval );
+    CHECK_EQUAL( M, count );
+  }
+  
+  return MB_SUCCESS;
+}
+
+static bool is_aligned( const void* ptr )
+  { return 0 == ((size_t)ptr) % MB_ARRAY_ALIGNMENT; }
+
+ErrorCode mb_array_alignment_test()
+{
+  ErrorCode rval;
+  Core moab;
+  Interface* mb = &moab;
+  
+    // odd count so that arrays need padding
+  const int N = 13;
+  std::vector<double> coords( 3*N, 1.0 );
+  Range verts;
+  rval = mb->create_vertices( &coords[0], N, verts );
+  CHKERR( rval );
+  
+  double *x, *y, *z;
+  int count;
+  rval = mb->coords_iterate( verts.begin(), verts.end(), x, y, z, count );
+  CHKERR( rval );
+  CHECK_EQUAL( N, count );
+  CHECK( is_aligned( x ) );
+  CHECK( is_aligned( y ) );
+  CHECK( is_aligned( z ) );
+  
+  Tag tag;
+  const double def_val = 2.0;
+  rval = mb->tag_get_handle( "align", 1, MB_TYPE_DOUBLE, tag, 
+                             MB_TAG_DENSE|MB_TAG_EXCL, &def_val );
+  CHKERR( rval );
+  void* ptr;
+  rval = mb->tag_iterate( tag, verts.begin(), verts.end(), count, ptr );
+  CHKERR( rval );
+  CHECK( is_aligned( ptr ) );
+  
+    // aligned memory keeps its counter and alignment when resized
+  MemoryCounter counter;
+  char* mem = (char*)MemoryCounter::allocate_aligned( 10, &counter );
+  CHECK( is_aligned( mem ) );
+  CHECK_EQUAL( (size_t)MB_ARRAY_ALIGNMENT, counter.bytes() );
+  CHECK_EQUAL( (char)0, mem[MB_ARRAY_ALIGNMENT-1] );
+  mem[0] = 'a';
+  mem = (char*)MemoryCounter::reallocate( mem, MB_ARRAY_ALIGNMENT + 1 );
+  CHECK( is_aligned( mem ) );
+  CHECK_EQUAL( 'a', mem[0] );
+  CHECK_EQUAL( (size_t)2*MB_ARRAY_ALIGNMENT, counter.bytes() );
+  CHECK( &counter == MemoryCounter::owner( mem ) );
+  MemoryCounter::deallocate( mem );
+  CHECK_EQUAL( (size_t)0, counter.bytes() );
+  CHECK_EQUAL( (size_t)0, counter.allocations() );
+  
+  return MB_SUCCESS;
+}
+
+  // fill coordinates and connectivity of an N x N x 1 grid of hexes
+class GridFill : public MeshBuilder::FillTask
+{
+public:
+  GridFill( int n, EntityHandle first_vtx, double* x, double* y, double* z, EntityHandle* conn )
+    : N(n), firstVtx(first_vtx), X(x), Y(y), Z(z), connArray(conn) {}
+
+  ErrorCode fill( size_t first, size_t count )
+  {
+    for (size_t e = first; e < first + count; ++e) {
+        // each item is one hex and the vertex at its lower corner 
+      const int i = e % (N+1), j = e / (N+1) % (N+1), k = e / ((N+1)*(N+1));
+      X[e] = i;
+      Y[e] = j;
+      Z[e] = k;
+      if (i == N || j == N || k)
+        continue;
+      const EntityHandle v = firstVtx + e;
+      const EntityHandle vi = N+1, vj = (N+1)*(N+1);
+      const EntityHandle c[8] = { v, v+1, v+vi+1, v+vi, v+vj, v+vj+1, v+vj+vi+1, v+vj+vi };
+      std::copy( c, c+8, connArray + 8*(j*N+i) );
+    }
+    return MB_SUCCESS;
+  }
+
+private:
+  int N;
+  EntityHandle firstVtx;
+  double *X, *Y, *Z;
+  EntityHandle* connArray;
+};
+
+ErrorCode mb_mesh_builder_test()
+{
+  ErrorCode rval;
+  Core moab;
+  Interface* mb = &moab;
+  
+    // one hex created the usual way, with vertex adjacencies 
+    // such that the builder must update them
+  const double hex_coords[] = { 0,0,-1, 1,0,-1, 1,1,-1, 0,1,-1,
+                                0,0, 0, 1,0, 0, 1,1, 0, 0,1, 0 };
+  Range hex_verts;
+  rval = mb->create_vertices( hex_coords, 8, hex_verts );
+  CHKERR( rval );
+  std::vector<EntityHandle> hex_conn( hex_verts.begin(), hex_verts.end() );
+  EntityHandle hex;
+  rval = mb->create_element( MBHEX, &hex_conn[0], 8, hex );
+  CHKERR( rval );
+  std::vector<EntityHandle> adj;
+  rval = mb->get_adjacencies( &hex_conn[0], 1, 3, false, adj );
+  CHKERR( rval );
+  CHECK_EQUAL( (size_t)1, adj.size() );
+  
+  const int N = 10, NV = 2*(N+1)*(N+1);
+  MeshBuilder builder( mb );
+  EntityHandle first_vtx, first_hex, *conn;
+  double *x, *y, *z;
+  rval = builder.add_vertices( NV, first_vtx, x, y, z );
+  CHKERR( rval );
+  rval = builder.add_elements( MBHEX, N*N, 8, first_hex, conn );
+  CHKERR( rval );
+  GridFill task( N, first_vtx, x, y, z, conn );
+  rval = builder.parallel_fill( task, NV, 4 );
+  CHKERR( rval );
+    // share a vertex with the existing hex
+  conn[0] = hex_conn[4];
+  Range created;
+  rval = builder.commit( &created );
+  CHKERR( rval );
+  CHECK_EQUAL( (size_t)(NV + N*N), created.size() );
+  CHECK_EQUAL( first_vtx, created.front() );
+  CHECK_EQUAL( first_hex + N*N - 1, created.back() );
+  
+    // check the mesh
+  const EntityHandle* hconn;
+  int len;
+  rval = mb->get_connectivity( first_hex + N + 1, hconn, len );
+  CHKERR( rval );
+  CHECK_EQUAL( 8, len );
+  double xyz[3];
+  rval = mb->get_coords( hconn + 6, 1, xyz );
+  CHKERR( rval );
+  CHECK_EQUAL( 2.0, xyz[0] );
+  CHECK_EQUAL( 2.0, xyz[1] );
+  CHECK_EQUAL( 1.0, xyz[2] );
+  
+    // check adjacencies, including for the shared vertex
+  adj.clear();
+  const EntityHandle center = first_vtx + (N+1) + 1;
+  rval = mb->get_adjacencies( &center, 1, 3, false, adj );
+  CHKERR( rval );
+  CHECK_EQUAL( (size_t)4, adj.size() );
+  const EntityHandle exp_adj[] = { first_hex, first_hex + 1, first_hex + N, first_hex + N + 1 };
+  CHECK( std::equal( exp_adj, exp_adj + 4, adj.begin() ) );
+  adj.clear();
+  rval = mb->get_adjacencies( &hex_conn[4], 1, 3, false, adj );
+  CHKERR( rval );
+  CHECK_EQUAL( (size_t)2, adj.size() );
+  CHECK_EQUAL( hex, adj[0] );
+  CHECK_EQUAL( first_hex, adj[1] );
+  adj.clear();
+  rval = mb->get_adjacencies( &first_vtx, 1, 3, false, adj );
+  CHKERR( rval );
+  CHECK( adj.empty() );
+  
+    // unfilled connectivity is reported, but the elements are
+    // created anyway
+  EntityHandle bad_hex;
+  rval = builder.add_elements( MBHEX, 1, 8, bad_hex, conn );
+  CHKERR( rval );
+  std::copy( hex_conn.begin(), hex_conn.begin() + 7, conn );
+  rval = builder.commit();
+  CHECK_EQUAL( MB_ENTITY_NOT_FOUND, rval );
+  conn[7] = hex_conn[7];
+  rval = mb->delete_entities( &bad_hex, 1 );
+  CHKERR( rval );
+  
+    // vertices must be created in the precision requested for the instance
+  moab.set_float_coordinates( true );
+  rval = builder.add_vertices( 4, first_vtx, x, y, z );
+  CHECK_EQUAL( MB_TYPE_OUT_OF_RANGE, rval );
+  float *fx, *fy, *fz;
+  rval = builder.add_vertices( 4, first_vtx, fx, fy, fz );
+  CHKERR( rval );
+  for (int i = 0; i < 4; ++i) {
+    fx[i] = 0.5f * i;
+    fy[i] = 1.0f;
+    fz[i] = -2.0f;
+  }
+  rval = builder.commit();
+  CHKERR( rval );
+  const EntityHandle last_vtx = first_vtx + 3;
+  rval = mb->get_coords( &last_vtx, 1, xyz );
+  CHKERR( rval );
+  CHECK_EQUAL( 1.5, xyz[0] );
+  CHECK_EQUAL( 1.0, xyz[1] );
+  CHECK_EQUAL( -2.0, xyz[2] );
+  
+  return MB_SUCCESS;
+}
+
+  // get the elements adjacent to each vertex of a grid from GridFill
+static ErrorCode get_vertex_hexes( Interface* mb, EntityHandle first_vtx, int num_vtx,
+                                   std::vector< std::vector<EntityHandle> >& adj )
+{
+  adj.resize( num_vtx );
+  for (int i = 0; i < num_vtx; ++i) {
+    adj[i].clear();
+    const EntityHandle v = first_vtx + i;
+    ErrorCode rval = mb->get_adjacencies( &v, 1, 3, false, adj[i] );
+    if (MB_SUCCESS != rval)
+      return rval;
+  }
+  return MB_SUCCESS;
+}
+
+ErrorCode mb_adjacency_budget_test()
+{
+  ErrorCode rval;
+  Core moab;
+  Interface* mb = &moab;
+  
+    // two grids of hexes, with vertices in separate blocks
+  const int N = 10, NV = 2*(N+1)*(N+1);
+  EntityHandle first_vtx[2], first_hex[2], *conn;
+  double *x, *y, *z;
+  for (int b = 0; b < 2; ++b) {
+    MeshBuilder builder( mb );
+    rval = builder.add_vertices( NV, first_vtx[b], x, y, z );
+    CHKERR( rval );
+    rval = builder.add_elements( MBHEX, N*N, 8, first_hex[b], conn );
+    CHKERR( rval );
+    GridFill task( N, first_vtx[b], x, y, z, conn );
+    rval = builder.parallel_fill( task, NV, 1 );
+    CHKERR( rval );
+    rval = builder.commit();
+    CHKERR( rval );
+  }
+  
+    // an explicit adjacency that cannot be computed from connectivity
+  rval = mb->add_adjacencies( first_vtx[0], &first_hex[1], 1, false );
+  CHKERR( rval );
+  
+  std::vector< std::vector<EntityHandle> > adj0, adj1, adj;
+  rval = get_vertex_hexes( mb, first_vtx[0], NV, adj0 );
+  CHKERR( rval );
+  rval = get_vertex_hexes( mb, first_vtx[1], NV, adj1 );
+  CHKERR( rval );
+  CHECK_EQUAL( (size_t)2, adj0[0].size() );
+  CHECK_EQUAL( first_hex[1], adj0[0][1] );
+  
+    // the lists of the first block were used least recently
+  const size_t full = moab.adjacency_memory_use();
+  const size_t budget = 3 * full / 4;
+  rval = moab.set_adjacency_memory_budget( budget );
+  CHKERR( rval );
+  CHECK_EQUAL( budget, moab.adjacency_memory_budget() );
+  CHECK( moab.adjacency_memory_use() <= budget );
+  CHECK( moab.adjacency_memory_use() < full / 2 + full / 8 );
+  
+    // querying the second block doesn't restore the first
+  rval = get_vertex_hexes( mb, first_vtx[1], NV, adj );
+  CHKERR( rval );
+  CHECK( adj == adj1 );
+  CHECK( moab.adjacency_memory_use() <= budget );
+  
+    // querying the first block restores it, and the next
+    // query releases the second block
+  rval = get_vertex_hexes( mb, first_vtx[0], NV, adj );
+  CHKERR( rval );
+  CHECK( adj == adj0 );
+  CHECK( moab.adjacency_memory_use() <= budget );
+  
+    // modify lists of a released block
+  EntityHandle hex;
+  const EntityHandle hex_conn[] = { first_vtx[1], first_vtx[1] + 1, first_vtx[1] + N + 2, 
+                                    first_vtx[1] + N + 1, first_vtx[0], first_vtx[0] + 1,
+                                    first_vtx[0] + N + 2, first_vtx[0] + N + 1 };
+  rval = mb->create_element( MBHEX, hex_conn, 8, hex );
+  CHKERR( rval );
+  for (int i = 0; i < 4; ++i) {
+    adj1[hex_conn[i] - first_vtx[1]].push_back( hex );
+    adj0[hex_conn[i+4] - first_vtx[0]].push_back( hex );
+  }
+  
+    // no budget restores all lists
+  rval = moab.set_adjacency_memory_budget( 0 );
+  CHKERR( rval );
+  CHECK( moab.adjacency_memory_use() > budget );
+  rval = get_vertex_hexes( mb, first_vtx[1], NV, adj );
+  CHKERR( rval );
+  CHECK( adj == adj1 );
+  rval = get_vertex_hexes( mb, first_vtx[0], NV, adj );
+  CHKERR( rval );
+  CHECK( adj == adj0 );
+  
+  return MB_SUCCESS;
+}
+
+ErrorCode mb_adjacency_budget_cost_test()
+{
+  ErrorCode rval;
+  Core moab;
+  Interface* mb = &moab;
+  
+    // one block of vertices, larger than the unit of release
+  const int N = 60, NV = 2*(N+1)*(N+1);
+  EntityHandle first_vtx, first_hex, *conn;
+  double *x, *y, *z;
+  MeshBuilder builder( mb );
+  rval = builder.add_vertices( NV, first_vtx, x, y, z );
+  CHKERR( rval );
+  rval = builder.add_elements( MBHEX, N*N, 8, first_hex, conn );
+  CHKERR( rval );
+  GridFill task( N, first_vtx, x, y, z, conn );
+  rval = builder.parallel_fill( task, NV, 1 );
+  CHKERR( rval );
+  rval = builder.commit();
+  CHKERR( rval );
+  
+  std::vector< std::vector<EntityHandle> > adj0, adj;
+  rval = get_vertex_hexes( mb, first_vtx, NV, adj0 );
+  CHKERR( rval );
+  const size_t full = moab.adjacency_memory_use();
+  const size_t budget = full / 2;
+  rval = moab.set_adjacency_memory_budget( budget );
+  CHKERR( rval );
+  CHECK( moab.adjacency_memory_use() <= budget );
+  
+    // a query restores only part of the block, so a sweep over
+    // all vertices restores each part about once
+  const AEntityFactory* factory = moab.a_entity_factory();
+  unsigned long restores = factory->vert_adjacency_restores();
+  rval = get_vertex_hexes( mb, first_vtx, NV, adj );
+  CHKERR( rval );
+  CHECK( adj == adj0 );
+  CHECK( factory->vert_adjacency_restores() - restores <= (unsigned long)NV / 512 );
+  CHECK( moab.adjacency_memory_use() < full );
+  
+    // alternating between two vertices doesn't release either
+  const EntityHandle ends[2] = { first_vtx, first_vtx + NV - 1 };
+  restores = factory->vert_adjacency_restores();
+  for (int i = 0; i < 100; ++i) {
+    std::vector<EntityHandle> hexes;
+    rval = mb->get_adjacencies( ends + i%2, 1, 3, false, hexes );
+    CHKERR( rval );
+    CHECK( hexes == adj0[ends[i%2] - first_vtx] );
+    CHECK( moab.adjacency_memory_use() < full );
+  }
+  CHECK( factory->vert_adjacency_restores() - restores <= 2 );
+  
+  return MB_SUCCESS;
+}
+
+ErrorCode mb_bulk_delete_test()
+{
+  ErrorCode rval;
+  Core moab;
+  Interface* mb = &moab;
+  
+  const int N = 10, NV = 2*(N+1)*(N+1);
+  EntityHandle first_vtx, first_hex, *conn;
+  double *x, *y, *z;
+  MeshBuilder builder( mb );
+  rval = builder.add_vertices( NV, first_vtx, x, y, z );
+  CHKERR( rval );
+  rval = builder.add_elements( MBHEX, N*N, 8, first_hex, conn );
+  CHKERR( rval );
+  GridFill task( N, first_vtx, x, y, z, conn );
+  rval = builder.parallel_fill( task, NV, 1 );
+  CHKERR( rval );
+  Range all;
+  rval = builder.commit( &all );
+  CHKERR( rval );
+  
+    // a set that tracks its contents, and an edge explicitly 
+    // adjacent to a hex in each half of the mesh (the explicit
+    // adjacencies of an edge are returned only if there is 
+    // another edge with the same vertices)
+  EntityHandle set;
+  rval = mb->create_meshset( MESHSET_SET | MESHSET_TRACK_OWNER, set );
+  CHKERR( rval );
+  rval = mb->add_entities( set, all );
+  CHKERR( rval );
+  const EntityHandle edge_conn[] = { first_vtx, first_vtx + NV - 1 };
+  EntityHandle edges[2], edge;
+  rval = mb->create_element( MBEDGE, edge_conn, 2, edges[0] );
+  CHKERR( rval );
+  rval = mb->create_element( MBEDGE, edge_conn, 2, edges[1] );
+  CHKERR( rval );
+  edge = edges[0];
+  const EntityHandle edge_adj[] = { first_hex, first_hex + N*N - 1 };
+  rval = mb->add_adjacencies( edge, edge_adj, 2, true );
+  CHKERR( rval );
+  
+    // delete the first half of the hexes, the vertices used only
+    // by them (except those of the edge), and one vertex still in use
+  const int M = N/2;
+  Range dead;
+  dead.insert( first_hex, first_hex + M*N - 1 );
+  for (int k = 0; k < 2; ++k)
+    dead.insert( first_vtx + k*(N+1)*(N+1), first_vtx + k*(N+1)*(N+1) + M*(N+1) - 1 );
+  dead.erase( first_vtx );
+  const EntityHandle used_vtx = first_vtx + M*(N+1) + 1;
+  dead.insert( used_vtx );
+  rval = mb->delete_entities( dead );
+  CHECK_EQUAL( MB_FAILURE, rval );
+  CHECK( moab.is_valid( used_vtx ) );
+  CHECK( !moab.is_valid( first_vtx + 1 ) );
+  CHECK( !moab.is_valid( first_hex ) );
+  
+  std::vector<EntityHandle> adj;
+  rval = mb->get_adjacencies( &used_vtx, 1, 3, false, adj );
+  CHKERR( rval );
+  CHECK_EQUAL( (size_t)2, adj.size() );
+  CHECK_EQUAL( first_hex + M*N, adj[0] );
+  CHECK_EQUAL( first_hex + M*N + 1, adj[1] );
+  adj.clear();
+  rval = mb->get_adjacencies( &edge, 1, 3, false, adj );
+  CHKERR( rval );
+  CHECK_EQUAL( (size_t)1, adj.size() );
+  CHECK_EQUAL( first_hex + N*N - 1, adj[0] );
+  
+  Range contents;
+  rval = mb->get_entities_by_handle( set, contents );
+  CHKERR( rval );
+  CHECK_EQUAL( all.size() - dead.size() + 1, contents.size() );
+  CHECK( intersect( contents, dead ).size() == 1 );
+  
+    // delete everything else
+  rval = mb->delete_entities( edges, 2 );
+  CHKERR( rval );
+  rval = mb->delete_entities( contents );
+  CHKERR( rval );
+  contents.clear();
+  rval = mb->get_entities_by_handle( set, contents );
+  CHKERR( rval );
+  CHECK( contents.empty() );
+  CHECK_EQUAL( (size_t)0, moab.adjacency_memory_use() );
+  
+  return MB_SUCCESS;
+}
+
+ErrorCode mb_bulk_delete_invalid_test()
+{
+  ErrorCode rval;
+  Core moab;
+  Interface* mb = &moab;
+  
+    // two triangles sharing an edge, with tagged vertices and triangles
+  const double coords[] = { 0,0,0, 1,0,0, 0,1,0, 1,1,0 };
+  Range vert_range;
+  rval = mb->create_vertices( coords, 4, vert_range );
+  CHKERR( rval );
+  std::vector<EntityHandle> verts( vert_range.begin(), vert_range.end() );
+  const EntityHandle conn[2][3] = { { verts[0], verts[1], verts[2] },
+                                    { verts[1], verts[3], verts[2] } };
+  EntityHandle tris[2];
+  for (int i = 0; i < 2; ++i) {
+    rval = mb->create_element( MBTRI, conn[i], 3, tris[i] );
+    CHKERR( rval );
+  }
+  Tag tag;
+  const int zero = 0;
+  rval = mb->tag_get_handle( "bulk_delete_invalid", 1, MB_TYPE_INTEGER, tag,
+                             MB_TAG_SPARSE|MB_TAG_CREAT, &zero );
+  CHKERR( rval );
+  const int values[] = { 1, 2, 3, 4 };
+  rval = mb->tag_set_data( tag, &verts[0], 4, values );
+  CHKERR( rval );
+  rval = mb->tag_set_data( tag, tris, 2, values );
+  CHKERR( rval );
+  std::vector<EntityHandle> adj;
+  rval = mb->get_adjacencies( &verts[1], 1, 2, false, adj );
+  CHKERR( rval );
+  CHECK_EQUAL( (size_t)2, adj.size() );
+  
+    // a stale handle fails, but doesn't keep the others from being deleted
+  rval = mb->delete_entities( tris, 1 );
+  CHKERR( rval );
+  Range dead;
+  dead.insert( tris[0] );
+  dead.insert( tris[1] );
+  rval = mb->delete_entities( dead );
+  CHECK( MB_SUCCESS != rval );
+  CHECK( !moab.is_valid( tris[1] ) );
+  for (int i = 0; i < 4; ++i) {
+    adj.clear();
+    rval = mb->get_adjacencies( &verts[i], 1, 2, false, adj );
+    CHKERR( rval );
+    CHECK( adj.empty() );
+  }
+  
+    // an entity that cannot be deleted keeps its tag data
+  EntityHandle tri;
+  rval = mb->create_element( MBTRI, conn[0], 3, tri );
+  CHKERR( rval );
+  dead.clear();
+  dead.insert( verts[0] );
+  dead.insert( verts[3] );
+  dead.insert( tris[1] );
+  rval = mb->delete_entities( dead );
+  CHECK( MB_SUCCESS != rval );
+  CHECK( moab.is_valid( verts[0] ) );
+  CHECK( !moab.is_valid( verts[3] ) );
+  int value;
+  rval = mb->tag_get_data( tag, &verts[0], 1, &value );
+  CHKERR( rval );
+  CHECK_EQUAL( 1, value );
+  adj.clear();
+  rval = mb->get_adjacencies( &verts[0], 1, 2, false, adj );
+  CHKERR( rval );
+  CHECK_EQUAL( (size_t)1, adj.size() );
+  CHECK_EQUAL( tri, adj[0] );
+  
+  return MB_SUCCESS;
+}
 
 static void usage(const char* exe) {
   cerr << "Usage: " << exe << " [-nostress] [-d input_file_dir]\n";
@@ -8279,7 +9595,21 @@ int main(int argc, char* argv[])
   RUN_TEST( mb_merge_update_test );
   RUN_TEST( mb_type_is_maxtype_test );
   RUN_TEST( mb_root_set_test );
+  RUN_TEST( mb_read_only_phase_test );
+  RUN_TEST( mb_compact_vert_adjacencies_test );
+  RUN_TEST( mb_vert_elem_adjacencies_threads_test );
+  RUN_TEST( mb_scd_vert_adjacencies_test );
+  RUN_TEST( mb_scd_raw_adjacencies_test );
+  RUN_TEST( mb_topo_util_construct_sides_test );
   RUN_TEST( mb_merge_test );
+  RUN_TEST( mb_memory_counter_test );
+  RUN_TEST( mb_float_coords_test );
+  RUN_TEST( mb_array_alignment_test );
+  RUN_TEST( mb_mesh_builder_test );
+  RUN_TEST( mb_adjacency_budget_test );
+  RUN_TEST( mb_adjacency_budget_cost_test );
+  RUN_TEST( mb_bulk_delete_test );
+  RUN_TEST( mb_bulk_delete_invalid_test );
 #if NETCDF_FILE
   if (stress_test) RUN_TEST( mb_stress_test );
 #endif
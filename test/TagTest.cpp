@@ -2,7 +2,10 @@
 #include "moab/Range.hpp"
 #include "TestUtil.hpp"
 #include <stdlib.h>
+#include <time.h>
 #include <algorithm>
+#include <iostream>
+#include <sstream>
 
 using namespace moab;
 
@@ -32,11 +35,16 @@ void test_get_set_variable_length_dense();
 void test_get_set_variable_length_mesh();
 void test_get_ents_with_default_value();
 void test_bit_tag_big();
+void test_bit_tag_search();
+void test_sparse_tag_big();
+void test_tag_value_index();
 void test_clear_dense();
 void test_clear_sparse();
 void test_clear_bit();
 void test_clear_dense_varlen();
 void test_clear_sparse_varlen();
+void test_set_packed_varlen_sparse();
+void test_set_packed_varlen_dense();
 void test_tag_iterate_sparse();
 void test_tag_iterate_dense();
 void test_tag_iterate_sparse_default();
@@ -76,6 +84,9 @@ int main()
   failures += RUN_TEST( test_get_set_variable_length_mesh );  
   failures += RUN_TEST( test_get_ents_with_default_value );  
   failures += RUN_TEST( test_bit_tag_big );  
+  failures += RUN_TEST( test_bit_tag_search );
+  failures += RUN_TEST( test_sparse_tag_big );
+  failures += RUN_TEST( test_tag_value_index );
   failures += RUN_TEST( regression_one_entity_by_var_tag );
   failures += RUN_TEST( regression_tag_on_nonexistent_entity );
   failures += RUN_TEST( test_clear_dense );
@@ -83,6 +94,8 @@ int main()
   failures += RUN_TEST( test_clear_bit );
   failures += RUN_TEST( test_clear_dense_varlen );
   failures += RUN_TEST( test_clear_sparse_varlen );
+  failures += RUN_TEST( test_set_packed_varlen_sparse );
+  failures += RUN_TEST( test_set_packed_varlen_dense );
   failures += RUN_TEST( test_tag_iterate_sparse );
   failures += RUN_TEST( test_tag_iterate_dense );
   failures += RUN_TEST( test_tag_iterate_sparse_default );
@@ -1945,6 +1958,323 @@ void test_bit_tag_big()
   CHECK_EQUAL( values.size(), first_one );
 }
 
+void test_bit_tag_search()
+{
+  Core moab;
+  Interface &mb = moab;
+  ErrorCode rval;
+  const size_t NUM_VTX = 70000; // more than one page for any tag size
+
+  std::vector<double> coords(3*NUM_VTX,0.0);
+  Range verts;
+  rval = mb.create_vertices( &coords[0], NUM_VTX, verts );
+  CHECK_ERR( rval );
+  
+    // Search a subset of the vertices consisting of blocks that
+    // begin and end at arbitrary offsets within page words and bytes.
+  Range subset;
+  Range::iterator it = verts.begin();
+  for (size_t i = 0; i < NUM_VTX; ++i, ++it)
+    if ((i / 173) % 3 != 1)
+      subset.insert( *it );
+  
+  const int bits[] = { 1, 2, 3, 4, 8 };
+  for (int b = 0; b < 5; ++b) {
+    const unsigned char mask = (unsigned char)((1u << bits[b]) - 1);
+    const unsigned char def = 1;
+    std::ostringstream name;
+    name << "search" << bits[b];
+    Tag tag = test_create_tag( mb, name.str().c_str(), bits[b], MB_TAG_BIT, MB_TYPE_BIT, &def );
+    
+      // long runs of the same value with scattered other values 
+    std::vector<unsigned char> values( NUM_VTX );
+    for (size_t i = 0; i < NUM_VTX; ++i)
+      values[i] = (unsigned char)(((i / 1000) % 2 ? i % 7 : (i % 13 ? 0 : 2)) & mask);
+    rval = mb.tag_set_data( tag, verts, &values[0] );
+    CHECK_ERR( rval );
+    std::vector<unsigned char> values2( NUM_VTX );
+    rval = mb.tag_get_data( tag, verts, &values2[0] );
+    CHECK_ERR( rval );
+    CHECK( values == values2 );
+    
+    for (unsigned v = 0; v <= mask && v < 8; ++v) {
+      const unsigned char value = (unsigned char)v;
+      Range expected, expected_subset;
+      it = verts.begin();
+      for (size_t i = 0; i < NUM_VTX; ++i, ++it) 
+        if (values[i] == value) {
+          expected.insert( *it );
+          if (subset.find( *it ) != subset.end())
+            expected_subset.insert( *it );
+        }
+      
+      const void* vals[] = { &value };
+      Range results;
+      rval = mb.get_entities_by_type_and_tag( 0, MBVERTEX, &tag, vals, 1, results );
+      CHECK_ERR( rval );
+      CHECK_EQUAL( expected, results );
+      
+      results = subset;
+      rval = mb.get_entities_by_type_and_tag( 0, MBVERTEX, &tag, vals, 1, results, Interface::INTERSECT );
+      CHECK_ERR( rval );
+      CHECK_EQUAL( expected_subset, results );
+      
+      int count = -1;
+      rval = mb.get_number_entities_by_type_and_tag( 0, MBVERTEX, &tag, vals, 1, count );
+      CHECK_ERR( rval );
+      CHECK_EQUAL( (int)expected.size(), count );
+    }
+    
+      // clear some values back to the default and count again
+    Range cleared;
+    cleared.insert( verts.front() + 5, verts.front() + 40000 );
+    std::vector<unsigned char> defvals( cleared.size(), def );
+    rval = mb.tag_set_data( tag, cleared, &defvals[0] );
+    CHECK_ERR( rval );
+    size_t expected = cleared.size();
+    for (size_t i = 0; i < NUM_VTX; ++i) 
+      if ((i < 5 || i > 40000) && values[i] == def)
+        ++expected;
+    const void* vals[] = { &def };
+    int count = -1;
+    rval = mb.get_number_entities_by_type_and_tag( 0, MBVERTEX, &tag, vals, 1, count );
+    CHECK_ERR( rval );
+    CHECK_EQUAL( (int)expected, count );
+  }
+}
+
+void test_sparse_tag_big()
+{
+  Core moab;
+  Interface &mb = moab;
+  ErrorCode rval;
+  const size_t NUM_VTX = 100000;
+
+    // create a lot of vertices
+  std::vector<double> coords(3*NUM_VTX,0.0);
+  Range verts;
+  rval = mb.create_vertices( &coords[0], NUM_VTX, verts );
+  CHECK_ERR( rval );
+  CHECK_EQUAL( NUM_VTX, (size_t)verts.size() );
+
+    // store handle as tag value on every vertex
+  Tag tag = test_create_tag( mb, "sparse_big", 1, MB_TAG_SPARSE, MB_TYPE_HANDLE, 0 );
+  std::vector<EntityHandle> values( verts.begin(), verts.end() );
+  clock_t t = clock();
+  rval = mb.tag_set_data( tag, verts, &values[0] );
+  CHECK_ERR( rval );
+  double set_time = (double)(clock() - t) / CLOCKS_PER_SEC;
+  
+  std::vector<EntityHandle> values2( NUM_VTX, 0 );
+  t = clock();
+  rval = mb.tag_get_data( tag, verts, &values2[0] );
+  CHECK_ERR( rval );
+  double get_time = (double)(clock() - t) / CLOCKS_PER_SEC;
+  CHECK( values == values2 );
+  
+    // Slots of a handle and value pointer are in a table that is at 
+    // least 3/8 full, and values are pooled in blocks of at most 4096.
+  unsigned long tag_mem, tag_am;
+  mb.estimated_memory_use( verts, 0, 0, 0, 0, 0, 0, &tag, 1, &tag_mem, &tag_am );
+  CHECK( tag_am < NUM_VTX * (2 * sizeof(EntityHandle) * 8 / 3 + sizeof(EntityHandle)) 
+                  + 4096 * sizeof(EntityHandle) + 1024 );
+  std::cout << "sparse handle tag: " << (double)tag_am / NUM_VTX 
+            << " bytes/entity, set " << set_time << " s, get " 
+            << get_time << " s for " << NUM_VTX << " entities" << std::endl;
+  
+    // pointers to values must survive changes to other entities
+  const EntityHandle stable = (verts.front() % 2) ? verts[1] : verts[0];
+  const void* stable_ptr;
+  rval = mb.tag_get_by_ptr( tag, &stable, 1, &stable_ptr );
+  CHECK_ERR( rval );
+
+    // remove every other value, one at a time
+  Range removed, kept;
+  for (Range::iterator j = verts.begin(); j != verts.end(); ++j) {
+    if (*j % 2) {
+      rval = mb.tag_delete_data( tag, &*j, 1 );
+      CHECK_ERR( rval );
+      removed.insert( *j );
+    }
+    else {
+      kept.insert( *j );
+    }
+  }
+  
+    // check that remaining values are unchanged
+  for (Range::iterator j = kept.begin(); j != kept.end(); ++j) {
+    EntityHandle value;
+    rval = mb.tag_get_data( tag, &*j, 1, &value );
+    CHECK_ERR( rval );
+    CHECK_EQUAL( *j, value );
+  }
+  for (Range::iterator j = removed.begin(); j != removed.end(); ++j) {
+    EntityHandle value;
+    rval = mb.tag_get_data( tag, &*j, 1, &value );
+    CHECK_EQUAL( MB_TAG_NOT_FOUND, rval );
+  }
+  Range tagged;
+  rval = mb.get_entities_by_type_and_tag( 0, MBVERTEX, &tag, 0, 1, tagged );
+  CHECK_ERR( rval );
+  CHECK_EQUAL( kept, tagged );
+  
+    // a range query fails for entities without a value, until
+    // they are given one by a range clear
+  rval = mb.tag_get_data( tag, verts, &values2[0] );
+  CHECK_EQUAL( MB_TAG_NOT_FOUND, rval );
+  const EntityHandle zero = 0;
+  rval = mb.tag_clear_data( tag, removed, &zero );
+  CHECK_ERR( rval );
+  rval = mb.tag_get_data( tag, verts, &values2[0] );
+  CHECK_ERR( rval );
+  for (size_t i = 0; i < NUM_VTX; ++i)
+    CHECK_EQUAL( values[i] % 2 ? zero : values[i], values2[i] );
+  const void* ptr;
+  rval = mb.tag_get_by_ptr( tag, &stable, 1, &ptr );
+  CHECK_ERR( rval );
+  CHECK( stable_ptr == ptr );
+  CHECK_EQUAL( stable, *reinterpret_cast<const EntityHandle*>(stable_ptr) );
+
+    // tag values too large to be stored inline
+  const int LEN = 12;
+  Tag big = test_create_tag( mb, "sparse_big_dbl", LEN, MB_TAG_SPARSE, MB_TYPE_DOUBLE, 0 );
+  std::vector<double> dvals( LEN * removed.size() );
+  for (size_t i = 0; i < dvals.size(); ++i)
+    dvals[i] = i;
+  rval = mb.tag_set_data( big, removed, &dvals[0] );
+  CHECK_ERR( rval );
+  rval = mb.tag_delete_data( big, kept );
+  CHECK_EQUAL( MB_TAG_NOT_FOUND, rval );
+  std::vector<double> dvals2( dvals.size(), -1.0 );
+  rval = mb.tag_get_data( big, removed, &dvals2[0] );
+  CHECK_ERR( rval );
+  CHECK( dvals == dvals2 );
+  rval = mb.tag_delete_data( big, removed );
+  CHECK_ERR( rval );
+  tagged.clear();
+  rval = mb.get_entities_by_type_and_tag( 0, MBVERTEX, &big, 0, 1, tagged );
+  CHECK_ERR( rval );
+  CHECK( tagged.empty() );
+  
+    // untagged entities get a pointer to the default value, without
+    // allocating storage for them
+  const int def_val = 42;
+  Tag deftag = test_create_tag( mb, "sparse_big_def", 1, MB_TAG_SPARSE, MB_TYPE_INTEGER, &def_val );
+  rval = mb.tag_get_by_ptr( deftag, &stable, 1, &ptr );
+  CHECK_ERR( rval );
+  CHECK_EQUAL( def_val, *reinterpret_cast<const int*>(ptr) );
+  tagged.clear();
+  rval = mb.get_entities_by_type_and_tag( 0, MBVERTEX, &deftag, 0, 1, tagged );
+  CHECK_ERR( rval );
+  CHECK( tagged.empty() );
+}
+
+static void check_packed_values( Interface& mb, Tag tag, const Range& ents,
+                                 const std::vector<int>& packed,
+                                 const std::vector<int>& offsets )
+{
+  std::vector<const void*> ptrs( ents.size() );
+  std::vector<int> sizes( ents.size() );
+  ErrorCode rval = mb.tag_get_by_ptr( tag, ents, &ptrs[0], &sizes[0] );
+  CHECK_ERR( rval );
+  for (size_t i = 0; i < ents.size(); ++i) {
+    CHECK_EQUAL( offsets[i+1] - offsets[i], sizes[i] );
+    const int* vals = reinterpret_cast<const int*>(ptrs[i]);
+    for (int j = 0; j < sizes[i]; ++j)
+      CHECK_EQUAL( packed[offsets[i]+j], vals[j] );
+  }
+}
+
+void test_set_packed_variable_length( TagType storage )
+{
+  Core moab;
+  Interface &mb = moab;
+  ErrorCode rval;
+  const size_t NUM_VTX = 20000;
+
+  std::vector<double> coords(3*NUM_VTX,0.0);
+  Range verts;
+  rval = mb.create_vertices( &coords[0], NUM_VTX, verts );
+  CHECK_ERR( rval );
+  Tag tag = test_create_var_len_tag( mb, "packed", storage, MB_TYPE_INTEGER, 0, 0 );
+  
+    // Overwrite all values several times with values of varying 
+    // length, such that some are stored inline and some are not
+    // and the tag must eventually discard the unused space.
+  std::vector<int> packed, offsets;
+  for (int pass = 0; pass < 5; ++pass) {
+    packed.clear();
+    offsets.clear();
+    for (size_t i = 0; i < NUM_VTX; ++i) {
+      offsets.push_back( packed.size() );
+      int len = 1 + (i + pass) % 12;
+      for (int j = 0; j < len; ++j)
+        packed.push_back( (int)(i + j + pass) );
+    }
+    offsets.push_back( packed.size() );
+    rval = mb.tag_set_packed_data( tag, verts, &packed[0], &offsets[0] );
+    CHECK_ERR( rval );
+    check_packed_values( mb, tag, verts, packed, offsets );
+  }
+  
+    // set values for individual entities
+  const EntityHandle ents[] = { verts.front(), verts.back() };
+  const int vals[] = { -1, -2, -3, -4, -5, -6, -7, -8, -9 };
+  const int offs[] = { 0, 1, 9 };
+  rval = mb.tag_set_packed_data( tag, ents, 2, vals, offs );
+  CHECK_ERR( rval );
+  int len;
+  const void* ptr;
+  rval = mb.tag_get_by_ptr( tag, ents, 1, &ptr, &len );
+  CHECK_ERR( rval );
+  CHECK_EQUAL( 1, len );
+  CHECK_EQUAL( -1, *reinterpret_cast<const int*>(ptr) );
+  rval = mb.tag_get_by_ptr( tag, ents+1, 1, &ptr, &len );
+  CHECK_ERR( rval );
+  CHECK_EQUAL( 8, len );
+  CHECK_ARRAYS_EQUAL( vals+1, 8, reinterpret_cast<const int*>(ptr), 8 );
+
+    // offsets that decrease or start before the buffer are rejected
+  const int bad_offs[] = { 0, 5, 1 };
+  rval = mb.tag_set_packed_data( tag, ents, 2, vals, bad_offs );
+  CHECK_EQUAL( MB_INDEX_OUT_OF_RANGE, rval );
+  const int neg_offs[] = { -1, 1, 9 };
+  rval = mb.tag_set_packed_data( tag, ents, 2, vals, neg_offs );
+  CHECK_EQUAL( MB_INDEX_OUT_OF_RANGE, rval );
+  rval = mb.tag_get_by_ptr( tag, ents, 1, &ptr, &len );
+  CHECK_ERR( rval );
+  CHECK_EQUAL( 1, len );
+  CHECK_EQUAL( -1, *reinterpret_cast<const int*>(ptr) );
+
+    // remove every other value and check the rest
+  Range removed, kept;
+  for (Range::iterator i = verts.begin(); i != verts.end(); ++i)
+    (*i % 2 ? removed : kept).insert( *i );
+  kept.erase( verts.front() );
+  kept.erase( verts.back() );
+  removed.erase( verts.front() );
+  removed.erase( verts.back() );
+  rval = mb.tag_delete_data( tag, removed );
+  CHECK_ERR( rval );
+  std::vector<int> kept_packed, kept_offsets;
+  Range::iterator r = verts.begin();
+  for (size_t i = 0; i < NUM_VTX; ++i, ++r) {
+    if (kept.find( *r ) == kept.end())
+      continue;
+    kept_offsets.push_back( kept_packed.size() );
+    kept_packed.insert( kept_packed.end(), packed.begin() + offsets[i],
+                        packed.begin() + offsets[i+1] );
+  }
+  kept_offsets.push_back( kept_packed.size() );
+  check_packed_values( mb, tag, kept, kept_packed, kept_offsets );
+}
+
+void test_set_packed_varlen_sparse()
+  { test_set_packed_variable_length( MB_TAG_SPARSE ); }
+
+void test_set_packed_varlen_dense()
+  { test_set_packed_variable_length( MB_TAG_DENSE ); }
+
 void setup_mesh( Interface& mb )
 {
   Range vertex_handles;
@@ -2256,3 +2586,178 @@ void test_tag_iterate_invalid()
   
     
 
+
+  // check that query of indexed tag gives same result as unindexed tag
+static void check_value_query( Interface& mb, Tag indexed, Tag plain, 
+                               EntityType type, int value )
+{
+  const void* ptr = &value;
+  Range expected, actual;
+  ErrorCode rval = mb.get_entities_by_type_and_tag( 0, type, &plain, &ptr, 1, expected );
+  CHECK_ERR( rval );
+  rval = mb.get_entities_by_type_and_tag( 0, type, &indexed, &ptr, 1, actual );
+  CHECK_ERR( rval );
+  CHECK_EQUAL( expected, actual );
+}
+
+void test_tag_value_index()
+{
+  Core moab;
+  Interface &mb = moab;
+  ErrorCode rval;
+  const int NUM_VTX = 10000, NUM_VAL = 50;
+
+  std::vector<double> coords(3*NUM_VTX,0.0);
+  Range verts;
+  rval = mb.create_vertices( &coords[0], NUM_VTX, verts );
+  CHECK_ERR( rval );
+  
+    // bit and variable-length tags cannot be indexed
+  Tag bit = test_create_tag( mb, "index_bit", 2, MB_TAG_BIT, MB_TYPE_BIT, 0 );
+  CHECK_EQUAL( MB_TYPE_OUT_OF_RANGE, mb.tag_set_value_index( bit ) );
+  Tag vtag;
+  rval = mb.tag_get_handle( "index_var", 0, MB_TYPE_INTEGER, vtag, MB_TAG_SPARSE|MB_TAG_VARLEN|MB_TAG_EXCL );
+  CHECK_ERR( rval );
+  CHECK_EQUAL( MB_TYPE_OUT_OF_RANGE, mb.tag_set_value_index( vtag ) );
+    // neither can values larger than the fixed key size
+  Tag big = test_create_tag( mb, "index_big", 4, MB_TAG_SPARSE, MB_TYPE_DOUBLE, 0 );
+  CHECK_EQUAL( MB_TYPE_OUT_OF_RANGE, mb.tag_set_value_index( big ) );
+  Tag vec = test_create_tag( mb, "index_vec", 3, MB_TAG_SPARSE, MB_TYPE_DOUBLE, 0 );
+  CHECK_ERR( mb.tag_set_value_index( vec ) );
+
+  const int def_val = -1;
+  for (int storage = 0; storage < 2; ++storage) {
+    const TagType tt = storage ? MB_TAG_DENSE : MB_TAG_SPARSE;
+    const void* def = storage ? &def_val : 0;
+    Tag tags[2];
+    tags[0] = test_create_tag( mb, storage ? "index_d" : "index_s", 1, tt, MB_TYPE_INTEGER, def );
+    tags[1] = test_create_tag( mb, storage ? "plain_d" : "plain_s", 1, tt, MB_TYPE_INTEGER, def );
+    Tag indexed = tags[0], plain = tags[1];
+    rval = mb.tag_set_value_index( indexed );
+    CHECK_ERR( rval );
+    
+      // tag every other vertex
+    Range tagged;
+    std::vector<int> values;
+    for (Range::iterator i = verts.begin(); i != verts.end(); i += 2) {
+      tagged.insert( *i );
+      values.push_back( (int)(*i % NUM_VAL) );
+    }
+    for (int t = 0; t < 2; ++t) {
+      rval = mb.tag_set_data( tags[t], tagged, &values[0] );
+      CHECK_ERR( rval );
+    }
+    for (int v = -1; v <= NUM_VAL; ++v)
+      check_value_query( mb, indexed, plain, MBVERTEX, v );
+    check_value_query( mb, indexed, plain, MBHEX, 1 );
+    
+      // change some values, clear others, and remove some
+    int new_val = 7, count;
+    for (int t = 0; t < 2; ++t) {
+      rval = mb.tag_set_data( tags[t], &*verts.begin(), 1, &new_val );
+      CHECK_ERR( rval );
+      rval = mb.tag_clear_data( tags[t], Range( verts[10], verts[100] ), &new_val );
+      CHECK_ERR( rval );
+      rval = mb.tag_delete_data( tags[t], intersect( tagged, Range( verts[200], verts[300] ) ) );
+      CHECK_ERR( rval );
+    }
+    for (int v = -1; v <= NUM_VAL; ++v)
+      check_value_query( mb, indexed, plain, MBVERTEX, v );
+    
+      // change values through direct pointer
+    for (int t = 0; t < 2; ++t) {
+      void* ptr;
+      rval = mb.tag_iterate( tags[t], verts.begin()+2, verts.end(), count, ptr );
+      CHECK_ERR( rval );
+      CHECK( count > 0 );
+      reinterpret_cast<int*>(ptr)[0] = 3;
+    }
+      // out-of-date index must not be used until it is rebuilt
+    for (int v = -1; v <= NUM_VAL; ++v)
+      check_value_query( mb, indexed, plain, MBVERTEX, v );
+    rval = mb.tag_set_value_index( indexed );
+    CHECK_ERR( rval );
+    for (int v = -1; v <= NUM_VAL; ++v)
+      check_value_query( mb, indexed, plain, MBVERTEX, v );
+    
+      // read-only access does not invalidate the index
+    rval = mb.begin_read_only_phase( false );
+    CHECK_ERR( rval );
+    for (int t = 0; t < 2; ++t) {
+      void* ptr;
+      rval = mb.tag_iterate( tags[t], verts.begin(), verts.end(), count, ptr, false );
+      CHECK_ERR( rval );
+    }
+    for (int v = -1; v <= NUM_VAL; ++v)
+      check_value_query( mb, indexed, plain, MBVERTEX, v );
+    rval = mb.end_read_only_phase();
+    CHECK_ERR( rval );
+    
+      // delete some entities
+    Range dead( verts[500], verts[600] );
+    rval = mb.delete_entities( dead );
+    CHECK_ERR( rval );
+    verts = subtract( verts, dead );
+    EntityHandle one_dead = verts[1000];
+    rval = mb.delete_entities( &one_dead, 1 );
+    CHECK_ERR( rval );
+    verts.erase( one_dead );
+    for (int v = -1; v <= NUM_VAL; ++v)
+      check_value_query( mb, indexed, plain, MBVERTEX, v );
+    
+      // query of a value combined with other tag
+    const void* vals[2] = { &new_val, 0 };
+    Tag two[2] = { indexed, bit };
+    Range result;
+    rval = mb.get_entities_by_type_and_tag( 0, MBVERTEX, two, vals, 2, result, Interface::UNION );
+    CHECK_ERR( rval );
+    
+      // time repeated queries
+    clock_t t = clock();
+    for (int v = 0; v < NUM_VAL; ++v) {
+      const void* ptr = &v;
+      result.clear();
+      rval = mb.get_entities_by_type_and_tag( 0, MBVERTEX, &plain, &ptr, 1, result );
+      CHECK_ERR( rval );
+    }
+    double plain_time = (double)(clock() - t) / CLOCKS_PER_SEC;
+    t = clock();
+    for (int v = 0; v < NUM_VAL; ++v) {
+      const void* ptr = &v;
+      result.clear();
+      rval = mb.get_entities_by_type_and_tag( 0, MBVERTEX, &indexed, &ptr, 1, result );
+      CHECK_ERR( rval );
+    }
+    double index_time = (double)(clock() - t) / CLOCKS_PER_SEC;
+    std::cout << (storage ? "dense" : "sparse") << " tag query by value: " 
+              << plain_time << " s unindexed, " << index_time << " s indexed" << std::endl;
+    
+      // disabling index should not change results
+    rval = mb.tag_set_value_index( indexed, false );
+    CHECK_ERR( rval );
+    for (int v = -1; v <= NUM_VAL; ++v)
+      check_value_query( mb, indexed, plain, MBVERTEX, v );
+    
+      // enabling index for existing values builds it immediately
+    rval = mb.tag_set_value_index( indexed );
+    CHECK_ERR( rval );
+    for (int v = -1; v <= NUM_VAL; ++v)
+      check_value_query( mb, indexed, plain, MBVERTEX, v );
+  }
+  
+    // index vector-valued tag
+  const double vals3[3][3] = { { 1, 2, 3 }, { 1, 2, 4 }, { 0, 2, 3 } };
+  std::vector<double> vecvals;
+  for (size_t i = 0; i < verts.size(); ++i)
+    vecvals.insert( vecvals.end(), vals3[i%3], vals3[i%3] + 3 );
+  rval = mb.tag_set_data( vec, verts, &vecvals[0] );
+  CHECK_ERR( rval );
+  for (int i = 0; i < 3; ++i) {
+    Range result;
+    const void* ptr = vals3[i];
+    rval = mb.get_entities_by_type_and_tag( 0, MBVERTEX, &vec, &ptr, 1, result );
+    CHECK_ERR( rval );
+    CHECK_EQUAL( (verts.size() + 2 - i) / 3, result.size() );
+    CHECK( !result.empty() && (size_t)(verts.index( result.front() )) % 3 == (size_t)i );
+  }
+}
@@ -10,6 +10,8 @@ void test_basic();
 void test_lower_bound();
 void test_upper_bound();
 void test_find();
+void test_find_read_only();
+void test_find_fragmented();
 void test_get_entities();
 void test_insert_sequence_merge();
 void test_insert_sequence_nomerge();
@@ -63,6 +65,8 @@ int main( )
   error_count += RUN_TEST( test_lower_bound );
   error_count += RUN_TEST( test_upper_bound );
   error_count += RUN_TEST( test_find );
+  error_count += RUN_TEST( test_find_read_only );
+  error_count += RUN_TEST( test_find_fragmented );
   error_count += RUN_TEST( test_get_entities );
   error_count += RUN_TEST( test_insert_sequence_merge );
   error_count += RUN_TEST( test_insert_sequence_nomerge );
@@ -309,6 +313,106 @@ void test_find()
   CHECK_EQUAL( NULL, seq );
 }
 
+void test_find_read_only()
+{
+  TypeSequenceManager seqman;
+  EntitySequence *seq1, // 3 to 7
+                 *seq2, // 100 to 111
+                 *seq3, // 1001
+                 *seq;
+  make_basic_sequence( seqman, seq1, seq2, seq3 );
+  
+  seq = seqman.find( 4 );
+  CHECK_EQUAL( seq1, seq );
+  CHECK( seq1 == seqman.get_last_accessed() );
+  
+    // lookups should succeed but not change cached sequence
+  seqman.set_read_only_phase( true );
+  CHECK( seqman.read_only_phase() );
+  seq = seqman.find( 100 );
+  CHECK_EQUAL( seq2, seq );
+  CHECK( seq1 == seqman.get_last_accessed() );
+  CHECK_ERR( seqman.find( 1001, seq ) );
+  CHECK_EQUAL( seq3, seq );
+  CHECK( seq1 == seqman.get_last_accessed() );
+  const TypeSequenceManager& const_seqman = seqman;
+  const EntitySequence* const_seq;
+  CHECK_ERR( const_seqman.find( 111, const_seq ) );
+  CHECK( seq2 == const_seq );
+  CHECK( seq1 == seqman.get_last_accessed() );
+  CHECK_EQUAL( (EntitySequence*)0, seqman.find( 99 ) );
+  CHECK( seq1 == seqman.get_last_accessed() );
+  
+    // cache should be updated again after leaving read-only phase
+  seqman.set_read_only_phase( false );
+  CHECK( !seqman.read_only_phase() );
+  seq = seqman.find( 1001 );
+  CHECK_EQUAL( seq3, seq );
+  CHECK( seq3 == seqman.get_last_accessed() );
+}
+
+/* Look up every handle in [1,exists.size()] in a scattered order
+ * (defeating the last-referenced cache) and compare the result 
+ * against the expected state of each handle.
+ */
+static void check_find_all( TypeSequenceManager& seqman,
+                            const std::vector<bool>& exists )
+{
+  const EntityHandle count = exists.size();
+  const EntityHandle step = 7919; // prime, so visits all handles
+  for (EntityHandle i = 0; i < count; ++i) {
+    EntityHandle h = (i * step) % count + 1;
+    EntitySequence* seq = seqman.find( h );
+    if (exists[h-1]) {
+      CHECK( seq != 0 );
+      CHECK( seq->start_handle() <= h );
+      CHECK( seq->end_handle() >= h );
+    }
+    else {
+      CHECK_EQUAL( (EntitySequence*)0, seq );
+    }
+  }
+}
+
+void test_find_fragmented()
+{
+  TypeSequenceManager seqman;
+  const EntityHandle count = 10000;
+  std::vector<bool> exists( count, false );
+  SequenceData* data = new SequenceData( 0, 1, count );
+  Error eh;
+  
+    // create a single-entity sequence for every other handle
+  for (EntityHandle h = 1; h <= count; h += 2) {
+    CHECK_ERR( insert_seq( seqman, h, 1, data ) );
+    exists[h-1] = true;
+  }
+  CHECK_EQUAL( (unsigned long)count/2, seqman.get_sequence_count() );
+  check_find_all( seqman, exists );
+  
+    // delete every other remaining handle
+  for (EntityHandle h = 1; h <= count; h += 4) {
+    CHECK_ERR( seqman.erase( &eh, h ) );
+    exists[h-1] = false;
+  }
+  CHECK_EQUAL( (unsigned long)count/4, seqman.get_sequence_count() );
+  check_find_all( seqman, exists );
+  
+    // fill in all even handles, merging sequences 
+  for (EntityHandle h = 2; h <= count; h += 2) {
+    CHECK_ERR( insert_seq( seqman, h, 1, data ) );
+    exists[h-1] = true;
+  }
+  check_find_all( seqman, exists );
+  
+    // split sequences by deleting from the middle
+  for (EntityHandle h = 3; h <= count; h += 12) {
+    CHECK_ERR( seqman.erase( &eh, h ) );
+    exists[h-1] = false;
+  }
+  check_find_all( seqman, exists );
+}
+
 bool seqman_equal( const EntityHandle pair_array[][2],
                      unsigned num_pairs,
                      const TypeSequenceManager& seqman )
@@ -1,8 +1,10 @@
 #include "MeshSet.hpp"
 #include "AEntityFactory.hpp"
+#include "SequenceManager.hpp"
 #include "TestUtil.hpp"
 #include "moab/Core.hpp"
 #include "moab/SetIterator.hpp"
+#include "moab/WriteUtilIface.hpp"
 
 using namespace moab;
 
@@ -52,6 +54,14 @@ void test_iterator(Interface &moab, SetIterator *iter,
                    EntityHandle set, EntityType etype, int dim);
 void test_iterators(unsigned int flags, bool type, bool dim);
 void test_all_iterators();
+//! test storage of large sets of scattered handles
+void test_compressed_set();
+//! test boolean operations and adjacencies for compressed sets
+void test_compressed_set_ops( unsigned flags );
+//! test allocation of set lists from a SetListPool
+void test_set_list_pool();
+//! test that set lists are released to the pool when sets are deleted
+void test_set_list_pool_delete();
 
 
 void test_add_entities_ordered()          { test_add_entities( MESHSET_ORDERED ); }
@@ -104,6 +114,9 @@ void test_clear_set()                 { test_clear(                     MESHSET_
 void test_clear_ordered_tracking()    { test_clear( MESHSET_TRACK_OWNER|MESHSET_ORDERED ); }
 void test_clear_set_tracking()        { test_clear( MESHSET_TRACK_OWNER|MESHSET_SET     ); }
 
+void test_compressed_set_ops_set()          { test_compressed_set_ops(                     MESHSET_SET ); }
+void test_compressed_set_ops_set_tracking() { test_compressed_set_ops( MESHSET_TRACK_OWNER|MESHSET_SET ); }
+
 // Reproduce contitions that resulted in bug reported to 
 // mailing list: 
 // http://lists.mcs.anl.gov/pipermail/moab-dev/2010/002714.html
@@ -166,6 +179,11 @@ int main()
   err += RUN_TEST(regression_insert_set_1);
 
   err += RUN_TEST(test_all_iterators);
+  err += RUN_TEST(test_compressed_set);
+  err += RUN_TEST(test_compressed_set_ops_set);
+  err += RUN_TEST(test_compressed_set_ops_set_tracking);
+  err += RUN_TEST(test_set_list_pool);
+  err += RUN_TEST(test_set_list_pool_delete);
   
   if (!err) 
     printf("ALL TESTS PASSED\n");
@@ -1072,12 +1090,13 @@ void test_subtract( unsigned flags1, unsigned flags2 )
 void test_contains_entities( unsigned flags )
 {
   CHECK( !(flags&MESHSET_TRACK_OWNER) );
+  SetListPool pool;
   MeshSet set(flags);
   bool result;
   
   const EntityHandle entities[] = { 1,2,3,6,10,11,25,100 };
   const int num_ents = sizeof(entities)/sizeof(EntityHandle);
-  ErrorCode rval = set.add_entities( entities, num_ents, 0, 0 );
+  ErrorCode rval = set.add_entities( entities, num_ents, 0, 0, &pool );
   CHECK_ERR(rval);
   
   result = set.contains_entities( entities, num_ents, Interface::UNION );
@@ -1374,3 +1393,310 @@ void test_iterator(Interface &moab, SetIterator *iter,
   
   CHECK_EQUAL(entities.size(), entities2.size());
 }
+
+void test_compressed_set()
+{
+  SetListPool pool;
+  MeshSet set(MESHSET_SET);
+  ErrorCode rval;
+
+    // every third vertex and every other hex, too many isolated
+    // handles to store efficiently as a list of ranges
+  const EntityHandle num_ents = 3*MeshSet::COMPRESS_MIN_RANGES;
+  const EntityHandle vstart = CREATE_HANDLE( MBVERTEX, 1 );
+  const EntityHandle hstart = CREATE_HANDLE( MBHEX, 1 );
+  Range expected;
+  for (EntityHandle i = 0; i < num_ents; ++i) {
+    expected.insert( vstart + 3*i );
+    expected.insert( hstart + 2*i );
+  }
+  rval = set.add_entities( expected, 0, 0, &pool );
+  CHECK_ERR(rval);
+  CHECK( set.compressed() );
+    // and a block of handles spanning several chunks
+  Range block( vstart + 200000, vstart + 400000 );
+  rval = set.add_entities( block, 0, 0, &pool );
+  CHECK_ERR(rval);
+  CHECK( set.compressed() );
+  expected.merge( block );
+  CHECK_EQUAL( (unsigned)expected.size(), set.num_entities() );
+  CHECK( set.get_memory_use() < expected.psize() * 2 * sizeof(EntityHandle) );
+
+    // adding things already in the set changes nothing
+  rval = set.add_entities( &expected.front(), 1, 0, 0, &pool );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( (unsigned)expected.size(), set.num_entities() );
+
+  Range range;
+  rval = set.get_entities( range );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( expected, range );
+  std::vector<EntityHandle> vect;
+  rval = set.get_entities( vect );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( expected.size(), vect.size() );
+  CHECK( std::equal( vect.begin(), vect.end(), expected.begin() ) );
+
+  range.clear();
+  rval = set.get_entities_by_type( MBHEX, range );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( expected.subset_by_type( MBHEX ), range );
+  CHECK_EQUAL( (unsigned)range.size(), set.num_entities_by_type( MBHEX ) );
+  CHECK_EQUAL( 0u, set.num_entities_by_type( MBTET ) );
+  range.clear();
+  rval = set.get_entities_by_dimension( 0, range );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( expected.subset_by_type( MBVERTEX ), range );
+  CHECK_EQUAL( (unsigned)range.size(), set.num_entities_by_dimension( 0 ) );
+
+    // pair list must match range contents
+  size_t len;
+  std::vector<EntityHandle> storage;
+  const EntityHandle* pairs = set.get_contents( len, storage );
+  CHECK_EQUAL( 2*expected.psize(), len );
+  Range::const_pair_iterator p = expected.const_pair_begin();
+  for (size_t i = 0; i < len; i += 2, ++p) {
+    CHECK_EQUAL( p->first, pairs[i] );
+    CHECK_EQUAL( p->second, pairs[i+1] );
+  }
+
+  const EntityHandle in[] = { vstart, vstart + 3, hstart + 2 };
+  const EntityHandle out[] = { vstart, vstart + 1, hstart + 1 };
+  CHECK( set.contains_entities( in, 3, Interface::INTERSECT ) );
+  CHECK( !set.contains_entities( out, 3, Interface::INTERSECT ) );
+  CHECK( set.contains_entities( out, 3, Interface::UNION ) );
+
+    // remove part of the block and all of the hexes
+  Range removed( vstart + 300000, vstart + 400000 );
+  removed.merge( expected.subset_by_type( MBHEX ) );
+  rval = set.remove_entities( removed, 0, 0, &pool );
+  CHECK_ERR(rval);
+  expected = subtract( expected, removed );
+  range.clear();
+  rval = set.get_entities( range );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( expected, range );
+  CHECK_EQUAL( (unsigned)expected.size(), set.num_entities() );
+
+    // few enough handles remain that ranges are better
+  removed.clear();
+  removed.insert( vstart, vstart + 3*(num_ents - 100) );
+  removed.insert( vstart + 200000, vstart + 300000 );
+  rval = set.remove_entities( removed, 0, 0, &pool );
+  CHECK_ERR(rval);
+  expected = subtract( expected, removed );
+  CHECK( !set.compressed() );
+  range.clear();
+  rval = set.get_entities( range );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( expected, range );
+
+    // isolated handles in separate chunks stay a list of ranges,
+    // as each chunk costs more than a range
+  MeshSet scattered(MESHSET_SET);
+  Range spread;
+  for (EntityHandle i = 0; i < num_ents; ++i)
+    spread.insert( vstart + (i << 16) );
+  rval = scattered.add_entities( spread, 0, 0, &pool );
+  CHECK_ERR(rval);
+  CHECK( !scattered.compressed() );
+  
+    // a set built one handle at a time is compressed once its 
+    // list of ranges grows large enough
+  MeshSet incremental(MESHSET_SET);
+  for (EntityHandle i = 0; i < num_ents; ++i) {
+    EntityHandle h = vstart + 3*i;
+    rval = incremental.add_entities( &h, 1, 0, 0, &pool );
+    CHECK_ERR(rval);
+  }
+  CHECK( incremental.compressed() );
+  CHECK_EQUAL( (unsigned)num_ents, incremental.num_entities() );
+}
+
+void test_compressed_set_ops( unsigned flags )
+{
+  Core mb;
+  const int num_vtx = 4*MeshSet::COMPRESS_MIN_RANGES;
+  std::vector<double> coords( 3*num_vtx, 0.0 );
+  Range verts;
+  ErrorCode rval = mb.create_vertices( &coords[0], num_vtx, verts );
+  CHECK_ERR(rval);
+
+  Range evens, threes, block;
+  for (Range::iterator i = verts.begin(); i != verts.end(); ++i) {
+    if (!(*i % 2))
+      evens.insert( *i );
+    if (!(*i % 3))
+      threes.insert( *i );
+  }
+  block.insert( verts[100], verts[num_vtx/2] );
+
+  CHECK( test_boolean( mb, UNITE, flags, evens, flags, threes ) );
+  CHECK( test_boolean( mb, INTERSECT, flags, evens, flags, threes ) );
+  CHECK( test_boolean( mb, SUBTRACT, flags, evens, flags, threes ) );
+  CHECK( test_boolean( mb, UNITE, flags, block, flags, evens ) );
+  CHECK( test_boolean( mb, INTERSECT, flags, block, flags, evens ) );
+  CHECK( test_boolean( mb, SUBTRACT, flags, block, flags, evens ) );
+  CHECK( test_boolean( mb, SUBTRACT, flags, evens, MESHSET_ORDERED, block ) );
+
+    // set iterators and writer access to the contents
+  EntityHandle set;
+  rval = mb.create_meshset( flags, set );
+  CHECK_ERR(rval);
+  rval = mb.add_entities( set, evens );
+  CHECK_ERR(rval);
+  SetIterator *iter;
+  rval = mb.create_set_iterator( set, MBVERTEX, -1, 1000, false, iter );
+  CHECK_ERR(rval);
+  Range all;
+  std::vector<EntityHandle> chunk;
+  bool atend = false;
+  while (!atend) {
+    chunk.clear();
+    rval = iter->get_next_arr( chunk, atend );
+    CHECK_ERR(rval);
+    std::copy( chunk.begin(), chunk.end(), range_inserter(all) );
+  }
+  delete iter;
+  CHECK_EQUAL( evens, all );
+  
+  WriteUtilIface* tool = 0;
+  rval = mb.query_interface( tool );
+  CHECK_ERR(rval);
+  const EntityHandle* contents;
+  int length;
+  rval = tool->get_entity_list_pointers( &set, 1, &contents, WriteUtilIface::CONTENTS, &length );
+  CHECK_ERR(rval);
+  if (!(flags & MESHSET_ORDERED)) {
+    CHECK_EQUAL( 2*(int)evens.psize(), length );
+    all.clear();
+    for (int i = 0; i < length; i += 2)
+      all.insert( contents[i], contents[i+1] );
+    CHECK_EQUAL( evens, all );
+  }
+  mb.release_interface( tool );
+
+  if (flags & MESHSET_TRACK_OWNER) {
+    std::vector<EntityHandle> adj;
+    rval = mb.get_adjacencies( &evens.back(), 1, 4, false, adj );
+    CHECK_ERR(rval);
+    CHECK( std::find( adj.begin(), adj.end(), set ) != adj.end() );
+    rval = mb.remove_entities( set, evens );
+    CHECK_ERR(rval);
+    adj.clear();
+    rval = mb.get_adjacencies( &evens.back(), 1, 4, false, adj );
+    CHECK_ERR(rval);
+    CHECK( std::find( adj.begin(), adj.end(), set ) == adj.end() );
+  }
+}
+
+void test_set_list_pool()
+{
+  SetListPool pool;
+  const size_t num_lists = 100;
+  std::vector<EntityHandle*> lists( num_lists );
+  std::vector<size_t> sizes( num_lists );
+  for (size_t i = 0; i < num_lists; ++i) {
+    sizes[i] = 3 + i;
+    lists[i] = pool.allocate( sizes[i] );
+    for (size_t j = 0; j < sizes[i]; ++j)
+      lists[i][j] = 1000*i + j;
+  }
+  CHECK( pool.live_bytes() <= pool.memory_use() );
+
+    // grow and shrink lists, moving some between pooled and large arrays
+  for (size_t i = 0; i < num_lists; ++i) {
+    const size_t new_size = (i % 2) ? 2*sizes[i] : sizes[i]/2 + 2;
+    lists[i] = pool.reallocate( lists[i], sizes[i], new_size );
+    for (size_t j = sizes[i]; j < new_size; ++j)
+      lists[i][j] = 1000*i + j;
+    sizes[i] = new_size;
+  }
+  for (size_t i = 0; i < num_lists; ++i) 
+    for (size_t j = 0; j < sizes[i]; ++j)
+      CHECK_EQUAL( (EntityHandle)(1000*i + j), lists[i][j] );
+
+  unsigned long live = 0;
+  for (size_t i = 0; i < num_lists; ++i) 
+    live += SetListPool::capacity( sizes[i] );
+  CHECK_EQUAL( live, pool.live_bytes() );
+
+    // freed space is reused
+  for (size_t i = 0; i < num_lists; i += 2)
+    pool.deallocate( lists[i], sizes[i] );
+  const unsigned long mem = pool.memory_use();
+  for (size_t i = 0; i < num_lists; i += 2)
+    lists[i] = pool.allocate( sizes[i] );
+  CHECK_EQUAL( mem, pool.memory_use() );
+  CHECK_EQUAL( pool.memory_use() - pool.live_bytes(), pool.slack_bytes() );
+
+    // slabs emptied by deallocation are returned to the heap, except
+    // for one kept for each size class
+  std::vector<EntityHandle*> small( 10000 );
+  for (size_t i = 0; i < small.size(); ++i)
+    small[i] = pool.allocate( 4 );
+  const size_t full_slabs = pool.num_slabs();
+  const unsigned long full_mem = pool.memory_use();
+  for (size_t i = 0; i < small.size(); ++i)
+    pool.deallocate( small[i], 4 );
+  CHECK( pool.num_slabs() + 10 < full_slabs );
+  CHECK( pool.memory_use() < full_mem );
+  CHECK_EQUAL( live, pool.live_bytes() );
+  for (size_t i = 1; i < num_lists; i += 2)
+    for (size_t j = 0; j < sizes[i]; ++j)
+      CHECK_EQUAL( (EntityHandle)(1000*i + j), lists[i][j] );
+
+    // freeing everything leaves at most one slab per size class
+  for (size_t i = 0; i < num_lists; ++i)
+    pool.deallocate( lists[i], sizes[i] );
+  CHECK_EQUAL( 0ul, pool.live_bytes() );
+  CHECK( pool.num_slabs() <= 5 );
+  CHECK_EQUAL( pool.memory_use(), pool.slack_bytes() );
+
+  pool.release();
+  CHECK_EQUAL( 0ul, pool.memory_use() );
+  CHECK_EQUAL( 0ul, pool.live_bytes() );
+}
+
+void test_set_list_pool_delete()
+{
+  Core mb;
+  make_mesh( mb );
+  SetListPool* pool = mb.sequence_manager()->set_list_pool();
+  CHECK_EQUAL( 0ul, pool->live_bytes() );
+
+  const int num_sets = 1000;
+  Range sets;
+  std::vector<EntityHandle> verts;
+  ErrorCode rval = mb.get_entities_by_type( 0, MBVERTEX, verts );
+  CHECK_ERR(rval);
+  for (int i = 0; i < num_sets; ++i) {
+    EntityHandle set;
+    rval = mb.create_meshset( MESHSET_ORDERED, set );
+    CHECK_ERR(rval);
+    rval = mb.add_entities( set, &verts[i % 200], 5 );
+    CHECK_ERR(rval);
+    if (!sets.empty()) {
+      rval = mb.add_parent_child( sets.back(), set );
+      CHECK_ERR(rval);
+      rval = mb.add_parent_child( sets.front(), set );
+      CHECK_ERR(rval);
+    }
+    sets.insert( set );
+  }
+  CHECK( pool->live_bytes() > 0 );
+
+    // memory reported for sets includes pooled lists
+  unsigned long set_storage = 0, amortized_set_storage = 0;
+  mb.estimated_memory_use( sets, 0, 0, &set_storage, &amortized_set_storage );
+  CHECK( set_storage >= pool->live_bytes() );
+  CHECK( pool->slack_bytes() > 0 );
+  CHECK( amortized_set_storage >= set_storage + pool->slack_bytes() );
+  unsigned long total = 0, amortized = 0;
+  mb.estimated_memory_use( 0, 0, &total, &amortized );
+  CHECK( amortized >= pool->memory_use() );
+
+  rval = mb.delete_entities( sets );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( 0ul, pool->live_bytes() );
+}
@@ -12,6 +12,8 @@ void test_resize_ii();
 void test_resize_in();
 void test_resize_ni();
 void test_resize_nn();
+void test_arena_resize();
+void test_arena_assign();
 
 int main()
 {
@@ -29,6 +31,8 @@ int main()
   count += RUN_TEST( test_resize_in );
   count += RUN_TEST( test_resize_ni );
   count += RUN_TEST( test_resize_nn );
+  count += RUN_TEST( test_arena_resize );
+  count += RUN_TEST( test_arena_assign );
   
   return count;
 }
@@ -114,5 +118,74 @@ void test_resize_nn()
   CHECK( (unsigned char*)&tag != tag.data() );
   CHECK( !memcmp( tag.data(), "TSRQPONMLKJIHGFEDCBA", sizeof(void*) ) );
 }
- 
 
+void test_arena_resize()
+{
+  const char str[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+  VarLenTagArena arena;
+  VarLenTag tag;
+  arena.set( tag, str, 2*sizeof(void*) );
+  CHECK( tag.in_arena() );
+  
+    // growing stays in the arena and keeps the value
+  unsigned char* ptr = arena.resize( tag, 4*sizeof(void*) );
+  CHECK_EQUAL( tag.data(), ptr );
+  CHECK( tag.in_arena() );
+  CHECK_EQUAL( 4*sizeof(void*), (size_t)tag.size() );
+  CHECK( !memcmp( tag.data(), str, 2*sizeof(void*) ) );
+  
+    // shrinking to an inline value leaves the arena
+  ptr = arena.resize( tag, sizeof(void*) );
+  CHECK_EQUAL( (unsigned char*)&tag, ptr );
+  CHECK( !tag.in_arena() );
+  CHECK( !memcmp( tag.data(), str, sizeof(void*) ) );
+  
+    // a value moved out of the arena is no longer counted as in use,
+    // so compaction frees all of its blocks
+  arena.compact_begin();
+  arena.compact_end();
+  CHECK_EQUAL( 0ul, arena.memory_use() );
+}
+
+void test_arena_assign()
+{
+  const char str[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+  const char rev[] = "9876543210ZYXWVUTSRQPONMLKJIHGFEDCBA";
+  VarLenTagArena arena;
+  VarLenTag tag, other;
+  arena.set( tag, str, 3*sizeof(void*) );
+  arena.set( other, rev, 2*sizeof(void*) );
+  CHECK( tag.in_arena() );
+  CHECK( other.in_arena() );
+  
+    // space is allocated in multiples of the arena alignment
+  CHECK_EQUAL( sizeof(double), VarLenTagArena::padded_size( 1 ) );
+  CHECK_EQUAL( sizeof(double), VarLenTagArena::padded_size( sizeof(double) ) );
+  CHECK_EQUAL( 2*sizeof(double), VarLenTagArena::padded_size( sizeof(double)+1 ) );
+  
+    // assigning to an arena value copies into separately allocated
+    // memory and leaves both the source and the arena intact
+  tag = other;
+  CHECK( !tag.in_arena() );
+  CHECK( other.in_arena() );
+  CHECK_EQUAL( 2*sizeof(void*), (size_t)tag.size() );
+  CHECK( tag.data() != other.data() );
+  CHECK( !memcmp( tag.data(), rev, 2*sizeof(void*) ) );
+  CHECK( !memcmp( other.data(), rev, 2*sizeof(void*) ) );
+  
+    // self-assignment is a no-op, even for an arena value
+  other = other;
+  CHECK( other.in_arena() );
+  CHECK( !memcmp( other.data(), rev, 2*sizeof(void*) ) );
+  
+    // resizing an arena value directly also moves it out of the arena
+  unsigned char* ptr = other.resize( 4*sizeof(void*) );
+  CHECK_EQUAL( other.data(), ptr );
+  CHECK( !other.in_arena() );
+  CHECK( !memcmp( other.data(), rev, 2*sizeof(void*) ) );
+  
+    // neither value is in the arena any longer, so compaction frees it
+  arena.compact_begin();
+  arena.compact_end();
+  CHECK_EQUAL( 0ul, arena.memory_use() );
+}
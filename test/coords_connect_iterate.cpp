@@ -3,12 +3,20 @@
 #include "moab/ScdInterface.hpp"
 #include "moab/HomXform.hpp"
 #include "moab/ReadUtilIface.hpp"
+#include "moab/ChunkIterator.hpp"
+#include "moab/ParallelFor.hpp"
 #include "TestUtil.hpp"
 #include <stdlib.h>
 #include <algorithm>
+#include <iostream>
+#include <time.h>
 
 void test_coords_connect_iterate();
 void test_scd_invalid();
+void test_chunk_iterator();
+void test_chunk_iterator_time();
+void test_parallel_for();
+void test_chunk_sequence_boundary();
 
 using namespace moab;
 
@@ -18,6 +26,10 @@ int main()
   
   failures += RUN_TEST(test_coords_connect_iterate);
   failures += RUN_TEST(test_scd_invalid);
+  failures += RUN_TEST(test_chunk_iterator);
+  failures += RUN_TEST(test_chunk_iterator_time);
+  failures += RUN_TEST(test_parallel_for);
+  failures += RUN_TEST(test_chunk_sequence_boundary);
   
   if (failures) 
     std::cerr << "<<<< " << failures << " TESTS FAILED >>>>" << std::endl;
@@ -171,3 +183,356 @@ void test_scd_invalid()
   rval = mb.connect_iterate(hexes.begin(), hexes.end(), connect, num_connect, count);
   CHECK_EQUAL(rval, MB_FAILURE);
 }
+
+void test_chunk_iterator()
+{
+  const int NUM_VTX = 1024;
+  Core moab;
+  Interface& mb = moab;
+  std::vector<double> coords(3*NUM_VTX);
+  for (int i = 0; i < 3*NUM_VTX; i++)
+    coords[i] = i;
+  Range verts, hexes;
+  ErrorCode rval = mb.create_vertices( &coords[0], NUM_VTX, verts );
+  CHECK_ERR(rval);
+  
+    // create hexes in two sequences so that chunks are split
+  ReadUtilIface *rui;
+  rval = mb.query_interface(rui);
+  CHECK_ERR(rval);
+  for (int s = 0; s < 2; ++s) {
+    EntityHandle start, *conn;
+    rval = rui->get_element_connect(NUM_VTX/16, 8, MBHEX, 1, start, conn);
+    CHECK_ERR(rval);
+    Range::iterator it = verts.begin() + s*NUM_VTX/2;
+    std::copy(it, it + NUM_VTX/2, conn);
+    hexes.insert(start, start + NUM_VTX/16 - 1);
+  }
+  
+    // dense tags with different sizes, initialized by handle
+  Tag itag, dtag, stag;
+  int zero = 0;
+  double dzero[3] = {0, 0, 0};
+  rval = mb.tag_get_handle("INT", 1, MB_TYPE_INTEGER, itag, MB_TAG_DENSE|MB_TAG_EXCL, &zero);
+  CHECK_ERR(rval);
+  rval = mb.tag_get_handle("DBL3", 3, MB_TYPE_DOUBLE, dtag, MB_TAG_DENSE|MB_TAG_EXCL, dzero);
+  CHECK_ERR(rval);
+  rval = mb.tag_get_handle("SPARSE", 1, MB_TYPE_INTEGER, stag, MB_TAG_SPARSE|MB_TAG_EXCL);
+  CHECK_ERR(rval);
+  Range all = verts;
+  all.merge(hexes);
+  std::vector<int> ivals(all.size());
+  std::vector<double> dvals(3*all.size());
+  for (size_t i = 0; i < all.size(); ++i) {
+    ivals[i] = (int)all[i];
+    dvals[3*i] = dvals[3*i+1] = dvals[3*i+2] = 0.5 * all[i];
+  }
+  rval = mb.tag_set_data(itag, all, &ivals[0]);
+  CHECK_ERR(rval);
+  rval = mb.tag_set_data(dtag, all, &dvals[0]);
+  CHECK_ERR(rval);
+  
+    // skip some entities so that range blocks don't align with sequences
+  verts.erase(verts.begin() + 10, verts.begin() + 20);
+  hexes.erase(hexes.begin() + 3);
+  
+    // sparse tags cannot be iterated over
+  {
+    ChunkIterator iter(&mb, verts, true, false, &stag, 1);
+    CHECK_EQUAL(MB_TYPE_OUT_OF_RANGE, iter.reset());
+  }
+  
+    // vertices: coordinates and both tags
+  Tag tags[2] = { itag, dtag };
+  ChunkIterator viter(&mb, verts, true, false, tags, 2);
+  size_t total = 0;
+  std::vector<double> xyz;
+  for (rval = viter.reset(); MB_SUCCESS == rval && !viter.at_end(); rval = viter.next()) {
+    CHECK(viter.count() > 0);
+    Range chunk(viter.start_handle(), viter.start_handle() + viter.count() - 1);
+    CHECK(chunk.all_of_type(MBVERTEX));
+    CHECK_EQUAL(*viter.position(), viter.start_handle());
+    xyz.resize(3*chunk.size());
+    rval = mb.get_coords(chunk, &xyz[0]);
+    CHECK_ERR(rval);
+    const int* iptr = reinterpret_cast<const int*>(viter.tag_data(0));
+    const double* dptr = reinterpret_cast<const double*>(viter.tag_data(1));
+    for (int i = 0; i < viter.count(); ++i) {
+      CHECK_REAL_EQUAL(xyz[3*i  ], viter.x()[i], 1e-12);
+      CHECK_REAL_EQUAL(xyz[3*i+1], viter.y()[i], 1e-12);
+      CHECK_REAL_EQUAL(xyz[3*i+2], viter.z()[i], 1e-12);
+      CHECK_EQUAL((int)(viter.start_handle() + i), iptr[i]);
+      CHECK_REAL_EQUAL(0.5 * (viter.start_handle() + i), dptr[3*i+2], 1e-12);
+    }
+      // after peeling, every array is aligned at the same entity
+    const int peel = viter.peel_count(16);
+    CHECK(peel >= 0 && peel <= viter.count());
+    if (peel < viter.count()) {
+      CHECK_EQUAL((size_t)0, (size_t)(viter.x() + peel) % 16);
+      CHECK_EQUAL((size_t)0, (size_t)(viter.z() + peel) % 16);
+      CHECK_EQUAL((size_t)0, (size_t)(iptr + peel) % 16);
+      CHECK_EQUAL((size_t)0, (size_t)(dptr + 3*peel) % 16);
+    }
+    CHECK_EQUAL(0, viter.peel_count(1));
+    total += viter.count();
+  }
+  CHECK_ERR(rval);
+  CHECK_EQUAL(verts.size(), total);
+  
+    // hexes: connectivity and one tag, modified in place
+  ChunkIterator hiter(&mb, hexes, false, true, &dtag, 1);
+  total = 0;
+  int num_chunks = 0;
+  for (rval = hiter.reset(); MB_SUCCESS == rval && !hiter.at_end(); rval = hiter.next()) {
+    CHECK_EQUAL(8, hiter.nodes_per_element());
+    double* dptr = reinterpret_cast<double*>(hiter.tag_data(0));
+    for (int i = 0; i < hiter.count(); ++i) {
+      const EntityHandle* conn;
+      int len;
+      rval = mb.get_connectivity(hiter.start_handle() + i, conn, len);
+      CHECK_ERR(rval);
+      CHECK_ARRAYS_EQUAL(conn, 8, hiter.connectivity() + 8*i, 8);
+      dptr[3*i] = -1.0;
+    }
+    total += hiter.count();
+    ++num_chunks;
+  }
+  CHECK_ERR(rval);
+  CHECK_EQUAL(hexes.size(), total);
+  CHECK(num_chunks >= 3);
+  for (Range::iterator i = hexes.begin(); i != hexes.end(); ++i) {
+    double v[3];
+    rval = mb.tag_get_data(dtag, &*i, 1, v);
+    CHECK_ERR(rval);
+    CHECK_REAL_EQUAL(-1.0, v[0], 1e-12);
+  }
+}
+
+void test_chunk_iterator_time()
+{
+  const int NUM_VTX = 1000000, REPEAT = 10;
+  Core moab;
+  Interface& mb = moab;
+  std::vector<double> coords(3*NUM_VTX, 1.0);
+  Range verts;
+  ErrorCode rval = mb.create_vertices( &coords[0], NUM_VTX, verts );
+  CHECK_ERR(rval);
+  Tag tag;
+  double zero = 0.0;
+  rval = mb.tag_get_handle("VAL", 1, MB_TYPE_DOUBLE, tag, MB_TAG_DENSE|MB_TAG_EXCL, &zero);
+  CHECK_ERR(rval);
+  
+    // copy coordinates and tag values out, compute, and copy results back
+  std::vector<double> vals(NUM_VTX);
+  clock_t t = clock();
+  for (int r = 0; r < REPEAT; ++r) {
+    rval = mb.get_coords(verts, &coords[0]);
+    CHECK_ERR(rval);
+    rval = mb.tag_get_data(tag, verts, &vals[0]);
+    CHECK_ERR(rval);
+    for (int i = 0; i < NUM_VTX; ++i)
+      vals[i] += coords[3*i] + coords[3*i+1] + coords[3*i+2];
+    rval = mb.tag_set_data(tag, verts, &vals[0]);
+    CHECK_ERR(rval);
+  }
+  double copy_time = (double)(clock() - t) / CLOCKS_PER_SEC;
+  
+    // same computation in place
+  t = clock();
+  for (int r = 0; r < REPEAT; ++r) {
+    ChunkIterator iter(&mb, verts, true, false, &tag, 1);
+    for (rval = iter.reset(); MB_SUCCESS == rval && !iter.at_end(); rval = iter.next()) {
+      const double *x = iter.x(), *y = iter.y(), *z = iter.z();
+      double* v = reinterpret_cast<double*>(iter.tag_data(0));
+      for (int i = 0; i < iter.count(); ++i)
+        v[i] += x[i] + y[i] + z[i];
+    }
+    CHECK_ERR(rval);
+  }
+  double iter_time = (double)(clock() - t) / CLOCKS_PER_SEC;
+  
+  rval = mb.tag_get_data(tag, verts, &vals[0]);
+  CHECK_ERR(rval);
+  CHECK_REAL_EQUAL(6.0 * REPEAT, vals[0], 1e-12);
+  CHECK_REAL_EQUAL(6.0 * REPEAT, vals[NUM_VTX-1], 1e-12);
+  
+  std::cout << "copy: " << copy_time << "s, chunk iterator: " 
+            << iter_time << "s" << std::endl;
+}
+
+  // sum vertex coordinates into tag and record handles by range position
+class SumCoords : public ChunkTask
+{
+public:
+  std::vector<EntityHandle> handles;
+  
+  ErrorCode execute( const EntityChunk& chunk )
+  {
+    double* v = reinterpret_cast<double*>(chunk.tag_data(0));
+    for (int i = 0; i < chunk.count(); ++i) {
+      if (chunk.float_coordinates())
+        v[i] = chunk.x_float()[i] + chunk.y_float()[i] + chunk.z_float()[i];
+      else
+        v[i] = chunk.x()[i] + chunk.y()[i] + chunk.z()[i];
+      handles[chunk.index() + i] = chunk.start_handle() + i;
+    }
+    return MB_SUCCESS;
+  }
+};
+
+  // copy first vertex of each element into tag
+class FirstVertex : public ChunkTask
+{
+public:
+  ErrorCode execute( const EntityChunk& chunk )
+  {
+    if (chunk.start_handle() == failHandle)
+      return MB_FAILURE;
+    EntityHandle* v = reinterpret_cast<EntityHandle*>(chunk.tag_data(0));
+    for (int i = 0; i < chunk.count(); ++i) 
+      v[i] = chunk.connectivity()[i*chunk.nodes_per_element()];
+    return MB_SUCCESS;
+  }
+  EntityHandle failHandle;
+};
+
+void test_parallel_for()
+{
+  const int NUM_VTX = 1000;
+  Core moab;
+  Interface& mb = moab;
+  std::vector<double> coords(3*NUM_VTX);
+  for (int i = 0; i < 3*NUM_VTX; i++)
+    coords[i] = i;
+  Range verts, edges;
+  ErrorCode rval = mb.create_vertices( &coords[0], NUM_VTX, verts );
+  CHECK_ERR(rval);
+  for (int i = 0; i + 1 < NUM_VTX; i += 2) {
+    EntityHandle conn[2] = { verts[i], verts[i+1] }, h;
+    rval = mb.create_element( MBEDGE, conn, 2, h );
+    CHECK_ERR(rval);
+    edges.insert( h );
+  }
+  verts.erase(verts.begin() + 10, verts.begin() + 20);
+  
+  Tag sum_tag, vtx_tag, sparse_tag;
+  rval = mb.tag_get_handle("SUM", 1, MB_TYPE_DOUBLE, sum_tag, MB_TAG_DENSE|MB_TAG_EXCL);
+  CHECK_ERR(rval);
+  rval = mb.tag_get_handle("VTX", 1, MB_TYPE_HANDLE, vtx_tag, MB_TAG_DENSE|MB_TAG_EXCL);
+  CHECK_ERR(rval);
+  rval = mb.tag_get_handle("SPARSE", 1, MB_TYPE_INTEGER, sparse_tag, MB_TAG_SPARSE|MB_TAG_EXCL);
+  CHECK_ERR(rval);
+  
+    // vertices in small chunks on several threads
+  SumCoords sum;
+  sum.handles.resize( verts.size(), 0 );
+  rval = parallel_for( &mb, verts, sum, true, false, &sum_tag, 1, 4, 7 );
+  CHECK_ERR(rval);
+  CHECK( std::equal( verts.begin(), verts.end(), sum.handles.begin() ) );
+  std::vector<double> sums(verts.size());
+  rval = mb.tag_get_data(sum_tag, verts, &sums[0]);
+  CHECK_ERR(rval);
+  for (size_t i = 0; i < verts.size(); ++i) {
+    const int j = verts[i] - verts.front();
+    CHECK_REAL_EQUAL( 9.0*j + 3.0, sums[i], 1e-12 );
+  }
+  
+    // vertices with single-precision coordinates, in a separate sequence
+  Range fverts;
+  moab.set_float_coordinates( true );
+  rval = mb.create_vertices( &coords[0], 100, fverts );
+  moab.set_float_coordinates( false );
+  CHECK_ERR(rval);
+  Range mixed( verts );
+  mixed.merge( fverts );
+  sum.handles.clear();
+  sum.handles.resize( mixed.size(), 0 );
+  rval = parallel_for( &mb, mixed, sum, true, false, &sum_tag, 1, 4, 64 );
+  CHECK_ERR(rval);
+  CHECK( std::equal( mixed.begin(), mixed.end(), sum.handles.begin() ) );
+  sums.resize( fverts.size() );
+  rval = mb.tag_get_data(sum_tag, fverts, &sums[0]);
+  CHECK_ERR(rval);
+  for (size_t i = 0; i < fverts.size(); ++i)
+    CHECK_REAL_EQUAL( 9.0*i + 3.0, sums[i], 1e-12 );
+  
+    // sparse tags cannot be iterated over
+  CHECK_EQUAL( MB_TYPE_OUT_OF_RANGE, parallel_for( &mb, verts, sum, true, false, &sparse_tag, 1 ) );
+  
+    // all elements of a dimension
+  FirstVertex first;
+  first.failHandle = 0;
+  rval = parallel_for( &mb, 1, first, false, true, &vtx_tag, 1, 3, 64 );
+  CHECK_ERR(rval);
+  for (Range::iterator i = edges.begin(); i != edges.end(); ++i) {
+    const EntityHandle* conn;
+    int len;
+    rval = mb.get_connectivity( *i, conn, len );
+    CHECK_ERR(rval);
+    EntityHandle v;
+    rval = mb.tag_get_data( vtx_tag, &*i, 1, &v );
+    CHECK_ERR(rval);
+    CHECK_EQUAL( conn[0], v );
+  }
+  
+    // errors from the task are returned
+  first.failHandle = edges.front() + 64;
+  CHECK_EQUAL( MB_FAILURE, parallel_for( &mb, MBEDGE, first, false, true, &vtx_tag, 1, 3, 64 ) );
+}
+
+  // Chunks must end where vertex sequences do, even when the handles
+  // of the next sequence follow on contiguously.
+void test_chunk_sequence_boundary()
+{
+  const int N = 10;
+  std::vector<double> coords(3*N);
+  for (int i = 0; i < 3*N; i++)
+    coords[i] = i;
+  
+    // double then float, and double then double
+  for (int pass = 0; pass < 2; ++pass) {
+    Core moab;
+    Interface& mb = moab;
+    Range first, second, verts;
+    ErrorCode rval = mb.create_vertices( &coords[0], N, first );
+    CHECK_ERR(rval);
+    moab.set_float_coordinates( 0 == pass );
+    rval = mb.create_vertices( &coords[0], N, second );
+    CHECK_ERR(rval);
+    verts.merge( first );
+    verts.merge( second );
+    CHECK_EQUAL( (size_t)1, verts.psize() );
+    
+    ChunkIterator iter( &mb, verts, true, false );
+    std::vector<int> counts;
+    std::vector<bool> floats;
+    for (rval = iter.reset(); MB_SUCCESS == rval && !iter.at_end(); rval = iter.next()) {
+      counts.push_back( iter.count() );
+      floats.push_back( iter.float_coordinates() );
+      for (int i = 0; i < iter.count(); ++i) {
+        const double x = iter.float_coordinates() ? iter.x_float()[i] : iter.x()[i];
+        CHECK_REAL_EQUAL( 3.0*i, x, 1e-12 );
+      }
+    }
+    CHECK_ERR(rval);
+    CHECK_EQUAL( (size_t)2, counts.size() );
+    CHECK_EQUAL( N, counts[0] );
+    CHECK_EQUAL( N, counts[1] );
+    CHECK( !floats[0] );
+    CHECK_EQUAL( 0 == pass, (bool)floats[1] );
+    
+    Tag sum_tag;
+    rval = mb.tag_get_handle( "SUM", 1, MB_TYPE_DOUBLE, sum_tag, MB_TAG_DENSE|MB_TAG_EXCL );
+    CHECK_ERR(rval);
+    SumCoords sum;
+    sum.handles.resize( verts.size(), 0 );
+    rval = parallel_for( &mb, verts, sum, true, false, &sum_tag, 1, 2 );
+    CHECK_ERR(rval);
+    CHECK( std::equal( verts.begin(), verts.end(), sum.handles.begin() ) );
+    std::vector<double> sums( verts.size() );
+    rval = mb.tag_get_data( sum_tag, verts, &sums[0] );
+    CHECK_ERR(rval);
+    for (int i = 0; i < 2*N; ++i)
+      CHECK_REAL_EQUAL( 9.0*(i%N) + 3.0, sums[i], 1e-12 );
+  }
+}
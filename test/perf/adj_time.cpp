@@ -1,8 +1,11 @@
 #include "moab/Core.hpp"
 #include "moab/Range.hpp"
+#include "AEntityFactory.hpp"
+#include "ThreadPool.hpp"
 #include <iostream>
 #include <assert.h>
 #include <time.h>
+#include <sys/time.h>
 
 using namespace moab;
 
@@ -14,18 +17,49 @@ using namespace moab;
 
 const char* default_input_file = "../mb_big_test.g";
 
+  // CPU time is summed over all threads, so use elapsed time
+double wall_time()
+{
+  struct timeval tv;
+  gettimeofday( &tv, 0 );
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+  // time building vertex-to-element adjacencies for a freshly loaded mesh
+ErrorCode time_vert_elem_adjacencies( Core& moab, unsigned num_threads )
+{
+  ErrorCode rval = moab.load_file( default_input_file );
+  if (MB_SUCCESS != rval) {
+    std::cerr << default_input_file <<": failed to load file." << std::endl;
+    return rval;
+  }
+
+  double t_0 = wall_time();
+  rval = moab.a_entity_factory()->create_vert_elem_adjacencies( num_threads );
+  if (MB_SUCCESS != rval)
+    return rval;
+  double t_build = wall_time() - t_0;
+  std::cout << "Building vertex-to-element adjacencies with " << num_threads 
+            << " thread(s): " << t_build << " seconds" << std::endl;
+  return MB_SUCCESS;
+}
+
 int main()
 {
   ErrorCode rval;
+  
+    // compare serial and threaded construction of up-adjacencies
+  {
+    Core serial_moab;
+    rval = time_vert_elem_adjacencies( serial_moab, 1 );
+    if (MB_SUCCESS != rval)
+      return 1;
+  }
   Core moab;
   Interface& mb = moab;
-  
-    // load test file
-  rval = mb.load_file( default_input_file );
-  if (MB_SUCCESS != rval) {
-    std::cerr << default_input_file <<": failed to load file." << std::endl;
+  rval = time_vert_elem_adjacencies( moab, ThreadPool::default_num_threads() );
+  if (MB_SUCCESS != rval)
     return 1;
-  }
   
     // get all region elements
   Range vols;
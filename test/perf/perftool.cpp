@@ -25,6 +25,8 @@
 #include "moab/Core.hpp"
 #include "moab/Skinner.hpp"
 #include "moab/ReadUtilIface.hpp"
+#include "moab/ReorderTool.hpp"
+#include <stdlib.h>
 
 using namespace moab;
 
@@ -52,6 +54,8 @@ void direct_tag( int intervals, int dim, int blocks )
   { std::cout << "Direct Tag Time:"; 
     tag_time( MB_TAG_DENSE, true, intervals, dim, blocks ); }
 
+void curve_order( int intervals, int dim, int passes );
+
 typedef void (*test_func_t)( int, int, int );
 const struct {
   std::string testName;
@@ -63,6 +67,7 @@ const struct {
  { "sparse",    &sparse_tag,"Sparse tag data manipulation" },
  { "dense",     &dense_tag, "Dense tag data manipulation" },
  { "direct",    &direct_tag,"Dense tag data manipulation using direct data access" },
+ { "curve",     &curve_order,"Element loop on shuffled mesh and after space-filling curve or RCM reordering" },
 };
 const int TestListSize = sizeof(TestList)/sizeof(TestList[0]); 
 
@@ -456,3 +461,105 @@ void tag_time( TagType storage, bool direct, int intervals, int dim, int blocks
   double secs = (clock() - t) / (double)CLOCKS_PER_SEC;
   std::cout << " " << iter_count << " iterations in " << secs << " seconds" << std::endl;
 }
+
+  // Apply some order to the vertices and elements of the mesh
+enum MeshOrder { SHUFFLED, MORTON, HILBERT, RCM };
+void order_mesh( Core& moab, MeshOrder order )
+{
+  ReorderTool tool( &moab );
+  Tag mapping;
+  ErrorCode rval;
+  if (SHUFFLED == order) {
+    Tag rand_tag;
+    const int negone = -1;
+    moab.tag_get_handle( 0, 1, MB_TYPE_INTEGER, rand_tag, MB_TAG_DENSE|MB_TAG_CREAT, &negone );
+    Range ents;
+    moab.get_entities_by_handle( 0, ents );
+    ents = subtract( ents, ents.subset_by_type( MBENTITYSET ) );
+    std::vector<int> vals( ents.size() );
+    srand( 17 );
+    for (size_t i = 0; i < vals.size(); ++i)
+      vals[i] = rand();
+    moab.tag_set_data( rand_tag, ents, &vals[0] );
+    rval = tool.handle_order_from_int_tag( rand_tag, negone, mapping );
+    moab.tag_delete( rand_tag );
+  }
+  else if (RCM == order) {
+    rval = tool.handle_order_from_rcm( mapping );
+  }
+  else {
+    rval = tool.handle_order_from_curve( MORTON == order ? ReorderTool::MORTON_CURVE 
+                                                         : ReorderTool::HILBERT_CURVE,
+                                         mapping );
+  }
+  if (MB_SUCCESS == rval)
+    rval = tool.reorder_entities( mapping );
+  if (MB_SUCCESS != rval) {
+    std::cerr << "Mesh reordering failed" << std::endl;
+    exit(2);
+  }
+  moab.tag_delete( mapping );
+}
+
+  // Time an assembly-like loop: for each element, read the coordinates
+  // of its vertices and accumulate a value in each vertex.
+double element_loop_time( Interface& mb, int dim, int passes )
+{
+  Range verts, elems;
+  mb.get_entities_by_type( 0, MBVERTEX, verts );
+  mb.get_entities_by_dimension( 0, dim, elems );
+  double *x, *y, *z;
+  int count;
+  mb.coords_iterate( verts.begin(), verts.end(), x, y, z, count );
+  if (count != (int)verts.size()) {
+    std::cerr << "Vertices not contiguous" << std::endl;
+    exit(2);
+  }
+  const EntityHandle first = verts.front();
+  std::vector<double> accum( verts.size(), 0.0 );
+  
+  clock_t t = clock();
+  for (int p = 0; p < passes; ++p) {
+    Range::iterator i = elems.begin();
+    while (i != elems.end()) {
+      EntityHandle* conn;
+      int len;
+      mb.connect_iterate( i, elems.end(), conn, len, count );
+      for (int e = 0; e < count; ++e, conn += len) {
+        double c[3] = { 0, 0, 0 };
+        for (int j = 0; j < len; ++j) {
+          const size_t v = conn[j] - first;
+          c[0] += x[v];
+          c[1] += y[v];
+          c[2] += z[v];
+        }
+        const double val = (c[0] + c[1] + c[2]) / len;
+        for (int j = 0; j < len; ++j)
+          accum[conn[j] - first] += val;
+      }
+      i += count;
+    }
+  }
+  return (clock() - t) / (double)CLOCKS_PER_SEC;
+}
+
+void curve_order( int intervals, int dim, int passes )
+{
+  if (passes < 1)
+    passes = 10;
+  const char* names[] = { "shuffled", "Morton", "Hilbert", "RCM" };
+  for (int o = SHUFFLED; o <= RCM; ++o) {
+    Core moab;
+    create_regular_mesh( &moab, intervals, dim );
+    order_mesh( moab, SHUFFLED );
+    clock_t t = clock();
+    if (SHUFFLED != o)
+      order_mesh( moab, (MeshOrder)o );
+    double reorder_secs = (clock() - t) / (double)CLOCKS_PER_SEC;
+    double secs = element_loop_time( moab, dim, passes );
+    std::cout << passes << " passes over " << names[o] << " mesh in " << secs << " seconds";
+    if (SHUFFLED != o)
+      std::cout << " (reordering took " << reorder_secs << " seconds)";
+    std::cout << std::endl;
+  }
+}
@@ -96,6 +96,14 @@ void forward_order_query_element_verts(int percent); //!< calculate centroid
 void reverse_order_query_element_verts(int percent); //!< calculate centroid
 void  random_order_query_element_verts(int percent); //!< calculate centroid
 
+void forward_order_lookup_vertices(int percent); //!< find sequence for each vertex handle
+void reverse_order_lookup_vertices(int percent); //!< find sequence for each vertex handle
+void  random_order_lookup_vertices(int percent); //!< find sequence for each vertex handle
+
+void forward_order_lookup_elements(int percent); //!< find sequence for each element handle
+void reverse_order_lookup_elements(int percent); //!< find sequence for each element handle
+void  random_order_lookup_elements(int percent); //!< find sequence for each element handle
+
 void forward_order_delete_vertices( int percent ); //!< delete x% of vertices
 void reverse_order_delete_vertices( int percent ); //!< delete x% of vertices
 void  random_order_delete_vertices( int percent ); //!< delete x% of vertices
@@ -107,6 +115,8 @@ void  random_order_delete_elements( int percent ); //!< delete x% of elements
 void create_missing_vertices( int percent ); //!< re-create deleted vertices
 void create_missing_elements( int percent ); //!< re-create deleted elements
 
+void churn_elements(); //!< delete and re-create every other element, with lookups between
+
 #ifdef PRINT_SEQUENCE_COUNT
 unsigned get_number_sequences( EntityType type );
 #endif
@@ -128,6 +138,14 @@ iaf_t query_elem_verts[3] = { &forward_order_query_element_verts,
                               &reverse_order_query_element_verts,
                               & random_order_query_element_verts };
 
+iaf_t lookup_verts[3] = { &forward_order_lookup_vertices,
+                          &reverse_order_lookup_vertices,
+                          & random_order_lookup_vertices };
+
+iaf_t lookup_elems[3] = { &forward_order_lookup_elements,
+                          &reverse_order_lookup_elements,
+                          & random_order_lookup_elements };
+
 iaf_t delete_verts[3] = { &forward_order_delete_vertices,
                           &reverse_order_delete_vertices,
                           & random_order_delete_vertices };
@@ -243,12 +261,15 @@ void do_test( int create_mode, //!< 0 == single, 1 == block
             << get_number_sequences(MBHEX) << " element sequences." << std::endl;
 #endif
 
+  TIME_QRY( "  Looking up vertex sequences", lookup_verts[order], percent );
+  TIME_QRY( "  Looking up element sequences", lookup_elems[order], percent );
   TIME_QRY( "  Querying vertex coordinates", query_verts[order], percent );
   TIME_QRY( "  Querying element connectivity", query_elems[order], percent );
   TIME_QRY( "  Querying element coordinates", query_elem_verts[order], percent );
 
   TIME_DEL( "  Re-creating vertices", create_missing_vertices, percent );
   TIME_DEL( "  Re-creating elements", create_missing_elements, percent );
+  TIME( "  Splitting and merging element sequences", churn_elements );
 
   TIME( "  Clearing mesh instance", delete_mesh );
   
@@ -694,6 +715,36 @@ void  random_order_query_element_verts(int percent)
   }
 }
 
+//! Check validity (find the sequence) of each undeleted handle.
+//! If 'perm' is non-null, visit handles in that order.
+static void lookup_handles( EntityHandle start, long count, bool reverse, 
+                            const long* perm, bool (*deleted)(long,int), 
+                            int percent )
+{
+  for (long i = 0; i < count; ++i) {
+    long idx = perm ? perm[i] : reverse ? count - i - 1 : i;
+    if (!deleted(idx,percent)) {
+      bool valid = mb_core.is_valid( start + idx );
+      assert(valid);
+      if (valid){} // empty line to remove compiler warning  
+    }
+  }
+}
+
+void forward_order_lookup_vertices(int percent)
+  { lookup_handles( vertStart, numVert, false, 0, &deleted_vert, percent ); }
+void reverse_order_lookup_vertices(int percent)
+  { lookup_handles( vertStart, numVert, true, 0, &deleted_vert, percent ); }
+void  random_order_lookup_vertices(int percent)
+  { lookup_handles( vertStart, numVert, false, queryVertPermutation, &deleted_vert, percent ); }
+
+void forward_order_lookup_elements(int percent)
+  { lookup_handles( elemStart, numElem, false, 0, &deleted_elem, percent ); }
+void reverse_order_lookup_elements(int percent)
+  { lookup_handles( elemStart, numElem, true, 0, &deleted_elem, percent ); }
+void  random_order_lookup_elements(int percent)
+  { lookup_handles( elemStart, numElem, false, queryElemPermutation, &deleted_elem, percent ); }
+
 void forward_order_delete_vertices( int percent )
 {
   for (long i = 0; i < numVert; ++i)
@@ -731,6 +782,51 @@ void  random_order_delete_elements( int percent )
 }
 
 
+//! query one of the elements that churn_elements does not delete
+inline void query_kept_element( const std::vector<EntityHandle>& elems, long i )
+{
+  const EntityHandle* conn;
+  int len;
+  const size_t idx = (queryElemPermutation[i % numElem] % elems.size()) | 1;
+  if (idx < elems.size())
+    mb.get_connectivity( elems[idx], conn, len );
+}
+
+void churn_elements()
+{
+    // Each deletion of an interior element splits its sequence and
+    // each re-creation may merge two, so the set of sequences changes
+    // at every step.  Query some other element after each change so
+    // that sequence lookup is exercised between modifications.
+  Range elems;
+  ErrorCode rval = mb.get_entities_by_type( 0, MBHEX, elems );
+  assert(!rval);
+  if (rval){} // empty line to remove compiler warning  
+  
+  std::vector<EntityHandle> live( elems.begin(), elems.end() );
+  std::vector<EntityHandle> dead_conn;
+  const EntityHandle* conn;
+  int len;
+  for (size_t i = 0; i < live.size(); i += 2) {
+    rval = mb.get_connectivity( live[i], conn, len );
+    assert(!rval && len == 8);
+    dead_conn.insert( dead_conn.end(), conn, conn + len );
+    rval = mb.delete_entities( &live[i], 1 );
+    assert(!rval);
+    query_kept_element( live, i );
+  }
+  
+  EntityHandle h;
+  for (size_t i = 0; i < dead_conn.size(); i += 8) {
+    rval = mb.create_element( MBHEX, &dead_conn[i], 8, h );
+    if (rval) {
+      assert(false);
+      abort();
+    }
+    query_kept_element( live, i/8 );
+  }
+}
+
 void create_missing_vertices( int percent )
 {
   EntityHandle h;
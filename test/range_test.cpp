@@ -1,5 +1,12 @@
 #include "moab/Range.hpp"
 #include "TestUtil.hpp"
+#include <set>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
 
 using namespace moab;
 
@@ -12,6 +19,13 @@ void subtract_test();
 void subset_by_dimension_test();
 void erase_test();
 void contains_test();
+void fragmented_test();
+void fragmented_perf_test();
+void list_comparison_perf_test();
+void erase_empty_test();
+void insert_sorted_test();
+void set_operations_test();
+void set_operations_perf_test();
 
 int main()
 {
@@ -25,6 +39,13 @@ int main()
   rval += RUN_TEST(subset_by_dimension_test);
   rval += RUN_TEST(erase_test);
   rval += RUN_TEST(contains_test);
+  rval += RUN_TEST(fragmented_test);
+  rval += RUN_TEST(fragmented_perf_test);
+  rval += RUN_TEST(list_comparison_perf_test);
+  rval += RUN_TEST(erase_empty_test);
+  rval += RUN_TEST(insert_sorted_test);
+  rval += RUN_TEST(set_operations_test);
+  rval += RUN_TEST(set_operations_perf_test);
   return rval;
 }
 
@@ -565,3 +586,562 @@ void contains_test()
   CHECK( !r1.contains(r2) );
   CHECK( !r2.contains(r1) );
 }
+
+  // compare a Range to the equivalent std::set
+static void check_fragmented( const Range& range, const std::set<EntityHandle>& set )
+{
+  range.sanity_check();
+  CHECK_EQUAL( set.size(), range.size() );
+  CHECK_EQUAL( (EntityID)set.size(), range.end() - range.begin() );
+  
+  std::vector<EntityHandle> list( set.begin(), set.end() );
+  size_t num_pairs = 0;
+  for (size_t i = 0; i < list.size(); ++i) {
+    if (!i || list[i] != list[i-1] + 1)
+      ++num_pairs;
+    CHECK_EQUAL( list[i], range[i] );
+    CHECK_EQUAL( (int)i, range.index( list[i] ) );
+    CHECK_EQUAL( list[i], *range.find( list[i] ) );
+    CHECK_EQUAL( (EntityID)i, range.find( list[i] ) - range.begin() );
+  }
+  CHECK_EQUAL( num_pairs, range.psize() );
+  
+  for (EntityHandle h = 1; h < list.back() + 2; ++h) {
+    std::set<EntityHandle>::const_iterator s = set.lower_bound( h );
+    Range::const_iterator r = range.lower_bound( h );
+    if (s == set.end()) {
+      CHECK( r == range.end() );
+    }
+    else {
+      CHECK_EQUAL( *s, *r );
+      if (*s != h) {
+        CHECK( range.find( h ) == range.end() );
+        CHECK_EQUAL( -1, range.index( h ) );
+      }
+    }
+  }
+}
+
+void fragmented_test()
+{
+  const EntityHandle num_handles = 2000;
+  std::set<EntityHandle> set;
+  Range range;
+  
+    // insert every third handle in decreasing order
+  for (EntityHandle h = num_handles; h > 0; --h) 
+    if (h % 3 == 0) {
+      set.insert( h );
+      range.insert( h );
+    }
+  check_fragmented( range, set );
+
+    // fill in some gaps in random order, merging pairs
+  srand( 42 );
+  Range::iterator hint = range.begin();
+  for (int i = 0; i < 1000; ++i) {
+    EntityHandle h = 1 + rand() % num_handles;
+    set.insert( h );
+    hint = range.insert( hint, h );
+    CHECK_EQUAL( h, *hint );
+  }
+  check_fragmented( range, set );
+  
+    // copies and assignment
+  Range copy( range );
+  check_fragmented( copy, set );
+  CHECK( copy == range );
+  copy.pop_front();
+  copy.pop_back();
+  CHECK( copy != range );
+  copy = range;
+  check_fragmented( copy, set );
+  
+    // erase random handles, splitting pairs
+  for (int i = 0; i < 1000; ++i) {
+    EntityHandle h = 1 + rand() % num_handles;
+    set.erase( h );
+    range.erase( h );
+  }
+  check_fragmented( range, set );
+  
+    // remove blocks from the middle and ends
+  Range::iterator b = range.begin() + range.size()/4;
+  Range::iterator e = range.begin() + range.size()/2;
+  std::set<EntityHandle>::iterator sb = set.find( *b ), se = set.find( *e );
+  set.erase( sb, se );
+  range.erase( b, e );
+  check_fragmented( range, set );
+  while (set.size() > 10) {
+    CHECK_EQUAL( *set.begin(), range.pop_front() );
+    set.erase( set.begin() );
+    CHECK_EQUAL( *set.rbegin(), range.pop_back() );
+    set.erase( --set.end() );
+  }
+  check_fragmented( range, set );
+}
+
+  // Time common operations on a range with many small blocks,
+  // the case where the storage of the blocks matters most.
+void fragmented_perf_test()
+{
+  const EntityHandle num_pairs = 200000;
+  Range range;
+  std::vector<EntityHandle> handles( num_pairs );
+  for (EntityHandle i = 0; i < num_pairs; ++i)
+    handles[i] = 3*i + 1;
+  std::vector<EntityHandle> shuffled( handles );
+  srand( 42 );
+  for (size_t i = shuffled.size() - 1; i > 0; --i)
+    std::swap( shuffled[i], shuffled[rand() % (i + 1)] );
+
+  clock_t t0 = clock();
+  Range::iterator hint = range.begin();
+  for (EntityHandle i = 0; i < num_pairs; ++i)
+    hint = range.insert( hint, handles[i], handles[i] + 1 );
+  clock_t t1 = clock();
+  CHECK_EQUAL( (size_t)num_pairs, range.psize() );
+  
+  Range reverse;
+  for (EntityHandle i = num_pairs; i > 0; --i)
+    reverse.insert( handles[i-1], handles[i-1] + 1 );
+  clock_t t2 = clock();
+  CHECK( range == reverse );
+  
+  size_t found = 0;
+  for (EntityHandle i = 0; i < num_pairs; ++i)
+    if (range.find( shuffled[i] + 1 ) != range.end())
+      ++found;
+  clock_t t3 = clock();
+  CHECK_EQUAL( (size_t)num_pairs, found );
+  
+  EntityHandle sum = 0;
+  for (EntityHandle i = 0; i < num_pairs; ++i)
+    sum += range.index( shuffled[i] ) + range[2*i];
+  clock_t t4 = clock();
+  CHECK( sum > 0 );
+  
+  size_t count = 0;
+  for (EntityHandle i = 0; i < 100; ++i)
+    count += range.size() + range.psize();
+  Range::const_pair_iterator p;
+  for (p = range.const_pair_begin(); p != range.const_pair_end(); ++p)
+    count += p->second - p->first;
+  clock_t t5 = clock();
+  CHECK_EQUAL( (size_t)(300*num_pairs + num_pairs), count );
+  
+  Range copy( range );
+  for (EntityHandle i = 0; i < num_pairs/100; ++i)
+    copy.erase( shuffled[i] );
+  copy -= reverse;
+  clock_t t6 = clock();
+  CHECK( copy.empty() );
+  
+  const double s = 1.0/CLOCKS_PER_SEC;
+  printf( "  Range with %lu blocks:\n", (unsigned long)num_pairs );
+  printf( "    ascending insert:  %f s\n", s*(t1 - t0) );
+  printf( "    descending insert: %f s\n", s*(t2 - t1) );
+  printf( "    random find:       %f s\n", s*(t3 - t2) );
+  printf( "    index/operator[]:  %f s\n", s*(t4 - t3) );
+  printf( "    size/iteration:    %f s\n", s*(t5 - t4) );
+  printf( "    copy/erase/remove: %f s\n", s*(t6 - t5) );
+}
+
+  // The storage and algorithms of Range before its blocks were kept
+  // in an array: a circular doubly-linked list of pairs searched 
+  // linearly, with a hint for insertion.  Kept as the baseline for
+  // list_comparison_perf_test.
+class ListRange
+{
+public:
+  struct Node { 
+    EntityHandle first, second;
+    Node *mNext, *mPrev;
+  };
+  
+  ListRange()
+    { mHead.first = mHead.second = 0; mHead.mNext = mHead.mPrev = &mHead; }
+  ~ListRange()
+    { 
+      while (mHead.mNext != &mHead) {
+        Node* dead = mHead.mNext;
+        mHead.mNext = dead->mNext;
+        delete dead;
+      }
+    }
+  
+  Node* begin() { return mHead.mNext; }
+  Node* end() { return &mHead; }
+  
+  Node* insert( Node* iter, EntityHandle val1, EntityHandle val2 )
+  {
+    if (mHead.mNext == &mHead)
+      return mHead.mNext = mHead.mPrev = alloc_pair( &mHead, &mHead, val1, val2 );
+    if (iter == &mHead) 
+      iter = mHead.mPrev;
+    if (iter != &mHead && iter->first > val2+1)
+      iter = mHead.mNext;
+    while (iter != mHead.mNext && iter->mPrev->second >= val1-1)
+      iter = iter->mPrev;
+    if (iter->mPrev == &mHead && val2 < iter->first - 1)
+      return mHead.mNext = iter->mPrev = alloc_pair( iter, &mHead, val1, val2 );
+    while (iter != &mHead && iter->second+1 < val1)
+      iter = iter->mNext;
+    if (iter == &mHead || iter->first-1 > val2) {
+      Node* new_node = alloc_pair( iter, iter->mPrev, val1, val2 );
+      return iter->mPrev = iter->mPrev->mNext = new_node;
+    }
+    if (iter->first > val1)
+      iter->first = val1;
+    if (iter->second >= val2)  
+      return iter;
+    iter->second = val2;
+    while (iter->mNext != &mHead && iter->mNext->first <= val2 + 1) {
+      Node* dead = iter->mNext;
+      iter->mNext = dead->mNext;
+      dead->mNext->mPrev = iter;
+      if (dead->second > val2)
+        iter->second = dead->second;
+      delete dead;
+    }
+    return iter;
+  }
+  
+  bool contains( EntityHandle val ) const
+  {
+    const Node* iter = mHead.mNext;
+    for ( ; iter != &mHead && (val > iter->second); iter=iter->mNext );
+    return iter->second >= val && iter->first <= val;
+  }
+  
+  int index( EntityHandle handle ) const
+  {
+    int i = 0;
+    const Node* iter = mHead.mNext;
+    for ( ; iter != &mHead && handle > iter->second; iter = iter->mNext)
+      i += iter->second - iter->first + 1;
+    if (iter == &mHead || handle < iter->first)
+      return -1;
+    return i + handle - iter->first;
+  }
+  
+  size_t size() const
+  {
+    size_t sz = 0;
+    for (const Node* iter = mHead.mNext; iter != &mHead; iter = iter->mNext)
+      sz += iter->second - iter->first + 1;
+    return sz;
+  }
+  
+  size_t psize() const
+  {
+    size_t sz = 0;
+    for (const Node* iter = mHead.mNext; iter != &mHead; iter = iter->mNext)
+      ++sz;
+    return sz;
+  }
+
+private:
+  static Node* alloc_pair( Node* next, Node* prev, EntityHandle first, EntityHandle second )
+  {
+    Node* node = new Node;
+    node->first = first;
+    node->second = second;
+    node->mNext = next;
+    node->mPrev = prev;
+    return node;
+  }
+
+  ListRange( const ListRange& );
+  ListRange& operator=( const ListRange& );
+  
+  Node mHead;
+};
+
+  // Time the same operations on Range and on the linked-list
+  // implementation it replaced.  Fewer blocks than fragmented_perf_test
+  // because lookups in the list are linear.
+void list_comparison_perf_test()
+{
+  const EntityHandle num_pairs = 20000;
+  std::vector<EntityHandle> shuffled( num_pairs );
+  for (EntityHandle i = 0; i < num_pairs; ++i)
+    shuffled[i] = 3*i + 1;
+  srand( 42 );
+  for (size_t i = shuffled.size() - 1; i > 0; --i)
+    std::swap( shuffled[i], shuffled[rand() % (i + 1)] );
+  
+  clock_t times[2][6];
+  size_t results[2][4];
+  
+  {
+    times[0][0] = clock();
+    Range range;
+    Range::iterator hint = range.begin();
+    for (EntityHandle i = 0; i < num_pairs; ++i)
+      hint = range.insert( hint, 3*i + 1, 3*i + 2 );
+    times[0][1] = clock();
+    Range reverse;
+    for (EntityHandle i = num_pairs; i > 0; --i)
+      reverse.insert( 3*i - 2, 3*i - 1 );
+    times[0][2] = clock();
+    results[0][0] = 0;
+    for (EntityHandle i = 0; i < num_pairs; ++i)
+      if (range.find( shuffled[i] + 1 ) != range.end())
+        ++results[0][0];
+    times[0][3] = clock();
+    results[0][1] = 0;
+    for (EntityHandle i = 0; i < num_pairs; ++i)
+      results[0][1] += range.index( shuffled[i] );
+    times[0][4] = clock();
+    results[0][2] = 0;
+    for (EntityHandle i = 0; i < 100; ++i)
+      results[0][2] += range.size() + range.psize();
+    times[0][5] = clock();
+    results[0][3] = reverse.size();
+  }
+  
+  {
+    times[1][0] = clock();
+    ListRange range;
+    ListRange::Node* hint = range.begin();
+    for (EntityHandle i = 0; i < num_pairs; ++i)
+      hint = range.insert( hint, 3*i + 1, 3*i + 2 );
+    times[1][1] = clock();
+    ListRange reverse;
+    for (EntityHandle i = num_pairs; i > 0; --i)
+      reverse.insert( reverse.begin(), 3*i - 2, 3*i - 1 );
+    times[1][2] = clock();
+    results[1][0] = 0;
+    for (EntityHandle i = 0; i < num_pairs; ++i)
+      if (range.contains( shuffled[i] + 1 ))
+        ++results[1][0];
+    times[1][3] = clock();
+    results[1][1] = 0;
+    for (EntityHandle i = 0; i < num_pairs; ++i)
+      results[1][1] += range.index( shuffled[i] );
+    times[1][4] = clock();
+    results[1][2] = 0;
+    for (EntityHandle i = 0; i < 100; ++i)
+      results[1][2] += range.size() + range.psize();
+    times[1][5] = clock();
+    results[1][3] = reverse.size();
+  }
+  
+  for (int j = 0; j < 4; ++j)
+    CHECK_EQUAL( results[1][j], results[0][j] );
+  CHECK_EQUAL( (size_t)num_pairs, results[0][0] );
+  
+  const char* names[] = { "ascending insert: ", "descending insert:", 
+                          "random find:      ", "index:            ", 
+                          "size/psize:       " };
+  const double s = 1.0/CLOCKS_PER_SEC;
+  printf( "  %lu blocks           Range       linked list\n", (unsigned long)num_pairs );
+  for (int j = 0; j < 5; ++j)
+    printf( "    %s %f s  %f s\n", names[j], 
+            s*(times[0][j+1] - times[0][j]), s*(times[1][j+1] - times[1][j]) );
+}
+
+  // Erasing nothing, in particular from an empty range, which shares
+  // static sentinel pairs with all other empty ranges, changes nothing.
+void erase_empty_test()
+{
+  Range empty;
+  Range::iterator i = empty.erase( empty.begin(), empty.end() );
+  CHECK( i == empty.end() );
+  i = empty.erase( empty.lower_bound( 5 ), empty.upper_bound( 10 ) );
+  CHECK( i == empty.end() );
+  CHECK( empty.empty() );
+  CHECK_EQUAL( (size_t)0, empty.size() );
+  
+  Range other;
+  other.insert( 1, 5 );
+  CHECK_EQUAL( (size_t)5, other.size() );
+  other.erase( other.end(), other.end() );
+  i = other.erase( other.begin(), other.begin() );
+  CHECK( i == other.begin() );
+  CHECK_EQUAL( (size_t)5, other.size() );
+  
+  Range another;
+  CHECK( another.empty() && another.begin() == another.end() );
+  CHECK_EQUAL( (size_t)0, another.size() );
+}
+
+void insert_sorted_test()
+{
+  const EntityHandle list[] = { 0, 2, 3, 3, 4, 8, 9, 12, 12, 20 };
+  const int list_len = sizeof(list)/sizeof(list[0]);
+  Range range;
+  Range::iterator i = range.insert_sorted_list( list, list + list_len );
+  range.sanity_check();
+  CHECK_EQUAL( (EntityHandle)2, *i );
+  CHECK_EQUAL( (size_t)4, range.psize() );
+  CHECK_EQUAL( (size_t)7, range.size() );
+  CHECK_EQUAL( (EntityHandle)2, range.front() );
+  CHECK_EQUAL( (EntityHandle)20, range.back() );
+  
+    // merge into existing contents: overlapping, adjacent, before and after
+  const EntityHandle pairs[] = { 1, 1, 5, 6, 10, 11, 11, 19, 30, 40 };
+  i = range.insert_sorted_pairs( pairs, sizeof(pairs)/sizeof(pairs[0])/2 );
+  range.sanity_check();
+  CHECK_EQUAL( (EntityHandle)1, *i );
+  CHECK_EQUAL( (size_t)3, range.psize() );
+  CHECK_EQUAL( (EntityHandle)1, range.const_pair_begin()->first );
+  CHECK_EQUAL( (EntityHandle)6, range.const_pair_begin()->second );
+  CHECK_EQUAL( (EntityHandle)40, range.back() );
+  CHECK_EQUAL( (size_t)30, range.size() );
+  
+    // compare to inserting one at a time
+  srand( 7 );
+  std::vector<EntityHandle> values( 5000 );
+  for (size_t j = 0; j < values.size(); ++j)
+    values[j] = 1 + rand() % 20000;
+  Range expected( range );
+  for (size_t j = 0; j < values.size(); ++j)
+    expected.insert( values[j] );
+  Range copy( range );
+  copy.insert( &values[0], &values[0] + values.size() );
+  copy.sanity_check();
+  CHECK( expected == copy );
+
+    // an unsorted list returns the start of its last run of
+    // consecutive handles, as inserting runs one at a time did
+  const EntityHandle unsorted[] = { 43, 7, 41, 5, 42, 6 };
+  Range runs;
+  i = runs.insert( unsorted, unsorted + sizeof(unsorted)/sizeof(unsorted[0]) );
+  CHECK_EQUAL( (EntityHandle)41, *i );
+  i = runs.insert( unsorted, unsorted );
+  CHECK( runs.begin() == i );
+  std::sort( values.begin(), values.end() );
+  range.insert_sorted_list( &values[0], &values[0] + values.size() );
+  range.sanity_check();
+  CHECK( expected == range );
+  
+    // append
+  values.clear();
+  for (EntityHandle h = 20001; h < 30000; h += 2)
+    values.push_back( h );
+  for (size_t j = 0; j < values.size(); ++j)
+    expected.insert( values[j] );
+  range.insert_sorted_list( &values[0], &values[0] + values.size() );
+  range.sanity_check();
+  CHECK( expected == range );
+  
+    // merging part of another range
+  Range other;
+  other.insert( 100, 200 );
+  other.insert( 300, 400 );
+  other.insert( 500, 600 );
+  Range sub;
+  sub.insert( 1, 150 );
+  sub.insert( 350, 360 );
+  sub.merge( other.begin() + 50, other.begin() + 175 );
+  sub.sanity_check();
+  CHECK_EQUAL( (size_t)2, sub.psize() );
+  CHECK_EQUAL( (EntityHandle)200, sub.const_pair_begin()->second );
+  CHECK_EQUAL( (EntityHandle)300, (++sub.const_pair_begin())->first );
+  CHECK_EQUAL( (EntityHandle)373, sub.back() );
+}
+
+  // random range of handles in [1,max], as both a Range and a std::set
+static void random_range( EntityHandle max, int num_blocks, int max_len,
+                          Range& range, std::set<EntityHandle>& set )
+{
+  for (int i = 0; i < num_blocks; ++i) {
+    EntityHandle start = 1 + rand() % max;
+    EntityHandle end = std::min( max, start + rand() % max_len );
+    range.insert( start, end );
+    for (EntityHandle h = start; h <= end; ++h)
+      set.insert( h );
+  }
+}
+
+static void check_range( const Range& range, const std::set<EntityHandle>& set )
+{
+  range.sanity_check();
+  CHECK_EQUAL( set.size(), range.size() );
+  CHECK( std::equal( set.begin(), set.end(), range.begin() ) );
+}
+
+void set_operations_test()
+{
+  srand( 11 );
+  const int block_counts[][2] = { { 1, 1 }, { 5, 500 }, { 500, 5 }, { 200, 200 }, { 0, 10 } };
+  const int num_counts = sizeof(block_counts)/sizeof(block_counts[0]);
+  for (int i = 0; i < num_counts; ++i) {
+    for (int max_len = 1; max_len < 100; max_len *= 7) {
+      Range r1, r2;
+      std::set<EntityHandle> s1, s2, s;
+      random_range( 10000, block_counts[i][0], max_len, r1, s1 );
+      random_range( 10000, block_counts[i][1], max_len, r2, s2 );
+      
+      s.clear();
+      std::set_intersection( s1.begin(), s1.end(), s2.begin(), s2.end(), 
+                             std::inserter( s, s.begin() ) );
+      check_range( intersect( r1, r2 ), s );
+      check_range( intersect( r2, r1 ), s );
+
+      s.clear();
+      std::set_union( s1.begin(), s1.end(), s2.begin(), s2.end(), 
+                      std::inserter( s, s.begin() ) );
+      check_range( unite( r1, r2 ), s );
+      Range r( r2 );
+      r.merge( r1 );
+      check_range( r, s );
+      
+      s.clear();
+      std::set_difference( s1.begin(), s1.end(), s2.begin(), s2.end(), 
+                           std::inserter( s, s.begin() ) );
+      check_range( subtract( r1, r2 ), s );
+      r = r1;
+      r -= r2;
+      check_range( r, s );
+    }
+  }
+}
+
+  // Time set operations on large ranges with many blocks, both of 
+  // similar size and with one much smaller than the other.
+void set_operations_perf_test()
+{
+  const EntityHandle num_pairs = 500000;
+  std::vector<EntityHandle> pairs1, pairs2, pairs3;
+  for (EntityHandle i = 0; i < num_pairs; ++i) {
+    pairs1.push_back( 10*i + 1 );
+    pairs1.push_back( 10*i + 5 );
+    pairs2.push_back( 10*i + 4 );
+    pairs2.push_back( 10*i + 7 );
+    if (i % 1000 == 0) {
+      pairs3.push_back( 10*i + 2 );
+      pairs3.push_back( 10*i + 12 );
+    }
+  }
+  
+  clock_t t0 = clock();
+  Range r1, r2, r3;
+  r1.insert_sorted_pairs( &pairs1[0], pairs1.size()/2 );
+  r2.insert_sorted_pairs( &pairs2[0], pairs2.size()/2 );
+  r3.insert_sorted_pairs( &pairs3[0], pairs3.size()/2 );
+  clock_t t1 = clock();
+  CHECK_EQUAL( (size_t)num_pairs, r1.psize() );
+  
+  Range i12 = intersect( r1, r2 );
+  Range u12 = unite( r1, r2 );
+  Range s12 = subtract( r1, r2 );
+  clock_t t2 = clock();
+  CHECK_EQUAL( (size_t)2*num_pairs, i12.size() );
+  CHECK_EQUAL( (size_t)7*num_pairs, u12.size() );
+  CHECK_EQUAL( (size_t)3*num_pairs, s12.size() );
+  
+  Range i13 = intersect( r1, r3 );
+  Range s31 = subtract( r3, r1 );
+  clock_t t3 = clock();
+  CHECK_EQUAL( (size_t)(num_pairs/1000)*6, i13.size() );
+  CHECK_EQUAL( (size_t)(num_pairs/1000)*5, s31.size() );
+  
+  const double s = 1.0/CLOCKS_PER_SEC;
+  printf( "  Set operations on ranges with %lu blocks:\n", (unsigned long)num_pairs );
+  printf( "    bulk insert:                %f s\n", s*(t1 - t0) );
+  printf( "    intersect/unite/subtract:   %f s\n", s*(t2 - t1) );
+  printf( "    with a much smaller range:  %f s\n", s*(t3 - t2) );
+}
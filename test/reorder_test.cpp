@@ -1,6 +1,10 @@
 #include "moab/Core.hpp"
 #include "moab/ReorderTool.hpp"
+#include "AEntityFactory.hpp"
 #include "TestUtil.hpp"
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
 
 using namespace moab;
 
@@ -63,6 +67,10 @@ void check_big_meshset();
 void check_handle_tag();
 void check_varlen_tag();
 void check_bit_tag();
+void test_compact_handles();
+void test_morton_order();
+void test_hilbert_order();
+void test_rcm_order();
 
 int main()
 {
@@ -94,6 +102,10 @@ int main()
   errors += RUN_TEST(check_handle_tag);
   errors += RUN_TEST(check_varlen_tag);
   errors += RUN_TEST(check_bit_tag);
+  errors += RUN_TEST(test_compact_handles);
+  errors += RUN_TEST(test_morton_order);
+  errors += RUN_TEST(test_hilbert_order);
+  errors += RUN_TEST(test_rcm_order);
   return errors;
 }
 
@@ -643,3 +655,363 @@ void check_bit_tag()
   
   CHECK_EQUAL( exp, act );
 }
+
+void test_compact_handles()
+{
+  const int N = 10;
+  ErrorCode rval;
+  Core moab;
+  Interface& mb = moab;
+  Tag gid, conn_ids, vtx_handle;
+  rval = mb.tag_get_handle( GLOBAL_ID_NAME, 1, MB_TYPE_INTEGER, gid, MB_TAG_CREAT|MB_TAG_DENSE );
+  CHECK_ERR(rval);
+  rval = mb.tag_get_handle( CONN_IDS_NAME, 4, MB_TYPE_INTEGER, conn_ids, MB_TAG_CREAT|MB_TAG_SPARSE );
+  CHECK_ERR(rval);
+  rval = mb.tag_get_handle( "VTX_HANDLE", 1, MB_TYPE_HANDLE, vtx_handle, MB_TAG_CREAT|MB_TAG_SPARSE );
+  CHECK_ERR(rval);
+  
+    // some vertices to delete, then a grid of quads
+  Range extra;
+  for (int i = 0; i < N; ++i) {
+    EntityHandle h;
+    double coords[3] = { -1, -1, (double)i };
+    rval = mb.create_vertex( coords, h );
+    CHECK_ERR(rval);
+    extra.insert( h );
+  }
+  std::vector<EntityHandle> verts( (N+1)*(N+1) );
+  for (int i = 0; i <= N; ++i) {
+    for (int j = 0; j <= N; ++j) {
+      const int id = i*(N+1) + j;
+      double coords[3] = { (double)i, (double)j, 0 };
+      rval = mb.create_vertex( coords, verts[id] );
+      CHECK_ERR(rval);
+      rval = mb.tag_set_data( gid, &verts[id], 1, &id );
+      CHECK_ERR(rval);
+    }
+  }
+  std::vector<EntityHandle> quads( N*N );
+  for (int i = 0; i < N; ++i) {
+    for (int j = 0; j < N; ++j) {
+      const int id = i*N + j;
+      const int c[4] = { i*(N+1)+j, (i+1)*(N+1)+j, (i+1)*(N+1)+j+1, i*(N+1)+j+1 };
+      EntityHandle conn[4] = { verts[c[0]], verts[c[1]], verts[c[2]], verts[c[3]] };
+      rval = mb.create_element( MBQUAD, conn, 4, quads[id] );
+      CHECK_ERR(rval);
+      rval = mb.tag_set_data( gid, &quads[id], 1, &id );
+      CHECK_ERR(rval);
+      rval = mb.tag_set_data( conn_ids, &quads[id], 1, c );
+      CHECK_ERR(rval);
+      rval = mb.tag_set_data( vtx_handle, &quads[id], 1, conn+2 );
+      CHECK_ERR(rval);
+    }
+  }
+  
+    // create vertex adjacencies and an explicit adjacency
+  std::vector<EntityHandle> adj;
+  rval = mb.get_adjacencies( &verts.back(), 1, 2, false, adj );
+  CHECK_ERR(rval);
+  EntityHandle last_quad = quads.back();
+  EntityHandle edge;
+  rval = mb.create_element( MBEDGE, &verts[verts.size()-2], 2, edge );
+  CHECK_ERR(rval);
+  rval = mb.add_adjacencies( last_quad, &edge, 1, true );
+  CHECK_ERR(rval);
+    // and a one-way explicit adjacency, from an edge to a quad
+  EntityHandle one_way_quad = quads[N*N-2];
+  EntityHandle edge2;
+  rval = mb.create_element( MBEDGE, &verts[0], 2, edge2 );
+  CHECK_ERR(rval);
+  rval = mb.add_adjacencies( edge2, &one_way_quad, 1, false );
+  CHECK_ERR(rval);
+  
+    // delete extra vertices and every other quad in the first half
+  rval = mb.delete_entities( extra );
+  CHECK_ERR(rval);
+  Range dead, set_contents;
+  for (int i = 0; i < N*N; ++i) {
+    if (i < N*N/2 && i % 2)
+      dead.insert( quads[i] );
+    else if (i % 3 == 0)
+      set_contents.insert( quads[i] );
+  }
+  rval = mb.delete_entities( dead );
+  CHECK_ERR(rval);
+  EntityHandle set;
+  rval = mb.create_meshset( MESHSET_SET, set );
+  CHECK_ERR(rval);
+  rval = mb.add_entities( set, set_contents );
+  CHECK_ERR(rval);
+  
+  Range old_quads, old_verts;
+  rval = mb.get_entities_by_type( 0, MBQUAD, old_quads );
+  CHECK_ERR(rval);
+  rval = mb.get_entities_by_type( 0, MBVERTEX, old_verts );
+  CHECK_ERR(rval);
+  CHECK( old_quads.psize() > 1 );
+  std::vector<int> old_quad_ids( old_quads.size() );
+  rval = mb.tag_get_data( gid, old_quads, &old_quad_ids[0] );
+  CHECK_ERR(rval);
+  
+  ReorderTool tool( &moab );
+  Range old_handles;
+  std::vector<EntityHandle> new_handles;
+  rval = tool.compact_handles( old_handles, new_handles );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( old_handles.size(), new_handles.size() );
+  CHECK_EQUAL( (size_t)N, (size_t)old_handles.num_of_type( MBVERTEX ) );
+  CHECK_EQUAL( dead.size(), (size_t)old_handles.num_of_type( MBQUAD ) );
+  
+    // entities are packed, and moved entities kept their data
+  Range new_quads, new_verts;
+  rval = mb.get_entities_by_type( 0, MBQUAD, new_quads );
+  CHECK_ERR(rval);
+  rval = mb.get_entities_by_type( 0, MBVERTEX, new_verts );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( old_quads.size(), new_quads.size() );
+  CHECK_EQUAL( old_verts.size(), new_verts.size() );
+  CHECK_EQUAL( (size_t)1, new_quads.psize() );
+  CHECK_EQUAL( (size_t)1, new_verts.psize() );
+  CHECK_EQUAL( old_quads.front(), new_quads.front() );
+  CHECK_EQUAL( old_verts.front(), new_verts.front() + N );
+  for (size_t i = 0; i < old_handles.size(); ++i) {
+    EntityHandle h = old_handles[i];
+    CHECK( new_quads.find( h ) == new_quads.end() || TYPE_FROM_HANDLE(h) != MBQUAD );
+    if (TYPE_FROM_HANDLE(h) == MBQUAD) {
+      int id;
+      rval = mb.tag_get_data( gid, &new_handles[i], 1, &id );
+      CHECK_ERR(rval);
+      CHECK_EQUAL( old_quad_ids[old_quads.index(h)], id );
+    }
+  }
+  
+    // connectivity, handle tags, and vertex adjacencies are updated
+  for (Range::iterator q = new_quads.begin(); q != new_quads.end(); ++q) {
+    const EntityHandle* conn;
+    int len;
+    rval = mb.get_connectivity( *q, conn, len );
+    CHECK_ERR(rval);
+    int exp_ids[4], act_ids[4];
+    rval = mb.tag_get_data( conn_ids, &*q, 1, exp_ids );
+    CHECK_ERR(rval);
+    rval = mb.tag_get_data( gid, conn, 4, act_ids );
+    CHECK_ERR(rval);
+    CHECK_ARRAYS_EQUAL( exp_ids, 4, act_ids, 4 );
+    EntityHandle vtx;
+    rval = mb.tag_get_data( vtx_handle, &*q, 1, &vtx );
+    CHECK_ERR(rval);
+    CHECK_EQUAL( conn[2], vtx );
+    for (int k = 0; k < 4; ++k) {
+      adj.clear();
+      rval = mb.get_adjacencies( conn+k, 1, 2, false, adj );
+      CHECK_ERR(rval);
+      CHECK( std::find( adj.begin(), adj.end(), *q ) != adj.end() );
+    }
+  }
+  
+    // set contents are updated
+  Range contents;
+  rval = mb.get_entities_by_handle( set, contents );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( set_contents.size(), contents.size() );
+  std::vector<int> ids( contents.size() );
+  rval = mb.tag_get_data( gid, contents, &ids[0] );
+  CHECK_ERR(rval);
+  for (size_t i = 0; i < ids.size(); ++i)
+    CHECK( ids[i] % 3 == 0 && (ids[i] >= N*N/2 || ids[i] % 2 == 0) );
+  
+    // explicit adjacency moved with the quad
+  CHECK( old_handles.find( last_quad ) != old_handles.end() );
+  EntityHandle new_last = new_handles[old_handles.index( last_quad )];
+  adj.clear();
+  rval = mb.get_adjacencies( &new_last, 1, 1, false, adj );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( (size_t)1, adj.size() );
+  CHECK_EQUAL( edge, adj[0] );
+  adj.clear();
+  rval = mb.get_adjacencies( &edge, 1, 2, false, adj );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( (size_t)1, adj.size() );
+  CHECK_EQUAL( new_last, adj[0] );
+  
+    // one-way adjacency refers to the new handle
+  CHECK( old_handles.find( one_way_quad ) != old_handles.end() );
+  EntityHandle new_one_way = new_handles[old_handles.index( one_way_quad )];
+  const EntityHandle* explicit_adj;
+  int num_explicit;
+  rval = moab.a_entity_factory()->get_adjacencies( edge2, explicit_adj, num_explicit );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( 1, num_explicit );
+  CHECK_EQUAL( new_one_way, explicit_adj[0] );
+  const EntityHandle* conn;
+  int len;
+  rval = mb.get_connectivity( explicit_adj[0], conn, len );
+  CHECK_ERR(rval);
+}
+
+/* Create the vertices of a 4x4x4 grid in a scrambled order, 
+ * reorder them along the specified curve, and return the 
+ * coordinates in the resulting handle order. */
+void curve_order_common( ReorderTool::CurveType curve, std::vector<double>& coords )
+{
+  const int N = 4;
+  ErrorCode rval;
+  Core moab;
+  Interface& mb = moab;
+  for (int n = 0; n < N*N*N; ++n) {
+    const int m = (37 * n) % (N*N*N);
+    double xyz[3] = { (double)(m % N), (double)(m / N % N), (double)(m / (N*N)) };
+    EntityHandle h;
+    rval = mb.create_vertex( xyz, h );
+    CHECK_ERR(rval);
+  }
+  
+  ReorderTool tool( &moab );
+  Tag mapping;
+  rval = tool.handle_order_from_curve( curve, mapping );
+  CHECK_ERR(rval);
+  rval = tool.reorder_entities( mapping );
+  CHECK_ERR(rval);
+  rval = mb.tag_delete( mapping );
+  CHECK_ERR(rval);
+  
+  Range verts;
+  rval = mb.get_entities_by_type( 0, MBVERTEX, verts );
+  CHECK_ERR(rval);
+  CHECK_EQUAL( (size_t)N*N*N, verts.size() );
+  coords.resize( 3 * verts.size() );
+  rval = mb.get_coords( verts, &coords[0] );
+  CHECK_ERR(rval);
+}
+
+void test_morton_order()
+{
+  std::vector<double> coords;
+  curve_order_common( ReorderTool::MORTON_CURVE, coords );
+  
+    // each consecutive group of 8 vertices is a 2x2x2 block, 
+    // and each consecutive group of 2 is a 1x1x2 block
+  for (size_t i = 0; i < coords.size(); i += 24) 
+    for (size_t j = 3; j < 24; j += 3)
+      for (int d = 0; d < 3; ++d)
+        CHECK_EQUAL( (int)coords[i+d] / 2, (int)coords[i+j+d] / 2 );
+  for (size_t i = 0; i < coords.size(); i += 6) {
+    CHECK_REAL_EQUAL( coords[i  ], coords[i+3], 1e-12 );
+    CHECK_REAL_EQUAL( coords[i+1], coords[i+4], 1e-12 );
+  }
+}
+
+void test_hilbert_order()
+{
+  std::vector<double> coords;
+  curve_order_common( ReorderTool::HILBERT_CURVE, coords );
+  
+    // each vertex is a grid neighbor of the previous one
+  for (size_t i = 3; i < coords.size(); i += 3) {
+    double dist = 0;
+    for (int d = 0; d < 3; ++d)
+      dist += fabs( coords[i+d] - coords[i+d-3] );
+    CHECK_REAL_EQUAL( 1.0, dist, 1e-12 );
+  }
+    // and each consecutive group of 8 vertices is a 2x2x2 block
+  for (size_t i = 0; i < coords.size(); i += 24) 
+    for (size_t j = 3; j < 24; j += 3)
+      for (int d = 0; d < 3; ++d)
+        CHECK_EQUAL( (int)coords[i+d] / 2, (int)coords[i+j+d] / 2 );
+}
+
+/* Largest difference in position in handle order of the
+ * entities in any pair of consecutive values in the list */
+size_t graph_bandwidth( const Range& ents, const std::vector<EntityHandle>& pairs )
+{
+  size_t result = 0;
+  for (size_t i = 0; i < pairs.size(); i += 2) {
+    int a = ents.index( pairs[i] ), b = ents.index( pairs[i+1] );
+    CHECK( a >= 0 && b >= 0 );
+    result = std::max( result, (size_t)abs( a - b ) );
+  }
+  return result;
+}
+
+void test_rcm_order()
+{
+    /* Create a long strip of N x M quads with the vertices and 
+       quads in scrambled order. */
+  const int N = 30, M = 4;
+  ErrorCode rval;
+  Core moab;
+  Interface& mb = moab;
+  std::vector<EntityHandle> verts( (N+1)*(M+1) ), quads( N*M );
+  for (int n = 0; n < (int)verts.size(); ++n) {
+    const int m = (37 * n) % verts.size();
+    double xyz[3] = { (double)(m / (M+1)), (double)(m % (M+1)), 0.0 };
+    rval = mb.create_vertex( xyz, verts[m] );
+    CHECK_ERR(rval);
+  }
+  for (int n = 0; n < (int)quads.size(); ++n) {
+    const int m = (37 * n) % quads.size();
+    const int i = m / M, j = m % M;
+    EntityHandle conn[4] = { verts[i*(M+1)+j], verts[(i+1)*(M+1)+j],
+                             verts[(i+1)*(M+1)+j+1], verts[i*(M+1)+j+1] };
+    rval = mb.create_element( MBQUAD, conn, 4, quads[m] );
+    CHECK_ERR(rval);
+  }
+  
+    /* Vertices are adjacent in the graph if they share a quad, and 
+       quads are adjacent if they share an edge.  Store some pairs of
+       adjacent entities on each quad with handle tags such that they
+       are updated by the reordering. */
+  Tag vtx_pairs, quad_pairs;
+  rval = mb.tag_get_handle( "VTX_PAIRS", 4, MB_TYPE_HANDLE, vtx_pairs, 
+                            MB_TAG_DENSE|MB_TAG_EXCL );
+  CHECK_ERR(rval);
+  rval = mb.tag_get_handle( "QUAD_PAIRS", 4, MB_TYPE_HANDLE, quad_pairs, 
+                            MB_TAG_DENSE|MB_TAG_EXCL );
+  CHECK_ERR(rval);
+  for (int i = 0; i < N; ++i) {
+    for (int j = 0; j < M; ++j) {
+      const EntityHandle q = quads[i*M+j];
+      const EntityHandle* v = &verts[i*(M+1)+j];
+      EntityHandle vpairs[4] = { v[0], v[M+1], v[1], v[M+1] };
+      rval = mb.tag_set_data( vtx_pairs, &q, 1, vpairs );
+      CHECK_ERR(rval);
+      EntityHandle qpairs[4] = { q, i+1 < N ? quads[(i+1)*M+j] : q,
+                                 q, j+1 < M ? quads[i*M+j+1] : q };
+      rval = mb.tag_set_data( quad_pairs, &q, 1, qpairs );
+      CHECK_ERR(rval);
+    }
+  }
+  
+  size_t vbw[2], qbw[2];
+  for (int pass = 0; pass < 2; ++pass) {
+    if (pass) {
+      ReorderTool tool( &moab );
+      Tag mapping;
+      rval = tool.handle_order_from_rcm( mapping );
+      CHECK_ERR(rval);
+      rval = tool.reorder_entities( mapping );
+      CHECK_ERR(rval);
+      rval = mb.tag_delete( mapping );
+      CHECK_ERR(rval);
+    }
+    
+    Range vtx_range, quad_range;
+    rval = mb.get_entities_by_type( 0, MBVERTEX, vtx_range );
+    CHECK_ERR(rval);
+    rval = mb.get_entities_by_type( 0, MBQUAD, quad_range );
+    CHECK_ERR(rval);
+    std::vector<EntityHandle> pairs( 4 * quad_range.size() );
+    rval = mb.tag_get_data( vtx_pairs, quad_range, &pairs[0] );
+    CHECK_ERR(rval);
+    vbw[pass] = graph_bandwidth( vtx_range, pairs );
+    rval = mb.tag_get_data( quad_pairs, quad_range, &pairs[0] );
+    CHECK_ERR(rval);
+    qbw[pass] = graph_bandwidth( quad_range, pairs );
+  }
+
+    /* Bandwidth is reduced to about the width of the strip */
+  CHECK( vbw[1] < vbw[0] );
+  CHECK( qbw[1] < qbw[0] );
+  CHECK( vbw[1] <= (size_t)2*(M+1) );
+  CHECK( qbw[1] <= (size_t)M+1 );
+}
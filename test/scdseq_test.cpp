@@ -1218,6 +1218,8 @@ ErrorCode access_adjacencies(ScdBox *box)
   EntityHandle dum_entity;
   const EntityHandle *connect;
   int num_connect;
+    // adjacent entities may be structured, which need storage for connectivity
+  std::vector<EntityHandle> storage;
   ErrorCode rval;
   bool is_2d = (box_size.k() <= 1);
 
@@ -1230,7 +1232,7 @@ ErrorCode access_adjacencies(ScdBox *box)
     if (MB_SUCCESS != rval) return rval;
   
       // do a simple API call on that entity to make sure we can
-    rval = box->sc_impl()->impl()->get_connectivity(dum_entity, connect, num_connect);
+    rval = box->sc_impl()->impl()->get_connectivity(dum_entity, connect, num_connect, false, &storage);
     if (MB_SUCCESS != rval) return rval;
   }
     // middle:
@@ -1244,7 +1246,7 @@ ErrorCode access_adjacencies(ScdBox *box)
     if (MB_SUCCESS != rval) return rval;
   
       // do a simple API call on that entity to make sure we can
-    rval = box->sc_impl()->impl()->get_connectivity(dum_entity, connect, num_connect);
+    rval = box->sc_impl()->impl()->get_connectivity(dum_entity, connect, num_connect, false, &storage);
     if (MB_SUCCESS != rval) return rval;
   }
   
@@ -1261,7 +1263,7 @@ ErrorCode access_adjacencies(ScdBox *box)
     if (MB_SUCCESS != rval) return rval;
   
       // do a simple API call on that entity to make sure we can
-    rval = box->sc_impl()->impl()->get_connectivity(dum_entity, connect, num_connect);
+    rval = box->sc_impl()->impl()->get_connectivity(dum_entity, connect, num_connect, false, &storage);
     if (MB_SUCCESS != rval) return rval;
   }
   
@@ -1273,7 +1275,7 @@ ErrorCode access_adjacencies(ScdBox *box)
     if (MB_SUCCESS != rval) return rval;
   
       // do a simple API call on that entity to make sure we can
-    rval = box->sc_impl()->impl()->get_connectivity(dum_entity, connect, num_connect);
+    rval = box->sc_impl()->impl()->get_connectivity(dum_entity, connect, num_connect, false, &storage);
     if (MB_SUCCESS != rval) return rval;
   }
     // middle:
@@ -1287,7 +1289,7 @@ ErrorCode access_adjacencies(ScdBox *box)
     if (MB_SUCCESS != rval) return rval;
   
       // do a simple API call on that entity to make sure we can
-    rval = box->sc_impl()->impl()->get_connectivity(dum_entity, connect, num_connect);
+    rval = box->sc_impl()->impl()->get_connectivity(dum_entity, connect, num_connect, false, &storage);
     if (MB_SUCCESS != rval) return rval;
   }
   
@@ -1304,7 +1306,7 @@ ErrorCode access_adjacencies(ScdBox *box)
     if (MB_SUCCESS != rval) return rval;
   
       // do a simple API call on that entity to make sure we can
-    rval = box->sc_impl()->impl()->get_connectivity(dum_entity, connect, num_connect);
+    rval = box->sc_impl()->impl()->get_connectivity(dum_entity, connect, num_connect, false, &storage);
     if (MB_SUCCESS != rval) return rval;
   }
 
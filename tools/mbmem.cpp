@@ -1,6 +1,7 @@
 #include "moab/Core.hpp"
 #include "moab/Range.hpp"
 #include "moab/CN.hpp"
+#include "moab/MemoryCounter.hpp"
 
 #include <iostream>
 #include <iomanip>
@@ -18,8 +19,8 @@
 static void usage( const char* argv0, bool help = false )
 {
   std::ostream& str = help ? std::cout : std::cerr;
-  str << "Usage: " << argv0 << " [-H|-b|-k|-m] <filename> [<filename> ...]" << std::endl
-      << "       " << argv0 << " [-H|-b|-k|-m] -T" << std::endl;
+  str << "Usage: " << argv0 << " [-H|-b|-k|-m] [-c] <filename> [<filename> ...]" << std::endl
+      << "       " << argv0 << " [-H|-b|-k|-m] [-c] -T" << std::endl;
   if (!help) {
     str << "       " << argv0 << " -h" << std::endl;
     std::exit(1);
@@ -30,6 +31,7 @@ static void usage( const char* argv0, bool help = false )
             << "  -k : kilobytes (1 kB == 1024 bytes)" << std::endl
             << "  -m : megabytes (1 MB == 1024 kB)" << std::endl
             << "  -g : gigabytes (1 GB == 1024 MB)" << std::endl
+            << "  -c : print live allocation counters after each file is loaded" << std::endl
             << "  -T : test mode" << std::endl
             << std::endl;
   std::exit(0);
@@ -37,6 +39,7 @@ static void usage( const char* argv0, bool help = false )
 
 enum Units { HUMAN, BYTES, KILOBYTES, MEGABYTES, GIGABYTES };
 Units UNITS = HUMAN;
+bool COUNTERS = false;
 
   // The core functionality of this example
 static void print_memory_stats( moab::Interface& mb,
@@ -45,6 +48,9 @@ static void print_memory_stats( moab::Interface& mb,
                                 bool totals = true,
                                 bool sysstats = true );
   
+  // Print live allocation counters for each subsystem and tag
+static void print_memory_counters( moab::Interface& mb );
+  
   // Generate a series of meshes for testing
 static void do_test_mode();
   
@@ -69,6 +75,8 @@ int main( int argc, char* argv[] )
         UNITS = MEGABYTES;
       else if(!strcmp(argv[i],"-g"))
         UNITS = GIGABYTES;
+      else if(!strcmp(argv[i],"-c"))
+        COUNTERS = true;
       else if(!strcmp(argv[i],"-T"))
         test_mode = true;
       else if(!strcmp(argv[i],"-h"))
@@ -107,6 +115,8 @@ int main( int argc, char* argv[] )
     }
     
     std::cout << "Loaded file: " << argv[*it] << std::endl;
+    if (COUNTERS)
+      print_memory_counters(mb);
   }
   
     // print summary of MOAB's memory use
@@ -268,6 +278,9 @@ void print_memory_stats( moab::Interface& mb,
 
   } // end totals
 
+  if (COUNTERS)
+    print_memory_counters(mb);
+
   if (sysstats) {
     std::FILE* filp = std::fopen("/proc/self/stat", "r");
     unsigned long vsize;
@@ -324,6 +337,55 @@ void print_memory_stats( moab::Interface& mb,
   } // end sysstats
 }
 
+void print_memory_counters( moab::Interface& mb )
+{
+  const int NAME_WIDTH = 14;
+  const int MEM_WIDTH = 7;
+  const int COUNT_WIDTH = 10;
+  
+  std::cout.fill(' ');
+  std::cout << std::endl
+            << std::left << std::setw(NAME_WIDTH) << "Counter" << ' '
+            << std::left << std::setw(MEM_WIDTH) << "Live" << ' '
+            << std::left << std::setw(MEM_WIDTH) << "Peak" << ' '
+            << std::left << std::setw(COUNT_WIDTH) << "Blocks" << std::endl;
+  std::cout.fill('-');
+  std::cout << std::setw(NAME_WIDTH) << '-' << ' '
+            << std::setw(MEM_WIDTH) << '-' << ' '
+            << std::setw(MEM_WIDTH) << '-' << ' '
+            << std::setw(COUNT_WIDTH) << '-' << std::endl;
+  std::cout.fill(' ');
+  
+  for (int i = 0; i < moab::MEM_NUM_CATEGORIES; ++i) {
+    moab::MemoryCategory cat = (moab::MemoryCategory)i;
+    const moab::MemoryCounter& c = moab::MemoryCounter::category( cat );
+    std::cout << std::left << std::setw(NAME_WIDTH) << moab::MemoryCounter::category_name(cat) << ' '
+              << std::right << std::setw(MEM_WIDTH) << memstr(c.bytes()) << ' '
+              << std::right << std::setw(MEM_WIDTH) << memstr(c.peak_bytes()) << ' '
+              << std::right << std::setw(COUNT_WIDTH) << c.allocations() << std::endl;
+  }
+  
+    // per-tag counters, indented under the "Tags" category
+  std::vector<moab::Tag> tags;
+  mb.tag_get_tags( tags );
+  for (std::vector<moab::Tag>::iterator ti = tags.begin(); ti != tags.end(); ++ti) {
+    const moab::MemoryCounter* c;
+    if (moab::MB_SUCCESS != mb.tag_get_memory_counter( *ti, c ) || !c->peak_bytes())
+      continue;
+    std::string name;
+    if (moab::MB_SUCCESS != mb.tag_get_name( *ti, name ) || name.empty())
+      name = "(anonymous)";
+    name = "  " + name;
+    if (name.size() > (size_t)NAME_WIDTH)
+      name = name.substr( 0, NAME_WIDTH );
+    std::cout << std::left << std::setw(NAME_WIDTH) << name << ' '
+              << std::right << std::setw(MEM_WIDTH) << memstr(c->bytes()) << ' '
+              << std::right << std::setw(MEM_WIDTH) << memstr(c->peak_bytes()) << ' '
+              << std::right << std::setw(COUNT_WIDTH) << c->allocations() << std::endl;
+  }
+  std::cout << std::endl;
+}
+
 
 bool is_zero( const MemStats& stats ) { return stats.total_amortized == 0; }
 